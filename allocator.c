@@ -0,0 +1,44 @@
+#include "allocator.h"
+#include <stdint.h>
+#include <string.h>
+
+void* allocator_t_alloc(allocator_t* p_allocator, size_t size)
+{
+    if (!p_allocator) return malloc(size);
+
+    return p_allocator->p_alloc(p_allocator->p_context, size);
+}
+
+void* allocator_t_calloc(allocator_t* p_allocator, size_t count, size_t size)
+{
+    void* p_block;
+
+    if (!p_allocator) return calloc(count, size);
+    if (size && count > SIZE_MAX / size) return NULL;
+
+    p_block = p_allocator->p_alloc(p_allocator->p_context, count * size);
+
+    if (p_block) memset(p_block, 0, count * size);
+
+    return p_block;
+}
+
+void* allocator_t_realloc(allocator_t* p_allocator, void* p_block, size_t size)
+{
+    if (!p_allocator) return realloc(p_block, size);
+
+    return p_allocator->p_realloc(p_allocator->p_context, p_block, size);
+}
+
+void allocator_t_free(allocator_t* p_allocator, void* p_block)
+{
+    if (!p_block) return;
+
+    if (!p_allocator)
+    {
+        free(p_block);
+        return;
+    }
+
+    p_allocator->p_free(p_allocator->p_context, p_block);
+}
@@ -0,0 +1,54 @@
+#ifndef ALLOCATOR_H
+#define	ALLOCATOR_H
+
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A memory allocator. Each function receives 'p_context' as its first      *
+    * argument. 'p_realloc' follows the contract of 'realloc' and 'p_free'     *
+    * must accept NULL. A container keeps a pointer to the allocator it was    *
+    * allocated with and returns all of its memory to it, so the allocator     *
+    * must outlive the container. A NULL allocator stands for the C library.   *
+    ***************************************************************************/
+    typedef struct allocator_t {
+        void* (*p_alloc)  (void* p_context, size_t size);
+        void* (*p_realloc)(void* p_context, void* p_block, size_t size);
+        void  (*p_free)   (void* p_context, void* p_block);
+        void*   p_context;
+    } allocator_t;
+
+    /***************************************************************************
+    * Allocates 'size' bytes from 'p_allocator'.                               *
+    ***************************************************************************/
+    void* allocator_t_alloc  (allocator_t* p_allocator, size_t size);
+
+    /***************************************************************************
+    * Allocates 'count' zeroed elements of 'size' bytes from 'p_allocator'.    *
+    * Returns NULL if the total size overflows.                                *
+    ***************************************************************************/
+    void* allocator_t_calloc (allocator_t* p_allocator,
+                              size_t count,
+                              size_t size);
+
+    /***************************************************************************
+    * Resizes the block 'p_block' of 'p_allocator' to 'size' bytes.            *
+    ***************************************************************************/
+    void* allocator_t_realloc(allocator_t* p_allocator,
+                              void* p_block,
+                              size_t size);
+
+    /***************************************************************************
+    * Returns the block 'p_block' to 'p_allocator'. Does nothing if 'p_block'  *
+    * is NULL.                                                                 *
+    ***************************************************************************/
+    void  allocator_t_free   (allocator_t* p_allocator, void* p_block);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* ALLOCATOR_H */
@@ -0,0 +1,467 @@
+#include "ara_star.h"
+#include "directed_graph_node.h"
+#include "heap.h"
+#include "list.h"
+#include "utils.h"
+#include <math.h>
+
+/* The number of children whose estimates are computed in one batch. */
+#define HEURISTIC_BATCH 64
+
+struct ara_star_t {
+    search_state_t                    state;
+    directed_graph_node_t*            p_source;
+    directed_graph_node_t*            p_target;
+    directed_graph_weight_function_t* p_weight_function;
+    heuristic_t                       heuristic;
+    search_stats_t*                   p_stats;
+    search_recorder_t*                p_recorder;
+    search_budget_t*                  p_budget;
+    /* The estimate of each node reached so far. */
+    unordered_map_t*                  p_estimate_map;
+    /* The settled nodes whose costs were lowered in this iteration. */
+    unordered_set_t*                  p_inconsistent_set;
+    /* The open nodes between two iterations, to be keyed anew. */
+    list_t*                           p_open_list;
+    /* The nodes settled over all the iterations, which the budget counts. */
+    size_t                            settled;
+    double                            epsilon;
+    double                            bound;
+    bool                              finished;
+};
+
+static double weight_of(unordered_map_t* p_map, directed_graph_node_t* p_node)
+{
+    return ((weight_t*) unordered_map_t_get(p_map, p_node))->weight;
+}
+
+/*******************************************************************************
+* Adds 'p_node' to the open set keyed by its cost plus 'inflation' times its   *
+* estimate. Returns false if there is not enough memory.                       *
+*******************************************************************************/
+static bool open_node(ara_star_t* p_search,
+                      directed_graph_node_t* p_node,
+                      double inflation)
+{
+    weight_t* p_key = allocator_t_alloc(p_search->state.p_allocator,
+                                        sizeof(*p_key));
+
+    if (!p_key) return false;
+
+    p_key->weight = weight_of(p_search->state.p_cost_map, p_node) +
+                    inflation * weight_of(p_search->p_estimate_map, p_node);
+    list_t_push_back(p_search->state.p_weight_list, p_key);
+
+    if (heap_t_contains_key(p_search->state.p_open_set, p_node))
+    {
+        heap_t_decrease_key(p_search->state.p_open_set, p_node, p_key);
+        SEARCH_STATS_COUNT(p_search->p_stats, decrease_keys);
+    }
+    else
+    {
+        heap_t_add(p_search->state.p_open_set, p_node, p_key);
+        SEARCH_STATS_COUNT(p_search->p_stats, heap_pushes);
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Sets the cost and the parent of 'p_node', and its estimate if the node is    *
+* new. Returns false if there is not enough memory.                            *
+*******************************************************************************/
+static bool reach_node(ara_star_t* p_search,
+                       directed_graph_node_t* p_node,
+                       directed_graph_node_t* p_parent,
+                       double cost,
+                       double estimate)
+{
+    allocator_t* p_allocator = p_search->state.p_allocator;
+    weight_t*    p_weight    = allocator_t_alloc(p_allocator,
+                                                 sizeof(*p_weight));
+    weight_t*    p_estimate;
+
+    if (!p_weight) return false;
+
+    p_weight->weight = cost;
+    list_t_push_back(p_search->state.p_weight_list, p_weight);
+    unordered_map_t_put(p_search->state.p_cost_map, p_node, p_weight);
+    unordered_map_t_put(p_search->state.p_parent_map, p_node, p_parent);
+
+    if (!unordered_map_t_contains_key(p_search->p_estimate_map, p_node))
+    {
+        if (!(p_estimate = allocator_t_alloc(p_allocator,
+                                             sizeof(*p_estimate))))
+        {
+            return false;
+        }
+
+        p_estimate->weight = estimate;
+        list_t_push_back(p_search->state.p_weight_list, p_estimate);
+        unordered_map_t_put(p_search->p_estimate_map, p_node, p_estimate);
+    }
+
+    return true;
+}
+
+ara_star_t* ara_star_t_alloc(
+        directed_graph_node_t* p_source,
+        directed_graph_node_t* p_target,
+        directed_graph_weight_function_t* p_weight_function,
+        unordered_map_t* p_location_map,
+        double epsilon,
+        search_options_t* p_options)
+{
+    ara_star_t*  p_search;
+    allocator_t* p_allocator = p_options ? p_options->p_allocator : NULL;
+
+    if (!p_source)           return NULL;
+    if (!p_target)           return NULL;
+    if (!p_weight_function)  return NULL;
+    if (!(epsilon >= 0.0))   return NULL;
+
+    if (!(p_search = allocator_t_calloc(p_allocator, 1, sizeof(*p_search))))
+    {
+        return NULL;
+    }
+
+    if (!choose_heuristic(&p_search->heuristic, p_location_map, p_options))
+    {
+        allocator_t_free(p_allocator, p_search);
+        return NULL;
+    }
+
+    p_search->p_source           = p_source;
+    p_search->p_target           = p_target;
+    p_search->p_weight_function  = p_weight_function;
+    p_search->p_stats            = p_options ? p_options->p_stats : NULL;
+    p_search->p_recorder         = p_options ? p_options->p_recorder : NULL;
+    p_search->p_budget           = p_options ? p_options->p_budget : NULL;
+    p_search->epsilon            = epsilon;
+    p_search->bound              = INFINITY;
+
+    SEARCH_STATS_START(p_search->p_stats);
+    SEARCH_RECORDER_CLEAR(p_search->p_recorder);
+    search_state_t_alloc(&p_search->state, p_allocator);
+
+    p_search->p_estimate_map     = unordered_map_t_alloc(INITIAL_CAPACITY,
+                                                         LOAD_FACTOR,
+                                                         hash_function,
+                                                         equals_function,
+                                                         p_allocator);
+    p_search->p_inconsistent_set = unordered_set_t_alloc(INITIAL_CAPACITY,
+                                                         LOAD_FACTOR,
+                                                         hash_function,
+                                                         equals_function,
+                                                         p_allocator);
+    p_search->p_open_list        = list_t_alloc(INITIAL_CAPACITY, p_allocator);
+
+    if (!search_state_t_is_ready(&p_search->state)
+            || !p_search->p_estimate_map
+            || !p_search->p_inconsistent_set
+            || !p_search->p_open_list
+            || !reach_node(p_search,
+                           p_source,
+                           NULL,
+                           0.0,
+                           heuristic_t_estimate(&p_search->heuristic,
+                                                p_source,
+                                                p_target))
+            || !list_t_push_back(p_search->p_open_list, p_source))
+    {
+        ara_star_t_free(p_search);
+        return NULL;
+    }
+
+    SEARCH_STATS_END_PHASE(p_search->p_stats, setup_time);
+    return p_search;
+}
+
+/*******************************************************************************
+* Runs a weighted A* search over the open set until no open node has a key     *
+* below the cost of the target. Returns false if there is not enough memory or *
+* the budget runs out.                                                         *
+*******************************************************************************/
+static bool improve_path(ara_star_t* p_search, double inflation)
+{
+    search_state_t*          p_state  = &p_search->state;
+    search_stats_t*          p_stats  = p_search->p_stats;
+    directed_graph_node_t*   p_target = p_search->p_target;
+    directed_graph_node_t*   p_current;
+    directed_graph_node_t*   p_child;
+    directed_graph_node_t**  p_children;
+    weight_t*                p_child_cost;
+    size_t                   child_count;
+    size_t                   i;
+    double                   estimates[HEURISTIC_BATCH];
+    double                   cost;
+    double                   key;
+
+    while (heap_t_size(p_state->p_open_set) > 0)
+    {
+        SEARCH_STATS_PEAK(p_stats,
+                          peak_memory,
+                          search_state_t_memory_usage(p_state));
+
+        if (SEARCH_BUDGET_EXHAUSTED(p_search->p_budget,
+                                    p_search->settled,
+                                    search_state_t_memory_usage(p_state)))
+        {
+            return false;
+        }
+
+        p_current = heap_t_min(p_state->p_open_set);
+        key = weight_of(p_state->p_cost_map, p_current) +
+              inflation * weight_of(p_search->p_estimate_map, p_current);
+
+        if (unordered_map_t_contains_key(p_state->p_cost_map, p_target) &&
+            weight_of(p_state->p_cost_map, p_target) <= key)
+        {
+            break;
+        }
+
+        heap_t_extract_min(p_state->p_open_set);
+        unordered_set_t_add(p_state->p_closed_set, p_current);
+
+        SEARCH_STATS_COUNT(p_stats, heap_pops);
+        SEARCH_STATS_COUNT(p_stats, nodes_settled);
+        ++p_search->settled;
+        SEARCH_RECORDER_SETTLE(p_search->p_recorder,
+                               p_current,
+                               weight_of(p_state->p_cost_map, p_current),
+                               key,
+                               SEARCH_FORWARD);
+
+        p_children  = directed_graph_node_t_children(p_current);
+        child_count = directed_graph_node_t_child_count(p_current);
+
+        for (i = 0; i < child_count; ++i)
+        {
+            p_child = p_children[i];
+
+            if (i % HEURISTIC_BATCH == 0)
+            {
+                heuristic_t_estimate_batch(
+                        &p_search->heuristic,
+                        p_children + i,
+                        child_count - i < HEURISTIC_BATCH ?
+                                child_count - i : HEURISTIC_BATCH,
+                        p_target,
+                        estimates);
+            }
+
+            SEARCH_STATS_COUNT(p_stats, arcs_relaxed);
+
+            cost = weight_of(p_state->p_cost_map, p_current) +
+                   *directed_graph_weight_function_t_get(
+                           p_search->p_weight_function,
+                           p_current,
+                           p_child);
+            p_child_cost = unordered_map_t_get(p_state->p_cost_map, p_child);
+
+            if (p_child_cost && p_child_cost->weight <= cost) continue;
+
+            if (!reach_node(p_search,
+                            p_child,
+                            p_current,
+                            cost,
+                            estimates[i % HEURISTIC_BATCH]))
+            {
+                return false;
+            }
+
+            /* A settled node waits for the next iteration. */
+            if (unordered_set_t_contains(p_state->p_closed_set, p_child))
+            {
+                unordered_set_t_add(p_search->p_inconsistent_set, p_child);
+            }
+            else if (!open_node(p_search, p_child, inflation))
+            {
+                return false;
+            }
+
+            SEARCH_STATS_PEAK(p_stats,
+                              peak_open_set,
+                              heap_t_size(p_state->p_open_set));
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Moves the open and the inconsistent nodes to the open list, and returns the  *
+* least cost plus estimate among them, which bounds the cost of the shortest   *
+* path to the target from below.                                               *
+*******************************************************************************/
+static double collect_open_nodes(ara_star_t* p_search)
+{
+    unordered_set_iterator_t* p_iterator;
+    directed_graph_node_t*    p_node;
+    double                    least = INFINITY;
+    double                    value;
+    size_t                    i;
+
+    while (heap_t_size(p_search->state.p_open_set) > 0)
+    {
+        list_t_push_back(p_search->p_open_list,
+                         heap_t_extract_min(p_search->state.p_open_set));
+    }
+
+    p_iterator = unordered_set_iterator_t_alloc(p_search->p_inconsistent_set);
+
+    while (p_iterator && unordered_set_iterator_t_has_next(p_iterator))
+    {
+        unordered_set_iterator_t_next(p_iterator, (void**) &p_node);
+        list_t_push_back(p_search->p_open_list, p_node);
+    }
+
+    if (p_iterator) unordered_set_iterator_t_free(p_iterator);
+    unordered_set_t_clear(p_search->p_inconsistent_set);
+
+    for (i = 0; i < list_t_size(p_search->p_open_list); ++i)
+    {
+        p_node = list_t_get(p_search->p_open_list, i);
+        value  = weight_of(p_search->state.p_cost_map, p_node) +
+                 weight_of(p_search->p_estimate_map, p_node);
+
+        if (value < least) least = value;
+    }
+
+    return least;
+}
+
+list_t* ara_star_t_next(ara_star_t* p_search)
+{
+    list_t*                p_path;
+    directed_graph_node_t* p_target;
+    double                 cost;
+    double                 least;
+    size_t                 i;
+
+    if (!p_search || p_search->finished) return NULL;
+
+    p_target = p_search->p_target;
+    search_budget_t_start(p_search->p_budget);
+
+    /* Key the nodes left open by the previous iteration anew. */
+    unordered_set_t_clear(p_search->state.p_closed_set);
+
+    for (i = 0; i < list_t_size(p_search->p_open_list); ++i)
+    {
+        if (!open_node(p_search,
+                       list_t_get(p_search->p_open_list, i),
+                       1.0 + p_search->epsilon))
+        {
+            return NULL;
+        }
+    }
+
+    list_t_clear(p_search->p_open_list);
+
+    if (!improve_path(p_search, 1.0 + p_search->epsilon)) return NULL;
+
+    SEARCH_STATS_END_PHASE(p_search->p_stats, search_time);
+    least = collect_open_nodes(p_search);
+
+    if (!unordered_map_t_contains_key(p_search->state.p_cost_map, p_target))
+    {
+        /* Nothing was left open, so nothing can reach the target. */
+        p_search->finished = true;
+        p_search->bound    = 0.0;
+        return list_t_alloc(10, NULL);
+    }
+
+    SEARCH_RECORDER_MEET(p_search->p_recorder, p_target);
+    p_path = traceback_path(p_target, p_search->state.p_parent_map);
+    SEARCH_STATS_END_PHASE(p_search->p_stats, traceback_time);
+
+    cost = weight_of(p_search->state.p_cost_map, p_target);
+    p_search->bound = cost <= least ? 0.0 : cost / least - 1.0;
+
+    if (p_search->bound > p_search->epsilon)
+    {
+        p_search->bound = p_search->epsilon;
+    }
+
+    if (p_search->bound == 0.0 || p_search->epsilon == 0.0)
+    {
+        p_search->finished = true;
+    }
+
+    p_search->epsilon = p_search->epsilon / 2.0 < p_search->bound ?
+                        p_search->epsilon / 2.0 :
+                        p_search->bound;
+
+    if (p_search->epsilon < ARA_STAR_LEAST_EPSILON) p_search->epsilon = 0.0;
+
+    return p_path;
+}
+
+double ara_star_t_bound(ara_star_t* p_search)
+{
+    return p_search ? p_search->bound : INFINITY;
+}
+
+void ara_star_t_free(ara_star_t* p_search)
+{
+    allocator_t* p_allocator;
+
+    if (!p_search) return;
+
+    p_allocator = p_search->state.p_allocator;
+    search_state_t_free(&p_search->state);
+
+    if (p_search->p_estimate_map)
+    {
+        unordered_map_t_free(p_search->p_estimate_map);
+    }
+
+    if (p_search->p_inconsistent_set)
+    {
+        unordered_set_t_free(p_search->p_inconsistent_set);
+    }
+
+    if (p_search->p_open_list) list_t_free(p_search->p_open_list);
+
+    allocator_t_free(p_allocator, p_search);
+}
+
+list_t* ara_star(directed_graph_node_t* p_source,
+                 directed_graph_node_t* p_target,
+                 directed_graph_weight_function_t* p_weight_function,
+                 unordered_map_t* p_location_map,
+                 double epsilon,
+                 unsigned long long time_budget,
+                 double* p_bound,
+                 search_options_t* p_options)
+{
+    unsigned long long start = search_budget_now();
+    ara_star_t*        p_search;
+    list_t*            p_path;
+    list_t*            p_next;
+
+    if (!(p_search = ara_star_t_alloc(p_source,
+                                      p_target,
+                                      p_weight_function,
+                                      p_location_map,
+                                      epsilon,
+                                      p_options)))
+    {
+        return NULL;
+    }
+
+    p_path = ara_star_t_next(p_search);
+
+    while (p_path && search_budget_now() - start < time_budget &&
+           (p_next = ara_star_t_next(p_search)))
+    {
+        list_t_free(p_path);
+        p_path = p_next;
+    }
+
+    if (p_bound) *p_bound = ara_star_t_bound(p_search);
+
+    ara_star_t_free(p_search);
+    return p_path;
+}
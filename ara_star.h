@@ -0,0 +1,91 @@
+#ifndef ARA_STAR_H
+#define	ARA_STAR_H
+
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include "unordered_map.h"
+#include "list.h"
+#include "search_options.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The smallest inflation an anytime search tries before the last, exact    *
+    * one.                                                                     *
+    ***************************************************************************/
+#define ARA_STAR_LEAST_EPSILON 0.001
+
+    /***************************************************************************
+    * An anytime repairing A* (ARA*) search. Each iteration is a weighted A*   *
+    * search with a smaller inflation than the one before, which only expands  *
+    * the nodes whose costs the previous iterations lowered: the costs,        *
+    * parents, open set and nodes reached more cheaply after they were         *
+    * settled all carry over, so a run of iterations costs little more than    *
+    * its first one. Each iteration yields a path no worse than the previous   *
+    * one with a tighter bound on its cost.                                    *
+    ***************************************************************************/
+    typedef struct ara_star_t ara_star_t;
+
+    /***************************************************************************
+    * Prepares a search from 'p_source' to 'p_target' whose first iteration    *
+    * inflates the estimates by 1 + 'epsilon'. The heuristic is chosen as in   *
+    * 'astar_with_options', and the statistics of 'p_options' add up over all  *
+    * the iterations. Returns NULL if 'epsilon' is negative, there is no       *
+    * heuristic or there is not enough memory.                                 *
+    ***************************************************************************/
+    ara_star_t* ara_star_t_alloc(
+            directed_graph_node_t* p_source,
+            directed_graph_node_t* p_target,
+            directed_graph_weight_function_t* p_weight_function,
+            unordered_map_t* p_location_map,
+            double epsilon,
+            search_options_t* p_options);
+
+    /***************************************************************************
+    * Runs the next iteration and returns its path, which is empty if the      *
+    * target is not reachable. Each iteration halves the inflation of the      *
+    * previous one, or lowers it to the bound already proven if that is less,  *
+    * and drops it to zero once it falls below 'ARA_STAR_LEAST_EPSILON'.       *
+    * Returns NULL once a path is known to be the shortest one, if there is    *
+    * not enough memory, or if the budget of the options runs out, in which    *
+    * case the next call resumes the interrupted iteration.                    *
+    ***************************************************************************/
+    list_t* ara_star_t_next(ara_star_t* p_search);
+
+    /***************************************************************************
+    * Returns the epsilon for which the last path costs at most 1 + epsilon    *
+    * times the shortest one. It never exceeds the inflation of the iteration  *
+    * and is often much less. Returns INFINITY before the first iteration.     *
+    ***************************************************************************/
+    double ara_star_t_bound(ara_star_t* p_search);
+
+    /***************************************************************************
+    * Deallocates the search. The paths it returned are left alone.            *
+    ***************************************************************************/
+    void ara_star_t_free(ara_star_t* p_search);
+
+    /***************************************************************************
+    * Runs the iterations of an ARA* search starting at 'epsilon' as long as   *
+    * 'time_budget' nanoseconds have not passed, and returns the last path.    *
+    * The first iteration always runs, and an iteration is only cut short by   *
+    * the budget of the options, which keeps the path found before it.         *
+    * If 'p_bound' is not NULL, the bound of the path is stored there.         *
+    * Returns NULL if 'ara_star_t_alloc' would or the budget runs out before   *
+    * the first path.                                                          *
+    ***************************************************************************/
+    list_t* ara_star(directed_graph_node_t* p_source,
+                     directed_graph_node_t* p_target,
+                     directed_graph_weight_function_t* p_weight_function,
+                     unordered_map_t* p_location_map,
+                     double epsilon,
+                     unsigned long long time_budget,
+                     double* p_bound,
+                     search_options_t* p_options);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* ARA_STAR_H */
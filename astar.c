@@ -6,44 +6,85 @@
 #include "list.h"
 #include "utils.h"
 
-static double heuristic_cost(unordered_map_t* p_location_map,
-                             directed_graph_node_t* p_node_a,
-                             directed_graph_node_t* p_node_b)
-{
-    point_3d_t* p_point_a = unordered_map_t_get(p_location_map, p_node_a);
-    point_3d_t* p_point_b = unordered_map_t_get(p_location_map, p_node_b);
-    return point_3d_t_distance(p_point_a, p_point_b);
-}
+/* The number of children whose estimates are computed in one batch. */
+#define HEURISTIC_BATCH 64
 
 list_t* astar(directed_graph_node_t* p_source,
               directed_graph_node_t* p_target,
               directed_graph_weight_function_t* p_weight_function,
-              unordered_map_t* p_location_map_arg)
+              unordered_map_t* p_location_map)
+{
+    return astar_with_options(p_source, 
+                              p_target, 
+                              p_weight_function, 
+                              p_location_map, 
+                              NULL);
+}
+
+list_t* astar_with_options(directed_graph_node_t* p_source,
+                           directed_graph_node_t* p_target,
+                           directed_graph_weight_function_t* p_weight_function,
+                           unordered_map_t* p_location_map,
+                           search_options_t* p_options)
+{
+    return weighted_astar(p_source,
+                          p_target,
+                          p_weight_function,
+                          p_location_map,
+                          0.0,
+                          p_options);
+}
+
+list_t* weighted_astar(directed_graph_node_t* p_source,
+                       directed_graph_node_t* p_target,
+                       directed_graph_weight_function_t* p_weight_function,
+                       unordered_map_t* p_location_map,
+                       double epsilon,
+                       search_options_t* p_options)
 {
     search_state_t            state;
+    search_stats_t*           p_stats;
+    heap_trace_t*             p_heap_trace;
+    search_recorder_t*        p_recorder;
+    search_budget_t*          p_budget;
+    heuristic_t               heuristic;
 
     list_t*                   p_list;
     heap_t*                   p_open_set;
     unordered_set_t*          p_closed_set;
     unordered_map_t*          p_parent_map;
     unordered_map_t*          p_cost_map;
-    unordered_map_t*          p_location_map;
     directed_graph_node_t*    p_current;
     directed_graph_node_t*    p_child;
-    unordered_set_iterator_t* p_child_iterator;
+    directed_graph_node_t**   p_children;
+    size_t                    child_count;
+    size_t                    i;
+    size_t                    settled = 0;
+    double                    estimates[HEURISTIC_BATCH];
+    double                    estimate;
+    double                    inflation = 1.0 + epsilon;
 
     /* Cannot pack a double into a void*, so use these simple structures. */
     weight_t*                 p_weight;
     weight_t*                 p_weight_f;
     list_t*                   p_weight_list;
-    size_t                    i;
 
     if (!p_source)           return NULL;
     if (!p_target)           return NULL;
     if (!p_weight_function)  return NULL;
-    if (!p_location_map_arg) return NULL;
+    if (!(epsilon >= 0.0))   return NULL;
+
+    p_stats      = p_options ? p_options->p_stats : NULL;
+    p_heap_trace = p_options ? p_options->p_heap_trace : NULL;
+    p_recorder   = p_options ? p_options->p_recorder : NULL;
+    p_budget     = p_options ? p_options->p_budget : NULL;
 
-    search_state_t_alloc(&state);
+    if (!choose_heuristic(&heuristic, p_location_map, p_options)) return NULL;
+
+    SEARCH_STATS_START(p_stats);
+    SEARCH_RECORDER_CLEAR(p_recorder);
+    search_budget_t_start(p_budget);
+    search_state_t_alloc(&state, p_options ? p_options->p_allocator : NULL);
 
     if (!search_state_t_is_ready(&state)) 
     {
@@ -51,50 +92,104 @@ list_t* astar(directed_graph_node_t* p_source,
         return NULL;
     }
 
-    p_weight = malloc(sizeof(*p_weight));
-    p_weight->weight = 0.0;
-
     p_open_set    = state.p_open_set;
     p_closed_set  = state.p_closed_set;
     p_weight_list = state.p_weight_list;
     p_cost_map    = state.p_cost_map;
     p_parent_map  = state.p_parent_map;
 
-    p_location_map = p_location_map_arg;
-
-    p_weight = malloc(sizeof(*p_weight));
+    p_weight = allocator_t_alloc(state.p_allocator, sizeof(*p_weight));
     p_weight->weight = 0.0;
 
     heap_t_add(p_open_set, p_source, p_weight);
     unordered_map_t_put(p_parent_map, p_source, NULL);
+
     unordered_map_t_put(p_cost_map, p_source, p_weight);
     list_t_push_back(p_weight_list, p_weight);
 
+    if (p_heap_trace)
+    {
+        heap_trace_t_begin(p_heap_trace);
+        heap_trace_t_add(p_heap_trace, p_source, 0.0);
+    }
+
+    SEARCH_STATS_COUNT(p_stats, heap_pushes);
+    SEARCH_STATS_PEAK(p_stats, peak_open_set, 1);
+    SEARCH_STATS_END_PHASE(p_stats, setup_time);
+
     while (heap_t_size(p_open_set) > 0)
     {
+        SEARCH_STATS_PEAK(p_stats,
+                          peak_memory,
+                          search_state_t_memory_usage(&state));
+
+        if (SEARCH_BUDGET_EXHAUSTED(p_budget,
+                                    settled,
+                                    search_state_t_memory_usage(&state)))
+        {
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
+            search_state_t_free(&state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+            return NULL;
+        }
+
         p_current = heap_t_extract_min(p_open_set);
 
+        if (p_heap_trace) heap_trace_t_extract_min(p_heap_trace, p_current);
+
+        SEARCH_STATS_COUNT(p_stats, heap_pops);
+        SEARCH_STATS_COUNT(p_stats, nodes_settled);
+        ++settled;
+        SEARCH_RECORDER_SETTLE(p_recorder,
+                               p_current,
+                               ((weight_t*) unordered_map_t_get(
+                                       p_cost_map, p_current))->weight,
+                               ((weight_t*) unordered_map_t_get(
+                                       p_cost_map, p_current))->weight +
+                               inflation * 
+                               heuristic_t_estimate(&heuristic,
+                                                    p_current,
+                                                    p_target),
+                               SEARCH_FORWARD);
+
         if (equals_function(p_current, p_target)) 
         {
+            SEARCH_RECORDER_MEET(p_recorder, p_target);
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
             p_list = traceback_path(p_target, p_parent_map);
+            SEARCH_STATS_END_PHASE(p_stats, traceback_time);
             search_state_t_free(&state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
             return p_list;
         }
 
         unordered_set_t_add(p_closed_set, p_current);
 
-        p_child_iterator = 
-                unordered_set_iterator_t_alloc(
-                    directed_graph_node_t_children_set(p_current));
+        p_children  = directed_graph_node_t_children(p_current);
+        child_count = directed_graph_node_t_child_count(p_current);
 
-        while (unordered_set_iterator_t_has_next(p_child_iterator)) 
+        for (i = 0; i < child_count; ++i) 
         {
-            unordered_set_iterator_t_next(p_child_iterator, &p_child);
+            p_child = p_children[i];
+
+            /* Estimate the children ahead, closed or not, in one batch. */
+            if (i % HEURISTIC_BATCH == 0)
+            {
+                heuristic_t_estimate_batch(
+                        &heuristic,
+                        p_children + i,
+                        child_count - i < HEURISTIC_BATCH ? 
+                                child_count - i : HEURISTIC_BATCH,
+                        p_target,
+                        estimates);
+            }
 
             if (unordered_set_t_contains(p_closed_set, p_child)) {
                 continue;
             }
 
+            SEARCH_STATS_COUNT(p_stats, arcs_relaxed);
+
             double tmp_cost = 
                 ((weight_t*) unordered_map_t_get(p_cost_map, 
                                                  p_current))->weight;
@@ -103,19 +198,34 @@ list_t* astar(directed_graph_node_t* p_source,
                                                               p_current, 
                                                               p_child);
 
-            double estimate = heuristic_cost(p_location_map, p_child, p_target);
+            estimate = inflation * estimates[i % HEURISTIC_BATCH];
 
             if (!unordered_map_t_contains_key(p_parent_map, p_child)) 
             {
                 /* Prepare the distance so far to 'p_child'. */
-                p_weight = malloc(sizeof(*p_weight));
+                p_weight = allocator_t_alloc(state.p_allocator,
+                                             sizeof(*p_weight));
                 p_weight->weight = tmp_cost;
 
                 /* Prepare the f-distance of 'p_child'. */
-                p_weight_f = malloc(sizeof(*p_weight_f));
+                p_weight_f = allocator_t_alloc(state.p_allocator,
+                                               sizeof(*p_weight_f));
                 p_weight_f->weight = tmp_cost + estimate;
 
                 heap_t_add(p_open_set, p_child, p_weight_f);
+                SEARCH_STATS_COUNT(p_stats, heap_pushes);
+
+                if (p_heap_trace)
+                {
+                    heap_trace_t_add(p_heap_trace,
+                                     p_child,
+                                     p_weight_f->weight);
+                }
+
+                SEARCH_STATS_PEAK(p_stats, 
+                                  peak_open_set, 
+                                  heap_t_size(p_open_set));
+
                 unordered_map_t_put(p_parent_map, p_child, p_current);
                 unordered_map_t_put(p_cost_map, p_child, p_weight);
 
@@ -131,14 +241,26 @@ list_t* astar(directed_graph_node_t* p_source,
                                                      p_child))->weight)
             {
                 /* Prepare the distance so far to 'p_child'. */
-                p_weight = malloc(sizeof(*p_weight));
+                p_weight = allocator_t_alloc(state.p_allocator,
+                                             sizeof(*p_weight));
                 p_weight->weight = tmp_cost;
 
                 /* Prepare the f-distance of 'p_child'. */
-                p_weight_f = malloc(sizeof(*p_weight));
+                p_weight_f = allocator_t_alloc(state.p_allocator,
+                                               sizeof(*p_weight));
                 p_weight_f->weight = tmp_cost + estimate;
 
                 heap_t_decrease_key(p_open_set, p_child, p_weight_f);
+                SEARCH_STATS_COUNT(p_stats, decrease_keys);
+
+                if (p_heap_trace)
+                {
+                    heap_trace_t_decrease_key(p_heap_trace,
+                                              p_child,
+                                              p_weight_f->weight);
+                }
+
+
                 unordered_map_t_put(p_parent_map, p_child, p_current);
                 unordered_map_t_put(p_cost_map, p_child, p_weight);
 
@@ -150,20 +272,13 @@ list_t* astar(directed_graph_node_t* p_source,
                 list_t_push_back(p_weight_list, p_weight_f);
             }
         }
-
-        unordered_set_iterator_t_free(p_child_iterator);
     }
 
+    SEARCH_STATS_END_PHASE(p_stats, search_time);
+
     /* Once here, return a empty path in order to denote the fact that the 
        target node is not reachable from source node. */
-    p_list = list_t_alloc(10);
     search_state_t_free(&state);
-
-    /* Deallocate the weights. */
-    for (i = 0; i < list_t_size(p_weight_list); ++i) 
-    {
-        free(list_t_get(p_weight_list, i));
-    }
-
-    return p_list;
+    SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+    return list_t_alloc(10, NULL);
 }
@@ -5,16 +5,48 @@
 #include "weight_function.h"
 #include "unordered_map.h"
 #include "list.h"
+#include "search_options.h"
 
 #ifdef	__cplusplus
 extern "C" {
 #endif
 
+    /***************************************************************************
+    * Returns a shortest path from 'p_source' to 'p_target' guided by the      *
+    * Euclidean distance between the points in 'p_location_map', or an empty   *
+    * path if 'p_target' is not reachable from 'p_source'.                     *
+    ***************************************************************************/
     list_t* astar(directed_graph_node_t* p_source,
                   directed_graph_node_t* p_target,
                   directed_graph_weight_function_t* p_weight_function,
                   unordered_map_t* p_location_map);    
 
+    /***************************************************************************
+    * Same as 'astar', but honours the options 'p_options', which may be NULL. *
+    * 'p_location_map' may be NULL if the options give a coordinate store or a *
+    * heuristic.                                                               *
+    ***************************************************************************/
+    list_t* astar_with_options(directed_graph_node_t* p_source,
+                               directed_graph_node_t* p_target,
+                               directed_graph_weight_function_t* 
+                                                      p_weight_function,
+                               unordered_map_t* p_location_map,
+                               search_options_t* p_options);
+
+    /***************************************************************************
+    * Same as 'astar_with_options', but inflates the estimates by              *
+    * 1 + 'epsilon'. This settles far fewer nodes as 'epsilon' grows and       *
+    * returns a path costing at most 1 + 'epsilon' times the shortest one, as  *
+    * long as the heuristic is consistent. Returns NULL if 'epsilon' is        *
+    * negative.                                                                *
+    ***************************************************************************/
+    list_t* weighted_astar(directed_graph_node_t* p_source,
+                           directed_graph_node_t* p_target,
+                           directed_graph_weight_function_t* p_weight_function,
+                           unordered_map_t* p_location_map,
+                           double epsilon,
+                           search_options_t* p_options);
+
 #ifdef	__cplusplus
 }
 #endif
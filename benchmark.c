@@ -0,0 +1,1259 @@
+#include "benchmark.h"
+#include "astar.h"
+#include "bidir_astar.h"
+#include "bidir_dijkstra.h"
+#include "dijkstra.h"
+#include "graph_generators.h"
+#include "utils.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+static const double COST_TOLERANCE = 1e-9;
+
+static list_t* run_dijkstra(directed_graph_node_t* p_source,
+                            directed_graph_node_t* p_target,
+                            graph_data_t*          p_data,
+                            search_options_t*      p_options)
+{
+    return dijkstra_with_options(p_source,
+                                 p_target,
+                                 p_data->p_weight_function,
+                                 p_options);
+}
+
+/*******************************************************************************
+* Copies the options 'p_options', which may be NULL, into 'p_copy' and points  *
+* the copy to the packed coordinates of the graph, which are built on the      *
+* first call. Returns false if there is not enough memory.                     *
+*******************************************************************************/
+static bool with_coordinates(search_options_t* p_copy,
+                             search_options_t* p_options,
+                             graph_data_t*     p_data)
+{
+    if (!graph_data_t_ensure_coordinates(p_data)) return false;
+
+    if (p_options) *p_copy = *p_options;
+    else           memset(p_copy, 0, sizeof(*p_copy));
+
+    p_copy->p_coordinates = p_data->p_coordinates;
+    return true;
+}
+
+static list_t* run_astar(directed_graph_node_t* p_source,
+                         directed_graph_node_t* p_target,
+                         graph_data_t*          p_data,
+                         search_options_t*      p_options)
+{
+    search_options_t options;
+
+    if (!with_coordinates(&options, p_options, p_data)) return NULL;
+
+    return astar_with_options(p_source,
+                              p_target,
+                              p_data->p_weight_function,
+                              p_data->p_point_map,
+                              &options);
+}
+
+static list_t* run_bidirectional_dijkstra(directed_graph_node_t* p_source,
+                                          directed_graph_node_t* p_target,
+                                          graph_data_t*          p_data,
+                                          search_options_t*      p_options)
+{
+    /* The reverse arcs are built on the first backward search. */
+    if (!graph_data_t_ensure_parents(p_data)) return NULL;
+
+    return bidirectional_dijkstra_with_options(p_source,
+                                               p_target,
+                                               p_data->p_weight_function,
+                                               p_options);
+}
+
+static list_t* run_bidirectional_astar(directed_graph_node_t* p_source,
+                                       directed_graph_node_t* p_target,
+                                       graph_data_t*          p_data,
+                                       search_options_t*      p_options)
+{
+    search_options_t options;
+
+    /* The reverse arcs are built on the first backward search. */
+    if (!graph_data_t_ensure_parents(p_data)) return NULL;
+    if (!with_coordinates(&options, p_options, p_data)) return NULL;
+
+    return bidirectional_astar_with_options(p_source,
+                                            p_target,
+                                            p_data->p_weight_function,
+                                            p_data->p_point_map,
+                                            &options);
+}
+
+static const benchmark_algorithm_t ALGORITHMS[] = {
+    { "dijkstra",               run_dijkstra               },
+    { "astar",                  run_astar                  },
+    { "bidirectional_dijkstra", run_bidirectional_dijkstra },
+    { "bidirectional_astar",    run_bidirectional_astar    }
+};
+
+const benchmark_algorithm_t* benchmark_algorithms(size_t* p_count)
+{
+    if (p_count) *p_count = sizeof(ALGORITHMS) / sizeof(ALGORITHMS[0]);
+
+    return ALGORITHMS;
+}
+
+void benchmark_config_t_init(benchmark_config_t* p_config)
+{
+    if (!p_config) return;
+
+    p_config->p_family      = "random";
+    p_config->nodes         = 20000;
+    p_config->seed          = (unsigned int) time(NULL);
+    p_config->queries       = 100;
+    p_config->warmup        = 10;
+    p_config->format        = BENCHMARK_FORMAT_TEXT;
+    p_config->per_query     = false;
+    p_config->ranks         = false;
+    p_config->perf          = false;
+    p_config->p_output_file = NULL;
+
+    p_config->p_search_space_prefix = NULL;
+    p_config->arcs                  = 0;
+    p_config->graph_memory          = 0;
+}
+
+static void print_usage(const char* p_program)
+{
+    fprintf(stderr,
+            "Usage: %s bench [--family NAME] [--nodes N] [--queries N]\n"
+            "       [--warmup N] [--seed N] [--format text|csv|json]\n"
+            "       [--per-query] [--ranks] [--perf] [--output FILE]\n"
+            "       [--search-space PREFIX]\n",
+            p_program);
+}
+
+bool benchmark_config_t_parse(benchmark_config_t* p_config,
+                              int argc,
+                              char** argv)
+{
+    int         i;
+    const char* p_option;
+    const char* p_value;
+
+    if (!p_config) return false;
+
+    for (i = 1; i < argc; ++i)
+    {
+        p_option = argv[i];
+
+        if (strcmp(p_option, "--per-query") == 0)
+        {
+            p_config->per_query = true;
+            continue;
+        }
+
+        if (strcmp(p_option, "--ranks") == 0)
+        {
+            p_config->ranks = true;
+            continue;
+        }
+
+        if (strcmp(p_option, "--perf") == 0)
+        {
+            p_config->perf = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            print_usage("cpathfinding");
+            return false;
+        }
+
+        p_value = argv[++i];
+
+        if (strcmp(p_option, "--family") == 0)
+        {
+            p_config->p_family = p_value;
+        }
+        else if (strcmp(p_option, "--nodes") == 0)
+        {
+            p_config->nodes = (size_t) strtoul(p_value, NULL, 10);
+        }
+        else if (strcmp(p_option, "--queries") == 0)
+        {
+            p_config->queries = (size_t) strtoul(p_value, NULL, 10);
+        }
+        else if (strcmp(p_option, "--warmup") == 0)
+        {
+            p_config->warmup = (size_t) strtoul(p_value, NULL, 10);
+        }
+        else if (strcmp(p_option, "--seed") == 0)
+        {
+            p_config->seed = (unsigned int) strtoul(p_value, NULL, 10);
+        }
+        else if (strcmp(p_option, "--output") == 0)
+        {
+            p_config->p_output_file = p_value;
+        }
+        else if (strcmp(p_option, "--search-space") == 0)
+        {
+            p_config->p_search_space_prefix = p_value;
+        }
+        else if (strcmp(p_option, "--format") == 0)
+        {
+            if (strcmp(p_value, "text") == 0)
+            {
+                p_config->format = BENCHMARK_FORMAT_TEXT;
+            }
+            else if (strcmp(p_value, "csv") == 0)
+            {
+                p_config->format = BENCHMARK_FORMAT_CSV;
+            }
+            else if (strcmp(p_value, "json") == 0)
+            {
+                p_config->format = BENCHMARK_FORMAT_JSON;
+            }
+            else
+            {
+                fprintf(stderr, "Unknown format: %s\n", p_value);
+                return false;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option: %s\n", p_option);
+            print_usage("cpathfinding");
+            return false;
+        }
+    }
+
+    if (!is_graph_family(p_config->p_family))
+    {
+        fprintf(stderr, "Unknown graph family: %s\n", p_config->p_family);
+        return false;
+    }
+
+    if (p_config->queries == 0 || p_config->nodes == 0)
+    {
+        fprintf(stderr, "Need at least one node and one query.\n");
+        return false;
+    }
+
+    return true;
+}
+
+unsigned long long benchmark_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int double_cmp(const void* pa, const void* pb)
+{
+    double a = *(const double*) pa;
+    double b = *(const double*) pb;
+
+    if (a < b) return -1;
+    if (a > b) return 1;
+    return 0;
+}
+
+double benchmark_percentile(double* p_values, size_t size, double p)
+{
+    size_t rank;
+
+    if (!p_values || size == 0) return 0.0;
+
+    rank = (size_t) ceil(p / 100.0 * size);
+
+    if (rank == 0)   rank = 1;
+    if (rank > size) rank = size;
+
+    return p_values[rank - 1];
+}
+
+/*******************************************************************************
+* Returns true if the two costs agree. A negative cost denotes an unreachable  *
+* target.                                                                      *
+*******************************************************************************/
+static bool costs_agree(const double a, const double b)
+{
+    if (a < 0.0 || b < 0.0) return a < 0.0 && b < 0.0;
+
+    return fabs(a - b) <= COST_TOLERANCE * (fabs(a) > 1.0 ? fabs(a) : 1.0);
+}
+
+/*******************************************************************************
+* Computes the hardware counter averages per query and per settled node.       *
+*******************************************************************************/
+static void summarize_perf(benchmark_result_t* p_result, double settled_sum)
+{
+    double sum;
+    size_t i;
+    size_t k;
+
+    for (k = 0; k < PERF_COUNTER_COUNT; ++k)
+    {
+        p_result->perf_per_query[k]   = -1.0;
+        p_result->perf_per_settled[k] = -1.0;
+
+        if (!p_result->p_perf || !p_result->perf_available[k]) continue;
+
+        sum = 0.0;
+
+        for (i = 0; i < p_result->queries; ++i)
+        {
+            sum += p_result->p_perf[i].values[k];
+        }
+
+        p_result->perf_per_query[k]   = sum / p_result->queries;
+        p_result->perf_per_settled[k] = settled_sum > 0.0 ?
+                                        sum / settled_sum : 0.0;
+    }
+}
+
+/*******************************************************************************
+* Returns the instructions per cycle of 'p_result', or a negative value if     *
+* either counter is unavailable.                                               *
+*******************************************************************************/
+static double instructions_per_cycle(benchmark_result_t* p_result)
+{
+    double cycles       = p_result->perf_per_query[PERF_COUNTER_CYCLES];
+    double instructions = p_result->perf_per_query[PERF_COUNTER_INSTRUCTIONS];
+
+    if (cycles <= 0.0 || instructions < 0.0) return -1.0;
+
+    return instructions / cycles;
+}
+
+/*******************************************************************************
+* Computes the summary statistics of the measurements in 'p_result'.           *
+*******************************************************************************/
+static bool summarize(benchmark_result_t* p_result)
+{
+    double* p_sorted;
+    double  latency_sum = 0.0;
+    double  settled_sum = 0.0;
+    double  relaxed_sum = 0.0;
+    double  decrease_key_sum = 0.0;
+    double  open_set_sum = 0.0;
+    double  memory_sum = 0.0;
+    size_t  i;
+
+    p_sorted = malloc(sizeof(double) * p_result->queries);
+
+    if (!p_sorted) return false;
+
+    p_result->max_settled = 0;
+
+    for (i = 0; i < p_result->queries; ++i)
+    {
+        p_sorted[i]  = p_result->p_latencies[i];
+        latency_sum += p_result->p_latencies[i];
+        settled_sum += p_result->p_stats[i].nodes_settled;
+        relaxed_sum += p_result->p_stats[i].arcs_relaxed;
+        decrease_key_sum += p_result->p_stats[i].decrease_keys;
+        open_set_sum += p_result->p_stats[i].peak_open_set;
+        memory_sum   += p_result->p_stats[i].peak_memory;
+
+        if (p_result->max_settled < p_result->p_stats[i].nodes_settled)
+        {
+            p_result->max_settled = p_result->p_stats[i].nodes_settled;
+        }
+    }
+
+    qsort(p_sorted, p_result->queries, sizeof(double), double_cmp);
+
+    p_result->mean_latency = latency_sum / p_result->queries;
+    p_result->mean_settled = settled_sum / p_result->queries;
+    p_result->mean_relaxed = relaxed_sum / p_result->queries;
+    p_result->mean_decrease_keys = decrease_key_sum / p_result->queries;
+    p_result->mean_peak_open_set = open_set_sum / p_result->queries;
+    p_result->mean_peak_memory = memory_sum / p_result->queries;
+    p_result->p50_latency  = benchmark_percentile(p_sorted,
+                                                  p_result->queries,
+                                                  50.0);
+    p_result->p90_latency  = benchmark_percentile(p_sorted,
+                                                  p_result->queries,
+                                                  90.0);
+    p_result->p99_latency  = benchmark_percentile(p_sorted,
+                                                  p_result->queries,
+                                                  99.0);
+    p_result->max_latency  = p_sorted[p_result->queries - 1];
+
+    free(p_sorted);
+    summarize_perf(p_result, settled_sum);
+    return true;
+}
+
+size_t benchmark_rank_queries(graph_data_t*       p_data,
+                              size_t              sources,
+                              benchmark_query_t** pp_queries)
+{
+    benchmark_query_t*     p_queries;
+    directed_graph_node_t* p_source;
+    list_t*                p_order;
+    size_t                 max_exponent = 0;
+    size_t                 count = 0;
+    size_t                 rank;
+    size_t                 i;
+
+    if (!p_data || !pp_queries) return 0;
+
+    /* The largest rank is the largest power of two below the node count. */
+    while (((size_t) 2 << max_exponent) < p_data->node_count) ++max_exponent;
+
+    p_queries = malloc(sizeof(*p_queries) * (sources * max_exponent + 1));
+
+    if (!p_queries) return 0;
+
+    for (i = 0; i < sources; ++i)
+    {
+        p_source = choose(p_data->p_node_array, p_data->node_count);
+        p_order  = dijkstra_settle_order(p_source,
+                                         p_data->p_weight_function,
+                                         ((size_t) 1 << max_exponent) + 1);
+
+        for (rank = 2; rank < list_t_size(p_order); rank <<= 1)
+        {
+            p_queries[count].p_source = p_source;
+            p_queries[count].p_target = list_t_get(p_order, rank);
+            p_queries[count].rank     = rank;
+            ++count;
+        }
+
+        list_t_free(p_order);
+    }
+
+    *pp_queries = p_queries;
+    return count;
+}
+
+bool benchmark_result_t_bucket(benchmark_result_t* p_all,
+                               benchmark_query_t*  p_queries,
+                               double*             p_reference_costs,
+                               size_t              rank,
+                               benchmark_result_t* p_bucket)
+{
+    size_t i;
+    size_t j;
+
+    if (!p_all || !p_queries || !p_bucket) return false;
+
+    memset(p_bucket, 0, sizeof(*p_bucket));
+
+    for (i = 0; i < p_all->queries; ++i)
+    {
+        if (p_queries[i].rank == rank) p_bucket->queries++;
+    }
+
+    if (p_bucket->queries == 0) return false;
+
+    p_bucket->p_name      = p_all->p_name;
+    p_bucket->rank        = rank;
+    p_bucket->p_latencies = malloc(sizeof(double) * p_bucket->queries);
+    p_bucket->p_stats     = malloc(sizeof(search_stats_t) * p_bucket->queries);
+    p_bucket->p_costs     = malloc(sizeof(double) * p_bucket->queries);
+
+    if (p_all->p_perf)
+    {
+        p_bucket->p_perf = malloc(sizeof(perf_sample_t) * p_bucket->queries);
+        memcpy(p_bucket->perf_available,
+               p_all->perf_available,
+               sizeof(p_all->perf_available));
+    }
+
+    if (!p_bucket->p_latencies || !p_bucket->p_stats || !p_bucket->p_costs
+            || (p_all->p_perf && !p_bucket->p_perf))
+    {
+        benchmark_result_t_free(p_bucket);
+        return false;
+    }
+
+    for (i = 0, j = 0; i < p_all->queries; ++i)
+    {
+        if (p_queries[i].rank != rank) continue;
+
+        p_bucket->p_latencies[j] = p_all->p_latencies[i];
+        p_bucket->p_stats[j]     = p_all->p_stats[i];
+
+        if (p_all->p_perf) p_bucket->p_perf[j] = p_all->p_perf[i];
+        p_bucket->p_costs[j]     = p_all->p_costs[i];
+
+        if (p_all->p_costs[i] < 0.0) p_bucket->unreachable++;
+
+        if (p_reference_costs
+                && !costs_agree(p_reference_costs[i], p_all->p_costs[i]))
+        {
+            p_bucket->mismatches++;
+        }
+
+        ++j;
+    }
+
+    return summarize(p_bucket);
+}
+
+bool benchmark_run_algorithm(const benchmark_algorithm_t* p_algorithm,
+                             graph_data_t*       p_data,
+                             benchmark_query_t*  p_queries,
+                             size_t              queries,
+                             size_t              warmup,
+                             double*             p_reference_costs,
+                             perf_counters_t*    p_counters,
+                             benchmark_result_t* p_result)
+{
+    search_options_t   options;
+    list_t*            p_path;
+    unsigned long long start;
+    unsigned long long end;
+    size_t             i;
+    size_t             k;
+
+    if (!p_algorithm || !p_data || !p_queries || !p_result) return false;
+
+    memset(p_result, 0, sizeof(*p_result));
+    memset(&options, 0, sizeof(options));
+
+    p_result->p_name      = p_algorithm->p_name;
+    p_result->queries     = queries;
+    p_result->p_latencies = malloc(sizeof(double) * queries);
+    p_result->p_stats     = malloc(sizeof(search_stats_t) * queries);
+    p_result->p_costs     = malloc(sizeof(double) * queries);
+
+    if (p_counters)
+    {
+        p_result->p_perf = malloc(sizeof(perf_sample_t) * queries);
+
+        for (k = 0; k < PERF_COUNTER_COUNT; ++k)
+        {
+            p_result->perf_available[k] =
+                    perf_counters_t_is_available(p_counters, k);
+        }
+    }
+
+    if (!p_result->p_latencies || !p_result->p_stats || !p_result->p_costs
+            || (p_counters && !p_result->p_perf))
+    {
+        benchmark_result_t_free(p_result);
+        return false;
+    }
+
+    for (i = 0; i < warmup && i < queries; ++i)
+    {
+        list_t_free(p_algorithm->p_search(p_queries[i].p_source,
+                                          p_queries[i].p_target,
+                                          p_data,
+                                          NULL));
+    }
+
+    for (i = 0; i < queries; ++i)
+    {
+        /* The searches leave the statistics alone if built without them. */
+        search_stats_t_clear(&p_result->p_stats[i]);
+        options.p_stats = &p_result->p_stats[i];
+
+        if (p_counters) perf_counters_t_start(p_counters);
+
+        start  = benchmark_now();
+        p_path = p_algorithm->p_search(p_queries[i].p_source,
+                                       p_queries[i].p_target,
+                                       p_data,
+                                       &options);
+        end    = benchmark_now();
+
+        if (p_counters) perf_counters_t_stop(p_counters, &p_result->p_perf[i]);
+
+        p_result->p_latencies[i] = (end - start) / 1000.0;
+
+        if (list_t_size(p_path) == 0)
+        {
+            p_result->p_costs[i] = -1.0;
+            p_result->unreachable++;
+        }
+        else
+        {
+            p_result->p_costs[i] = compute_path_cost(p_path,
+                                                     p_data->p_weight_function);
+
+            if (!is_valid_path(p_path)) p_result->p_costs[i] = -2.0;
+        }
+
+        if (p_reference_costs
+                && !costs_agree(p_reference_costs[i], p_result->p_costs[i]))
+        {
+            p_result->mismatches++;
+        }
+
+        list_t_free(p_path);
+    }
+
+    return summarize(p_result);
+}
+
+void benchmark_result_t_free(benchmark_result_t* p_result)
+{
+    if (!p_result) return;
+
+    free(p_result->p_latencies);
+    free(p_result->p_stats);
+    free(p_result->p_perf);
+    free(p_result->p_costs);
+
+    p_result->p_latencies = NULL;
+    p_result->p_stats     = NULL;
+    p_result->p_perf      = NULL;
+    p_result->p_costs     = NULL;
+}
+
+static void print_text(FILE* p_out,
+                       benchmark_config_t* p_config,
+                       benchmark_result_t* p_results,
+                       size_t count)
+{
+    size_t i;
+    size_t k;
+
+    fprintf(p_out,
+            "Family: %s, nodes: %zu, seed: %u, queries: %zu, warmup: %zu\n",
+            p_config->p_family,
+            p_config->nodes,
+            p_config->seed,
+            p_config->queries,
+            p_config->warmup);
+    fprintf(p_out,
+            "Graph: %zu arcs, %zu bytes, %.1f bytes per node, "
+            "%.1f bytes per arc\n",
+            p_config->arcs,
+            p_config->graph_memory,
+            (double) p_config->graph_memory / p_config->nodes,
+            p_config->arcs ? (double) p_config->graph_memory / p_config->arcs :
+                             0.0);
+    fprintf(p_out,
+            "%-24s %10s %10s %10s %10s %10s %10s %12s %12s %12s %10s\n",
+            "algorithm", "rank", "mean_us", "p50_us", "p90_us", "p99_us",
+            "max_us", "settled", "relaxed", "peak_kib", "mismatches");
+
+    for (i = 0; i < count; ++i)
+    {
+        fprintf(p_out,
+                "%-24s %10zu %10.1f %10.1f %10.1f %10.1f %10.1f %12.1f "
+                "%12.1f %12.1f %10zu\n",
+                p_results[i].p_name,
+                p_results[i].rank,
+                p_results[i].mean_latency,
+                p_results[i].p50_latency,
+                p_results[i].p90_latency,
+                p_results[i].p99_latency,
+                p_results[i].max_latency,
+                p_results[i].mean_settled,
+                p_results[i].mean_relaxed,
+                p_results[i].mean_peak_memory / 1024.0,
+                p_results[i].mismatches);
+    }
+
+    if (count == 0 || !p_results[0].p_perf) return;
+
+    fprintf(p_out,
+            "\n%-24s %10s %14s %14s %14s\n",
+            "algorithm", "rank", "counter", "per_query", "per_settled");
+
+    for (i = 0; i < count; ++i)
+    {
+        for (k = 0; k < PERF_COUNTER_COUNT; ++k)
+        {
+            if (!p_results[i].perf_available[k]) continue;
+
+            fprintf(p_out,
+                    "%-24s %10zu %14s %14.1f %14.2f\n",
+                    p_results[i].p_name,
+                    p_results[i].rank,
+                    perf_counter_name(k),
+                    p_results[i].perf_per_query[k],
+                    p_results[i].perf_per_settled[k]);
+        }
+
+        if (instructions_per_cycle(&p_results[i]) >= 0.0)
+        {
+            fprintf(p_out,
+                    "%-24s %10zu %14s %14.3f\n",
+                    p_results[i].p_name,
+                    p_results[i].rank,
+                    "ipc",
+                    instructions_per_cycle(&p_results[i]));
+        }
+    }
+}
+
+/*******************************************************************************
+* Prints the hardware counter columns of a CSV header, if the counters were    *
+* used.                                                                        *
+*******************************************************************************/
+static void print_perf_csv_header(FILE* p_out,
+                                  benchmark_result_t* p_results,
+                                  size_t count,
+                                  bool per_query)
+{
+    size_t k;
+
+    if (count == 0 || !p_results[0].p_perf) return;
+
+    for (k = 0; k < PERF_COUNTER_COUNT; ++k)
+    {
+        if (per_query)
+        {
+            fprintf(p_out, ",%s", perf_counter_name(k));
+        }
+        else
+        {
+            fprintf(p_out, ",%s_per_query,%s_per_settled",
+                    perf_counter_name(k),
+                    perf_counter_name(k));
+        }
+    }
+
+    if (!per_query) fprintf(p_out, ",ipc");
+}
+
+/*******************************************************************************
+* Prints the hardware counter columns of a CSV row. Unavailable counters are   *
+* left empty. If 'query' is less than the query count of 'p_result', prints    *
+* the counters of that query instead of the averages.                          *
+*******************************************************************************/
+static void print_perf_csv_row(FILE* p_out,
+                               benchmark_result_t* p_result,
+                               size_t query)
+{
+    size_t k;
+
+    if (!p_result->p_perf) return;
+
+    for (k = 0; k < PERF_COUNTER_COUNT; ++k)
+    {
+        if (!p_result->perf_available[k])
+        {
+            fprintf(p_out, query < p_result->queries ? "," : ",,");
+        }
+        else if (query < p_result->queries)
+        {
+            fprintf(p_out, ",%llu", p_result->p_perf[query].values[k]);
+        }
+        else
+        {
+            fprintf(p_out, ",%.3f,%.5f",
+                    p_result->perf_per_query[k],
+                    p_result->perf_per_settled[k]);
+        }
+    }
+
+    if (query >= p_result->queries)
+    {
+        if (instructions_per_cycle(p_result) >= 0.0)
+        {
+            fprintf(p_out, ",%.3f", instructions_per_cycle(p_result));
+        }
+        else
+        {
+            fprintf(p_out, ",");
+        }
+    }
+}
+
+static void print_csv(FILE* p_out,
+                      benchmark_config_t* p_config,
+                      benchmark_result_t* p_results,
+                      size_t count)
+{
+    size_t i;
+    size_t j;
+
+    if (p_config->per_query)
+    {
+        fprintf(p_out, "algorithm,family,nodes,seed,rank,query,latency_us,"
+                       "settled,relaxed,decrease_keys,heap_pushes,heap_pops,"
+                       "peak_open_set,peak_memory,setup_us,search_us,"
+                       "traceback_us,cleanup_us,cost");
+        print_perf_csv_header(p_out, p_results, count, true);
+        fprintf(p_out, "\n");
+
+        for (i = 0; i < count; ++i)
+        {
+            for (j = 0; j < p_results[i].queries; ++j)
+            {
+                fprintf(p_out, "%s,%s,%zu,%u,%zu,%zu,%.3f,%zu,%zu,%zu,%zu,"
+                               "%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.6f",
+                        p_results[i].p_name,
+                        p_config->p_family,
+                        p_config->nodes,
+                        p_config->seed,
+                        p_results[i].rank,
+                        j,
+                        p_results[i].p_latencies[j],
+                        p_results[i].p_stats[j].nodes_settled,
+                        p_results[i].p_stats[j].arcs_relaxed,
+                        p_results[i].p_stats[j].decrease_keys,
+                        p_results[i].p_stats[j].heap_pushes,
+                        p_results[i].p_stats[j].heap_pops,
+                        p_results[i].p_stats[j].peak_open_set,
+                        p_results[i].p_stats[j].peak_memory,
+                        p_results[i].p_stats[j].setup_time / 1000.0,
+                        p_results[i].p_stats[j].search_time / 1000.0,
+                        p_results[i].p_stats[j].traceback_time / 1000.0,
+                        p_results[i].p_stats[j].cleanup_time / 1000.0,
+                        p_results[i].p_costs[j]);
+                print_perf_csv_row(p_out, &p_results[i], j);
+                fprintf(p_out, "\n");
+            }
+        }
+
+        return;
+    }
+
+    fprintf(p_out, "algorithm,family,nodes,seed,rank,queries,warmup,mean_us,"
+                   "p50_us,p90_us,p99_us,max_us,mean_settled,max_settled,"
+                   "mean_relaxed,mean_decrease_keys,mean_peak_open_set,"
+                   "mean_peak_memory,graph_memory,unreachable,mismatches");
+    print_perf_csv_header(p_out, p_results, count, false);
+    fprintf(p_out, "\n");
+
+    for (i = 0; i < count; ++i)
+    {
+        fprintf(p_out, "%s,%s,%zu,%u,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,"
+                       "%.3f,%zu,%.3f,%.3f,%.3f,%.3f,%zu,%zu,%zu",
+                p_results[i].p_name,
+                p_config->p_family,
+                p_config->nodes,
+                p_config->seed,
+                p_results[i].rank,
+                p_results[i].queries,
+                p_config->warmup,
+                p_results[i].mean_latency,
+                p_results[i].p50_latency,
+                p_results[i].p90_latency,
+                p_results[i].p99_latency,
+                p_results[i].max_latency,
+                p_results[i].mean_settled,
+                p_results[i].max_settled,
+                p_results[i].mean_relaxed,
+                p_results[i].mean_decrease_keys,
+                p_results[i].mean_peak_open_set,
+                p_results[i].mean_peak_memory,
+                p_config->graph_memory,
+                p_results[i].unreachable,
+                p_results[i].mismatches);
+        print_perf_csv_row(p_out, &p_results[i], p_results[i].queries);
+        fprintf(p_out, "\n");
+    }
+}
+
+/*******************************************************************************
+* Prints the hardware counter averages of 'p_result' as a JSON member. An      *
+* unavailable counter is null.                                                 *
+*******************************************************************************/
+static void print_perf_json(FILE* p_out, benchmark_result_t* p_result)
+{
+    size_t k;
+
+    fprintf(p_out, ",\n      \"counters\": {\n");
+
+    for (k = 0; k < PERF_COUNTER_COUNT; ++k)
+    {
+        if (p_result->perf_available[k])
+        {
+            fprintf(p_out, "        \"%s\": { \"per_query\": %.3f, "
+                           "\"per_settled\": %.5f },\n",
+                    perf_counter_name(k),
+                    p_result->perf_per_query[k],
+                    p_result->perf_per_settled[k]);
+        }
+        else
+        {
+            fprintf(p_out, "        \"%s\": null,\n", perf_counter_name(k));
+        }
+    }
+
+    if (instructions_per_cycle(p_result) >= 0.0)
+    {
+        fprintf(p_out, "        \"ipc\": %.3f\n      }",
+                instructions_per_cycle(p_result));
+    }
+    else
+    {
+        fprintf(p_out, "        \"ipc\": null\n      }");
+    }
+}
+
+static void print_json(FILE* p_out,
+                       benchmark_config_t* p_config,
+                       benchmark_result_t* p_results,
+                       size_t count)
+{
+    size_t i;
+    size_t j;
+
+    fprintf(p_out, "{\n  \"family\": \"%s\",\n  \"nodes\": %zu,\n"
+                   "  \"seed\": %u,\n  \"queries\": %zu,\n"
+                   "  \"warmup\": %zu,\n  \"arcs\": %zu,\n"
+                   "  \"graph_memory\": %zu,\n  \"algorithms\": [\n",
+            p_config->p_family,
+            p_config->nodes,
+            p_config->seed,
+            p_config->queries,
+            p_config->warmup,
+            p_config->arcs,
+            p_config->graph_memory);
+
+    for (i = 0; i < count; ++i)
+    {
+        fprintf(p_out, "    {\n      \"name\": \"%s\",\n"
+                       "      \"rank\": %zu,\n"
+                       "      \"queries\": %zu,\n"
+                       "      \"mean_us\": %.3f,\n"
+                       "      \"p50_us\": %.3f,\n"
+                       "      \"p90_us\": %.3f,\n"
+                       "      \"p99_us\": %.3f,\n"
+                       "      \"max_us\": %.3f,\n"
+                       "      \"mean_settled\": %.3f,\n"
+                       "      \"max_settled\": %zu,\n"
+                       "      \"mean_relaxed\": %.3f,\n"
+                       "      \"mean_decrease_keys\": %.3f,\n"
+                       "      \"mean_peak_open_set\": %.3f,\n"
+                       "      \"mean_peak_memory\": %.3f,\n"
+                       "      \"unreachable\": %zu,\n"
+                       "      \"mismatches\": %zu",
+                p_results[i].p_name,
+                p_results[i].rank,
+                p_results[i].queries,
+                p_results[i].mean_latency,
+                p_results[i].p50_latency,
+                p_results[i].p90_latency,
+                p_results[i].p99_latency,
+                p_results[i].max_latency,
+                p_results[i].mean_settled,
+                p_results[i].max_settled,
+                p_results[i].mean_relaxed,
+                p_results[i].mean_decrease_keys,
+                p_results[i].mean_peak_open_set,
+                p_results[i].mean_peak_memory,
+                p_results[i].unreachable,
+                p_results[i].mismatches);
+
+        if (p_results[i].p_perf) print_perf_json(p_out, &p_results[i]);
+
+        if (p_config->per_query)
+        {
+            fprintf(p_out, ",\n      \"per_query\": [\n");
+
+            for (j = 0; j < p_results[i].queries; ++j)
+            {
+                fprintf(p_out, "        { \"latency_us\": %.3f, "
+                               "\"settled\": %zu, \"relaxed\": %zu, "
+                               "\"decrease_keys\": %zu, "
+                               "\"heap_pushes\": %zu, \"heap_pops\": %zu, "
+                               "\"peak_open_set\": %zu, "
+                               "\"peak_memory\": %zu, "
+                               "\"search_us\": %.3f, \"cost\": %.6f }%s\n",
+                        p_results[i].p_latencies[j],
+                        p_results[i].p_stats[j].nodes_settled,
+                        p_results[i].p_stats[j].arcs_relaxed,
+                        p_results[i].p_stats[j].decrease_keys,
+                        p_results[i].p_stats[j].heap_pushes,
+                        p_results[i].p_stats[j].heap_pops,
+                        p_results[i].p_stats[j].peak_open_set,
+                        p_results[i].p_stats[j].peak_memory,
+                        p_results[i].p_stats[j].search_time / 1000.0,
+                        p_results[i].p_costs[j],
+                        j + 1 < p_results[i].queries ? "," : "");
+            }
+
+            fprintf(p_out, "      ]");
+        }
+
+        fprintf(p_out, "\n    }%s\n", i + 1 < count ? "," : "");
+    }
+
+    fprintf(p_out, "  ]\n}\n");
+}
+
+/*******************************************************************************
+* Splits each result in 'p_results' into buckets by Dijkstra rank. On success, *
+* frees the original results and returns the buckets, storing their number in  *
+* 'p_count'.                                                                   *
+*******************************************************************************/
+static benchmark_result_t* bucket_by_rank(benchmark_result_t* p_results,
+                                          size_t*             p_count,
+                                          benchmark_query_t*  p_queries)
+{
+    benchmark_result_t* p_buckets;
+    size_t              max_rank = 0;
+    size_t              rank_count = 0;
+    size_t              bucket_count = 0;
+    size_t              rank;
+    size_t              i;
+
+    for (i = 0; i < p_results[0].queries; ++i)
+    {
+        if (max_rank < p_queries[i].rank) max_rank = p_queries[i].rank;
+    }
+
+    for (rank = 2; rank <= max_rank; rank <<= 1) ++rank_count;
+
+    p_buckets = calloc(*p_count * rank_count + 1, sizeof(*p_buckets));
+
+    if (!p_buckets) return NULL;
+
+    for (i = 0; i < *p_count; ++i)
+    {
+        for (rank = 2; rank <= max_rank; rank <<= 1)
+        {
+            if (benchmark_result_t_bucket(&p_results[i],
+                                          p_queries,
+                                          i > 0 ? p_results[0].p_costs : NULL,
+                                          rank,
+                                          &p_buckets[bucket_count]))
+            {
+                ++bucket_count;
+            }
+        }
+    }
+
+    for (i = 0; i < *p_count; ++i)
+    {
+        benchmark_result_t_free(&p_results[i]);
+    }
+
+    free(p_results);
+    *p_count = bucket_count;
+    return p_buckets;
+}
+
+/*******************************************************************************
+* Reruns the slowest query of the result with a search recorder, and saves the *
+* search space to "<prefix>.<algorithm>.srec".                                 *
+*******************************************************************************/
+static bool save_slowest_search_space(const benchmark_algorithm_t* p_algorithm,
+                                      graph_data_t*       p_data,
+                                      benchmark_query_t*  p_queries,
+                                      benchmark_result_t* p_result,
+                                      const char*         p_prefix)
+{
+    search_options_t options;
+    char*            p_file_name;
+    size_t           slowest = 0;
+    size_t           i;
+    bool             ok;
+
+    for (i = 1; i < p_result->queries; ++i)
+    {
+        if (p_result->p_latencies[i] > p_result->p_latencies[slowest])
+        {
+            slowest = i;
+        }
+    }
+
+    memset(&options, 0, sizeof(options));
+    options.p_recorder = search_recorder_t_alloc();
+    p_file_name = malloc(strlen(p_prefix) + strlen(p_algorithm->p_name) + 7);
+
+    if (!options.p_recorder || !p_file_name)
+    {
+        search_recorder_t_free(options.p_recorder);
+        free(p_file_name);
+        return false;
+    }
+
+    sprintf(p_file_name, "%s.%s.srec", p_prefix, p_algorithm->p_name);
+
+    list_t_free(p_algorithm->p_search(p_queries[slowest].p_source,
+                                      p_queries[slowest].p_target,
+                                      p_data,
+                                      &options));
+
+    ok = search_recorder_t_write(options.p_recorder,
+                                 p_data->p_point_map,
+                                 p_file_name);
+
+    if (!ok) fprintf(stderr, "Could not write %s.\n", p_file_name);
+
+    search_recorder_t_free(options.p_recorder);
+    free(p_file_name);
+    return ok;
+}
+
+int benchmark_main(int argc, char** argv)
+{
+    benchmark_config_t           config;
+    benchmark_query_t*           p_queries;
+    benchmark_result_t*          p_results;
+    const benchmark_algorithm_t* p_algorithms;
+    graph_data_t*                p_data;
+    FILE*                        p_out;
+    size_t                       algorithm_count;
+    size_t                       result_count;
+    size_t                       query_count;
+    perf_counters_t              counters;
+    perf_counters_t*             p_counters = NULL;
+    size_t                       mismatches = 0;
+    size_t                       i;
+
+    benchmark_config_t_init(&config);
+
+    if (!benchmark_config_t_parse(&config, argc, argv)) return EXIT_FAILURE;
+
+    p_data = create_graph_family(config.p_family, config.nodes, config.seed);
+
+    if (!p_data)
+    {
+        fprintf(stderr, "Could not build the graph.\n");
+        return EXIT_FAILURE;
+    }
+
+    /* The node count of grid families is rounded up. */
+    config.nodes        = p_data->node_count;
+    config.graph_memory = graph_data_t_memory_usage(p_data);
+    config.arcs         = 0;
+
+    for (i = 0; i < p_data->node_count; ++i)
+    {
+        config.arcs += directed_graph_node_t_child_count(
+                p_data->p_node_array[i]);
+    }
+
+    p_algorithms = benchmark_algorithms(&algorithm_count);
+    p_results    = calloc(algorithm_count, sizeof(*p_results));
+
+    /* Every algorithm runs the very same query set. */
+    srand(config.seed);
+
+    if (config.ranks)
+    {
+        query_count = benchmark_rank_queries(p_data,
+                                             config.queries,
+                                             &p_queries);
+    }
+    else
+    {
+        query_count = config.queries;
+        p_queries   = malloc(sizeof(*p_queries) * query_count);
+
+        for (i = 0; p_queries && i < query_count; ++i)
+        {
+            p_queries[i].p_source = choose(p_data->p_node_array,
+                                           p_data->node_count);
+            p_queries[i].p_target = choose(p_data->p_node_array,
+                                           p_data->node_count);
+            p_queries[i].rank     = 0;
+        }
+    }
+
+    if (query_count == 0 || !p_queries || !p_results)
+    {
+        fprintf(stderr, "Could not allocate the query set.\n");
+        graph_data_t_free(p_data);
+        return EXIT_FAILURE;
+    }
+
+    if (config.perf)
+    {
+        if (perf_counters_t_open(&counters))
+        {
+            p_counters = &counters;
+        }
+        else
+        {
+            fprintf(stderr, "Hardware counters are not available, "
+                            "measuring time only.\n");
+        }
+    }
+
+    for (i = 0; i < algorithm_count; ++i)
+    {
+        if (!benchmark_run_algorithm(&p_algorithms[i],
+                                     p_data,
+                                     p_queries,
+                                     query_count,
+                                     config.warmup,
+                                     i > 0 ? p_results[0].p_costs : NULL,
+                                     p_counters,
+                                     &p_results[i]))
+        {
+            fprintf(stderr, "Could not benchmark %s.\n",
+                    p_algorithms[i].p_name);
+            graph_data_t_free(p_data);
+            return EXIT_FAILURE;
+        }
+
+        mismatches += p_results[i].mismatches;
+
+        if (config.p_search_space_prefix)
+        {
+            save_slowest_search_space(&p_algorithms[i],
+                                      p_data,
+                                      p_queries,
+                                      &p_results[i],
+                                      config.p_search_space_prefix);
+        }
+    }
+
+    if (p_counters) perf_counters_t_close(p_counters);
+
+    result_count = algorithm_count;
+
+    if (config.ranks)
+    {
+        p_results = bucket_by_rank(p_results, &result_count, p_queries);
+
+        if (!p_results)
+        {
+            fprintf(stderr, "Could not allocate the rank buckets.\n");
+            graph_data_t_free(p_data);
+            return EXIT_FAILURE;
+        }
+    }
+
+    p_out = config.p_output_file ? fopen(config.p_output_file, "w") : stdout;
+
+    if (!p_out)
+    {
+        fprintf(stderr, "Could not open %s.\n", config.p_output_file);
+        graph_data_t_free(p_data);
+        return EXIT_FAILURE;
+    }
+
+    switch (config.format)
+    {
+        case BENCHMARK_FORMAT_CSV:
+            print_csv(p_out, &config, p_results, result_count);
+            break;
+
+        case BENCHMARK_FORMAT_JSON:
+            print_json(p_out, &config, p_results, result_count);
+            break;
+
+        default:
+            print_text(p_out, &config, p_results, result_count);
+            break;
+    }
+
+    if (p_out != stdout) fclose(p_out);
+
+    if (mismatches > 0)
+    {
+        fprintf(stderr, "%zu path costs disagree with %s.\n",
+                mismatches,
+                p_algorithms[0].p_name);
+    }
+
+    for (i = 0; i < result_count; ++i)
+    {
+        benchmark_result_t_free(&p_results[i]);
+    }
+
+    free(p_results);
+    free(p_queries);
+    graph_data_t_free(p_data);
+    return mismatches > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,180 @@
+#ifndef BENCHMARK_H
+#define	BENCHMARK_H
+
+#include "directed_graph_node.h"
+#include "perf_counters.h"
+#include "search_options.h"
+#include "list.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    typedef enum benchmark_format_t {
+        BENCHMARK_FORMAT_TEXT,
+        BENCHMARK_FORMAT_CSV,
+        BENCHMARK_FORMAT_JSON
+    } benchmark_format_t;
+
+    typedef struct benchmark_config_t {
+        const char*        p_family;
+        size_t             nodes;
+        unsigned int       seed;
+        size_t             queries;
+        size_t             warmup;
+        benchmark_format_t format;
+        bool               per_query;
+        bool               ranks;
+        bool               perf;
+        const char*        p_output_file;
+        /* If set, the search space of the slowest query of each algorithm
+           is saved to "<prefix>.<algorithm>.srec". */
+        const char*        p_search_space_prefix;
+        /* Filled in once the graph is built. */
+        size_t             arcs;
+        size_t             graph_memory;
+    } benchmark_config_t;
+
+    typedef struct benchmark_query_t {
+        directed_graph_node_t* p_source;
+        directed_graph_node_t* p_target;
+        /* The Dijkstra rank of the target, or 0 for a random query. */
+        size_t                 rank;
+    } benchmark_query_t;
+
+    /***************************************************************************
+    * A search algorithm under benchmark. All algorithms are called through    *
+    * this common signature.                                                   *
+    ***************************************************************************/
+    typedef struct benchmark_algorithm_t {
+        const char* p_name;
+        list_t*   (*p_search)(directed_graph_node_t* p_source,
+                              directed_graph_node_t* p_target,
+                              graph_data_t*          p_data,
+                              search_options_t*      p_options);
+    } benchmark_algorithm_t;
+
+    /***************************************************************************
+    * Measurements of a single algorithm over a query set. Latencies are in    *
+    * microseconds of wall-clock time. 'p_perf' holds the hardware counters of *
+    * each query, or is NULL if the counters were not used. The counter        *
+    * averages of an unavailable counter are negative.                         *
+    ***************************************************************************/
+    typedef struct benchmark_result_t {
+        const char* p_name;
+        /* The Dijkstra rank of the bucket, or 0 for all the queries. */
+        size_t      rank;
+        size_t      queries;
+        double*     p_latencies;
+        search_stats_t* p_stats;
+        double*     p_costs;
+        double      mean_latency;
+        double      p50_latency;
+        double      p90_latency;
+        double      p99_latency;
+        double      max_latency;
+        double      mean_settled;
+        size_t      max_settled;
+        double      mean_relaxed;
+        double      mean_decrease_keys;
+        double      mean_peak_open_set;
+        double      mean_peak_memory;
+        perf_sample_t* p_perf;
+        bool        perf_available[PERF_COUNTER_COUNT];
+        double      perf_per_query[PERF_COUNTER_COUNT];
+        double      perf_per_settled[PERF_COUNTER_COUNT];
+        size_t      unreachable;
+        size_t      mismatches;
+    } benchmark_result_t;
+
+    /***************************************************************************
+    * Loads the default configuration: 20000 nodes of the "random" family,     *
+    * 100 random queries after 10 warmup queries and textual output. With      *
+    * 'ranks' set, 'queries' is the number of Dijkstra rank sources instead.   *
+    ***************************************************************************/
+    void benchmark_config_t_init(benchmark_config_t* p_config);
+
+    /***************************************************************************
+    * Reads the command line options into 'p_config'. Returns false and        *
+    * prints a message to the standard error on invalid options.               *
+    ***************************************************************************/
+    bool benchmark_config_t_parse(benchmark_config_t* p_config,
+                                  int argc,
+                                  char** argv);
+
+    /***************************************************************************
+    * Returns the wall-clock time in nanoseconds from an arbitrary, fixed      *
+    * point in the past.                                                       *
+    ***************************************************************************/
+    unsigned long long benchmark_now(void);
+
+    /***************************************************************************
+    * Returns the 'p'th percentile of the 'size' values in 'p_values' using    *
+    * the nearest-rank method. The values must be sorted.                      *
+    ***************************************************************************/
+    double benchmark_percentile(double* p_values, size_t size, double p);
+
+    /***************************************************************************
+    * Returns the table of all the benchmarked algorithms, and stores its      *
+    * length in 'p_count'. The first entry is the reference algorithm.         *
+    ***************************************************************************/
+    const benchmark_algorithm_t* benchmark_algorithms(size_t* p_count);
+
+    /***************************************************************************
+    * Generates the Dijkstra rank workload: for each of 'sources' random       *
+    * sources, runs Dijkstra's algorithm and emits the queries to the nodes    *
+    * settled as the 2^r'th ones for r = 1, 2, ... The queries are stored in   *
+    * '*pp_queries' and their number is returned.                              *
+    ***************************************************************************/
+    size_t benchmark_rank_queries(graph_data_t*       p_data,
+                                  size_t              sources,
+                                  benchmark_query_t** pp_queries);
+
+    /***************************************************************************
+    * Loads into 'p_bucket' the measurements of 'p_all' on the queries of      *
+    * Dijkstra rank 'rank', and summarizes them. Returns false if the bucket   *
+    * is empty or could not be allocated.                                      *
+    ***************************************************************************/
+    bool benchmark_result_t_bucket(benchmark_result_t* p_all,
+                                   benchmark_query_t*  p_queries,
+                                   double*             p_reference_costs,
+                                   size_t              rank,
+                                   benchmark_result_t* p_bucket);
+
+    /***************************************************************************
+    * Runs 'p_algorithm' on every query in 'p_queries' after running it on the *
+    * first 'warmup' queries without measuring. If 'p_reference_costs' is not  *
+    * NULL, the path costs are checked against it. If 'p_counters' is not      *
+    * NULL, the hardware counters are read around each query, outside of the   *
+    * timed section. Returns false if the result could not be allocated.       *
+    ***************************************************************************/
+    bool benchmark_run_algorithm(const benchmark_algorithm_t* p_algorithm,
+                                 graph_data_t*       p_data,
+                                 benchmark_query_t*  p_queries,
+                                 size_t              queries,
+                                 size_t              warmup,
+                                 double*             p_reference_costs,
+                                 perf_counters_t*    p_counters,
+                                 benchmark_result_t* p_result);
+
+    /***************************************************************************
+    * Deallocates the measurement arrays of the result.                        *
+    ***************************************************************************/
+    void benchmark_result_t_free(benchmark_result_t* p_result);
+
+    /***************************************************************************
+    * Runs the benchmark with given command line options. Returns the exit     *
+    * status for the program: failure if the algorithms disagree on any path   *
+    * cost.                                                                    *
+    ***************************************************************************/
+    int benchmark_main(int argc, char** argv);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* BENCHMARK_H */
@@ -1,3 +1,4 @@
+#include "bidir_astar.h"
 #include "directed_graph_node.h"
 #include "list.h"
 #include "weight_function.h"
@@ -5,24 +6,8 @@
 #include <float.h>
 #include <stdlib.h>
 
-static void free_weight_list(list_t* p_list) 
-{
-    size_t i;
-    
-    for (i = 0; i < list_t_size(p_list); ++i) 
-    {
-        free(list_t_get(p_list, i));
-    }
-}
-
-static double heuristic_cost(unordered_map_t* p_location_map,
-                             directed_graph_node_t* p_node_a,
-                             directed_graph_node_t* p_node_b)
-{
-    point_3d_t* p_point_a = unordered_map_t_get(p_location_map, p_node_a);
-    point_3d_t* p_point_b = unordered_map_t_get(p_location_map, p_node_b);
-    return point_3d_t_distance(p_point_a, p_point_b);
-}
+/* The number of neighbours whose estimates are computed in one batch. */
+#define HEURISTIC_BATCH 64
 
 static double maxd(double a, double b) 
 {
@@ -35,10 +20,56 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
                                                    p_weight_function,
                             unordered_map_t* p_location_map)
 {
+    return bidirectional_astar_with_options(p_source,
+                                            p_target,
+                                            p_weight_function,
+                                            p_location_map,
+                                            NULL);
+}
+
+list_t* bidirectional_astar_with_options(directed_graph_node_t* p_source,
+                                         directed_graph_node_t* p_target,
+                                         directed_graph_weight_function_t* 
+                                                        p_weight_function,
+                                         unordered_map_t* p_location_map,
+                                         search_options_t* p_options)
+{
+    return weighted_bidirectional_astar(p_source,
+                                        p_target,
+                                        p_weight_function,
+                                        p_location_map,
+                                        0.0,
+                                        p_options);
+}
+
+list_t* weighted_bidirectional_astar(directed_graph_node_t* p_source,
+                                     directed_graph_node_t* p_target,
+                                     directed_graph_weight_function_t* 
+                                                    p_weight_function,
+                                     unordered_map_t* p_location_map,
+                                     double epsilon,
+                                     search_options_t* p_options)
+{
+    search_stats_t*    p_stats    = p_options ? p_options->p_stats : NULL;
+    search_recorder_t* p_recorder = p_options ? p_options->p_recorder : NULL;
+    allocator_t*       p_allocator = p_options ? p_options->p_allocator : NULL;
+    search_budget_t*   p_budget   = p_options ? p_options->p_budget : NULL;
+    size_t             settled    = 0;
+    heuristic_t        heuristic;
+    double             inflation = 1.0 + epsilon;
+    
+    if (!(epsilon >= 0.0)) return NULL;
+    if (!choose_heuristic(&heuristic, p_location_map, p_options)) return NULL;
+    
+    SEARCH_STATS_START(p_stats);
+    SEARCH_RECORDER_CLEAR(p_recorder);
+    search_budget_t_start(p_budget);
+    
     if (equals_function(p_source, p_target))
     {
-        list_t* p_path = list_t_alloc(1);
+        list_t* p_path = list_t_alloc(1, NULL);
         list_t_push_back(p_path, p_source);
+        SEARCH_RECORDER_MEET(p_recorder, p_source);
         return p_path;
     }
     
@@ -60,12 +91,14 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
     list_t* p_weight_list;
     
     weight_t* p_weight;
-    size_t i;
+    list_t*   p_path;
     
     directed_graph_node_t* p_touch_node = NULL;
     double best_path_cost = DBL_MAX;
+    double estimates[HEURISTIC_BATCH];
+    double estimate;
     
-    search_state_t_alloc(&forward_search_state);
+    search_state_t_alloc(&forward_search_state, p_allocator);
     
     if (!search_state_t_is_ready(&forward_search_state)) 
     {
@@ -73,20 +106,13 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
         return NULL;
     }
     
-    search_state_t_alloc(&backward_search_state);
+    search_state_t_alloc(&backward_search_state, p_allocator);
     
     if (!search_state_t_is_ready(&backward_search_state)) 
     {
         search_state_t_free(&forward_search_state);
         search_state_t_free(&backward_search_state);
-    }
-    
-    p_weight_list = list_t_alloc(INITIAL_CAPACITY);
-    
-    if (!p_weight_list) 
-    {
-        search_state_t_free(&forward_search_state);
-        search_state_t_free(&backward_search_state);
+        return NULL;
     }
     
     p_open_set_a   = forward_search_state.p_open_set;
@@ -101,7 +127,7 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
     p_cost_map_b   = backward_search_state.p_cost_map;
     
     /* Initialize the forward search structures. */
-    p_weight = malloc(sizeof(*p_weight));
+    p_weight = allocator_t_alloc(p_allocator, sizeof(*p_weight));
     p_weight->weight = 0.0;
     
     list_t_push_back(p_weight_list, p_weight);
@@ -109,7 +135,7 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
     unordered_map_t_put(p_cost_map_a, p_source, p_weight);
     
     /* Initialize the backward search structures. */
-    p_weight = malloc(sizeof(*p_weight));
+    p_weight = allocator_t_alloc(p_allocator, sizeof(*p_weight));
     p_weight->weight = 0.0;
     
     list_t_push_back(p_weight_list, p_weight);
@@ -120,8 +146,30 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
     unordered_map_t_put(p_parent_map_a, p_source, NULL);
     unordered_map_t_put(p_parent_map_b, p_target, NULL);
     
+    SEARCH_STATS_ADD(p_stats, heap_pushes, 2);
+    SEARCH_STATS_PEAK(p_stats, peak_open_set, 2);
+    SEARCH_STATS_END_PHASE(p_stats, setup_time);
+    
     while (heap_t_size(p_open_set_a) > 0 && heap_t_size(p_open_set_b) > 0) 
     {
+        SEARCH_STATS_PEAK(p_stats,
+                          peak_memory,
+                          search_state_t_memory_usage(&forward_search_state) +
+                          search_state_t_memory_usage(&backward_search_state));
+        
+        if (SEARCH_BUDGET_EXHAUSTED(
+                p_budget,
+                settled,
+                search_state_t_memory_usage(&forward_search_state) +
+                search_state_t_memory_usage(&backward_search_state)))
+        {
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
+            search_state_t_free(&forward_search_state);
+            search_state_t_free(&backward_search_state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+            return NULL;
+        }
+        
         if (p_touch_node)
         {
             directed_graph_node_t* p_min_a = heap_t_min(p_open_set_a);
@@ -129,20 +177,27 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
             
             double cost_a = ((weight_t*) 
                             unordered_map_t_get(p_cost_map_a, p_min_a))->weight + 
-                            heuristic_cost(p_location_map, p_min_a, p_target);
+                            inflation * heuristic_t_estimate(&heuristic, 
+                                                             p_min_a, 
+                                                             p_target);
             
             double cost_b = ((weight_t*)
                             unordered_map_t_get(p_cost_map_b, p_min_b))->weight +
-                            heuristic_cost(p_location_map, p_min_b, p_source);
+                            inflation * heuristic_t_estimate(&heuristic,
+                                                             p_source,
+                                                             p_min_b);
             
             if (best_path_cost < maxd(cost_a, cost_b))
             {
-                list_t* p_path = traceback_bidirectional_path(p_touch_node,
+                SEARCH_STATS_END_PHASE(p_stats, search_time);
+                SEARCH_RECORDER_MEET(p_recorder, p_touch_node);
+                p_path = traceback_bidirectional_path(p_touch_node,
                                                               p_parent_map_a,
                                                               p_parent_map_b);
-                free_weight_list(p_weight_list);
+                SEARCH_STATS_END_PHASE(p_stats, traceback_time);
                 search_state_t_free(&forward_search_state);
                 search_state_t_free(&backward_search_state);
+                SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
                 return p_path;
             }
         }
@@ -151,21 +206,50 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
         {
             directed_graph_node_t* p_current = heap_t_extract_min(p_open_set_a);
             
+            SEARCH_STATS_COUNT(p_stats, heap_pops);
+            SEARCH_STATS_COUNT(p_stats, nodes_settled);
+            ++settled;
+            SEARCH_RECORDER_SETTLE(p_recorder,
+                                   p_current,
+                                   ((weight_t*) unordered_map_t_get(
+                                           p_cost_map_a, p_current))->weight,
+                                   ((weight_t*) unordered_map_t_get(
+                                           p_cost_map_a, p_current))->weight +
+                                   inflation *
+                                   heuristic_t_estimate(&heuristic,
+                                                        p_current,
+                                                        p_target),
+                                   SEARCH_FORWARD);
+            
             unordered_set_t_add(p_closed_set_a, p_current);
             
-            unordered_set_iterator_t* p_child_iterator = 
-                    unordered_set_iterator_t_alloc(
-                        directed_graph_node_t_children_set(p_current));
+            directed_graph_node_t** p_children = 
+                    directed_graph_node_t_children(p_current);
+            size_t child_count = directed_graph_node_t_child_count(p_current);
+            size_t i;
             
-            while (unordered_set_iterator_t_has_next(p_child_iterator))
+            for (i = 0; i < child_count; ++i)
             {
-                directed_graph_node_t* p_child;
-                unordered_set_iterator_t_next(p_child_iterator, &p_child);
+                directed_graph_node_t* p_child = p_children[i];
+                
+                /* Estimate the children ahead, closed or not, in one batch. */
+                if (i % HEURISTIC_BATCH == 0)
+                {
+                    heuristic_t_estimate_batch(
+                            &heuristic,
+                            p_children + i,
+                            child_count - i < HEURISTIC_BATCH ? 
+                                    child_count - i : HEURISTIC_BATCH,
+                            p_target,
+                            estimates);
+                }
                 
                 if (unordered_set_t_contains(p_closed_set_a, p_child)) 
                 {
                     continue;
                 }
+
+                SEARCH_STATS_COUNT(p_stats, arcs_relaxed);
                 
                 double tmp_g_score = 
                     ((weight_t*) unordered_map_t_get(p_cost_map_a,
@@ -174,18 +258,24 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
                                                           p_current, 
                                                           p_child);
                 
+                estimate = inflation * estimates[i % HEURISTIC_BATCH];
+                
                 if (!unordered_map_t_contains_key(p_cost_map_a, p_child)) 
                 {
-                    p_weight = malloc(sizeof(*p_weight));
-                    p_weight->weight = tmp_g_score + 
-                                       heuristic_cost(p_location_map,
-                                                      p_child,
-                                                      p_target);
+                    p_weight = allocator_t_alloc(p_allocator,
+                                                 sizeof(*p_weight));
+                    p_weight->weight = tmp_g_score + estimate;
                     
                     list_t_push_back(p_weight_list, p_weight);
                     heap_t_add(p_open_set_a, p_child, p_weight);
+                    SEARCH_STATS_COUNT(p_stats, heap_pushes);
+                    SEARCH_STATS_PEAK(p_stats,
+                                      peak_open_set,
+                                      heap_t_size(p_open_set_a) + 
+                                      heap_t_size(p_open_set_b));
                     
-                    p_weight = malloc(sizeof(*p_weight));
+                    p_weight = allocator_t_alloc(p_allocator,
+                                                 sizeof(*p_weight));
                     p_weight->weight = tmp_g_score;
                     
                     list_t_push_back(p_weight_list, p_weight);
@@ -213,16 +303,16 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
                                                      p_child))->weight;
                     if (old_score > tmp_g_score)
                     {
-                        p_weight = malloc(sizeof(*p_weight));
-                        p_weight->weight = tmp_g_score +
-                                           heuristic_cost(p_location_map,
-                                                          p_child,
-                                                          p_target);
+                        p_weight = allocator_t_alloc(p_allocator,
+                                                     sizeof(*p_weight));
+                        p_weight->weight = tmp_g_score + estimate;
                         
                         list_t_push_back(p_weight_list, p_weight);
                         heap_t_decrease_key(p_open_set_a, p_child, p_weight);
+                        SEARCH_STATS_COUNT(p_stats, decrease_keys);
                         
-                        p_weight = malloc(sizeof(*p_weight));
+                        p_weight = allocator_t_alloc(p_allocator,
+                                                     sizeof(*p_weight));
                         p_weight->weight = tmp_g_score;
                         
                         list_t_push_back(p_weight_list, p_weight);
@@ -249,21 +339,60 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
         {
             directed_graph_node_t* p_current = heap_t_extract_min(p_open_set_b);
             
+            SEARCH_STATS_COUNT(p_stats, heap_pops);
+            SEARCH_STATS_COUNT(p_stats, nodes_settled);
+            ++settled;
+            SEARCH_RECORDER_SETTLE(p_recorder,
+                                   p_current,
+                                   ((weight_t*) unordered_map_t_get(
+                                           p_cost_map_b, p_current))->weight,
+                                   ((weight_t*) unordered_map_t_get(
+                                           p_cost_map_b, p_current))->weight +
+                                   inflation *
+                                   heuristic_t_estimate(&heuristic,
+                                                        p_source,
+                                                        p_current),
+                                   SEARCH_BACKWARD);
+            
             unordered_set_t_add(p_closed_set_b, p_current);
             
-            unordered_set_iterator_t* p_parent_iterator = 
-                    unordered_set_iterator_t_alloc(
-                        directed_graph_node_t_parent_set(p_current));
+            /* Missing parents would hide paths, so give up instead. */
+            if (!directed_graph_node_t_parents_known(p_current))
+            {
+                SEARCH_STATS_END_PHASE(p_stats, search_time);
+                search_state_t_free(&forward_search_state);
+                search_state_t_free(&backward_search_state);
+                SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+                return NULL;
+            }
+            
+            directed_graph_node_t** p_parents = 
+                    directed_graph_node_t_parents(p_current);
+            size_t parent_count = directed_graph_node_t_parent_count(p_current);
+            size_t i;
             
-            while (unordered_set_iterator_t_has_next(p_parent_iterator)) 
+            for (i = 0; i < parent_count; ++i)
             {
-                directed_graph_node_t* p_parent;
-                unordered_set_iterator_t_next(p_parent_iterator, &p_parent);
+                directed_graph_node_t* p_parent = p_parents[i];
+                
+                /* Estimate the parents ahead, closed or not, in one batch. */
+                if (i % HEURISTIC_BATCH == 0)
+                {
+                    heuristic_t_estimate_batch_to(
+                            &heuristic,
+                            p_source,
+                            p_parents + i,
+                            parent_count - i < HEURISTIC_BATCH ? 
+                                    parent_count - i : HEURISTIC_BATCH,
+                            estimates);
+                }
                 
                 if (unordered_set_t_contains(p_closed_set_b, p_parent)) 
                 {
                     continue;
                 }
+
+                SEARCH_STATS_COUNT(p_stats, arcs_relaxed);
                 
                 double tmp_g_score = 
                     ((weight_t*) unordered_map_t_get(p_cost_map_b,
@@ -272,20 +401,27 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
                                                           p_parent, 
                                                           p_current);
                 
+                estimate = inflation * estimates[i % HEURISTIC_BATCH];
+                
                 if (!unordered_map_t_contains_key(p_cost_map_b, p_parent)) 
                 {
-                    p_weight = malloc(sizeof(*p_weight));
-                    p_weight->weight = tmp_g_score +
-                                       heuristic_cost(p_location_map,
-                                                      p_parent,
-                                                      p_source);
+                    p_weight = allocator_t_alloc(p_allocator,
+                                                 sizeof(*p_weight));
+                    p_weight->weight = tmp_g_score + estimate;
                     
                     list_t_push_back(p_weight_list, p_weight);
                     heap_t_add(p_open_set_b, p_parent, p_weight);
+                    SEARCH_STATS_COUNT(p_stats, heap_pushes);
+                    SEARCH_STATS_PEAK(p_stats,
+                                      peak_open_set,
+                                      heap_t_size(p_open_set_a) + 
+                                      heap_t_size(p_open_set_b));
                     
-                    p_weight = malloc(sizeof(*p_weight));
+                    p_weight = allocator_t_alloc(p_allocator,
+                                                 sizeof(*p_weight));
                     p_weight->weight = tmp_g_score;
                     
+                    list_t_push_back(p_weight_list, p_weight);
                     unordered_map_t_put(p_cost_map_b, p_parent, p_weight);
                     unordered_map_t_put(p_parent_map_b, p_parent, p_current);
                     
@@ -310,18 +446,19 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
                                                      p_parent))->weight;
                     if (old_score > tmp_g_score)
                     {
-                        p_weight = malloc(sizeof(*p_weight));
-                        p_weight->weight = tmp_g_score +
-                                           heuristic_cost(p_location_map,
-                                                          p_parent,
-                                                          p_source);
+                        p_weight = allocator_t_alloc(p_allocator,
+                                                     sizeof(*p_weight));
+                        p_weight->weight = tmp_g_score + estimate;
                         
                         list_t_push_back(p_weight_list, p_weight);
                         heap_t_decrease_key(p_open_set_b, p_parent, p_weight);
+                        SEARCH_STATS_COUNT(p_stats, decrease_keys);
                         
-                        p_weight = malloc(sizeof(*p_weight));
+                        p_weight = allocator_t_alloc(p_allocator,
+                                                     sizeof(*p_weight));
                         p_weight->weight = tmp_g_score;
                         
+                        list_t_push_back(p_weight_list, p_weight);
                         unordered_map_t_put(p_cost_map_b, p_parent, p_weight);
                         unordered_map_t_put(p_parent_map_b, p_parent, p_current);
                         
@@ -343,8 +480,19 @@ list_t* bidirectional_astar(directed_graph_node_t* p_source,
         }
     }
     
-    free_weight_list(p_weight_list);
+    SEARCH_STATS_END_PHASE(p_stats, search_time);
+    SEARCH_RECORDER_MEET(p_recorder, p_touch_node);
+    
+    /* One of the searches ran out of nodes after the two have met. */
+    p_path = p_touch_node ? 
+             traceback_bidirectional_path(p_touch_node,
+                                          p_parent_map_a,
+                                          p_parent_map_b) :
+             list_t_alloc(INITIAL_CAPACITY, NULL);
+    
+    SEARCH_STATS_END_PHASE(p_stats, traceback_time);
     search_state_t_free(&forward_search_state);
     search_state_t_free(&backward_search_state);
-    return list_t_alloc(INITIAL_CAPACITY);
+    SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+    return p_path;
 }
@@ -1,16 +1,54 @@
 #ifndef BIDIR_ASTAR_H
 #define	BIDIR_ASTAR_H
 
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include "unordered_map.h"
+#include "list.h"
+#include "search_options.h"
+
 #ifdef	__cplusplus
 extern "C" {
 #endif
 
+    /***************************************************************************
+    * Returns a shortest path from 'p_source' to 'p_target' by running A*      *
+    * from both ends, or an empty path if 'p_target' is not reachable. Returns *
+    * NULL if the backward search meets a node whose parents are not known.    *
+    ***************************************************************************/
     list_t* bidirectional_astar
         (directed_graph_node_t* p_source,
          directed_graph_node_t* p_target,
          directed_graph_weight_function_t* p_weight_function,
          unordered_map_t*       p_location_map);    
 
+    /***************************************************************************
+    * Same as 'bidirectional_astar', but honours the options 'p_options',      *
+    * which may be NULL. 'p_location_map' may be NULL if the options give a    *
+    * coordinate store or a heuristic. A heuristic that is not symmetric is    *
+    * asked for the estimates from the source in the backward search.          *
+    ***************************************************************************/
+    list_t* bidirectional_astar_with_options
+        (directed_graph_node_t* p_source,
+         directed_graph_node_t* p_target,
+         directed_graph_weight_function_t* p_weight_function,
+         unordered_map_t*       p_location_map,
+         search_options_t*      p_options);
+
+    /***************************************************************************
+    * Same as 'bidirectional_astar_with_options', but inflates the estimates   *
+    * of both searches by 1 + 'epsilon' and returns a path costing at most     *
+    * 1 + 'epsilon' times the shortest one. Returns NULL if 'epsilon' is       *
+    * negative.                                                                *
+    ***************************************************************************/
+    list_t* weighted_bidirectional_astar
+        (directed_graph_node_t* p_source,
+         directed_graph_node_t* p_target,
+         directed_graph_weight_function_t* p_weight_function,
+         unordered_map_t*       p_location_map,
+         double                 epsilon,
+         search_options_t*      p_options);
+
 
 #ifdef	__cplusplus
 }
@@ -1,3 +1,4 @@
+#include "bidir_dijkstra.h"
 #include "directed_graph_node.h"
 #include "list.h"
 #include "weight_function.h"
@@ -5,25 +6,38 @@
 #include <float.h>
 #include <stdlib.h>
 
-static void free_weight_list(list_t* p_list) 
-{
-    size_t i;
-    
-    for (i = 0; i < list_t_size(p_list); ++i) 
-    {
-        free(list_t_get(p_list, i));
-    }
-}
-
 list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
                                directed_graph_node_t* p_target,
                                directed_graph_weight_function_t* 
                                                       p_weight_function)
 {
+    return bidirectional_dijkstra_with_options(p_source,
+                                               p_target,
+                                               p_weight_function,
+                                               NULL);
+}
+
+list_t* bidirectional_dijkstra_with_options(directed_graph_node_t* p_source,
+                                            directed_graph_node_t* p_target,
+                                            directed_graph_weight_function_t* 
+                                                        p_weight_function,
+                                            search_options_t* p_options)
+{
+    search_stats_t*    p_stats    = p_options ? p_options->p_stats : NULL;
+    search_recorder_t* p_recorder = p_options ? p_options->p_recorder : NULL;
+    allocator_t*       p_allocator = p_options ? p_options->p_allocator : NULL;
+    search_budget_t*   p_budget   = p_options ? p_options->p_budget : NULL;
+    size_t             settled    = 0;
+    
+    SEARCH_STATS_START(p_stats);
+    SEARCH_RECORDER_CLEAR(p_recorder);
+    search_budget_t_start(p_budget);
+    
     if (equals_function(p_source, p_target))
     {
-        list_t* p_path = list_t_alloc(1);
+        list_t* p_path = list_t_alloc(1, NULL);
         list_t_push_back(p_path, p_source);
+        SEARCH_RECORDER_MEET(p_recorder, p_source);
         return p_path;
     }
     
@@ -45,12 +59,12 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
     list_t* p_weight_list;
     
     weight_t* p_weight;
-    size_t i;
+    list_t*   p_path;
     
     directed_graph_node_t* p_touch_node = NULL;
     double best_path_cost = DBL_MAX;
     
-    search_state_t_alloc(&forward_search_state);
+    search_state_t_alloc(&forward_search_state, p_allocator);
     
     if (!search_state_t_is_ready(&forward_search_state)) 
     {
@@ -58,20 +72,13 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
         return NULL;
     }
     
-    search_state_t_alloc(&backward_search_state);
+    search_state_t_alloc(&backward_search_state, p_allocator);
     
     if (!search_state_t_is_ready(&backward_search_state)) 
     {
         search_state_t_free(&forward_search_state);
         search_state_t_free(&backward_search_state);
-    }
-    
-    p_weight_list = list_t_alloc(INITIAL_CAPACITY);
-    
-    if (!p_weight_list) 
-    {
-        search_state_t_free(&forward_search_state);
-        search_state_t_free(&backward_search_state);
+        return NULL;
     }
     
     p_open_set_a   = forward_search_state.p_open_set;
@@ -86,7 +93,7 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
     p_cost_map_b   = backward_search_state.p_cost_map;
     
     /* Initialize the forward search structures. */
-    p_weight = malloc(sizeof(*p_weight));
+    p_weight = allocator_t_alloc(p_allocator, sizeof(*p_weight));
     p_weight->weight = 0.0;
     
     list_t_push_back(p_weight_list, p_weight);
@@ -94,7 +101,7 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
     unordered_map_t_put(p_cost_map_a, p_source, p_weight);
     
     /* Initialize the backward search structures. */
-    p_weight = malloc(sizeof(*p_weight));
+    p_weight = allocator_t_alloc(p_allocator, sizeof(*p_weight));
     p_weight->weight = 0.0;
     
     list_t_push_back(p_weight_list, p_weight);
@@ -105,8 +112,30 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
     unordered_map_t_put(p_parent_map_a, p_source, NULL);
     unordered_map_t_put(p_parent_map_b, p_target, NULL);
     
+    SEARCH_STATS_ADD(p_stats, heap_pushes, 2);
+    SEARCH_STATS_PEAK(p_stats, peak_open_set, 2);
+    SEARCH_STATS_END_PHASE(p_stats, setup_time);
+    
     while (heap_t_size(p_open_set_a) > 0 && heap_t_size(p_open_set_b) > 0) 
     {
+        SEARCH_STATS_PEAK(p_stats,
+                          peak_memory,
+                          search_state_t_memory_usage(&forward_search_state) +
+                          search_state_t_memory_usage(&backward_search_state));
+        
+        if (SEARCH_BUDGET_EXHAUSTED(
+                p_budget,
+                settled,
+                search_state_t_memory_usage(&forward_search_state) +
+                search_state_t_memory_usage(&backward_search_state)))
+        {
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
+            search_state_t_free(&forward_search_state);
+            search_state_t_free(&backward_search_state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+            return NULL;
+        }
+        
         double top_a_cost = 
         ((weight_t*) unordered_map_t_get(p_cost_map_a, 
                                          heap_t_min(p_open_set_a)))->weight;
@@ -119,12 +148,15 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
         
         if (top_sum > best_path_cost)
         {
-            list_t* p_path = traceback_bidirectional_path(p_touch_node,
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
+            SEARCH_RECORDER_MEET(p_recorder, p_touch_node);
+            p_path = traceback_bidirectional_path(p_touch_node,
                                                           p_parent_map_a,
                                                           p_parent_map_b);
-            free_weight_list(p_weight_list);
+            SEARCH_STATS_END_PHASE(p_stats, traceback_time);
             search_state_t_free(&forward_search_state);
             search_state_t_free(&backward_search_state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
             return p_path;
         }
         
@@ -132,21 +164,34 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
         {
             directed_graph_node_t* p_current = heap_t_extract_min(p_open_set_a);
             
+            SEARCH_STATS_COUNT(p_stats, heap_pops);
+            SEARCH_STATS_COUNT(p_stats, nodes_settled);
+            ++settled;
+            SEARCH_RECORDER_SETTLE(p_recorder,
+                                   p_current,
+                                   ((weight_t*) unordered_map_t_get(
+                                           p_cost_map_a, p_current))->weight,
+                                   ((weight_t*) unordered_map_t_get(
+                                           p_cost_map_a, p_current))->weight,
+                                   SEARCH_FORWARD);
+            
             unordered_set_t_add(p_closed_set_a, p_current);
             
-            unordered_set_iterator_t* p_child_iterator = 
-                    unordered_set_iterator_t_alloc(
-                        directed_graph_node_t_children_set(p_current));
+            directed_graph_node_t** p_children = 
+                    directed_graph_node_t_children(p_current);
+            size_t child_count = directed_graph_node_t_child_count(p_current);
+            size_t i;
             
-            while (unordered_set_iterator_t_has_next(p_child_iterator))
+            for (i = 0; i < child_count; ++i)
             {
-                directed_graph_node_t* p_child;
-                unordered_set_iterator_t_next(p_child_iterator, &p_child);
+                directed_graph_node_t* p_child = p_children[i];
                 
                 if (unordered_set_t_contains(p_closed_set_a, p_child)) 
                 {
                     continue;
                 }
+
+                SEARCH_STATS_COUNT(p_stats, arcs_relaxed);
                 
                 double tmp_g_score = 
                     ((weight_t*) unordered_map_t_get(p_cost_map_a,
@@ -157,11 +202,17 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
                 
                 if (!unordered_map_t_contains_key(p_cost_map_a, p_child)) 
                 {
-                    p_weight = malloc(sizeof(*p_weight));
+                    p_weight = allocator_t_alloc(p_allocator,
+                                                 sizeof(*p_weight));
                     p_weight->weight = tmp_g_score;
                     
                     list_t_push_back(p_weight_list, p_weight);
                     heap_t_add(p_open_set_a, p_child, p_weight);
+                    SEARCH_STATS_COUNT(p_stats, heap_pushes);
+                    SEARCH_STATS_PEAK(p_stats,
+                                      peak_open_set,
+                                      heap_t_size(p_open_set_a) + 
+                                      heap_t_size(p_open_set_b));
                     unordered_map_t_put(p_cost_map_a, p_child, p_weight);
                     unordered_map_t_put(p_parent_map_a, p_child, p_current);
                     
@@ -186,11 +237,13 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
                                                      p_child))->weight;
                     if (old_score > tmp_g_score)
                     {
-                        p_weight = malloc(sizeof(*p_weight));
+                        p_weight = allocator_t_alloc(p_allocator,
+                                                     sizeof(*p_weight));
                         p_weight->weight = tmp_g_score;
                         
                         list_t_push_back(p_weight_list, p_weight);
                         heap_t_decrease_key(p_open_set_a, p_child, p_weight);
+                        SEARCH_STATS_COUNT(p_stats, decrease_keys);
                         unordered_map_t_put(p_cost_map_a, p_child, p_weight);
                         unordered_map_t_put(p_parent_map_a, p_child, p_current);
                         
@@ -214,21 +267,44 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
         {
             directed_graph_node_t* p_current = heap_t_extract_min(p_open_set_b);
             
+            SEARCH_STATS_COUNT(p_stats, heap_pops);
+            SEARCH_STATS_COUNT(p_stats, nodes_settled);
+            ++settled;
+            SEARCH_RECORDER_SETTLE(p_recorder,
+                                   p_current,
+                                   ((weight_t*) unordered_map_t_get(
+                                           p_cost_map_b, p_current))->weight,
+                                   ((weight_t*) unordered_map_t_get(
+                                           p_cost_map_b, p_current))->weight,
+                                   SEARCH_BACKWARD);
+            
             unordered_set_t_add(p_closed_set_b, p_current);
             
-            unordered_set_iterator_t* p_parent_iterator = 
-                    unordered_set_iterator_t_alloc(
-                        directed_graph_node_t_parent_set(p_current));
+            /* Missing parents would hide paths, so give up instead. */
+            if (!directed_graph_node_t_parents_known(p_current))
+            {
+                SEARCH_STATS_END_PHASE(p_stats, search_time);
+                search_state_t_free(&forward_search_state);
+                search_state_t_free(&backward_search_state);
+                SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+                return NULL;
+            }
+            
+            directed_graph_node_t** p_parents = 
+                    directed_graph_node_t_parents(p_current);
+            size_t parent_count = directed_graph_node_t_parent_count(p_current);
+            size_t i;
             
-            while (unordered_set_iterator_t_has_next(p_parent_iterator)) 
+            for (i = 0; i < parent_count; ++i)
             {
-                directed_graph_node_t* p_parent;
-                unordered_set_iterator_t_next(p_parent_iterator, &p_parent);
+                directed_graph_node_t* p_parent = p_parents[i];
                 
                 if (unordered_set_t_contains(p_closed_set_b, p_parent)) 
                 {
                     continue;
                 }
+
+                SEARCH_STATS_COUNT(p_stats, arcs_relaxed);
                 
                 double tmp_g_score = 
                     ((weight_t*) unordered_map_t_get(p_cost_map_b,
@@ -239,11 +315,17 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
                 
                 if (!unordered_map_t_contains_key(p_cost_map_b, p_parent)) 
                 {
-                    p_weight = malloc(sizeof(*p_weight));
+                    p_weight = allocator_t_alloc(p_allocator,
+                                                 sizeof(*p_weight));
                     p_weight->weight = tmp_g_score;
                     
                     list_t_push_back(p_weight_list, p_weight);
                     heap_t_add(p_open_set_b, p_parent, p_weight);
+                    SEARCH_STATS_COUNT(p_stats, heap_pushes);
+                    SEARCH_STATS_PEAK(p_stats,
+                                      peak_open_set,
+                                      heap_t_size(p_open_set_a) + 
+                                      heap_t_size(p_open_set_b));
                     unordered_map_t_put(p_cost_map_b, p_parent, p_weight);
                     unordered_map_t_put(p_parent_map_b, p_parent, p_current);
                     
@@ -268,11 +350,13 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
                                                      p_parent))->weight;
                     if (old_score > tmp_g_score)
                     {
-                        p_weight = malloc(sizeof(*p_weight));
+                        p_weight = allocator_t_alloc(p_allocator,
+                                                     sizeof(*p_weight));
                         p_weight->weight = tmp_g_score;
                         
                         list_t_push_back(p_weight_list, p_weight);
                         heap_t_decrease_key(p_open_set_b, p_parent, p_weight);
+                        SEARCH_STATS_COUNT(p_stats, decrease_keys);
                         unordered_map_t_put(p_cost_map_b, p_parent, p_weight);
                         unordered_map_t_put(p_parent_map_b, p_parent, p_current);
                         
@@ -294,8 +378,19 @@ list_t* bidirectional_dijkstra(directed_graph_node_t* p_source,
         }
     }
     
-    free_weight_list(p_weight_list);
+    SEARCH_STATS_END_PHASE(p_stats, search_time);
+    SEARCH_RECORDER_MEET(p_recorder, p_touch_node);
+    
+    /* One of the searches ran out of nodes after the two have met. */
+    p_path = p_touch_node ? 
+             traceback_bidirectional_path(p_touch_node,
+                                          p_parent_map_a,
+                                          p_parent_map_b) :
+             list_t_alloc(INITIAL_CAPACITY, NULL);
+    
+    SEARCH_STATS_END_PHASE(p_stats, traceback_time);
     search_state_t_free(&forward_search_state);
     search_state_t_free(&backward_search_state);
-    return list_t_alloc(INITIAL_CAPACITY);
+    SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+    return p_path;
 }
\ No newline at end of file
@@ -4,16 +4,32 @@
 #include "directed_graph_node.h"
 #include "list.h"
 #include "weight_function.h"
+#include "search_options.h"
 
 #ifdef	__cplusplus
 extern "C" {
 #endif
 
+    /***************************************************************************
+    * Returns a shortest path from 'p_source' to 'p_target' by searching from  *
+    * both ends, or an empty path if 'p_target' is not reachable. Returns NULL *
+    * if the backward search meets a node whose parents are not known.         *
+    ***************************************************************************/
     list_t* bidirectional_dijkstra
         (directed_graph_node_t* p_source,
          directed_graph_node_t* p_target,
          directed_graph_weight_function_t* p_weight_function);    
 
+    /***************************************************************************
+    * Same as 'bidirectional_dijkstra', but honours the options 'p_options',   *
+    * which may be NULL.                                                       *
+    ***************************************************************************/
+    list_t* bidirectional_dijkstra_with_options
+        (directed_graph_node_t* p_source,
+         directed_graph_node_t* p_target,
+         directed_graph_weight_function_t* p_weight_function,
+         search_options_t* p_options);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -0,0 +1,462 @@
+#include "coordinate_store.h"
+#include "memory_usage.h"
+#include <math.h>
+
+#if !defined(NO_COORDINATE_SIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define COORDINATE_X86
+#include <immintrin.h>
+#endif
+
+#ifndef M_PI
+#define M_PI    3.14159265358979323846
+#endif
+
+#ifndef M_SQRT2
+#define M_SQRT2 1.41421356237309504880
+#endif
+
+/* The number of node ids resolved before each run of the kernels. */
+#define BATCH 64
+
+struct coordinate_store_t {
+    /* One block holding the x, then the y, then the z array. */
+    double*             p_x;
+    double*             p_y;
+    double*             p_z;
+    /* The factor all the distances are multiplied by. */
+    double              scale;
+    coordinate_metric_t metric;
+    size_t              capacity;
+    allocator_t*        p_allocator;
+};
+
+/* The widest supported instruction set, or -1 until first asked for. */
+static int best_simd = -1;
+
+coordinate_store_t* coordinate_store_t_alloc(size_t capacity,
+                                             allocator_t* p_allocator)
+{
+    coordinate_store_t* p_store;
+
+    if (capacity > INT32_MAX) return NULL;
+
+    p_store = allocator_t_alloc(p_allocator, sizeof(*p_store));
+
+    if (!p_store) return NULL;
+
+    p_store->p_x = allocator_t_calloc(p_allocator,
+                                      3 * (capacity ? capacity : 1),
+                                      sizeof(double));
+
+    if (!p_store->p_x)
+    {
+        allocator_t_free(p_allocator, p_store);
+        return NULL;
+    }
+
+    p_store->p_y         = p_store->p_x + capacity;
+    p_store->p_z         = p_store->p_y + capacity;
+    p_store->scale       = 1.0;
+    p_store->metric      = COORDINATE_METRIC_EUCLIDEAN_3D;
+    p_store->capacity    = capacity;
+    p_store->p_allocator = p_allocator;
+    return p_store;
+}
+
+bool coordinate_store_t_set(coordinate_store_t* p_store,
+                            uint32_t id,
+                            double x,
+                            double y,
+                            double z)
+{
+    if (!p_store || id >= p_store->capacity) return false;
+
+    p_store->p_x[id] = x;
+    p_store->p_y[id] = y;
+    p_store->p_z[id] = z;
+    return true;
+}
+
+size_t coordinate_store_t_capacity(coordinate_store_t* p_store)
+{
+    return p_store ? p_store->capacity : 0;
+}
+
+bool coordinate_store_t_set_geo(coordinate_store_t* p_store,
+                                uint32_t id,
+                                double latitude,
+                                double longitude)
+{
+    double phi    = latitude  * (M_PI / 180.0);
+    double lambda = longitude * (M_PI / 180.0);
+
+    return coordinate_store_t_set(
+            p_store,
+            id,
+            COORDINATE_EARTH_RADIUS * cos(phi) * cos(lambda),
+            COORDINATE_EARTH_RADIUS * cos(phi) * sin(lambda),
+            COORDINATE_EARTH_RADIUS * sin(phi));
+}
+
+bool coordinate_store_t_get(coordinate_store_t* p_store,
+                            uint32_t id,
+                            double* p_x,
+                            double* p_y,
+                            double* p_z)
+{
+    if (!p_store || id >= p_store->capacity) return false;
+
+    if (p_x) *p_x = p_store->p_x[id];
+    if (p_y) *p_y = p_store->p_y[id];
+    if (p_z) *p_z = p_store->p_z[id];
+    return true;
+}
+
+void coordinate_store_t_set_metric(coordinate_store_t* p_store,
+                                   coordinate_metric_t metric)
+{
+    if (p_store) p_store->metric = metric;
+}
+
+coordinate_metric_t coordinate_store_t_metric(coordinate_store_t* p_store)
+{
+    return p_store ? p_store->metric : COORDINATE_METRIC_EUCLIDEAN_3D;
+}
+
+bool coordinate_store_t_set_scale(coordinate_store_t* p_store, double scale)
+{
+    if (!p_store || !(scale >= 0.0)) return false;
+
+    p_store->scale = scale;
+    return true;
+}
+
+double coordinate_store_t_scale(coordinate_store_t* p_store)
+{
+    return p_store ? p_store->scale : 1.0;
+}
+
+/*******************************************************************************
+* The kernels compute the distances from the nodes 'p_ids' to the point        *
+* (tx, ty, tz) in the same order of operations as 'point_3d_t_distance', and   *
+* scale them last, so that all of them agree to the last bit.                  *
+*******************************************************************************/
+static void distances_scalar(coordinate_store_t* p_store,
+                             const uint32_t* p_ids,
+                             size_t count,
+                             double tx,
+                             double ty,
+                             double tz,
+                             double* p_distances)
+{
+    double dx;
+    double dy;
+    double dz;
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+    {
+        dx = p_store->p_x[p_ids[i]] - tx;
+        dy = p_store->p_y[p_ids[i]] - ty;
+        dz = p_store->p_z[p_ids[i]] - tz;
+        p_distances[i] = p_store->scale * sqrt(dx * dx + dy * dy + dz * dz);
+    }
+}
+
+/*******************************************************************************
+* Same as 'distances_scalar', but measures the metric of the store.            *
+*******************************************************************************/
+static void distances_metric(coordinate_store_t* p_store,
+                             const uint32_t* p_ids,
+                             size_t count,
+                             double tx,
+                             double ty,
+                             double tz,
+                             double* p_distances)
+{
+    double dx;
+    double dy;
+    double distance;
+    size_t i;
+
+    if (p_store->metric == COORDINATE_METRIC_EUCLIDEAN_3D)
+    {
+        distances_scalar(p_store, p_ids, count, tx, ty, tz, p_distances);
+        return;
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        dx = fabs(p_store->p_x[p_ids[i]] - tx);
+        dy = fabs(p_store->p_y[p_ids[i]] - ty);
+
+        switch (p_store->metric)
+        {
+            case COORDINATE_METRIC_MANHATTAN:
+                distance = dx + dy;
+                break;
+
+            case COORDINATE_METRIC_OCTILE:
+                distance = dx > dy ? dx + (M_SQRT2 - 1.0) * dy :
+                                     dy + (M_SQRT2 - 1.0) * dx;
+                break;
+
+            default:
+                distance = sqrt(dx * dx + dy * dy);
+                break;
+        }
+
+        p_distances[i] = p_store->scale * distance;
+    }
+}
+
+#ifdef COORDINATE_X86
+
+__attribute__((target("sse2")))
+static void distances_sse2(coordinate_store_t* p_store,
+                           const uint32_t* p_ids,
+                           size_t count,
+                           double tx,
+                           double ty,
+                           double tz,
+                           double* p_distances)
+{
+    __m128d vtx = _mm_set1_pd(tx);
+    __m128d vty = _mm_set1_pd(ty);
+    __m128d vtz = _mm_set1_pd(tz);
+    __m128d vscale = _mm_set1_pd(p_store->scale);
+    __m128d dx;
+    __m128d dy;
+    __m128d dz;
+    size_t  i;
+
+    for (i = 0; i + 2 <= count; i += 2)
+    {
+        dx = _mm_sub_pd(_mm_set_pd(p_store->p_x[p_ids[i + 1]],
+                                   p_store->p_x[p_ids[i]]), vtx);
+        dy = _mm_sub_pd(_mm_set_pd(p_store->p_y[p_ids[i + 1]],
+                                   p_store->p_y[p_ids[i]]), vty);
+        dz = _mm_sub_pd(_mm_set_pd(p_store->p_z[p_ids[i + 1]],
+                                   p_store->p_z[p_ids[i]]), vtz);
+
+        _mm_storeu_pd(
+                p_distances + i,
+                _mm_mul_pd(vscale,
+                           _mm_sqrt_pd(_mm_add_pd(
+                                   _mm_add_pd(_mm_mul_pd(dx, dx),
+                                              _mm_mul_pd(dy, dy)),
+                                   _mm_mul_pd(dz, dz)))));
+    }
+
+    distances_scalar(p_store, p_ids + i, count - i, tx, ty, tz,
+                     p_distances + i);
+}
+
+__attribute__((target("avx2")))
+static void distances_avx2(coordinate_store_t* p_store,
+                           const uint32_t* p_ids,
+                           size_t count,
+                           double tx,
+                           double ty,
+                           double tz,
+                           double* p_distances)
+{
+    __m256d vtx = _mm256_set1_pd(tx);
+    __m256d vty = _mm256_set1_pd(ty);
+    __m256d vtz = _mm256_set1_pd(tz);
+    __m256d vscale = _mm256_set1_pd(p_store->scale);
+    __m128i index;
+    __m256d dx;
+    __m256d dy;
+    __m256d dz;
+    size_t  i;
+
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        /* The ids are below INT32_MAX, so they gather as signed indices. */
+        index = _mm_loadu_si128((const __m128i*) (p_ids + i));
+        dx = _mm256_sub_pd(_mm256_i32gather_pd(p_store->p_x, index, 8), vtx);
+        dy = _mm256_sub_pd(_mm256_i32gather_pd(p_store->p_y, index, 8), vty);
+        dz = _mm256_sub_pd(_mm256_i32gather_pd(p_store->p_z, index, 8), vtz);
+
+        _mm256_storeu_pd(
+                p_distances + i,
+                _mm256_mul_pd(vscale,
+                              _mm256_sqrt_pd(_mm256_add_pd(
+                                      _mm256_add_pd(_mm256_mul_pd(dx, dx),
+                                                    _mm256_mul_pd(dy, dy)),
+                                      _mm256_mul_pd(dz, dz)))));
+    }
+
+    distances_scalar(p_store, p_ids + i, count - i, tx, ty, tz,
+                     p_distances + i);
+}
+
+#endif
+
+coordinate_simd_t coordinate_simd_best(void)
+{
+    if (best_simd < 0)
+    {
+        best_simd = COORDINATE_SIMD_SCALAR;
+#ifdef COORDINATE_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+        {
+            best_simd = COORDINATE_SIMD_AVX2;
+        }
+        else if (__builtin_cpu_supports("sse2"))
+        {
+            best_simd = COORDINATE_SIMD_SSE2;
+        }
+#endif
+    }
+
+    return (coordinate_simd_t) best_simd;
+}
+
+const char* coordinate_simd_name(coordinate_simd_t simd)
+{
+    switch (simd)
+    {
+        case COORDINATE_SIMD_SCALAR: return "scalar";
+        case COORDINATE_SIMD_SSE2:   return "sse2";
+        case COORDINATE_SIMD_AVX2:   return "avx2";
+    }
+
+    return "unknown";
+}
+
+double coordinate_store_t_distance(coordinate_store_t* p_store,
+                                   directed_graph_node_t* p_node_a,
+                                   directed_graph_node_t* p_node_b)
+{
+    uint32_t id_a = directed_graph_node_t_id(p_node_a);
+    uint32_t id_b = directed_graph_node_t_id(p_node_b);
+    double   distance;
+
+    if (!p_store)                     return 0.0;
+    if (id_a >= p_store->capacity)    return 0.0;
+    if (id_b >= p_store->capacity)    return 0.0;
+
+    distances_metric(p_store,
+                     &id_a,
+                     1,
+                     p_store->p_x[id_b],
+                     p_store->p_y[id_b],
+                     p_store->p_z[id_b],
+                     &distance);
+    return distance;
+}
+
+void coordinate_store_t_distances(coordinate_store_t* p_store,
+                                  directed_graph_node_t** p_nodes,
+                                  size_t count,
+                                  directed_graph_node_t* p_target,
+                                  double* p_distances)
+{
+    coordinate_store_t_distances_simd(p_store,
+                                      p_nodes,
+                                      count,
+                                      p_target,
+                                      p_distances,
+                                      coordinate_simd_best());
+}
+
+void coordinate_store_t_distances_simd(coordinate_store_t* p_store,
+                                       directed_graph_node_t** p_nodes,
+                                       size_t count,
+                                       directed_graph_node_t* p_target,
+                                       double* p_distances,
+                                       coordinate_simd_t simd)
+{
+    uint32_t ids[BATCH];
+    uint32_t target_id;
+    size_t   batch;
+    size_t   i;
+    size_t   j;
+
+    if (!p_store || !p_nodes || !p_distances) return;
+
+    target_id = directed_graph_node_t_id(p_target);
+
+    if (target_id >= p_store->capacity)
+    {
+        for (i = 0; i < count; ++i) p_distances[i] = 0.0;
+        return;
+    }
+
+    if (simd > coordinate_simd_best()) simd = coordinate_simd_best();
+
+    if (p_store->metric != COORDINATE_METRIC_EUCLIDEAN_3D) 
+    {
+        simd = COORDINATE_SIMD_SCALAR;
+    }
+
+    for (i = 0; i < count; i += batch)
+    {
+        batch = count - i < BATCH ? count - i : BATCH;
+
+        /* A node without coordinates borrows the target's, at distance 0. */
+        for (j = 0; j < batch; ++j)
+        {
+            ids[j] = directed_graph_node_t_id(p_nodes[i + j]);
+
+            if (ids[j] >= p_store->capacity) ids[j] = target_id;
+        }
+
+        switch (simd)
+        {
+#ifdef COORDINATE_X86
+            case COORDINATE_SIMD_AVX2:
+                distances_avx2(p_store,
+                               ids,
+                               batch,
+                               p_store->p_x[target_id],
+                               p_store->p_y[target_id],
+                               p_store->p_z[target_id],
+                               p_distances + i);
+                break;
+
+            case COORDINATE_SIMD_SSE2:
+                distances_sse2(p_store,
+                               ids,
+                               batch,
+                               p_store->p_x[target_id],
+                               p_store->p_y[target_id],
+                               p_store->p_z[target_id],
+                               p_distances + i);
+                break;
+#endif
+            default:
+                distances_metric(p_store,
+                                 ids,
+                                 batch,
+                                 p_store->p_x[target_id],
+                                 p_store->p_y[target_id],
+                                 p_store->p_z[target_id],
+                                 p_distances + i);
+                break;
+        }
+    }
+}
+
+size_t coordinate_store_t_memory_usage(coordinate_store_t* p_store)
+{
+    if (!p_store) return 0;
+
+    return memory_block_size(sizeof(*p_store)) +
+           memory_block_usage(p_store->p_x,
+                              3 * (p_store->capacity ? p_store->capacity : 1) *
+                              sizeof(double));
+}
+
+void coordinate_store_t_free(coordinate_store_t* p_store)
+{
+    if (!p_store) return;
+
+    allocator_t_free(p_store->p_allocator, p_store->p_x);
+    allocator_t_free(p_store->p_allocator, p_store);
+}
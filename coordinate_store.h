@@ -0,0 +1,175 @@
+#ifndef COORDINATE_STORE_H
+#define	COORDINATE_STORE_H
+
+#include "allocator.h"
+#include "directed_graph_node.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The coordinates of the nodes of a graph, kept as three dense arrays of   *
+    * x, y and z indexed by the node ids, so that the heuristic of a batch of  *
+    * nodes loads them without any hashing and evaluates several at a time.    *
+    ***************************************************************************/
+    typedef struct coordinate_store_t coordinate_store_t;
+
+    /***************************************************************************
+    * The distances a store measures. The Manhattan and octile distances are   *
+    * taken in the plane of x and y and bound the paths of 4- and 8-connected  *
+    * grids whose arcs cost at least their length. Points set with             *
+    * 'coordinate_store_t_set_geo' lie on the sphere of the earth, where the   *
+    * Euclidean distance is the chord, a lower bound on the great circle.      *
+    ***************************************************************************/
+    typedef enum coordinate_metric_t {
+        COORDINATE_METRIC_EUCLIDEAN_3D,
+        COORDINATE_METRIC_EUCLIDEAN_2D,
+        COORDINATE_METRIC_MANHATTAN,
+        COORDINATE_METRIC_OCTILE
+    } coordinate_metric_t;
+
+    /* The mean radius of the earth in metres. */
+#define COORDINATE_EARTH_RADIUS 6371008.8
+
+    /***************************************************************************
+    * The instruction sets the batch distances can be computed with.           *
+    ***************************************************************************/
+    typedef enum coordinate_simd_t {
+        COORDINATE_SIMD_SCALAR,
+        COORDINATE_SIMD_SSE2,
+        COORDINATE_SIMD_AVX2
+    } coordinate_simd_t;
+
+    /***************************************************************************
+    * Allocates a store for the nodes with ids below 'capacity', all at the    *
+    * origin. The arrays come from 'p_allocator', or from the C library if it  *
+    * is NULL. Returns NULL if 'capacity' exceeds INT32_MAX, which is the      *
+    * reach of the vector gathers.                                             *
+    ***************************************************************************/
+    coordinate_store_t* coordinate_store_t_alloc(size_t capacity,
+                                                 allocator_t* p_allocator);
+
+    /***************************************************************************
+    * Sets the coordinates of the node with id 'id'. Returns false if the id   *
+    * is out of the range of the store.                                        *
+    ***************************************************************************/
+    bool coordinate_store_t_set(coordinate_store_t* p_store,
+                                uint32_t id,
+                                double x,
+                                double y,
+                                double z);
+
+    /***************************************************************************
+    * Returns the number of ids the store has room for.                        *
+    ***************************************************************************/
+    size_t coordinate_store_t_capacity(coordinate_store_t* p_store);
+
+    /***************************************************************************
+    * Sets the coordinates of the node with id 'id' to the point of the        *
+    * surface of the earth at given latitude and longitude in degrees, in      *
+    * metres from the centre of the earth. The trigonometry is done here once, *
+    * so that the chord to another such point needs only a square root.        *
+    * Returns false if the id is out of the range of the store.                *
+    ***************************************************************************/
+    bool coordinate_store_t_set_geo(coordinate_store_t* p_store,
+                                    uint32_t id,
+                                    double latitude,
+                                    double longitude);
+
+    /***************************************************************************
+    * Loads the coordinates of the node with id 'id'. Returns false if the id  *
+    * is out of the range of the store.                                        *
+    ***************************************************************************/
+    bool coordinate_store_t_get(coordinate_store_t* p_store,
+                                uint32_t id,
+                                double* p_x,
+                                double* p_y,
+                                double* p_z);
+
+    /***************************************************************************
+    * Sets the distance the store measures, which is the three-dimensional     *
+    * Euclidean distance for a new store. Only that one is vectorized.         *
+    ***************************************************************************/
+    void coordinate_store_t_set_metric(coordinate_store_t* p_store,
+                                       coordinate_metric_t metric);
+
+    /***************************************************************************
+    * Returns the distance the store measures.                                 *
+    ***************************************************************************/
+    coordinate_metric_t coordinate_store_t_metric(coordinate_store_t* p_store);
+
+    /***************************************************************************
+    * Sets the factor all the distances of the store are multiplied by, which  *
+    * is 1.0 for a new store. A heuristic stays admissible as long as no arc   *
+    * costs less than 'scale' times its Euclidean length. Returns false if the *
+    * scale is negative or not a number.                                       *
+    ***************************************************************************/
+    bool coordinate_store_t_set_scale(coordinate_store_t* p_store, 
+                                      double scale);
+
+    /***************************************************************************
+    * Returns the factor the distances of the store are multiplied by.         *
+    ***************************************************************************/
+    double coordinate_store_t_scale(coordinate_store_t* p_store);
+
+    /***************************************************************************
+    * Returns the scaled distance between the two nodes, or zero if either has *
+    * no coordinates in the store, which keeps a heuristic admissible.         *
+    ***************************************************************************/
+    double coordinate_store_t_distance(coordinate_store_t* p_store,
+                                       directed_graph_node_t* p_node_a,
+                                       directed_graph_node_t* p_node_b);
+
+    /***************************************************************************
+    * Loads the scaled distances from each of the 'count' nodes of 'p_nodes'   *
+    * to 'p_target' into 'p_distances', using the widest instruction set the   *
+    * processor supports. Nodes without coordinates get a distance of zero.    *
+    ***************************************************************************/
+    void coordinate_store_t_distances(coordinate_store_t* p_store,
+                                      directed_graph_node_t** p_nodes,
+                                      size_t count,
+                                      directed_graph_node_t* p_target,
+                                      double* p_distances);
+
+    /***************************************************************************
+    * Same as 'coordinate_store_t_distances', but uses the instruction set     *
+    * 'simd', or the widest supported one if 'simd' is not supported.          *
+    ***************************************************************************/
+    void coordinate_store_t_distances_simd(coordinate_store_t* p_store,
+                                           directed_graph_node_t** p_nodes,
+                                           size_t count,
+                                           directed_graph_node_t* p_target,
+                                           double* p_distances,
+                                           coordinate_simd_t simd);
+
+    /***************************************************************************
+    * Returns the widest instruction set of the processor the batch distances  *
+    * can use. Compiling with -DNO_COORDINATE_SIMD leaves only the scalar one. *
+    ***************************************************************************/
+    coordinate_simd_t coordinate_simd_best(void);
+
+    /***************************************************************************
+    * Returns the name of the instruction set, such as "avx2".                 *
+    ***************************************************************************/
+    const char* coordinate_simd_name(coordinate_simd_t simd);
+
+    /***************************************************************************
+    * Returns the number of bytes the store takes from the allocator,          *
+    * including the allocator overhead of each block.                          *
+    ***************************************************************************/
+    size_t coordinate_store_t_memory_usage(coordinate_store_t* p_store);
+
+    /***************************************************************************
+    * Deallocates the store.                                                   *
+    ***************************************************************************/
+    void coordinate_store_t_free(coordinate_store_t* p_store);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* COORDINATE_STORE_H */
@@ -10,8 +10,21 @@
 list_t* dijkstra(directed_graph_node_t* p_source,
                  directed_graph_node_t* p_target,
                  directed_graph_weight_function_t* p_weight_function)
+{
+    return dijkstra_with_options(p_source, p_target, p_weight_function, NULL);
+}
+
+list_t* dijkstra_with_options(directed_graph_node_t* p_source,
+                              directed_graph_node_t* p_target,
+                              directed_graph_weight_function_t* 
+                                                     p_weight_function,
+                              search_options_t* p_options)
 {
     search_state_t            state;
+    search_stats_t*           p_stats;
+    heap_trace_t*             p_heap_trace;
+    search_recorder_t*        p_recorder;
+    search_budget_t*          p_budget;
     
     list_t*                   p_weight_list;
     heap_t*                   p_open_set;
@@ -22,8 +35,10 @@ list_t* dijkstra(directed_graph_node_t* p_source,
     list_t*                   p_list;
     directed_graph_node_t*    p_current;
     directed_graph_node_t*    p_child;
-    unordered_set_iterator_t* p_child_iterator;
+    directed_graph_node_t**   p_children;
+    size_t                    child_count;
     size_t                    i;
+    size_t                    settled = 0;
     
     /* Cannot pack a double into a void*, so use this simple structure. */
     weight_t*                 p_weight;
@@ -32,7 +47,14 @@ list_t* dijkstra(directed_graph_node_t* p_source,
     if (!p_target)          return NULL;
     if (!p_weight_function) return NULL;
     
-    search_state_t_alloc(&state);
+    p_stats      = p_options ? p_options->p_stats : NULL;
+    p_heap_trace = p_options ? p_options->p_heap_trace : NULL;
+    p_recorder   = p_options ? p_options->p_recorder : NULL;
+    p_budget     = p_options ? p_options->p_budget : NULL;
+    SEARCH_STATS_START(p_stats);
+    SEARCH_RECORDER_CLEAR(p_recorder);
+    search_budget_t_start(p_budget);
+    search_state_t_alloc(&state, p_options ? p_options->p_allocator : NULL);
     
     if (!search_state_t_is_ready(&state)) 
     {
@@ -40,7 +62,7 @@ list_t* dijkstra(directed_graph_node_t* p_source,
         return NULL;
     }
 
-    p_weight = malloc(sizeof(*p_weight));
+    p_weight = allocator_t_alloc(state.p_allocator, sizeof(*p_weight));
     p_weight->weight = 0.0;
 
     p_open_set    = state.p_open_set;
@@ -51,34 +73,77 @@ list_t* dijkstra(directed_graph_node_t* p_source,
     
     heap_t_add(p_open_set, p_source, p_weight);
     unordered_map_t_put(p_parent_map, p_source, NULL);
+
     unordered_map_t_put(p_cost_map, p_source, p_weight);
     list_t_push_back(p_weight_list, p_weight);
 
+    if (p_heap_trace)
+    {
+        heap_trace_t_begin(p_heap_trace);
+        heap_trace_t_add(p_heap_trace, p_source, 0.0);
+    }
+
+    SEARCH_STATS_COUNT(p_stats, heap_pushes);
+    SEARCH_STATS_PEAK(p_stats, peak_open_set, 1);
+    SEARCH_STATS_END_PHASE(p_stats, setup_time);
+
     while (heap_t_size(p_open_set) > 0)
     {
+        SEARCH_STATS_PEAK(p_stats,
+                          peak_memory,
+                          search_state_t_memory_usage(&state));
+
+        if (SEARCH_BUDGET_EXHAUSTED(p_budget,
+                                    settled,
+                                    search_state_t_memory_usage(&state)))
+        {
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
+            search_state_t_free(&state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+            return NULL;
+        }
+
         p_current = heap_t_extract_min(p_open_set);
 
+        if (p_heap_trace) heap_trace_t_extract_min(p_heap_trace, p_current);
+
+        SEARCH_STATS_COUNT(p_stats, heap_pops);
+        SEARCH_STATS_COUNT(p_stats, nodes_settled);
+        ++settled;
+        SEARCH_RECORDER_SETTLE(p_recorder,
+                               p_current,
+                               ((weight_t*) unordered_map_t_get(
+                                       p_cost_map, p_current))->weight,
+                               ((weight_t*) unordered_map_t_get(
+                                       p_cost_map, p_current))->weight,
+                               SEARCH_FORWARD);
+
         if (equals_function(p_current, p_target)) 
         {
+            SEARCH_RECORDER_MEET(p_recorder, p_target);
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
             p_list = traceback_path(p_target, p_parent_map);
+            SEARCH_STATS_END_PHASE(p_stats, traceback_time);
             search_state_t_free(&state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
             return p_list;
         }
 
         unordered_set_t_add(p_closed_set, p_current);
 
-        p_child_iterator = 
-                unordered_set_iterator_t_alloc(
-                    directed_graph_node_t_children_set(p_current));
+        p_children  = directed_graph_node_t_children(p_current);
+        child_count = directed_graph_node_t_child_count(p_current);
 
-        while (unordered_set_iterator_t_has_next(p_child_iterator)) 
+        for (i = 0; i < child_count; ++i) 
         {
-            unordered_set_iterator_t_next(p_child_iterator, &p_child);
+            p_child = p_children[i];
 
             if (unordered_set_t_contains(p_closed_set, p_child)) {
                 continue;
             }
 
+            SEARCH_STATS_COUNT(p_stats, arcs_relaxed);
+
             double tmp_cost = 
                 ((weight_t*) unordered_map_t_get(p_cost_map, 
                                                  p_current))->weight;
@@ -90,7 +155,8 @@ list_t* dijkstra(directed_graph_node_t* p_source,
 
             if (!unordered_map_t_contains_key(p_parent_map, p_child)) 
             {
-                p_weight = malloc(sizeof(*p_weight));
+                p_weight = allocator_t_alloc(state.p_allocator,
+                                             sizeof(*p_weight));
                 p_weight->weight = tmp_cost;
 
                 heap_t_add(p_open_set, p_child, p_weight);
@@ -98,12 +164,23 @@ list_t* dijkstra(directed_graph_node_t* p_source,
                 unordered_map_t_put(p_cost_map, p_child, p_weight);
                 
                 list_t_push_back(p_weight_list, p_weight);
+
+                if (p_heap_trace)
+                {
+                    heap_trace_t_add(p_heap_trace, p_child, tmp_cost);
+                }
+
+                SEARCH_STATS_COUNT(p_stats, heap_pushes);
+                SEARCH_STATS_PEAK(p_stats, 
+                                  peak_open_set, 
+                                  heap_t_size(p_open_set));
             }
             else if (tmp_cost < 
                     ((weight_t*) unordered_map_t_get(p_cost_map, 
                                                      p_child))->weight)
             {
-                p_weight = malloc(sizeof(*p_weight));
+                p_weight = allocator_t_alloc(state.p_allocator,
+                                             sizeof(*p_weight));
                 p_weight->weight = tmp_cost;
 
                 heap_t_decrease_key(p_open_set, p_child, p_weight);
@@ -111,22 +188,121 @@ list_t* dijkstra(directed_graph_node_t* p_source,
                 unordered_map_t_put(p_cost_map, p_child, p_weight);
                 
                 list_t_push_back(p_weight_list, p_weight);
+
+                if (p_heap_trace)
+                {
+                    heap_trace_t_decrease_key(p_heap_trace, p_child, tmp_cost);
+                }
+
+                SEARCH_STATS_COUNT(p_stats, decrease_keys);
             }
         }
-
-        unordered_set_iterator_t_free(p_child_iterator);
     }
 
+    SEARCH_STATS_END_PHASE(p_stats, search_time);
+
     /* Once here, return a empty path in order to denote the fact that the 
        target node is not reachable from source node. */
     search_state_t_free(&state);
-    p_list = list_t_alloc(10);
+    SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+    return list_t_alloc(10, NULL);
+}
+
+list_t* dijkstra_settle_order(directed_graph_node_t* p_source,
+                              directed_graph_weight_function_t* 
+                                                     p_weight_function,
+                              size_t max_nodes)
+{
+    search_state_t            state;
+    
+    list_t*                   p_order;
+    list_t*                   p_weight_list;
+    heap_t*                   p_open_set;
+    unordered_set_t*          p_closed_set;
+    unordered_map_t*          p_cost_map;
+    
+    directed_graph_node_t*    p_current;
+    directed_graph_node_t*    p_child;
+    directed_graph_node_t**   p_children;
+    size_t                    child_count;
+    size_t                    i;
+    weight_t*                 p_weight;
+    double                    tmp_cost;
+
+    if (!p_source)          return NULL;
+    if (!p_weight_function) return NULL;
+    
+    search_state_t_alloc(&state, NULL);
+    
+    if (!search_state_t_is_ready(&state) || 
+        !(p_order = list_t_alloc(10, NULL))) 
+    {
+        search_state_t_free(&state);
+        return NULL;
+    }
+
+    p_open_set    = state.p_open_set;
+    p_closed_set  = state.p_closed_set;
+    p_weight_list = state.p_weight_list;
+    p_cost_map    = state.p_cost_map;
+    
+    p_weight = allocator_t_alloc(state.p_allocator, sizeof(*p_weight));
+    p_weight->weight = 0.0;
+
+    heap_t_add(p_open_set, p_source, p_weight);
+    unordered_map_t_put(p_cost_map, p_source, p_weight);
+    list_t_push_back(p_weight_list, p_weight);
 
-    /* Deallocate the weights. */
-    for (i = 0; i < list_t_size(p_weight_list); ++i) 
+    while (heap_t_size(p_open_set) > 0 && list_t_size(p_order) < max_nodes)
     {
-        free(list_t_get(p_weight_list, i));
+        p_current = heap_t_extract_min(p_open_set);
+        
+        list_t_push_back(p_order, p_current);
+        unordered_set_t_add(p_closed_set, p_current);
+
+        p_children  = directed_graph_node_t_children(p_current);
+        child_count = directed_graph_node_t_child_count(p_current);
+
+        for (i = 0; i < child_count; ++i) 
+        {
+            p_child = p_children[i];
+
+            if (unordered_set_t_contains(p_closed_set, p_child)) 
+            {
+                continue;
+            }
+
+            tmp_cost = ((weight_t*) unordered_map_t_get(p_cost_map, 
+                                                        p_current))->weight +
+                       *directed_graph_weight_function_t_get(p_weight_function, 
+                                                             p_current, 
+                                                             p_child);
+
+            if (!unordered_map_t_contains_key(p_cost_map, p_child)) 
+            {
+                p_weight = allocator_t_alloc(state.p_allocator,
+                                             sizeof(*p_weight));
+                p_weight->weight = tmp_cost;
+
+                heap_t_add(p_open_set, p_child, p_weight);
+                unordered_map_t_put(p_cost_map, p_child, p_weight);
+                list_t_push_back(p_weight_list, p_weight);
+            }
+            else if (tmp_cost < 
+                    ((weight_t*) unordered_map_t_get(p_cost_map, 
+                                                     p_child))->weight)
+            {
+                p_weight = allocator_t_alloc(state.p_allocator,
+                                             sizeof(*p_weight));
+                p_weight->weight = tmp_cost;
+
+                heap_t_decrease_key(p_open_set, p_child, p_weight);
+                unordered_map_t_put(p_cost_map, p_child, p_weight);
+                list_t_push_back(p_weight_list, p_weight);
+            }
+        }
     }
 
-    return p_list;
+    search_state_t_free(&state);
+    return p_order;
 }
@@ -4,15 +4,39 @@
 #include "directed_graph_node.h"
 #include "weight_function.h"
 #include "list.h"
+#include "search_options.h"
 
 #ifdef	__cplusplus
 extern "C" {
 #endif
 
+/*******************************************************************************
+* Returns a shortest path from 'p_source' to 'p_target', or an empty path if   *
+* 'p_target' is not reachable from 'p_source'.                                 *
+*******************************************************************************/
 list_t* dijkstra(directed_graph_node_t* p_source,
                  directed_graph_node_t* p_target,
                  directed_graph_weight_function_t* p_weight_function);    
 
+/*******************************************************************************
+* Same as 'dijkstra', but honours the options 'p_options', which may be NULL.  *
+*******************************************************************************/
+list_t* dijkstra_with_options(directed_graph_node_t* p_source,
+                              directed_graph_node_t* p_target,
+                              directed_graph_weight_function_t* 
+                                                     p_weight_function,
+                              search_options_t* p_options);
+
+/*******************************************************************************
+* Runs Dijkstra's algorithm from 'p_source' without a target and returns the   *
+* first 'max_nodes' nodes in the order they were settled. The node at index    *
+* 'i' of the returned list has Dijkstra rank 'i' with respect to 'p_source'.   *
+*******************************************************************************/
+list_t* dijkstra_settle_order(directed_graph_node_t* p_source,
+                              directed_graph_weight_function_t* 
+                                                     p_weight_function,
+                              size_t max_nodes);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -1,19 +1,72 @@
 #include "directed_graph_node.h"
+#include "allocator.h"
+#include "memory_usage.h"
+#include "unordered_map.h"
 #include "unordered_set.h"
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
+/* The number of neighbours an adjacency holds without a separate block. */
+#define INLINE_CAPACITY 2
+
+/* The capacity of the parents of an undirected node, which are its children. */
+#define MIRRORED_CAPACITY 1
+
+/*******************************************************************************
+* The children or the parents of a node, kept in a contiguous array. Up to     *
+* INLINE_CAPACITY neighbours live in the adjacency itself; beyond that the     *
+* array is a separate block. Once the adjacency grows past INDEX_THRESHOLD     *
+* neighbours, a hash set of them is built so that lookups stay constant time.  *
+* A capacity of zero marks a slice of a block shared by many nodes, such as    *
+* the reverse arcs of a whole graph; it is copied out before it grows. The     *
+* parents of an undirected node hold nothing and have MIRRORED_CAPACITY.       *
+*******************************************************************************/
+typedef struct adjacency_t {
+    union {
+        directed_graph_node_t*  inline_nodes[INLINE_CAPACITY];
+        directed_graph_node_t** p_nodes;
+    } storage;
+    unordered_set_t* p_index;
+    uint32_t         size;
+    uint32_t         capacity;
+} adjacency_t;
+
 typedef struct directed_graph_node_t {
-    char* p_name;
-    char* p_text;
-    unordered_set_t* p_parent_node_set;
-    unordered_set_t* p_child_node_set;
+    char*          p_name;
+    adjacency_t    children;
+    adjacency_t    parents;
+    allocator_t*   p_allocator;
+    /* The textual representation, built on first request. */
+    _Atomic(char*) p_text;
+    uint32_t       id;
+    /* Set once the node is the head of an arc its parents do not record. */
+    bool           parents_unknown;
 } directed_graph_node_t;
 
-static const size_t INITIAL_CAPACITY = 16;
+static const size_t INDEX_THRESHOLD = 16;
 static const size_t MAXIMUM_NAME_STRING_LEN = 80;
 static const float  LOAD_FACTOR = 1.0f;
 
+/*******************************************************************************
+* The version of all the graphs, bumped by every change to their arcs or       *
+* weights, and the arc version, bumped only by the changes to their arcs. They *
+* are atomic so that graphs on different threads may change them.              *
+*******************************************************************************/
+static _Atomic uint64_t graph_version = 0;
+static _Atomic uint64_t arc_version   = 0;
+
+/*******************************************************************************
+* Changes both versions, for a change to the arcs of some graph.               *
+*******************************************************************************/
+static void arcs_changed(void)
+{
+    atomic_fetch_add(&arc_version, 1);
+    atomic_fetch_add(&graph_version, 1);
+}
+
 bool equals_function(void* a, void* b)
 {
     if (!a || !b) return false;
@@ -44,55 +97,239 @@ size_t hash_function(void* v)
     return ret;
 }
 
-static const size_t MAXIMUM_NAME_LENGTH = 80;
+/*******************************************************************************
+* The arcs and the text table know nodes by identity, not by name.             *
+*******************************************************************************/
+static size_t identity_hash(void* p_node)
+{
+    /* Nodes are at least 16-byte aligned, so the low bits carry nothing. */
+    return (size_t) ((uintptr_t) p_node >> 4);
+}
 
-directed_graph_node_t* directed_graph_node_t_alloc(char* name)
+static bool identity_equals(void* p_a, void* p_b)
 {
-    directed_graph_node_t* p_node = malloc(sizeof(*p_node));
-    char* p_text;
+    return p_a == p_b;
+}
 
-    if (!p_node) return NULL;
+static directed_graph_node_t** adjacency_t_nodes(adjacency_t* p_adjacency)
+{
+    return p_adjacency->capacity == INLINE_CAPACITY ?
+           p_adjacency->storage.inline_nodes :
+           p_adjacency->storage.p_nodes;
+}
 
-    p_node->p_name = name;
+/*******************************************************************************
+* Returns the adjacency holding the parents of 'p_node', which is its children *
+* if the node is undirected.                                                   *
+*******************************************************************************/
+static adjacency_t* parents_of(directed_graph_node_t* p_node)
+{
+    return p_node->parents.capacity == MIRRORED_CAPACITY ?
+           &p_node->children :
+           &p_node->parents;
+}
 
-    p_text = malloc(sizeof(char) * MAXIMUM_NAME_STRING_LEN); 
+static bool is_undirected(directed_graph_node_t* p_node)
+{
+    return p_node->parents.capacity == MIRRORED_CAPACITY;
+}
+
+static void adjacency_t_init(adjacency_t* p_adjacency)
+{
+    p_adjacency->p_index  = NULL;
+    p_adjacency->size     = 0;
+    p_adjacency->capacity = INLINE_CAPACITY;
+}
+
+static bool adjacency_t_contains(adjacency_t* p_adjacency,
+                                 directed_graph_node_t* p_node)
+{
+    directed_graph_node_t** p_nodes;
+    size_t                  i;
 
-    if (!p_text)
-    { 
-        free(p_node);
-        return NULL;
+    if (p_adjacency->p_index)
+    {
+        return unordered_set_t_contains(p_adjacency->p_index, p_node);
     }
 
-    p_node->p_child_node_set = unordered_set_t_alloc(INITIAL_CAPACITY,
-                                                     LOAD_FACTOR,
-                                                     hash_function,
-                                                     equals_function);
-    if (!p_node->p_child_node_set)
+    p_nodes = adjacency_t_nodes(p_adjacency);
+
+    for (i = 0; i < p_adjacency->size; ++i)
     {
-        free(p_text);
-        free(p_node);
-        return NULL;
+        if (p_nodes[i] == p_node) return true;
     }
 
-    p_node->p_parent_node_set = unordered_set_t_alloc(INITIAL_CAPACITY,
-                                                      LOAD_FACTOR,
-                                                      hash_function,
-                                                      equals_function);
-    if (!p_node->p_parent_node_set) 
+    return false;
+}
+
+/*******************************************************************************
+* Makes room for one more neighbour, moving the inline or shared neighbours to *
+* a block of their own when they no longer fit.                                *
+*******************************************************************************/
+static bool adjacency_t_ensure_capacity(adjacency_t* p_adjacency,
+                                        allocator_t* p_allocator)
+{
+    directed_graph_node_t** p_nodes;
+    size_t                  new_capacity;
+
+    if (p_adjacency->size < p_adjacency->capacity) return true;
+
+    new_capacity = 2 * (size_t) p_adjacency->size;
+
+    if (new_capacity <= INLINE_CAPACITY) new_capacity = 2 * INLINE_CAPACITY;
+    if (new_capacity > UINT32_MAX)       return false;
+
+    if (p_adjacency->capacity <= INLINE_CAPACITY)
     {
-        unordered_set_t_free(p_node->p_child_node_set);
-        free(p_text);
-        free(p_node);
-        return NULL;
+        p_nodes = allocator_t_alloc(p_allocator,
+                                    sizeof(directed_graph_node_t*) *
+                                    new_capacity);
+
+        if (!p_nodes) return false;
+
+        memcpy(p_nodes,
+               adjacency_t_nodes(p_adjacency),
+               sizeof(directed_graph_node_t*) * p_adjacency->size);
     }
+    else
+    {
+        p_nodes = allocator_t_realloc(p_allocator,
+                                      p_adjacency->storage.p_nodes,
+                                      sizeof(directed_graph_node_t*) *
+                                      new_capacity);
 
-    snprintf(p_text, 
-             MAXIMUM_NAME_STRING_LEN, 
-             "[directed_graph_node_t: id = %s]",
-             name);
+        if (!p_nodes) return false;
+    }
 
-    p_node->p_name = name;
-    p_node->p_text = p_text;
+    p_adjacency->storage.p_nodes = p_nodes;
+    p_adjacency->capacity        = (uint32_t) new_capacity;
+    return true;
+}
+
+/*******************************************************************************
+* Builds the hash set of the neighbours once there are too many of them to     *
+* scan. If that fails, the adjacency keeps on scanning.                        *
+*******************************************************************************/
+static void adjacency_t_ensure_index(adjacency_t* p_adjacency,
+                                     allocator_t* p_allocator)
+{
+    directed_graph_node_t** p_nodes;
+    size_t                  i;
+
+    if (p_adjacency->p_index || p_adjacency->size <= INDEX_THRESHOLD) return;
+
+    p_adjacency->p_index = unordered_set_t_alloc(2 * p_adjacency->size,
+                                                 LOAD_FACTOR,
+                                                 identity_hash,
+                                                 identity_equals,
+                                                 p_allocator);
+    if (!p_adjacency->p_index) return;
+
+    p_nodes = adjacency_t_nodes(p_adjacency);
+
+    for (i = 0; i < p_adjacency->size; ++i)
+    {
+        if (!unordered_set_t_add(p_adjacency->p_index, p_nodes[i]))
+        {
+            unordered_set_t_free(p_adjacency->p_index);
+            p_adjacency->p_index = NULL;
+            return;
+        }
+    }
+}
+
+static bool adjacency_t_add(adjacency_t* p_adjacency,
+                            directed_graph_node_t* p_node,
+                            allocator_t* p_allocator)
+{
+    if (adjacency_t_contains(p_adjacency, p_node))              return false;
+    if (!adjacency_t_ensure_capacity(p_adjacency, p_allocator)) return false;
+
+    if (p_adjacency->p_index &&
+        !unordered_set_t_add(p_adjacency->p_index, p_node))
+    {
+        return false;
+    }
+
+    adjacency_t_nodes(p_adjacency)[p_adjacency->size++] = p_node;
+    adjacency_t_ensure_index(p_adjacency, p_allocator);
+    return true;
+}
+
+/*******************************************************************************
+* Removes 'p_node' by moving the last neighbour into its place.                *
+*******************************************************************************/
+static bool adjacency_t_remove(adjacency_t* p_adjacency,
+                               directed_graph_node_t* p_node)
+{
+    directed_graph_node_t** p_nodes;
+    size_t                  i;
+
+    if (p_adjacency->p_index &&
+        !unordered_set_t_remove(p_adjacency->p_index, p_node))
+    {
+        return false;
+    }
+
+    p_nodes = adjacency_t_nodes(p_adjacency);
+
+    for (i = 0; i < p_adjacency->size; ++i)
+    {
+        if (p_nodes[i] == p_node)
+        {
+            p_nodes[i] = p_nodes[--p_adjacency->size];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void adjacency_t_clear(adjacency_t* p_adjacency)
+{
+    p_adjacency->size = 0;
+    unordered_set_t_clear(p_adjacency->p_index);
+}
+
+static size_t adjacency_t_memory_usage(adjacency_t* p_adjacency)
+{
+    size_t usage = unordered_set_t_memory_usage(p_adjacency->p_index);
+
+    if (p_adjacency->capacity > INLINE_CAPACITY)
+    {
+        usage += memory_block_size(sizeof(directed_graph_node_t*) *
+                                   p_adjacency->capacity);
+    }
+
+    return usage;
+}
+
+static void adjacency_t_free(adjacency_t* p_adjacency,
+                             allocator_t* p_allocator)
+{
+    if (p_adjacency->capacity > INLINE_CAPACITY)
+    {
+        allocator_t_free(p_allocator, p_adjacency->storage.p_nodes);
+    }
+
+    unordered_set_t_free(p_adjacency->p_index);
+}
+
+directed_graph_node_t* directed_graph_node_t_alloc(char* name,
+                                                   allocator_t* p_allocator)
+{
+    directed_graph_node_t* p_node = allocator_t_alloc(p_allocator,
+                                                      sizeof(*p_node));
+
+    if (!p_node) return NULL;
+
+    p_node->p_name          = name;
+    p_node->p_allocator     = p_allocator;
+    p_node->id              = DIRECTED_GRAPH_NODE_NO_ID;
+    p_node->parents_unknown = false;
+    atomic_init(&p_node->p_text, NULL);
+    adjacency_t_init(&p_node->children);
+    adjacency_t_init(&p_node->parents);
     return p_node;
 }
 
@@ -100,29 +337,88 @@ bool
 directed_graph_node_t_add_arc(directed_graph_node_t* p_tail,
                               directed_graph_node_t* p_head)
 {
-    if (!p_tail || !p_head) return false;
+    if (!p_tail || !p_head)                         return false;
+    if (is_undirected(p_tail) || is_undirected(p_head)) return false;
+
+    if (!adjacency_t_add(&p_tail->children, p_head, p_tail->p_allocator)) 
+    {
+        return false;
+    }
+
+    if (!adjacency_t_add(&p_head->parents, p_tail, p_head->p_allocator))
+    {
+        adjacency_t_remove(&p_tail->children, p_head);
+        return false;
+    }
+
+    arcs_changed();
+    return true;
+}
+
+bool directed_graph_node_t_add_child(directed_graph_node_t* p_tail,
+                                     directed_graph_node_t* p_head)
+{
+    if (!p_tail || !p_head)                         return false;
+    if (is_undirected(p_tail) || is_undirected(p_head)) return false;
 
-    if (!unordered_set_t_add(p_tail->p_child_node_set, p_head)) 
+    if (!adjacency_t_add(&p_tail->children, p_head, p_tail->p_allocator))
     {
         return false;
     }
 
-    if (!unordered_set_t_add(p_head->p_parent_node_set, p_tail))
+    p_head->parents_unknown = true;
+    arcs_changed();
+    return true;
+}
+
+/*******************************************************************************
+* Turns 'p_node' undirected unless it already has directed arcs.               *
+*******************************************************************************/
+static bool make_undirected(directed_graph_node_t* p_node)
+{
+    if (is_undirected(p_node)) return true;
+
+    if (p_node->children.size > 0 || p_node->parents.size > 0) return false;
+
+    adjacency_t_free(&p_node->parents, p_node->p_allocator);
+    p_node->parents.p_index  = NULL;
+    p_node->parents.capacity = MIRRORED_CAPACITY;
+    return true;
+}
+
+bool directed_graph_node_t_add_edge(directed_graph_node_t* p_a,
+                                    directed_graph_node_t* p_b)
+{
+    if (!p_a || !p_b)                                   return false;
+    if (!make_undirected(p_a) || !make_undirected(p_b)) return false;
+
+    if (!adjacency_t_add(&p_a->children, p_b, p_a->p_allocator)) 
     {
-        unordered_set_t_remove(p_tail->p_child_node_set, p_head);
         return false;
     }
 
+    if (p_a != p_b && 
+        !adjacency_t_add(&p_b->children, p_a, p_b->p_allocator))
+    {
+        adjacency_t_remove(&p_a->children, p_b);
+        return false;
+    }
+
+    arcs_changed();
     return true;
 }
 
+bool directed_graph_node_t_is_undirected(directed_graph_node_t* p_node)
+{
+    return p_node ? is_undirected(p_node) : false;
+}
+
 bool directed_graph_node_t_has_child
 (directed_graph_node_t* p_node, directed_graph_node_t* p_child_candidate)
 {
     if (!p_node || !p_child_candidate) return false;
 
-    return unordered_set_t_contains(p_node->p_child_node_set, 
-                                    p_child_candidate);
+    return adjacency_t_contains(&p_node->children, p_child_candidate);
 }
 
 bool directed_graph_node_t_remove_arc(directed_graph_node_t* p_tail,
@@ -130,74 +426,238 @@ bool directed_graph_node_t_remove_arc(directed_graph_node_t* p_tail,
 {
     if (!p_tail || !p_head) return false;
 
-    unordered_set_t_remove(p_tail->p_child_node_set, p_head);
-    unordered_set_t_remove(p_head->p_parent_node_set, p_tail);
+    adjacency_t_remove(&p_tail->children, p_head);
+    adjacency_t_remove(parents_of(p_head), p_tail);
+    arcs_changed();
     return true;
 }
 
 char* directed_graph_node_t_to_string(directed_graph_node_t* p_node)
 {
+    char* p_text;
+    char* p_expected = NULL;
+
     if (!p_node) return "NULL node";
 
-    return p_node->p_text;
+    if ((p_text = atomic_load(&p_node->p_text))) return p_text;
+
+    if (!(p_text = malloc(sizeof(char) * MAXIMUM_NAME_STRING_LEN)))
+    {
+        return p_node->p_name;
+    }
+
+    snprintf(p_text, 
+             MAXIMUM_NAME_STRING_LEN, 
+             "[directed_graph_node_t: id = %s]",
+             p_node->p_name);
+
+    /* Another thread may have built the text meanwhile; keep the first. */
+    if (!atomic_compare_exchange_strong(&p_node->p_text, &p_expected, p_text))
+    {
+        free(p_text);
+        return p_expected;
+    }
+
+    return p_text;
 }
 
-unordered_set_t* 
-directed_graph_node_t_children_set(directed_graph_node_t* p_node)
+char* directed_graph_node_t_name(directed_graph_node_t* p_node)
 {
-    return p_node ? p_node->p_child_node_set : NULL;
+    return p_node ? p_node->p_name : NULL;
 }
 
-unordered_set_t* 
-directed_graph_node_t_parent_set(directed_graph_node_t* p_node)
+void directed_graph_node_t_set_id(directed_graph_node_t* p_node, uint32_t id)
 {
-    return p_node ? p_node->p_parent_node_set : NULL;
+    if (p_node) p_node->id = id;
 }
 
-void directed_graph_node_t_clear(directed_graph_node_t* p_node)
+uint32_t directed_graph_node_t_id(directed_graph_node_t* p_node)
 {
-    unordered_set_iterator_t* p_iterator;
-    directed_graph_node_t*    p_tmp_node;
+    return p_node ? p_node->id : DIRECTED_GRAPH_NODE_NO_ID;
+}
 
-    if (!p_node) return;
+size_t directed_graph_node_t_child_count(directed_graph_node_t* p_node)
+{
+    return p_node ? p_node->children.size : 0;
+}
 
-    p_iterator = unordered_set_iterator_t_alloc(p_node->p_child_node_set);
+directed_graph_node_t** 
+directed_graph_node_t_children(directed_graph_node_t* p_node)
+{
+    return p_node ? adjacency_t_nodes(&p_node->children) : NULL;
+}
+
+size_t directed_graph_node_t_parent_count(directed_graph_node_t* p_node)
+{
+    return p_node ? parents_of(p_node)->size : 0;
+}
+
+directed_graph_node_t** 
+directed_graph_node_t_parents(directed_graph_node_t* p_node)
+{
+    return p_node ? adjacency_t_nodes(parents_of(p_node)) : NULL;
+}
 
-    while (unordered_set_iterator_t_has_next(p_iterator)) 
+bool directed_graph_node_t_parents_known(directed_graph_node_t* p_node)
+{
+    return p_node ? !p_node->parents_unknown : false;
+}
+
+directed_graph_node_t** 
+directed_graph_node_t_build_parents(directed_graph_node_t** p_nodes,
+                                    size_t node_count,
+                                    allocator_t* p_allocator)
+{
+    directed_graph_node_t** p_block;
+    directed_graph_node_t** p_children;
+    adjacency_t*            p_parents;
+    size_t                  arcs = 0;
+    size_t                  offset;
+    size_t                  i;
+    size_t                  j;
+
+    if (!p_nodes) return NULL;
+
+    /* Undirected nodes keep their parents among their children. */
+    for (i = 0; i < node_count; ++i) 
     {
-        unordered_set_iterator_t_next(p_iterator, &p_tmp_node);
+        if (!is_undirected(p_nodes[i])) arcs += p_nodes[i]->children.size;
+    }
+
+    p_block = allocator_t_alloc(p_allocator,
+                                sizeof(directed_graph_node_t*) *
+                                (arcs ? arcs : 1));
 
-        if (strcmp(p_node->p_name, p_tmp_node->p_name) != 0) 
+    if (!p_block) return NULL;
+
+    for (i = 0; i < node_count; ++i)
+    {
+        if (is_undirected(p_nodes[i])) continue;
+
+        adjacency_t_free(&p_nodes[i]->parents, p_nodes[i]->p_allocator);
+        adjacency_t_init(&p_nodes[i]->parents);
+        p_nodes[i]->parents_unknown = false;
+    }
+
+    /* Count the parents of each node in its size field... */
+    for (i = 0; i < node_count; ++i)
+    {
+        if (is_undirected(p_nodes[i])) continue;
+
+        p_children = adjacency_t_nodes(&p_nodes[i]->children);
+
+        for (j = 0; j < p_nodes[i]->children.size; ++j)
         {
-            unordered_set_t_remove(p_tmp_node->p_parent_node_set, p_node);
+            p_children[j]->parents.size++;
         }
     }
 
-    p_iterator = unordered_set_iterator_t_alloc(p_node->p_parent_node_set);
+    /* ...carve the block into the slices of the nodes... */
+    for (i = 0, offset = 0; i < node_count; ++i)
+    {
+        if (is_undirected(p_nodes[i])) continue;
+
+        p_parents = &p_nodes[i]->parents;
+        p_parents->storage.p_nodes = p_block + offset;
+        offset += p_parents->size;
+        p_parents->size     = 0;
+        p_parents->capacity = 0;
+    }
 
-    while (unordered_set_iterator_t_has_next(p_iterator))
+    /* ...and fill them in. */
+    for (i = 0; i < node_count; ++i)
     {
-        unordered_set_iterator_t_next(p_iterator, &p_tmp_node);
+        if (is_undirected(p_nodes[i])) continue;
 
-        if (strcmp(p_node->p_name, p_tmp_node->p_name) != 0) 
+        p_children = adjacency_t_nodes(&p_nodes[i]->children);
+
+        for (j = 0; j < p_nodes[i]->children.size; ++j)
         {
-            unordered_set_t_remove(p_tmp_node->p_child_node_set, p_node);
+            p_parents = &p_children[j]->parents;
+            p_parents->storage.p_nodes[p_parents->size++] = p_nodes[i];
         }
     }
 
-    unordered_set_t_clear(p_node->p_parent_node_set);
-    unordered_set_t_clear(p_node->p_child_node_set);
+    return p_block;
 }
 
-void directed_graph_node_t_free(directed_graph_node_t* p_node) 
+void directed_graph_node_t_clear(directed_graph_node_t* p_node)
 {
-    unordered_set_iterator_t* p_iterator;
-    directed_graph_node_t* p_tmp_node;
+    directed_graph_node_t** p_nodes;
+    size_t                  i;
 
     if (!p_node) return;
 
+    p_nodes = adjacency_t_nodes(&p_node->children);
+
+    for (i = 0; i < p_node->children.size; ++i)
+    {
+        if (p_nodes[i] != p_node) 
+        {
+            adjacency_t_remove(parents_of(p_nodes[i]), p_node);
+        }
+    }
+
+    p_nodes = adjacency_t_nodes(parents_of(p_node));
+
+    for (i = 0; i < parents_of(p_node)->size; ++i)
+    {
+        if (p_nodes[i] != p_node) 
+        {
+            adjacency_t_remove(&p_nodes[i]->children, p_node);
+        }
+    }
+
+    adjacency_t_clear(parents_of(p_node));
+    adjacency_t_clear(&p_node->children);
+    arcs_changed();
+}
+
+size_t directed_graph_node_t_memory_usage(directed_graph_node_t* p_node)
+{
+    size_t usage;
+
+    if (!p_node) return 0;
+
+    usage = memory_block_size(sizeof(*p_node)) +
+            adjacency_t_memory_usage(&p_node->children) +
+            adjacency_t_memory_usage(&p_node->parents);
+
+    if (atomic_load(&p_node->p_text))
+    {
+        usage += memory_block_size(sizeof(char) * MAXIMUM_NAME_STRING_LEN);
+    }
+
+    return usage;
+}
+
+uint64_t directed_graph_version(void)
+{
+    return atomic_load(&graph_version);
+}
+
+uint64_t directed_graph_arc_version(void)
+{
+    return atomic_load(&arc_version);
+}
+
+uint64_t directed_graph_weight_version_bump(void)
+{
+    return atomic_fetch_add(&graph_version, 1) + 1;
+}
+
+void directed_graph_version_bump(void)
+{
+    arcs_changed();
+}
+
+void directed_graph_node_t_free(directed_graph_node_t* p_node) 
+{
+    if (!p_node) return;
+
     directed_graph_node_t_clear(p_node);
-    unordered_set_t_free(p_node->p_child_node_set);
-    unordered_set_t_free(p_node->p_parent_node_set);
-    free(p_node);
+    adjacency_t_free(&p_node->children, p_node->p_allocator);
+    adjacency_t_free(&p_node->parents, p_node->p_allocator);
+    free(atomic_load(&p_node->p_text));
+    allocator_t_free(p_node->p_allocator, p_node);
 }
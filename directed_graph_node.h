@@ -1,16 +1,24 @@
 #ifndef DIRECTED_GRAPH_NODE_H
 #define	DIRECTED_GRAPH_NODE_H
 
-#include "unordered_set.h"
+#include "allocator.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 
 #ifdef	__cplusplus
 extern "C" {
 #endif
 
+    /***************************************************************************
+    * A node keeps its children and its parents in contiguous arrays, the      *
+    * first two of each inside the node itself, and knows them by identity.    *
+    ***************************************************************************/
     typedef struct directed_graph_node_t directed_graph_node_t;
 
+    /* The id of a node that has not been given one. */
+#define DIRECTED_GRAPH_NODE_NO_ID UINT32_MAX
+
     /***************************************************************************
     * The function for testing node equality.                                  *
     ***************************************************************************/  
@@ -22,9 +30,12 @@ extern "C" {
     size_t hash_function(void* v);
 
     /***************************************************************************
-    * Allocates a new directed graph node with given name.                     *
+    * Allocates a new directed graph node with given name. The node and its    *
+    * arc arrays come from 'p_allocator', or from the C library if it is NULL. *
+    * The name is not copied and stays owned by the caller.                    *
     ***************************************************************************/  
-    directed_graph_node_t* directed_graph_node_t_alloc(char* name);
+    directed_graph_node_t* 
+    directed_graph_node_t_alloc(char* name, allocator_t* p_allocator);
 
     /***************************************************************************
     * Creates an arc (p_tail, p_head) and returns true if the arc is actually  *
@@ -35,6 +46,34 @@ extern "C" {
     directed_graph_node_t_add_arc(directed_graph_node_t* p_tail,
                                   directed_graph_node_t* p_head);
 
+    /***************************************************************************
+    * Creates the arc (p_tail, p_head) without recording 'p_tail' among the    *
+    * parents of 'p_head', and returns true if the arc is actually created.    *
+    * Graphs that are only searched forward may be built this way at half the  *
+    * adjacency cost; 'directed_graph_node_t_build_parents' recovers the       *
+    * parents of all the nodes at once. Until then 'p_head' reports that its   *
+    * parents are not known, and the backward searches give up on it.          *
+    ***************************************************************************/  
+    bool directed_graph_node_t_add_child(directed_graph_node_t* p_tail,
+                                         directed_graph_node_t* p_head);
+
+    /***************************************************************************
+    * Creates the undirected edge {p_a, p_b} and returns true if it is         *
+    * actually created. The edge is stored once in the children of either      *
+    * node, and an undirected node reports its children as its parents, so     *
+    * backward searches walk the same adjacency. A node takes either edges or  *
+    * arcs: this fails if either node has arcs, and the arc functions fail on  *
+    * undirected nodes. 'directed_graph_node_t_remove_arc' removes an edge     *
+    * given either way around.                                                 *
+    ***************************************************************************/  
+    bool directed_graph_node_t_add_edge(directed_graph_node_t* p_a,
+                                        directed_graph_node_t* p_b);
+
+    /***************************************************************************
+    * Returns true if 'p_node' takes undirected edges.                         *
+    ***************************************************************************/  
+    bool directed_graph_node_t_is_undirected(directed_graph_node_t* p_node);
+
     /***************************************************************************
     * Returns true if 'p_node' has a child 'p_child_candidate'.                *
     ***************************************************************************/  
@@ -48,27 +87,114 @@ extern "C" {
                                           directed_graph_node_t* p_head);
 
     /***************************************************************************
-    * Returns the textual representation of the node.                          *
+    * Returns the textual representation of the node. The text is built on     *
+    * first request and kept with the node until it is freed. It may be asked  *
+    * for from several threads at once.                                        *
     ***************************************************************************/  
     char* directed_graph_node_t_to_string(directed_graph_node_t* p_node);
 
     /***************************************************************************
-    * Returns the set containing all the child nodes of the given node.        *
+    * Returns the name the node was allocated with.                            *
     ***************************************************************************/  
-    unordered_set_t* 
-    directed_graph_node_t_children_set(directed_graph_node_t* p_node);
+    char* directed_graph_node_t_name(directed_graph_node_t* p_node);
 
     /***************************************************************************
-    * Returns the set containing all the parent nodes of the given node.       *
+    * Sets the dense id of the node, which indexes the arrays that keep data   *
+    * per node, such as a 'coordinate_store_t'. The graph chooses the ids; a   *
+    * new node has DIRECTED_GRAPH_NODE_NO_ID.                                  *
     ***************************************************************************/  
-    unordered_set_t*
-    directed_graph_node_t_parent_set(directed_graph_node_t* p_node);
+    void directed_graph_node_t_set_id(directed_graph_node_t* p_node, 
+                                      uint32_t id);
 
     /***************************************************************************
-    * Removes all the arcs involving the input node.                           *
+    * Returns the id of the node, or DIRECTED_GRAPH_NODE_NO_ID if it has none. *
+    ***************************************************************************/  
+    uint32_t directed_graph_node_t_id(directed_graph_node_t* p_node);
+
+    /***************************************************************************
+    * Returns the number of child nodes of the given node.                     *
+    ***************************************************************************/  
+    size_t directed_graph_node_t_child_count(directed_graph_node_t* p_node);
+
+    /***************************************************************************
+    * Returns the array of the child nodes of the given node. The array is     *
+    * valid until the arcs of the node change.                                 *
+    ***************************************************************************/  
+    directed_graph_node_t** 
+    directed_graph_node_t_children(directed_graph_node_t* p_node);
+
+    /***************************************************************************
+    * Returns the number of parent nodes of the given node.                    *
+    ***************************************************************************/  
+    size_t directed_graph_node_t_parent_count(directed_graph_node_t* p_node);
+
+    /***************************************************************************
+    * Returns the array of the parent nodes of the given node. The array is    *
+    * valid until the arcs of the node change.                                 *
+    ***************************************************************************/  
+    directed_graph_node_t** 
+    directed_graph_node_t_parents(directed_graph_node_t* p_node);
+
+    /***************************************************************************
+    * Returns false if 'p_node' is the head of an arc created by               *
+    * 'directed_graph_node_t_add_child' since its parents were last built, so  *
+    * that its parents miss some of its arcs.                                  *
+    ***************************************************************************/
+    bool directed_graph_node_t_parents_known(directed_graph_node_t* p_node);
+
+    /***************************************************************************
+    * Rebuilds the parents of all the nodes of 'p_nodes' from their children   *
+    * as one reverse adjacency block taken from 'p_allocator'. Every child of  *
+    * these nodes must be among them. Returns the block, which the nodes share *
+    * and which the caller frees after them, or NULL if it cannot be           *
+    * allocated.                                                               *
+    ***************************************************************************/  
+    directed_graph_node_t** 
+    directed_graph_node_t_build_parents(directed_graph_node_t** p_nodes,
+                                        size_t node_count,
+                                        allocator_t* p_allocator);
+
+    /***************************************************************************
+    * Removes all the arcs involving the input node. Arcs created by           *
+    * 'directed_graph_node_t_add_child' are only found from their tail.        *
     ***************************************************************************/  
     void directed_graph_node_t_clear(directed_graph_node_t* p_node);
 
+    /***************************************************************************
+    * Returns the number of bytes the node, its arc arrays and its text take   *
+    * from the allocator, including the allocator overhead of each block. The  *
+    * name of the node is owned by the caller and is not counted.              *
+    ***************************************************************************/
+    size_t directed_graph_node_t_memory_usage(directed_graph_node_t* p_node);
+
+    /***************************************************************************
+    * Returns the version of the graphs, which changes whenever an arc or an   *
+    * edge is added or removed, a node is cleared or freed, or a weight is put *
+    * into a weight function, in any graph. It may be read and changed from    *
+    * any thread.                                                              *
+    ***************************************************************************/
+    uint64_t directed_graph_version(void);
+
+    /***************************************************************************
+    * Returns the arc version of the graphs, which changes like the version    *
+    * above except when only weights change. Caches of paths compare it to     *
+    * the version they were filled at, and the version of each weight function *
+    * to the one each path was found at.                                       *
+    ***************************************************************************/
+    uint64_t directed_graph_arc_version(void);
+
+    /***************************************************************************
+    * Changes the version of the graphs, but not the arc version, for a change *
+    * of weights, and returns the new version.                                 *
+    ***************************************************************************/
+    uint64_t directed_graph_weight_version_bump(void);
+
+    /***************************************************************************
+    * Changes both versions of the graphs, for changes made behind the back of *
+    * the functions above.                                                     *
+    ***************************************************************************/
+    void directed_graph_version_bump(void);
+
     /***************************************************************************
     * Deallocates the node.                                                    *
     ***************************************************************************/  
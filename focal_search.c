@@ -0,0 +1,363 @@
+#include "focal_search.h"
+#include "directed_graph_node.h"
+#include "heap.h"
+#include "list.h"
+#include "utils.h"
+
+/* The number of children whose estimates are computed in one batch. */
+#define HEURISTIC_BATCH 64
+
+/*******************************************************************************
+* The structures of a focal search beyond the usual search state. The open set *
+* of the state holds all the open nodes by their f-values, 'p_focal_set' those *
+* within the bound by their estimates and 'p_pending_set' the rest by their    *
+* f-values. A node settled through one of the heaps is left in the others and  *
+* skipped once it comes up, rather than taken out with 'heap_t_remove': most   *
+* of them never come up before the search ends, so this saves the work.        *
+*******************************************************************************/
+typedef struct focal_state_t {
+    heap_t*          p_focal_set;
+    heap_t*          p_pending_set;
+    unordered_map_t* p_f_map;
+    unordered_map_t* p_estimate_map;
+} focal_state_t;
+
+static void focal_state_t_alloc(focal_state_t* p_state,
+                                allocator_t* p_allocator)
+{
+    p_state->p_focal_set    = heap_t_alloc(4,
+                                           INITIAL_CAPACITY,
+                                           LOAD_FACTOR,
+                                           hash_function,
+                                           equals_function,
+                                           priority_cmp,
+                                           p_allocator);
+    p_state->p_pending_set  = heap_t_alloc(4,
+                                           INITIAL_CAPACITY,
+                                           LOAD_FACTOR,
+                                           hash_function,
+                                           equals_function,
+                                           priority_cmp,
+                                           p_allocator);
+    p_state->p_f_map        = unordered_map_t_alloc(INITIAL_CAPACITY,
+                                                    LOAD_FACTOR,
+                                                    hash_function,
+                                                    equals_function,
+                                                    p_allocator);
+    p_state->p_estimate_map = unordered_map_t_alloc(INITIAL_CAPACITY,
+                                                    LOAD_FACTOR,
+                                                    hash_function,
+                                                    equals_function,
+                                                    p_allocator);
+}
+
+static bool focal_state_t_is_ready(focal_state_t* p_state)
+{
+    return p_state->p_focal_set
+            && p_state->p_pending_set
+            && p_state->p_f_map
+            && p_state->p_estimate_map;
+}
+
+static size_t focal_state_t_memory_usage(focal_state_t* p_state)
+{
+    return heap_t_memory_usage(p_state->p_focal_set) +
+           heap_t_memory_usage(p_state->p_pending_set) +
+           unordered_map_t_memory_usage(p_state->p_f_map) +
+           unordered_map_t_memory_usage(p_state->p_estimate_map);
+}
+
+static void focal_state_t_free(focal_state_t* p_state)
+{
+    if (p_state->p_focal_set)    heap_t_free(p_state->p_focal_set);
+    if (p_state->p_pending_set)  heap_t_free(p_state->p_pending_set);
+    if (p_state->p_f_map)        unordered_map_t_free(p_state->p_f_map);
+    if (p_state->p_estimate_map) unordered_map_t_free(p_state->p_estimate_map);
+}
+
+/*******************************************************************************
+* Adds 'p_node' to the heap with priority 'p_priority', or lowers its priority *
+* to it if the node is already there.                                          *
+*******************************************************************************/
+static void push(heap_t* p_heap, directed_graph_node_t* p_node,
+                 weight_t* p_priority)
+{
+    if (heap_t_contains_key(p_heap, p_node))
+    {
+        heap_t_decrease_key(p_heap, p_node, p_priority);
+    }
+    else
+    {
+        heap_t_add(p_heap, p_node, p_priority);
+    }
+}
+
+static double weight_of(unordered_map_t* p_map, directed_graph_node_t* p_node)
+{
+    return ((weight_t*) unordered_map_t_get(p_map, p_node))->weight;
+}
+
+list_t* focal_astar(directed_graph_node_t* p_source,
+                    directed_graph_node_t* p_target,
+                    directed_graph_weight_function_t* p_weight_function,
+                    unordered_map_t* p_location_map,
+                    double epsilon,
+                    search_options_t* p_options)
+{
+    search_state_t            state;
+    focal_state_t             focal;
+    search_stats_t*           p_stats;
+    search_recorder_t*        p_recorder;
+    search_budget_t*          p_budget;
+    heuristic_t               heuristic;
+
+    list_t*                   p_list;
+    directed_graph_node_t*    p_current;
+    directed_graph_node_t*    p_node;
+    directed_graph_node_t*    p_child;
+    directed_graph_node_t**   p_children;
+    weight_t*                 p_weight;
+    weight_t*                 p_weight_f;
+    weight_t*                 p_estimate;
+    size_t                    child_count;
+    size_t                    i;
+    size_t                    settled = 0;
+    double                    estimates[HEURISTIC_BATCH];
+    double                    inflation = 1.0 + epsilon;
+    double                    bound;
+    double                    tmp_cost;
+
+    if (!p_source)           return NULL;
+    if (!p_target)           return NULL;
+    if (!p_weight_function)  return NULL;
+    if (!(epsilon >= 0.0))   return NULL;
+
+    p_stats    = p_options ? p_options->p_stats : NULL;
+    p_recorder = p_options ? p_options->p_recorder : NULL;
+    p_budget   = p_options ? p_options->p_budget : NULL;
+
+    if (!choose_heuristic(&heuristic, p_location_map, p_options)) return NULL;
+
+    SEARCH_STATS_START(p_stats);
+    SEARCH_RECORDER_CLEAR(p_recorder);
+    search_budget_t_start(p_budget);
+    search_state_t_alloc(&state, p_options ? p_options->p_allocator : NULL);
+    focal_state_t_alloc(&focal, state.p_allocator);
+
+    if (!search_state_t_is_ready(&state) || !focal_state_t_is_ready(&focal))
+    {
+        focal_state_t_free(&focal);
+        search_state_t_free(&state);
+        return NULL;
+    }
+
+    p_weight   = allocator_t_alloc(state.p_allocator, sizeof(*p_weight));
+    p_weight_f = allocator_t_alloc(state.p_allocator, sizeof(*p_weight_f));
+    p_estimate = allocator_t_alloc(state.p_allocator, sizeof(*p_estimate));
+    p_weight->weight   = 0.0;
+    p_estimate->weight = heuristic_t_estimate(&heuristic, p_source, p_target);
+    p_weight_f->weight = p_estimate->weight;
+
+    list_t_push_back(state.p_weight_list, p_weight);
+    list_t_push_back(state.p_weight_list, p_weight_f);
+    list_t_push_back(state.p_weight_list, p_estimate);
+
+    unordered_map_t_put(state.p_cost_map, p_source, p_weight);
+    unordered_map_t_put(state.p_parent_map, p_source, NULL);
+    unordered_map_t_put(focal.p_f_map, p_source, p_weight_f);
+    unordered_map_t_put(focal.p_estimate_map, p_source, p_estimate);
+    heap_t_add(state.p_open_set, p_source, p_weight_f);
+    heap_t_add(focal.p_focal_set, p_source, p_estimate);
+
+    SEARCH_STATS_ADD(p_stats, heap_pushes, 2);
+    SEARCH_STATS_PEAK(p_stats, peak_open_set, 1);
+    SEARCH_STATS_END_PHASE(p_stats, setup_time);
+
+    for (;;)
+    {
+        SEARCH_STATS_PEAK(p_stats,
+                          peak_memory,
+                          search_state_t_memory_usage(&state) +
+                          focal_state_t_memory_usage(&focal));
+
+        if (SEARCH_BUDGET_EXHAUSTED(p_budget,
+                                    settled,
+                                    search_state_t_memory_usage(&state) +
+                                    focal_state_t_memory_usage(&focal)))
+        {
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
+            focal_state_t_free(&focal);
+            search_state_t_free(&state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+            return NULL;
+        }
+
+        /* Drop the settled nodes off the top of the open set. */
+        while (heap_t_size(state.p_open_set) > 0 &&
+               unordered_set_t_contains(state.p_closed_set,
+                                        heap_t_min(state.p_open_set)))
+        {
+            heap_t_extract_min(state.p_open_set);
+            SEARCH_STATS_COUNT(p_stats, heap_pops);
+        }
+
+        if (heap_t_size(state.p_open_set) == 0) break;
+
+        bound = inflation * weight_of(focal.p_f_map,
+                                      heap_t_min(state.p_open_set));
+
+        /* The bound never decreases, so admit the pending nodes below it. */
+        while (heap_t_size(focal.p_pending_set) > 0)
+        {
+            p_node = heap_t_min(focal.p_pending_set);
+
+            if (!unordered_set_t_contains(state.p_closed_set, p_node))
+            {
+                if (weight_of(focal.p_f_map, p_node) > bound) break;
+
+                heap_t_add(focal.p_focal_set,
+                           p_node,
+                           unordered_map_t_get(focal.p_estimate_map, p_node));
+                SEARCH_STATS_COUNT(p_stats, heap_pushes);
+            }
+
+            heap_t_extract_min(focal.p_pending_set);
+            SEARCH_STATS_COUNT(p_stats, heap_pops);
+        }
+
+        /* Take the node of the focal set the closest to the target. A node
+           that came back there with a higher f-value waits in pending. */
+        p_current = NULL;
+
+        while (heap_t_size(focal.p_focal_set) > 0)
+        {
+            p_node = heap_t_extract_min(focal.p_focal_set);
+            SEARCH_STATS_COUNT(p_stats, heap_pops);
+
+            if (unordered_set_t_contains(state.p_closed_set, p_node)) continue;
+
+            if (weight_of(focal.p_f_map, p_node) > bound)
+            {
+                push(focal.p_pending_set,
+                     p_node,
+                     unordered_map_t_get(focal.p_f_map, p_node));
+                SEARCH_STATS_COUNT(p_stats, heap_pushes);
+                continue;
+            }
+
+            p_current = p_node;
+            break;
+        }
+
+        if (!p_current) break;
+
+        SEARCH_STATS_COUNT(p_stats, nodes_settled);
+        ++settled;
+        SEARCH_RECORDER_SETTLE(p_recorder,
+                               p_current,
+                               weight_of(state.p_cost_map, p_current),
+                               weight_of(focal.p_f_map, p_current),
+                               SEARCH_FORWARD);
+
+        if (equals_function(p_current, p_target))
+        {
+            SEARCH_RECORDER_MEET(p_recorder, p_target);
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
+            p_list = traceback_path(p_target, state.p_parent_map);
+            SEARCH_STATS_END_PHASE(p_stats, traceback_time);
+            focal_state_t_free(&focal);
+            search_state_t_free(&state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+            return p_list;
+        }
+
+        unordered_set_t_add(state.p_closed_set, p_current);
+
+        p_children  = directed_graph_node_t_children(p_current);
+        child_count = directed_graph_node_t_child_count(p_current);
+
+        for (i = 0; i < child_count; ++i)
+        {
+            p_child = p_children[i];
+
+            if (i % HEURISTIC_BATCH == 0)
+            {
+                heuristic_t_estimate_batch(
+                        &heuristic,
+                        p_children + i,
+                        child_count - i < HEURISTIC_BATCH ?
+                                child_count - i : HEURISTIC_BATCH,
+                        p_target,
+                        estimates);
+            }
+
+            SEARCH_STATS_COUNT(p_stats, arcs_relaxed);
+
+            tmp_cost = weight_of(state.p_cost_map, p_current) +
+                       *directed_graph_weight_function_t_get(p_weight_function,
+                                                             p_current,
+                                                             p_child);
+
+            /* Settled nodes are not skipped: one reached more cheaply is
+               opened again, which the bound relies on. */
+            if (unordered_map_t_contains_key(state.p_cost_map, p_child) &&
+                tmp_cost >= weight_of(state.p_cost_map, p_child))
+            {
+                continue;
+            }
+
+            if (!(p_estimate = unordered_map_t_get(focal.p_estimate_map,
+                                                   p_child)))
+            {
+                p_estimate = allocator_t_alloc(state.p_allocator,
+                                               sizeof(*p_estimate));
+                p_estimate->weight = estimates[i % HEURISTIC_BATCH];
+                list_t_push_back(state.p_weight_list, p_estimate);
+                unordered_map_t_put(focal.p_estimate_map, p_child, p_estimate);
+            }
+            else
+            {
+                SEARCH_STATS_COUNT(p_stats, decrease_keys);
+            }
+
+            p_weight   = allocator_t_alloc(state.p_allocator,
+                                           sizeof(*p_weight));
+            p_weight_f = allocator_t_alloc(state.p_allocator,
+                                           sizeof(*p_weight_f));
+            p_weight->weight   = tmp_cost;
+            p_weight_f->weight = tmp_cost + p_estimate->weight;
+
+            list_t_push_back(state.p_weight_list, p_weight);
+            list_t_push_back(state.p_weight_list, p_weight_f);
+
+            unordered_map_t_put(state.p_cost_map, p_child, p_weight);
+            unordered_map_t_put(state.p_parent_map, p_child, p_current);
+            unordered_map_t_put(focal.p_f_map, p_child, p_weight_f);
+            unordered_set_t_remove(state.p_closed_set, p_child);
+
+            push(state.p_open_set, p_child, p_weight_f);
+
+            if (p_weight_f->weight <= bound)
+            {
+                heap_t_add(focal.p_focal_set, p_child, p_estimate);
+            }
+            else
+            {
+                push(focal.p_pending_set, p_child, p_weight_f);
+            }
+
+            SEARCH_STATS_ADD(p_stats, heap_pushes, 2);
+            SEARCH_STATS_PEAK(p_stats,
+                              peak_open_set,
+                              heap_t_size(state.p_open_set));
+        }
+    }
+
+    SEARCH_STATS_END_PHASE(p_stats, search_time);
+
+    /* The target is not reachable from the source. */
+    focal_state_t_free(&focal);
+    search_state_t_free(&state);
+    SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+    return list_t_alloc(10, NULL);
+}
@@ -0,0 +1,36 @@
+#ifndef FOCAL_SEARCH_H
+#define	FOCAL_SEARCH_H
+
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include "unordered_map.h"
+#include "list.h"
+#include "search_options.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * Returns a path from 'p_source' to 'p_target' costing at most             *
+    * 1 + 'epsilon' times the shortest one, or an empty path if 'p_target' is  *
+    * not reachable. Of the open nodes whose f-value is within 1 + 'epsilon'   *
+    * of the least one, the search settles the one with the smallest estimate  *
+    * to the target, so it heads for the target much like a greedy search      *
+    * while the bound holds for any admissible heuristic. A node reached more  *
+    * cheaply after it was settled is opened again. The heuristic is chosen as *
+    * in 'astar_with_options'. Returns NULL if 'epsilon' is negative or there  *
+    * is no heuristic.                                                         *
+    ***************************************************************************/
+    list_t* focal_astar(directed_graph_node_t* p_source,
+                        directed_graph_node_t* p_target,
+                        directed_graph_weight_function_t* p_weight_function,
+                        unordered_map_t* p_location_map,
+                        double epsilon,
+                        search_options_t* p_options);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* FOCAL_SEARCH_H */
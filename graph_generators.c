@@ -0,0 +1,668 @@
+#include "graph_generators.h"
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include "unordered_map.h"
+#include "utils.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+* Arc costs are the Euclidean length of the arc times a cost factor of the arc *
+* class. All factors are at least 1.0 so that the Euclidean distance remains   *
+* an admissible heuristic.                                                     *
+*******************************************************************************/
+static const double LOCAL_ROAD_FACTOR        = 1.5;
+static const double LOCAL_ROAD_FACTOR_SPREAD = 0.5;
+static const double ARTERIAL_ROAD_FACTOR     = 1.2;
+static const double MOTORWAY_FACTOR          = 1.0;
+
+static const size_t MAXIMUM_NAME_LENGTH = 24;
+
+/* Defaults used by 'create_graph_family'. */
+static const size_t DEFAULT_RANDOM_NODES       = 20000;
+static const double DEFAULT_RANDOM_SIDE        = 10000.0;
+static const double DEFAULT_RANDOM_MAXZ        = 200.0;
+static const double DEFAULT_RANDOM_MAX_DIST    = 800.0;
+static const size_t DEFAULT_RANDOM_DEGREE      = 9;
+static const double DEFAULT_CELL_SIZE          = 100.0;
+static const double DEFAULT_JITTER             = 0.3;
+static const double DEFAULT_REMOVAL            = 0.1;
+static const size_t DEFAULT_HIGHWAY_SPACING    = 10;
+
+/*******************************************************************************
+* A small splitmix64 generator. Unlike 'rand', its state is local to a single  *
+* graph construction, so the output depends on the seed only.                  *
+*******************************************************************************/
+static uint64_t next_random(uint64_t* p_state)
+{
+    uint64_t z = (*p_state += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*******************************************************************************
+* Returns a uniformly distributed value from [0, 1).                           *
+*******************************************************************************/
+static double next_double(uint64_t* p_state)
+{
+    return (next_random(p_state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*******************************************************************************
+* Allocates the graph data with 'nodes' named, unconnected nodes. The point of *
+* every node is allocated but left for the caller to initialize.               *
+*******************************************************************************/
+static graph_data_t* graph_data_alloc(const size_t nodes)
+{
+    graph_data_t* p_ret;
+    point_3d_t*   p_point;
+    char*         p_name;
+    size_t        i;
+
+    p_ret = calloc(1, sizeof(*p_ret));
+
+    if (!p_ret) return NULL;
+
+    /* Unbuilt nodes stay NULL for 'graph_data_t_free'. */
+    p_ret->node_count   = nodes;
+    p_ret->p_node_array = calloc(nodes ? nodes : 1,
+                                 sizeof(directed_graph_node_t*));
+
+    if (!p_ret->p_node_array)
+    {
+        free(p_ret);
+        return NULL;
+    }
+
+    if (!(p_ret->p_weight_function =
+            directed_graph_weight_function_t_alloc_symmetric(hash_function,
+                                                             equals_function,
+                                                             NULL)) ||
+        !(p_ret->p_point_map = unordered_map_t_alloc(nodes,
+                                                     1.0f,
+                                                     hash_function,
+                                                     equals_function,
+                                                     NULL)))
+    {
+        graph_data_t_free(p_ret);
+        return NULL;
+    }
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_name  = malloc(sizeof(char) * MAXIMUM_NAME_LENGTH);
+        p_point = malloc(sizeof(*p_point));
+
+        if (p_name)
+        {
+            snprintf(p_name, MAXIMUM_NAME_LENGTH, "%zu", i);
+            p_ret->p_node_array[i] = directed_graph_node_t_alloc(p_name, NULL);
+        }
+
+        if (p_ret->p_node_array[i] && p_point)
+        {
+            unordered_map_t_put(p_ret->p_point_map,
+                                p_ret->p_node_array[i],
+                                p_point);
+        }
+
+        /* The map does not tell when it runs out of memory. */
+        if (!p_ret->p_node_array[i] ||
+            !p_point ||
+            unordered_map_t_get(p_ret->p_point_map,
+                                p_ret->p_node_array[i]) != p_point)
+        {
+            if (!p_ret->p_node_array[i]) free(p_name);
+
+            free(p_point);
+            graph_data_t_free(p_ret);
+            return NULL;
+        }
+    }
+
+    return p_ret;
+}
+
+static point_3d_t* point_of(graph_data_t* p_data, const size_t index)
+{
+    return unordered_map_t_get(p_data->p_point_map,
+                               p_data->p_node_array[index]);
+}
+
+/*******************************************************************************
+* Connects the nodes 'a' and 'b' by an undirected edge, which costs the        *
+* distance between the two nodes times 'factor' in both directions.            *
+*******************************************************************************/
+static void connect_nodes(graph_data_t* p_data,
+                          point_3d_t**  p_points,
+                          const size_t  a,
+                          const size_t  b,
+                          const double  factor)
+{
+    directed_graph_node_t* p_a = p_data->p_node_array[a];
+    directed_graph_node_t* p_b = p_data->p_node_array[b];
+    double weight = factor * point_3d_t_distance(p_points[a], p_points[b]);
+
+    directed_graph_node_t_add_edge(p_a, p_b);
+    directed_graph_weight_function_t_put(p_data->p_weight_function,
+                                         p_a,
+                                         p_b,
+                                         weight);
+}
+
+static double local_road_factor(uint64_t* p_random)
+{
+    return LOCAL_ROAD_FACTOR + LOCAL_ROAD_FACTOR_SPREAD * next_double(p_random);
+}
+
+/*******************************************************************************
+* Places the nodes on a jittered grid of given dimensions and returns an array *
+* of their points for fast access by node index.                               *
+*******************************************************************************/
+static point_3d_t** load_grid_points(graph_data_t* p_data,
+                                     const size_t  width,
+                                     const size_t  height,
+                                     const double  cell_size,
+                                     const double  jitter,
+                                     uint64_t*     p_random)
+{
+    point_3d_t** p_points;
+    size_t       i;
+
+    p_points = malloc(sizeof(point_3d_t*) * (p_data->node_count + 1));
+
+    if (!p_points) return NULL;
+
+    for (i = 0; i < p_data->node_count; ++i)
+    {
+        p_points[i] = point_of(p_data, i);
+
+        p_points[i]->x = (double)(i % width);
+        p_points[i]->y = (double)((i / width) % height);
+        p_points[i]->z = (double)(i / (width * height));
+
+        p_points[i]->x += jitter * (2.0 * next_double(p_random) - 1.0);
+        p_points[i]->y += jitter * (2.0 * next_double(p_random) - 1.0);
+
+        p_points[i]->x *= cell_size;
+        p_points[i]->y *= cell_size;
+        p_points[i]->z *= cell_size;
+    }
+
+    return p_points;
+}
+
+graph_data_t* create_grid_graph(const size_t width,
+                                const size_t height,
+                                const size_t depth,
+                                const double cell_size,
+                                const double jitter,
+                                const double removal_probability,
+                                const unsigned int seed)
+{
+    graph_data_t* p_ret;
+    point_3d_t**  p_points;
+    uint64_t      random_state = seed;
+    size_t        x;
+    size_t        y;
+    size_t        z;
+    size_t        index;
+
+    if (width == 0 || height == 0 || depth == 0) return NULL;
+
+    if (!(p_ret = graph_data_alloc(width * height * depth))) return NULL;
+
+    if (!(p_points = load_grid_points(p_ret,
+                                      width,
+                                      height,
+                                      cell_size,
+                                      jitter,
+                                      &random_state)))
+    {
+        graph_data_t_free(p_ret);
+        return NULL;
+    }
+
+    for (z = 0; z < depth; ++z)
+    {
+        for (y = 0; y < height; ++y)
+        {
+            for (x = 0; x < width; ++x)
+            {
+                index = (z * height + y) * width + x;
+
+                if (x + 1 < width
+                        && next_double(&random_state) >= removal_probability)
+                {
+                    connect_nodes(p_ret,
+                                  p_points,
+                                  index,
+                                  index + 1,
+                                  local_road_factor(&random_state));
+                }
+
+                if (y + 1 < height
+                        && next_double(&random_state) >= removal_probability)
+                {
+                    connect_nodes(p_ret,
+                                  p_points,
+                                  index,
+                                  index + width,
+                                  local_road_factor(&random_state));
+                }
+
+                if (z + 1 < depth
+                        && next_double(&random_state) >= removal_probability)
+                {
+                    connect_nodes(p_ret,
+                                  p_points,
+                                  index,
+                                  index + width * height,
+                                  local_road_factor(&random_state));
+                }
+            }
+        }
+    }
+
+    free(p_points);
+    return p_ret;
+}
+
+static double squared_planar_distance(point_3d_t* p_a,
+                                      const double x,
+                                      const double y)
+{
+    double dx = p_a->x - x;
+    double dy = p_a->y - y;
+
+    return dx * dx + dy * dy;
+}
+
+static size_t clamp_cell(const double coordinate,
+                         const double cell_side,
+                         const size_t cells)
+{
+    double cell = floor(coordinate / cell_side);
+
+    if (cell < 0.0)                  return 0;
+    if (cell >= (double)(cells - 1)) return cells - 1;
+
+    return (size_t) cell;
+}
+
+/*******************************************************************************
+* Returns true if no point lies strictly inside the circle whose diameter is   *
+* the segment between the points 'a' and 'b'.                                  *
+*******************************************************************************/
+static bool is_gabriel_edge(point_3d_t** p_points,
+                            size_t*      p_cell_start,
+                            size_t*      p_cell_items,
+                            const size_t cells_x,
+                            const size_t cells_y,
+                            const double cell_side,
+                            const size_t a,
+                            const size_t b)
+{
+    double mx = 0.5 * (p_points[a]->x + p_points[b]->x);
+    double my = 0.5 * (p_points[a]->y + p_points[b]->y);
+    double r2 = squared_planar_distance(p_points[a], mx, my);
+    double r  = sqrt(r2);
+    size_t x_begin = clamp_cell(mx - r, cell_side, cells_x);
+    size_t x_end   = clamp_cell(mx + r, cell_side, cells_x);
+    size_t y_begin = clamp_cell(my - r, cell_side, cells_y);
+    size_t y_end   = clamp_cell(my + r, cell_side, cells_y);
+    size_t cx;
+    size_t cy;
+    size_t i;
+    size_t w;
+
+    for (cy = y_begin; cy <= y_end; ++cy)
+    {
+        for (cx = x_begin; cx <= x_end; ++cx)
+        {
+            for (i = p_cell_start[cy * cells_x + cx];
+                 i < p_cell_start[cy * cells_x + cx + 1];
+                 ++i)
+            {
+                w = p_cell_items[i];
+
+                if (w != a && w != b
+                        && squared_planar_distance(p_points[w], mx, my) < r2)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+graph_data_t* create_planar_graph(const size_t nodes,
+                                  const double maxx,
+                                  const double maxy,
+                                  const double maxz,
+                                  const unsigned int seed)
+{
+    /* Gabriel edges are searched for within this many cells, which misses
+       the rare longer ones across empty regions. */
+    static const size_t NEIGHBOURHOOD_RADIUS = 2;
+
+    graph_data_t* p_ret;
+    point_3d_t**  p_points;
+    size_t*       p_cell_of;
+    size_t*       p_cell_start;
+    size_t*       p_cell_items;
+    uint64_t      random_state = seed;
+    double        cell_side;
+    size_t        cells_x;
+    size_t        cells_y;
+    size_t        cx;
+    size_t        cy;
+    size_t        x_begin;
+    size_t        y_begin;
+    size_t        x_end;
+    size_t        y_end;
+    size_t        cell;
+    size_t        a;
+    size_t        b;
+    size_t        i;
+
+    if (nodes == 0 || maxx <= 0.0 || maxy <= 0.0) return NULL;
+
+    if (!(p_ret = graph_data_alloc(nodes))) return NULL;
+
+    /* Aim at one point per cell on average. */
+    cell_side = sqrt(maxx * maxy / nodes);
+    cells_x   = (size_t) ceil(maxx / cell_side);
+    cells_y   = (size_t) ceil(maxy / cell_side);
+
+    p_points     = malloc(sizeof(point_3d_t*) * nodes);
+    p_cell_of    = malloc(sizeof(size_t) * nodes);
+    p_cell_items = malloc(sizeof(size_t) * nodes);
+    p_cell_start = calloc(cells_x * cells_y + 1, sizeof(size_t));
+
+    if (!p_points || !p_cell_of || !p_cell_items || !p_cell_start)
+    {
+        free(p_points);
+        free(p_cell_of);
+        free(p_cell_items);
+        free(p_cell_start);
+        graph_data_t_free(p_ret);
+        return NULL;
+    }
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_points[i] = point_of(p_ret, i);
+        p_points[i]->x = next_double(&random_state) * maxx;
+        p_points[i]->y = next_double(&random_state) * maxy;
+        p_points[i]->z = next_double(&random_state) * maxz;
+
+        p_cell_of[i] = clamp_cell(p_points[i]->y, cell_side, cells_y) * cells_x
+                     + clamp_cell(p_points[i]->x, cell_side, cells_x);
+        p_cell_start[p_cell_of[i] + 1]++;
+    }
+
+    /* Bucket the points by their cells. */
+    for (cell = 0; cell < cells_x * cells_y; ++cell)
+    {
+        p_cell_start[cell + 1] += p_cell_start[cell];
+    }
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_cell_items[p_cell_start[p_cell_of[i]]++] = i;
+    }
+
+    for (cell = cells_x * cells_y; cell > 0; --cell)
+    {
+        p_cell_start[cell] = p_cell_start[cell - 1];
+    }
+
+    p_cell_start[0] = 0;
+
+    for (a = 0; a < nodes; ++a)
+    {
+        cx = p_cell_of[a] % cells_x;
+        cy = p_cell_of[a] / cells_x;
+        x_begin = cx < NEIGHBOURHOOD_RADIUS ? 0 : cx - NEIGHBOURHOOD_RADIUS;
+        y_begin = cy < NEIGHBOURHOOD_RADIUS ? 0 : cy - NEIGHBOURHOOD_RADIUS;
+        x_end   = cx + NEIGHBOURHOOD_RADIUS < cells_x ?
+                  cx + NEIGHBOURHOOD_RADIUS : cells_x - 1;
+        y_end   = cy + NEIGHBOURHOOD_RADIUS < cells_y ?
+                  cy + NEIGHBOURHOOD_RADIUS : cells_y - 1;
+
+        /* The cells of a row are consecutive in 'p_cell_items'. */
+        for (cell = y_begin * cells_x;
+             cell <= y_end * cells_x;
+             cell += cells_x)
+        {
+            for (i = p_cell_start[cell + x_begin];
+                 i < p_cell_start[cell + x_end + 1];
+                 ++i)
+            {
+                b = p_cell_items[i];
+
+                /* Consider each unordered pair only once. */
+                if (b <= a) continue;
+
+                if (is_gabriel_edge(p_points,
+                                    p_cell_start,
+                                    p_cell_items,
+                                    cells_x,
+                                    cells_y,
+                                    cell_side,
+                                    a,
+                                    b))
+                {
+                    connect_nodes(p_ret,
+                                  p_points,
+                                  a,
+                                  b,
+                                  local_road_factor(&random_state));
+                }
+            }
+        }
+    }
+
+    free(p_points);
+    free(p_cell_of);
+    free(p_cell_items);
+    free(p_cell_start);
+    return p_ret;
+}
+
+graph_data_t* create_highway_graph(const size_t width,
+                                   const size_t height,
+                                   const size_t spacing,
+                                   const double cell_size,
+                                   const double jitter,
+                                   const double removal_probability,
+                                   const unsigned int seed)
+{
+    graph_data_t* p_ret;
+    point_3d_t**  p_points;
+    uint64_t      random_state = seed;
+    bool          arterial_row;
+    bool          arterial_column;
+    size_t        x;
+    size_t        y;
+    size_t        index;
+
+    if (width == 0 || height == 0 || spacing < 2) return NULL;
+
+    if (!(p_ret = graph_data_alloc(width * height))) return NULL;
+
+    if (!(p_points = load_grid_points(p_ret,
+                                      width,
+                                      height,
+                                      cell_size,
+                                      jitter,
+                                      &random_state)))
+    {
+        graph_data_t_free(p_ret);
+        return NULL;
+    }
+
+    for (y = 0; y < height; ++y)
+    {
+        arterial_row = y % spacing == 0;
+
+        for (x = 0; x < width; ++x)
+        {
+            arterial_column = x % spacing == 0;
+            index = y * width + x;
+
+            if (x + 1 < width)
+            {
+                if (arterial_row)
+                {
+                    connect_nodes(p_ret,
+                                  p_points,
+                                  index,
+                                  index + 1,
+                                  ARTERIAL_ROAD_FACTOR);
+                }
+                else if (next_double(&random_state) >= removal_probability)
+                {
+                    connect_nodes(p_ret,
+                                  p_points,
+                                  index,
+                                  index + 1,
+                                  local_road_factor(&random_state));
+                }
+            }
+
+            if (y + 1 < height)
+            {
+                if (arterial_column)
+                {
+                    connect_nodes(p_ret,
+                                  p_points,
+                                  index,
+                                  index + width,
+                                  ARTERIAL_ROAD_FACTOR);
+                }
+                else if (next_double(&random_state) >= removal_probability)
+                {
+                    connect_nodes(p_ret,
+                                  p_points,
+                                  index,
+                                  index + width,
+                                  local_road_factor(&random_state));
+                }
+            }
+
+            if (!arterial_row || !arterial_column) continue;
+
+            /* A junction of two arterials: lay the motorway overlay. */
+            if (x + spacing < width)
+            {
+                connect_nodes(p_ret,
+                              p_points,
+                              index,
+                              index + spacing,
+                              MOTORWAY_FACTOR);
+            }
+
+            if (y + spacing < height)
+            {
+                connect_nodes(p_ret,
+                              p_points,
+                              index,
+                              index + spacing * width,
+                              MOTORWAY_FACTOR);
+            }
+        }
+    }
+
+    free(p_points);
+    return p_ret;
+}
+
+bool is_graph_family(const char* p_family)
+{
+    if (!p_family) return false;
+
+    return strcmp(p_family, "random")  == 0
+        || strcmp(p_family, "grid")    == 0
+        || strcmp(p_family, "grid3d")  == 0
+        || strcmp(p_family, "planar")  == 0
+        || strcmp(p_family, "highway") == 0;
+}
+
+graph_data_t* create_graph_family(const char* p_family,
+                                  const size_t nodes,
+                                  const unsigned int seed)
+{
+    size_t side;
+    double scale;
+
+    if (!p_family || nodes == 0) return NULL;
+
+    if (strcmp(p_family, "random") == 0)
+    {
+        /* Keep the density of the original 20000 node setup. */
+        scale = sqrt((double) nodes / DEFAULT_RANDOM_NODES);
+        srand(seed);
+        return create_random_graph(nodes,
+                                   DEFAULT_RANDOM_DEGREE * nodes,
+                                   scale * DEFAULT_RANDOM_SIDE,
+                                   scale * DEFAULT_RANDOM_SIDE,
+                                   DEFAULT_RANDOM_MAXZ,
+                                   DEFAULT_RANDOM_MAX_DIST);
+    }
+
+    if (strcmp(p_family, "grid") == 0)
+    {
+        side = (size_t) ceil(sqrt((double) nodes));
+        return create_grid_graph(side,
+                                 side,
+                                 1,
+                                 DEFAULT_CELL_SIZE,
+                                 DEFAULT_JITTER,
+                                 DEFAULT_REMOVAL,
+                                 seed);
+    }
+
+    if (strcmp(p_family, "grid3d") == 0)
+    {
+        side = (size_t) ceil(cbrt((double) nodes));
+        return create_grid_graph(side,
+                                 side,
+                                 side,
+                                 DEFAULT_CELL_SIZE,
+                                 DEFAULT_JITTER,
+                                 DEFAULT_REMOVAL,
+                                 seed);
+    }
+
+    if (strcmp(p_family, "planar") == 0)
+    {
+        scale = DEFAULT_CELL_SIZE * sqrt((double) nodes);
+        return create_planar_graph(nodes,
+                                   scale,
+                                   scale,
+                                   DEFAULT_RANDOM_MAXZ,
+                                   seed);
+    }
+
+    if (strcmp(p_family, "highway") == 0)
+    {
+        side = (size_t) ceil(sqrt((double) nodes));
+        return create_highway_graph(side,
+                                    side,
+                                    DEFAULT_HIGHWAY_SPACING,
+                                    DEFAULT_CELL_SIZE,
+                                    DEFAULT_JITTER,
+                                    DEFAULT_REMOVAL,
+                                    seed);
+    }
+
+    return NULL;
+}
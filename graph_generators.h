@@ -0,0 +1,80 @@
+#ifndef GRAPH_GENERATORS_H
+#define	GRAPH_GENERATORS_H
+
+#include "utils.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * Creates a perturbed grid of 'width' x 'height' x 'depth' nodes. Setting  *
+    * 'depth' to 1 yields a planar grid. Neighbouring nodes are 'cell_size'    *
+    * apart before each coordinate is shifted by at most 'jitter' x            *
+    * 'cell_size'. Each grid edge is undirected and stored once, with one      *
+    * weight for both directions, and is omitted with probability              *
+    * 'removal_probability'. The same 'seed' always produces the same graph.   *
+    ***************************************************************************/
+    graph_data_t* create_grid_graph(const size_t width,
+                                    const size_t height,
+                                    const size_t depth,
+                                    const double cell_size,
+                                    const double jitter,
+                                    const double removal_probability,
+                                    const unsigned int seed);
+
+    /***************************************************************************
+    * Scatters 'nodes' random points over the box 'maxx' x 'maxy' x 'maxz' and *
+    * connects them by the Gabriel graph of their (x, y)-projection. This is   *
+    * a planar subgraph of the Delaunay triangulation, which resembles a road  *
+    * network far better than uniformly random arcs do. Each edge is           *
+    * undirected. The graph is an approximation: the candidates for the edges  *
+    * of a point are only sought within two cells of about one point each      *
+    * around it, so an edge to a farther point across an empty region is       *
+    * missed. Every edge that is made is a true Gabriel edge, though, so the   *
+    * graph stays planar.                                                      *
+    ***************************************************************************/
+    graph_data_t* create_planar_graph(const size_t nodes,
+                                      const double maxx,
+                                      const double maxy,
+                                      const double maxz,
+                                      const unsigned int seed);
+
+    /***************************************************************************
+    * Creates a perturbed planar grid of local roads, upgrades every           *
+    * 'spacing'th row and column to faster arterial roads and lays a motorway  *
+    * overlay on top of them: faster edges that connect neighbouring arterial  *
+    * junctions directly. Like the roads, each motorway is an undirected edge  *
+    * stored once, with one weight for both directions. Only local roads are   *
+    * subject to 'removal_probability'.                                        *
+    ***************************************************************************/
+    graph_data_t* create_highway_graph(const size_t width,
+                                       const size_t height,
+                                       const size_t spacing,
+                                       const double cell_size,
+                                       const double jitter,
+                                       const double removal_probability,
+                                       const unsigned int seed);
+
+    /***************************************************************************
+    * Creates a graph of the family 'p_family' with approximately 'nodes'      *
+    * nodes using default parameters. Known families are "random", "grid",     *
+    * "grid3d", "planar" and "highway". Returns NULL on unknown family.        *
+    ***************************************************************************/
+    graph_data_t* create_graph_family(const char* p_family,
+                                      const size_t nodes,
+                                      const unsigned int seed);
+
+    /***************************************************************************
+    * Returns true if 'p_family' names a family known to                       *
+    * 'create_graph_family'.                                                   *
+    ***************************************************************************/
+    bool is_graph_family(const char* p_family);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* GRAPH_GENERATORS_H */
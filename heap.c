@@ -1,4 +1,6 @@
 #include "heap.h"
+#include "allocator.h"
+#include "memory_usage.h"
 #include "unordered_map.h"
 #include <stdbool.h>
 
@@ -18,11 +20,15 @@ typedef struct heap_t {
     size_t           capacity;
     size_t           degree;
     size_t*          p_indices;
+    allocator_t*     p_allocator;
 } heap_t;
 
-static heap_node_t* heap_node_t_alloc(void* p_element, void* p_priority) 
+static heap_node_t* heap_node_t_alloc(heap_t* p_heap,
+                                      void* p_element,
+                                      void* p_priority) 
 {
-    heap_node_t* p_ret = malloc(sizeof(*p_ret));
+    heap_node_t* p_ret = allocator_t_alloc(p_heap->p_allocator,
+                                           sizeof(*p_ret));
 
     if (!p_ret) return NULL;
 
@@ -51,7 +57,8 @@ heap_t* heap_t_alloc(size_t degree,
                      float load_factor,
                      size_t (*p_hash_function)(void*),
                      bool (*p_equals_function)(void*, void*),
-                     int (*p_priority_compare_function)(void*, void*))
+                     int (*p_priority_compare_function)(void*, void*),
+                     allocator_t* p_allocator)
 {
     heap_t* p_ret;
     unordered_map_t* p_map;
@@ -60,40 +67,42 @@ heap_t* heap_t_alloc(size_t degree,
     if (!p_equals_function)      return NULL;
     if (!p_priority_compare_function) return NULL;
 
-    p_ret = malloc(sizeof(*p_ret));
+    p_ret = allocator_t_alloc(p_allocator, sizeof(*p_ret));
 
     if (!p_ret) return NULL;
 
     p_map = unordered_map_t_alloc(initial_capacity,
                                   load_factor,
                                   p_hash_function,
-                                  p_equals_function);
+                                  p_equals_function,
+                                  p_allocator);
 
     if (!p_map) 
     {
-        free(p_ret);
+        allocator_t_free(p_allocator, p_ret);
         return NULL;
     }
 
     degree = fix_degree(degree);
     initial_capacity = fix_initial_capacity(initial_capacity);
 
-    p_ret->p_table = malloc(sizeof(heap_node_t*) * initial_capacity);
+    p_ret->p_table = allocator_t_alloc(p_allocator,
+                                       sizeof(heap_node_t*) * initial_capacity);
 
     if (!p_ret->p_table) 
     {
         unordered_map_t_free(p_map);
-        free(p_ret);
+        allocator_t_free(p_allocator, p_ret);
         return NULL;
     }
 
-    p_ret->p_indices = malloc(sizeof(size_t) * degree);
+    p_ret->p_indices = allocator_t_alloc(p_allocator, sizeof(size_t) * degree);
 
     if (!p_ret->p_indices) 
     {
         unordered_map_t_free(p_map);
-        free(p_ret->p_table);
-        free(p_ret);
+        allocator_t_free(p_allocator, p_ret->p_table);
+        allocator_t_free(p_allocator, p_ret);
         return NULL;
     }
 
@@ -104,6 +113,7 @@ heap_t* heap_t_alloc(size_t degree,
     p_ret->p_hash_function        = p_hash_function;
     p_ret->p_equals_function      = p_equals_function;
     p_ret->p_key_compare_function = p_priority_compare_function;
+    p_ret->p_allocator            = p_allocator;
 
     return p_ret;
 }
@@ -210,19 +220,18 @@ bool heap_t_is_healthy(heap_t* p_heap)
 }
 
 /*******************************************************************************
-* Sifts down the node at the root to location that maintains the minimum heap  *
+* Sifts down the node at 'index' to location that maintains the minimum heap   *
 * property.                                                                    *  
 *******************************************************************************/
-static void sift_down_root(heap_t* p_heap) 
+static void sift_down(heap_t* p_heap, size_t index) 
 {
-    heap_node_t* p_target = p_heap->p_table[0];
+    heap_node_t* p_target = p_heap->p_table[index];
     void* p_priority = p_target->p_priority;
     void* p_min_child_priority;
     void* p_tentative_priority;
     size_t min_child_index;
     size_t i;
     size_t degree = p_heap->degree;
-    size_t index = 0;
 
     for (;;) 
     {
@@ -269,21 +278,17 @@ static bool ensure_capacity_before_add(heap_t* p_heap)
 {
     heap_node_t** p_new_table;
     size_t        new_capacity;
-    size_t        i;
+
     if (p_heap->size < p_heap->capacity) 
         return true;
 
     new_capacity = 3 * p_heap->capacity / 2;
-    p_new_table  = malloc(sizeof(heap_node_t*) * new_capacity);
+    p_new_table  = allocator_t_realloc(p_heap->p_allocator,
+                                       p_heap->p_table,
+                                       sizeof(heap_node_t*) * new_capacity);
 
     if (!p_new_table) return false;
 
-    for (i = 0; i < p_heap->size; ++i)
-    {
-        p_new_table[i] = p_heap->p_table[i];
-    }
-
-    free(p_heap->p_table);
     p_heap->p_table  = p_new_table;
     p_heap->capacity = new_capacity;
     return true;
@@ -302,7 +307,7 @@ bool heap_t_add(heap_t* p_heap, void* p_element, void* p_priority)
     if (!ensure_capacity_before_add(p_heap)) 
         return false;
 
-    p_node = heap_node_t_alloc(p_element, p_priority);
+    p_node = heap_node_t_alloc(p_heap, p_element, p_priority);
 
     if (!p_node) return false;
 
@@ -335,6 +340,34 @@ bool heap_t_decrease_key(heap_t* p_heap, void* p_element, void* p_priority)
     return false;
 }
 
+bool heap_t_remove(heap_t* p_heap, void* p_element)
+{
+    heap_node_t* p_node;
+    heap_node_t* p_last;
+
+    if (!p_heap) return false;
+
+    if (!(p_node = unordered_map_t_remove(p_heap->p_node_map, p_element)))
+    {
+        return false;
+    }
+
+    p_heap->size--;
+
+    /* Move the last node to the hole and restore the heap around it. */
+    if (p_node->index < p_heap->size)
+    {
+        p_last = p_heap->p_table[p_heap->size];
+        p_heap->p_table[p_node->index] = p_last;
+        p_last->index = p_node->index;
+        sift_up(p_heap, p_last->index);
+        sift_down(p_heap, p_last->index);
+    }
+
+    allocator_t_free(p_heap->p_allocator, p_node);
+    return true;
+}
+
 bool heap_t_contains_key(heap_t* p_heap, void* p_element)
 {
     if (!p_heap) return false;
@@ -355,8 +388,8 @@ void* heap_t_extract_min(heap_t* p_heap)
     p_heap->size--;
     p_heap->p_table[0] = p_heap->p_table[p_heap->size];
     unordered_map_t_remove(p_heap->p_node_map, p_ret);
-    sift_down_root(p_heap);
-    free(p_node);
+    sift_down(p_heap, 0);
+    allocator_t_free(p_heap->p_allocator, p_node);
     return p_ret;
 }
 
@@ -372,6 +405,17 @@ int heap_t_size(heap_t* p_heap)
     return p_heap ? p_heap->size : -1;
 }
 
+size_t heap_t_memory_usage(heap_t* p_heap)
+{
+    if (!p_heap) return 0;
+
+    return memory_block_size(sizeof(*p_heap)) +
+           memory_block_size(sizeof(heap_node_t*) * p_heap->capacity) +
+           memory_block_size(sizeof(size_t) * p_heap->degree) +
+           memory_block_size(sizeof(heap_node_t)) * p_heap->size +
+           unordered_map_t_memory_usage(p_heap->p_node_map);
+}
+
 void heap_t_clear(heap_t* p_heap)
 {
     size_t i;
@@ -382,8 +426,10 @@ void heap_t_clear(heap_t* p_heap)
 
     for (i = 0; i < p_heap->size; ++i)
     {
-        free(p_heap->p_table[i]);
+        allocator_t_free(p_heap->p_allocator, p_heap->p_table[i]);
     }
+
+    p_heap->size = 0;
 }
 
 void heap_t_free(heap_t* p_heap) 
@@ -392,6 +438,7 @@ void heap_t_free(heap_t* p_heap)
 
     heap_t_clear(p_heap);
     unordered_map_t_free(p_heap->p_node_map);
-    free(p_heap->p_indices);
-    free(p_heap->p_table);
+    allocator_t_free(p_heap->p_allocator, p_heap->p_indices);
+    allocator_t_free(p_heap->p_allocator, p_heap->p_table);
+    allocator_t_free(p_heap->p_allocator, p_heap);
 }
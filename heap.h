@@ -1,6 +1,7 @@
 #ifndef HEAP_H
 #define	HEAP_H
 
+#include "allocator.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -11,14 +12,17 @@ extern "C" {
     typedef struct heap_t heap_t;
 
     /***************************************************************************
-    * Allocates a new, empty heap with given degree.                           *
+    * Allocates a new, empty heap with given degree. The heap, its nodes and   *
+    * its node map come from 'p_allocator', or from the C library if it is     *
+    * NULL.                                                                    *
     ***************************************************************************/  
     heap_t* heap_t_alloc(size_t degree,
                          size_t initial_capacity,
                          float load_factor,
                          size_t (*p_hash_function)(void*),
                          bool (*p_equals_function)(void*, void*),
-                         int (*p_priority_compare_function)(void*, void*));
+                         int (*p_priority_compare_function)(void*, void*),
+                         allocator_t* p_allocator);
 
     /***************************************************************************
     * Adds a new element and its priority to the heap only if it is not        *
@@ -32,6 +36,13 @@ extern "C" {
     ***************************************************************************/  
     bool heap_t_decrease_key(heap_t* p_heap, void* p_element, void* p_priority);
 
+    /***************************************************************************
+    * Removes the element from the heap wherever it is. Returns true only if   *
+    * the element was in the heap. Removing an element and adding it again     *
+    * with any priority moves it either way.                                   *
+    ***************************************************************************/  
+    bool heap_t_remove(heap_t* p_heap, void* p_element);
+
     /***************************************************************************
     * Return true only if the element is in the heap.                          * 
     ***************************************************************************/  
@@ -52,6 +63,13 @@ extern "C" {
     ***************************************************************************/  
     int heap_t_size(heap_t* p_heap);
 
+    /***************************************************************************
+    * Returns the number of bytes the heap takes from the allocator, including *
+    * the allocator overhead of each block. The elements and priorities are    *
+    * not counted.                                                             *
+    ***************************************************************************/
+    size_t heap_t_memory_usage(heap_t* p_heap);
+
     /***************************************************************************
     * Drops all the contents of the heap. Only internal structures are         *
     * deallocated; the user is responsible for memory-managing the contents.   * 
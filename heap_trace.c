@@ -0,0 +1,470 @@
+#include "heap_trace.h"
+#include "unordered_map.h"
+#include "utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char          MAGIC[4] = { 'H', 'T', 'R', 'C' };
+static const unsigned char VERSION  = 1;
+
+typedef enum heap_trace_operation_t {
+    HEAP_TRACE_BEGIN,
+    HEAP_TRACE_ADD,
+    HEAP_TRACE_DECREASE_KEY,
+    HEAP_TRACE_EXTRACT_MIN
+} heap_trace_operation_t;
+
+/*******************************************************************************
+* A single recorded operation. The priority is stored as a 'weight_t' so that  *
+* the replay can hand out pointers to it.                                      *
+*******************************************************************************/
+typedef struct heap_trace_entry_t {
+    unsigned char operation;
+    size_t        element;
+    weight_t      priority;
+} heap_trace_entry_t;
+
+struct heap_trace_t {
+    heap_trace_entry_t* p_entries;
+    size_t              size;
+    size_t              capacity;
+    size_t              elements;
+    size_t              searches;
+    /* Maps the recorded elements to their numbers. Allocated lazily, since
+       a trace read from a file does not need it. */
+    unordered_map_t*    p_element_map;
+    bool                truncated;
+};
+
+size_t heap_trace_element_hash(void* p_element)
+{
+    uint64_t x = (uint64_t) (uintptr_t) p_element;
+
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return (size_t) (x ^ (x >> 31));
+}
+
+bool heap_trace_element_equals(void* p_a, void* p_b)
+{
+    return p_a == p_b;
+}
+
+heap_trace_t* heap_trace_t_alloc(void)
+{
+    heap_trace_t* p_trace = calloc(1, sizeof(*p_trace));
+
+    if (!p_trace) return NULL;
+
+    p_trace->capacity  = 1024;
+    p_trace->p_entries = malloc(sizeof(heap_trace_entry_t) *
+                                p_trace->capacity);
+
+    if (!p_trace->p_entries)
+    {
+        free(p_trace);
+        return NULL;
+    }
+
+    return p_trace;
+}
+
+/*******************************************************************************
+* Appends a new entry to the trace and returns it, or returns NULL and marks   *
+* the trace truncated if the trace cannot grow.                                *
+*******************************************************************************/
+static heap_trace_entry_t* append(heap_trace_t* p_trace,
+                                  heap_trace_operation_t operation)
+{
+    heap_trace_entry_t* p_entries;
+    heap_trace_entry_t* p_entry;
+
+    if (p_trace->truncated) return NULL;
+
+    if (p_trace->size == p_trace->capacity)
+    {
+        p_entries = realloc(p_trace->p_entries,
+                            sizeof(heap_trace_entry_t) * 2 *
+                            p_trace->capacity);
+
+        if (!p_entries)
+        {
+            p_trace->truncated = true;
+            return NULL;
+        }
+
+        p_trace->p_entries  = p_entries;
+        p_trace->capacity  *= 2;
+    }
+
+    p_entry = &p_trace->p_entries[p_trace->size++];
+    p_entry->operation       = (unsigned char) operation;
+    p_entry->element         = 0;
+    p_entry->priority.weight = 0.0;
+    return p_entry;
+}
+
+/*******************************************************************************
+* Returns the number of 'p_element', numbering it if it is seen for the first  *
+* time. Returns zero on allocation failure.                                    *
+*******************************************************************************/
+static size_t element_number(heap_trace_t* p_trace, void* p_element)
+{
+    size_t number;
+
+    if (!p_trace->p_element_map)
+    {
+        p_trace->p_element_map =
+                unordered_map_t_alloc(INITIAL_CAPACITY,
+                                      LOAD_FACTOR,
+                                      heap_trace_element_hash,
+                                      heap_trace_element_equals,
+                                      NULL);
+
+        if (!p_trace->p_element_map) return 0;
+    }
+
+    number = (size_t) unordered_map_t_get(p_trace->p_element_map, p_element);
+
+    if (number == 0)
+    {
+        number = ++p_trace->elements;
+        unordered_map_t_put(p_trace->p_element_map,
+                            p_element,
+                            (void*) number);
+    }
+
+    return number;
+}
+
+static void record(heap_trace_t* p_trace,
+                   heap_trace_operation_t operation,
+                   void* p_element,
+                   double priority)
+{
+    heap_trace_entry_t* p_entry;
+    size_t              number;
+
+    if (!p_trace) return;
+
+    if ((number = element_number(p_trace, p_element)) == 0)
+    {
+        p_trace->truncated = true;
+        return;
+    }
+
+    if ((p_entry = append(p_trace, operation)))
+    {
+        p_entry->element         = number;
+        p_entry->priority.weight = priority;
+    }
+}
+
+void heap_trace_t_begin(heap_trace_t* p_trace)
+{
+    if (!p_trace) return;
+
+    if (append(p_trace, HEAP_TRACE_BEGIN)) p_trace->searches++;
+}
+
+void heap_trace_t_add(heap_trace_t* p_trace,
+                      void* p_element,
+                      double priority)
+{
+    record(p_trace, HEAP_TRACE_ADD, p_element, priority);
+}
+
+void heap_trace_t_decrease_key(heap_trace_t* p_trace,
+                               void* p_element,
+                               double priority)
+{
+    record(p_trace, HEAP_TRACE_DECREASE_KEY, p_element, priority);
+}
+
+void heap_trace_t_extract_min(heap_trace_t* p_trace, void* p_element)
+{
+    record(p_trace, HEAP_TRACE_EXTRACT_MIN, p_element, 0.0);
+}
+
+size_t heap_trace_t_size(heap_trace_t* p_trace)
+{
+    return p_trace ? p_trace->size - p_trace->searches : 0;
+}
+
+size_t heap_trace_t_elements(heap_trace_t* p_trace)
+{
+    return p_trace ? p_trace->elements : 0;
+}
+
+size_t heap_trace_t_searches(heap_trace_t* p_trace)
+{
+    return p_trace ? p_trace->searches : 0;
+}
+
+bool heap_trace_t_is_truncated(heap_trace_t* p_trace)
+{
+    return p_trace && p_trace->truncated;
+}
+
+/*******************************************************************************
+* Writes 'value' seven bits at a time, least significant group first, setting  *
+* the high bit of every byte but the last.                                     *
+*******************************************************************************/
+static void write_varint(FILE* p_file, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        putc((int) (value & 0x7f) | 0x80, p_file);
+        value >>= 7;
+    }
+
+    putc((int) value, p_file);
+}
+
+static bool read_varint(FILE* p_file, uint64_t* p_value)
+{
+    uint64_t value = 0;
+    int      shift;
+    int      c;
+
+    for (shift = 0; shift < 64; shift += 7)
+    {
+        if ((c = getc(p_file)) == EOF) return false;
+
+        value |= (uint64_t) (c & 0x7f) << shift;
+
+        if (!(c & 0x80))
+        {
+            *p_value = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void write_double(FILE* p_file, double value)
+{
+    uint64_t bits;
+    int      i;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    for (i = 0; i < 8; ++i)
+    {
+        putc((int) ((bits >> (8 * i)) & 0xff), p_file);
+    }
+}
+
+static bool read_double(FILE* p_file, double* p_value)
+{
+    uint64_t bits = 0;
+    int      i;
+    int      c;
+
+    for (i = 0; i < 8; ++i)
+    {
+        if ((c = getc(p_file)) == EOF) return false;
+
+        bits |= (uint64_t) c << (8 * i);
+    }
+
+    memcpy(p_value, &bits, sizeof(bits));
+    return true;
+}
+
+bool heap_trace_t_write(heap_trace_t* p_trace, const char* p_file_name)
+{
+    FILE*               p_file;
+    heap_trace_entry_t* p_entry;
+    size_t              i;
+    bool                ok;
+
+    if (!p_trace || !p_file_name) return false;
+    if (!(p_file = fopen(p_file_name, "wb"))) return false;
+
+    fwrite(MAGIC, 1, sizeof(MAGIC), p_file);
+    putc(VERSION, p_file);
+    write_varint(p_file, p_trace->size);
+    write_varint(p_file, p_trace->elements);
+
+    for (i = 0; i < p_trace->size; ++i)
+    {
+        p_entry = &p_trace->p_entries[i];
+        putc(p_entry->operation, p_file);
+
+        if (p_entry->operation == HEAP_TRACE_BEGIN) continue;
+
+        write_varint(p_file, p_entry->element);
+
+        if (p_entry->operation != HEAP_TRACE_EXTRACT_MIN)
+        {
+            write_double(p_file, p_entry->priority.weight);
+        }
+    }
+
+    ok = !ferror(p_file);
+    return fclose(p_file) == 0 && ok;
+}
+
+heap_trace_t* heap_trace_t_read(const char* p_file_name)
+{
+    FILE*               p_file;
+    heap_trace_t*       p_trace;
+    heap_trace_entry_t* p_entry;
+    char                magic[sizeof(MAGIC)];
+    uint64_t            size;
+    uint64_t            elements;
+    uint64_t            element;
+    uint64_t            i;
+    int                 operation;
+    bool                ok = true;
+
+    if (!p_file_name) return NULL;
+    if (!(p_file = fopen(p_file_name, "rb"))) return NULL;
+
+    if (fread(magic, 1, sizeof(magic), p_file) != sizeof(magic)
+            || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+            || getc(p_file) != VERSION
+            || !read_varint(p_file, &size)
+            || !read_varint(p_file, &elements)
+            || !(p_trace = heap_trace_t_alloc()))
+    {
+        fclose(p_file);
+        return NULL;
+    }
+
+    p_trace->elements = (size_t) elements;
+
+    for (i = 0; i < size && ok; ++i)
+    {
+        operation = getc(p_file);
+
+        if (operation < HEAP_TRACE_BEGIN || operation > HEAP_TRACE_EXTRACT_MIN
+                || !(p_entry = append(p_trace, operation)))
+        {
+            ok = false;
+            break;
+        }
+
+        if (operation == HEAP_TRACE_BEGIN)
+        {
+            p_trace->searches++;
+            continue;
+        }
+
+        ok = read_varint(p_file, &element) && element > 0
+                                           && element <= elements;
+
+        if (ok) p_entry->element = (size_t) element;
+
+        if (ok && operation != HEAP_TRACE_EXTRACT_MIN)
+        {
+            ok = read_double(p_file, &p_entry->priority.weight);
+        }
+    }
+
+    fclose(p_file);
+
+    if (!ok)
+    {
+        heap_trace_t_free(p_trace);
+        return NULL;
+    }
+
+    return p_trace;
+}
+
+bool heap_trace_t_replay(heap_trace_t* p_trace, heap_trace_queue_t* p_queue)
+{
+    heap_trace_entry_t* p_entry;
+    heap_trace_entry_t* p_end;
+
+    if (!p_trace || !p_queue) return false;
+
+    p_end = p_trace->p_entries + p_trace->size;
+
+    for (p_entry = p_trace->p_entries; p_entry != p_end; ++p_entry)
+    {
+        switch (p_entry->operation)
+        {
+            case HEAP_TRACE_ADD:
+                p_queue->p_add(p_queue->p_queue,
+                               (void*) p_entry->element,
+                               &p_entry->priority);
+                break;
+
+            case HEAP_TRACE_DECREASE_KEY:
+                p_queue->p_decrease_key(p_queue->p_queue,
+                                        (void*) p_entry->element,
+                                        &p_entry->priority);
+                break;
+
+            case HEAP_TRACE_EXTRACT_MIN:
+                if (!p_queue->p_extract_min(p_queue->p_queue)) return false;
+
+                break;
+
+            default:
+                if (p_queue->p_clear) p_queue->p_clear(p_queue->p_queue);
+
+                break;
+        }
+    }
+
+    return true;
+}
+
+void heap_trace_t_clear(heap_trace_t* p_trace)
+{
+    if (!p_trace) return;
+
+    p_trace->size      = 0;
+    p_trace->elements  = 0;
+    p_trace->searches  = 0;
+    p_trace->truncated = false;
+
+    if (p_trace->p_element_map) unordered_map_t_clear(p_trace->p_element_map);
+}
+
+void heap_trace_t_free(heap_trace_t* p_trace)
+{
+    if (!p_trace) return;
+
+    if (p_trace->p_element_map) unordered_map_t_free(p_trace->p_element_map);
+
+    free(p_trace->p_entries);
+    free(p_trace);
+}
+
+static bool heap_add(void* p_queue, void* p_element, void* p_priority)
+{
+    return heap_t_add((heap_t*) p_queue, p_element, p_priority);
+}
+
+static bool heap_decrease_key(void* p_queue, void* p_element, void* p_priority)
+{
+    return heap_t_decrease_key((heap_t*) p_queue, p_element, p_priority);
+}
+
+static void* heap_extract_min(void* p_queue)
+{
+    return heap_t_extract_min((heap_t*) p_queue);
+}
+
+static void heap_clear(void* p_queue)
+{
+    heap_t_clear((heap_t*) p_queue);
+}
+
+void heap_trace_queue_t_init_heap(heap_trace_queue_t* p_queue, heap_t* p_heap)
+{
+    if (!p_queue) return;
+
+    p_queue->p_queue        = p_heap;
+    p_queue->p_add          = heap_add;
+    p_queue->p_decrease_key = heap_decrease_key;
+    p_queue->p_extract_min  = heap_extract_min;
+    p_queue->p_clear        = heap_clear;
+}
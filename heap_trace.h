@@ -0,0 +1,133 @@
+#ifndef HEAP_TRACE_H
+#define	HEAP_TRACE_H
+
+#include "heap.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A recorded sequence of priority queue operations. The elements are       *
+    * numbered from one in the order they are first seen, so that a trace can  *
+    * be saved and replayed without the graph it was recorded on. A trace may  *
+    * hold several searches one after another.                                 *
+    ***************************************************************************/
+    typedef struct heap_trace_t heap_trace_t;
+
+    /***************************************************************************
+    * A priority queue to replay a trace against. The elements passed to it    *
+    * are the element numbers cast to pointers, and the priorities point to    *
+    * 'weight_t' values, so that 'priority_cmp' orders them. 'p_clear' may be  *
+    * NULL if the trace holds a single search.                                 *
+    ***************************************************************************/
+    typedef struct heap_trace_queue_t {
+        void* p_queue;
+        bool  (*p_add)(void* p_queue, void* p_element, void* p_priority);
+        bool  (*p_decrease_key)(void* p_queue,
+                                void* p_element,
+                                void* p_priority);
+        void* (*p_extract_min)(void* p_queue);
+        void  (*p_clear)(void* p_queue);
+    } heap_trace_queue_t;
+
+    /***************************************************************************
+    * Allocates a new, empty trace.                                            *
+    ***************************************************************************/
+    heap_trace_t* heap_trace_t_alloc(void);
+
+    /***************************************************************************
+    * Marks the beginning of a new search. On replay, the queue is cleared     *
+    * here.                                                                    *
+    ***************************************************************************/
+    void heap_trace_t_begin(heap_trace_t* p_trace);
+
+    /***************************************************************************
+    * Records the insertion of 'p_element' with given priority.                *
+    ***************************************************************************/
+    void heap_trace_t_add(heap_trace_t* p_trace,
+                          void* p_element,
+                          double priority);
+
+    /***************************************************************************
+    * Records the improvement of the priority of 'p_element'.                  *
+    ***************************************************************************/
+    void heap_trace_t_decrease_key(heap_trace_t* p_trace,
+                                   void* p_element,
+                                   double priority);
+
+    /***************************************************************************
+    * Records the removal of 'p_element' as the minimum of the queue.          *
+    ***************************************************************************/
+    void heap_trace_t_extract_min(heap_trace_t* p_trace, void* p_element);
+
+    /***************************************************************************
+    * Returns the number of queue operations in the trace.                     *
+    ***************************************************************************/
+    size_t heap_trace_t_size(heap_trace_t* p_trace);
+
+    /***************************************************************************
+    * Returns the number of distinct elements in the trace.                    *
+    ***************************************************************************/
+    size_t heap_trace_t_elements(heap_trace_t* p_trace);
+
+    /***************************************************************************
+    * Returns the number of searches in the trace.                             *
+    ***************************************************************************/
+    size_t heap_trace_t_searches(heap_trace_t* p_trace);
+
+    /***************************************************************************
+    * Returns true if some operation could not be recorded for lack of memory. *
+    ***************************************************************************/
+    bool heap_trace_t_is_truncated(heap_trace_t* p_trace);
+
+    /***************************************************************************
+    * Saves the trace to a file. Each operation takes a tag byte followed by   *
+    * the element number as a variable-length integer and, unless it is an     *
+    * extraction, the priority as a little-endian double. Returns false on an  *
+    * I/O error.                                                               *
+    ***************************************************************************/
+    bool heap_trace_t_write(heap_trace_t* p_trace, const char* p_file_name);
+
+    /***************************************************************************
+    * Loads a trace saved by 'heap_trace_t_write'. Returns NULL if the file    *
+    * cannot be read or is not a trace.                                        *
+    ***************************************************************************/
+    heap_trace_t* heap_trace_t_read(const char* p_file_name);
+
+    /***************************************************************************
+    * Runs the operations of the trace against the queue. Returns false if the *
+    * queue runs empty while the trace still extracts from it.                 *
+    ***************************************************************************/
+    bool heap_trace_t_replay(heap_trace_t* p_trace,
+                             heap_trace_queue_t* p_queue);
+
+    /***************************************************************************
+    * Drops all the operations and element numbers of the trace.               *
+    ***************************************************************************/
+    void heap_trace_t_clear(heap_trace_t* p_trace);
+
+    /***************************************************************************
+    * Deallocates the trace.                                                   *
+    ***************************************************************************/
+    void heap_trace_t_free(heap_trace_t* p_trace);
+
+    /***************************************************************************
+    * Sets up 'p_queue' to replay into the heap 'p_heap'.                      *
+    ***************************************************************************/
+    void heap_trace_queue_t_init_heap(heap_trace_queue_t* p_queue,
+                                      heap_t* p_heap);
+
+    /***************************************************************************
+    * Hashes and compares the element numbers of a replayed trace.             *
+    ***************************************************************************/
+    size_t heap_trace_element_hash(void* p_element);
+    bool heap_trace_element_equals(void* p_a, void* p_b);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* HEAP_TRACE_H */
@@ -0,0 +1,203 @@
+#include "heuristic.h"
+#include "utils.h"
+
+/* The number of estimates each part of a combination computes at a time. */
+#define BATCH 64
+
+static double estimate_coordinates(void* p_context,
+                                   directed_graph_node_t* p_from,
+                                   directed_graph_node_t* p_to)
+{
+    return coordinate_store_t_distance(p_context, p_from, p_to);
+}
+
+static void estimate_coordinates_batch(void* p_context,
+                                       directed_graph_node_t** p_from,
+                                       size_t count,
+                                       directed_graph_node_t* p_to,
+                                       double* p_estimates)
+{
+    coordinate_store_t_distances(p_context, p_from, count, p_to, p_estimates);
+}
+
+heuristic_t heuristic_coordinates(coordinate_store_t* p_store)
+{
+    heuristic_t heuristic;
+
+    heuristic.p_estimate       = estimate_coordinates;
+    heuristic.p_estimate_batch = estimate_coordinates_batch;
+    heuristic.p_context        = p_store;
+    heuristic.p_coordinates    = p_store;
+    heuristic.symmetric        = true;
+    return heuristic;
+}
+
+static double estimate_location_map(void* p_context,
+                                    directed_graph_node_t* p_from,
+                                    directed_graph_node_t* p_to)
+{
+    point_3d_t* p_point_a = unordered_map_t_get(p_context, p_from);
+    point_3d_t* p_point_b = unordered_map_t_get(p_context, p_to);
+    return point_3d_t_distance(p_point_a, p_point_b);
+}
+
+heuristic_t heuristic_location_map(unordered_map_t* p_location_map)
+{
+    heuristic_t heuristic;
+
+    heuristic.p_estimate       = estimate_location_map;
+    heuristic.p_estimate_batch = NULL;
+    heuristic.p_context        = p_location_map;
+    heuristic.p_coordinates    = NULL;
+    heuristic.symmetric        = true;
+    return heuristic;
+}
+
+static double estimate_max(void* p_context,
+                           directed_graph_node_t* p_from,
+                           directed_graph_node_t* p_to)
+{
+    heuristic_max_t* p_max = p_context;
+    double           best  = 0.0;
+    double           estimate;
+    size_t           i;
+
+    for (i = 0; i < p_max->count; ++i)
+    {
+        estimate = heuristic_t_estimate(&p_max->p_heuristics[i], p_from, p_to);
+
+        if (estimate > best) best = estimate;
+    }
+
+    return best;
+}
+
+static void estimate_max_batch(void* p_context,
+                               directed_graph_node_t** p_from,
+                               size_t count,
+                               directed_graph_node_t* p_to,
+                               double* p_estimates)
+{
+    heuristic_max_t* p_max = p_context;
+    double           estimates[BATCH];
+    size_t           batch;
+    size_t           i;
+    size_t           j;
+    size_t           k;
+
+    for (i = 0; i < count; i += batch)
+    {
+        batch = count - i < BATCH ? count - i : BATCH;
+
+        for (k = 0; k < batch; ++k) p_estimates[i + k] = 0.0;
+
+        for (j = 0; j < p_max->count; ++j)
+        {
+            heuristic_t_estimate_batch(&p_max->p_heuristics[j],
+                                       p_from + i,
+                                       batch,
+                                       p_to,
+                                       estimates);
+
+            for (k = 0; k < batch; ++k)
+            {
+                if (estimates[k] > p_estimates[i + k])
+                {
+                    p_estimates[i + k] = estimates[k];
+                }
+            }
+        }
+    }
+}
+
+heuristic_t heuristic_max(heuristic_max_t* p_max)
+{
+    heuristic_t heuristic;
+    size_t      i;
+
+    heuristic.p_estimate       = estimate_max;
+    heuristic.p_estimate_batch = estimate_max_batch;
+    heuristic.p_context        = p_max;
+    heuristic.p_coordinates    = NULL;
+    heuristic.symmetric        = true;
+
+    for (i = 0; i < p_max->count; ++i)
+    {
+        if (!p_max->p_heuristics[i].symmetric) heuristic.symmetric = false;
+    }
+
+    return heuristic;
+}
+
+double heuristic_t_estimate(heuristic_t* p_heuristic,
+                            directed_graph_node_t* p_from,
+                            directed_graph_node_t* p_to)
+{
+    if (p_heuristic->p_coordinates)
+    {
+        return coordinate_store_t_distance(p_heuristic->p_coordinates,
+                                           p_from,
+                                           p_to);
+    }
+
+    return p_heuristic->p_estimate(p_heuristic->p_context, p_from, p_to);
+}
+
+void heuristic_t_estimate_batch(heuristic_t* p_heuristic,
+                                directed_graph_node_t** p_from,
+                                size_t count,
+                                directed_graph_node_t* p_to,
+                                double* p_estimates)
+{
+    size_t i;
+
+    if (p_heuristic->p_coordinates)
+    {
+        coordinate_store_t_distances(p_heuristic->p_coordinates,
+                                     p_from,
+                                     count,
+                                     p_to,
+                                     p_estimates);
+    }
+    else if (p_heuristic->p_estimate_batch)
+    {
+        p_heuristic->p_estimate_batch(p_heuristic->p_context,
+                                      p_from,
+                                      count,
+                                      p_to,
+                                      p_estimates);
+    }
+    else
+    {
+        for (i = 0; i < count; ++i)
+        {
+            p_estimates[i] = p_heuristic->p_estimate(p_heuristic->p_context,
+                                                     p_from[i],
+                                                     p_to);
+        }
+    }
+}
+
+void heuristic_t_estimate_batch_to(heuristic_t* p_heuristic,
+                                   directed_graph_node_t* p_from,
+                                   directed_graph_node_t** p_to,
+                                   size_t count,
+                                   double* p_estimates)
+{
+    size_t i;
+
+    if (p_heuristic->symmetric)
+    {
+        heuristic_t_estimate_batch(p_heuristic,
+                                   p_to,
+                                   count,
+                                   p_from,
+                                   p_estimates);
+        return;
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        p_estimates[i] = heuristic_t_estimate(p_heuristic, p_from, p_to[i]);
+    }
+}
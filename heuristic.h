@@ -0,0 +1,102 @@
+#ifndef HEURISTIC_H
+#define	HEURISTIC_H
+
+#include "coordinate_store.h"
+#include "directed_graph_node.h"
+#include "unordered_map.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A lower bound on the cost of the paths between two nodes, which guides   *
+    * the A* searches. The searches ask for the estimates of all the           *
+    * neighbours of a node in one batch. A heuristic over a coordinate store   *
+    * also names the store, and the searches then compute the estimates with   *
+    * the vectorized distances of the store rather than through the pointers.  *
+    ***************************************************************************/
+    typedef struct heuristic_t {
+        /* Returns a lower bound on the cost of the paths from 'p_from' to
+           'p_to'. */
+        double (*p_estimate)(void* p_context,
+                             directed_graph_node_t* p_from,
+                             directed_graph_node_t* p_to);
+        /* Loads the estimates from each of the 'count' nodes of 'p_from' to
+           'p_to'. If NULL, 'p_estimate' is called for each node. */
+        void   (*p_estimate_batch)(void* p_context,
+                                   directed_graph_node_t** p_from,
+                                   size_t count,
+                                   directed_graph_node_t* p_to,
+                                   double* p_estimates);
+        void*               p_context;
+        /* If set, the estimates are the distances of this store. */
+        coordinate_store_t* p_coordinates;
+        /* True if the estimate from a to b always equals that from b to a. */
+        bool                symmetric;
+    } heuristic_t;
+
+    /***************************************************************************
+    * The heuristics combined by 'heuristic_max'. The array is owned by the    *
+    * caller and must outlive the combination.                                 *
+    ***************************************************************************/
+    typedef struct heuristic_max_t {
+        heuristic_t* p_heuristics;
+        size_t       count;
+    } heuristic_max_t;
+
+    /***************************************************************************
+    * Returns the heuristic measuring the scaled distances of the store in its *
+    * metric: Euclidean in two or three dimensions, Manhattan, octile, or the  *
+    * chord between points on the earth set with 'coordinate_store_t_set_geo'. *
+    ***************************************************************************/
+    heuristic_t heuristic_coordinates(coordinate_store_t* p_store);
+
+    /***************************************************************************
+    * Returns the heuristic measuring the Euclidean distance between the       *
+    * points of 'p_location_map', which maps nodes to 'point_3d_t' values.     *
+    * Every estimate takes two hash table lookups.                             *
+    ***************************************************************************/
+    heuristic_t heuristic_location_map(unordered_map_t* p_location_map);
+
+    /***************************************************************************
+    * Returns the heuristic taking the largest estimate of the heuristics of   *
+    * 'p_max', which is admissible if all of them are.                         *
+    ***************************************************************************/
+    heuristic_t heuristic_max(heuristic_max_t* p_max);
+
+    /***************************************************************************
+    * Returns the estimate of the heuristic from 'p_from' to 'p_to'.           *
+    ***************************************************************************/
+    double heuristic_t_estimate(heuristic_t* p_heuristic,
+                                directed_graph_node_t* p_from,
+                                directed_graph_node_t* p_to);
+
+    /***************************************************************************
+    * Loads the estimates from each of the 'count' nodes of 'p_from' to 'p_to' *
+    * into 'p_estimates'.                                                      *
+    ***************************************************************************/
+    void heuristic_t_estimate_batch(heuristic_t* p_heuristic,
+                                    directed_graph_node_t** p_from,
+                                    size_t count,
+                                    directed_graph_node_t* p_to,
+                                    double* p_estimates);
+
+    /***************************************************************************
+    * Loads the estimates from 'p_from' to each of the 'count' nodes of 'p_to' *
+    * into 'p_estimates', as a backward search needs them. This is a batch if  *
+    * the heuristic is symmetric.                                              *
+    ***************************************************************************/
+    void heuristic_t_estimate_batch_to(heuristic_t* p_heuristic,
+                                       directed_graph_node_t* p_from,
+                                       directed_graph_node_t** p_to,
+                                       size_t count,
+                                       double* p_estimates);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* HEURISTIC_H */
@@ -0,0 +1,370 @@
+#include "landmarks.h"
+#include "memory_usage.h"
+#include "utils.h"
+#include <math.h>
+
+struct landmark_set_t {
+    directed_graph_node_t** p_landmarks;
+    /* The cost from the landmark j to the node with id i is at
+       p_from[i * count + j], so the bounds of a node are contiguous. */
+    double*                 p_from;
+    /* The cost from the node with id i to the landmark j, laid out alike. */
+    double*                 p_to;
+    size_t                  count;
+    size_t                  node_count;
+    allocator_t*            p_allocator;
+};
+
+/*******************************************************************************
+* Loads into 'p_costs' the cost of the shortest path from 'p_landmark' to each *
+* node, or from each node to 'p_landmark' if 'backward' is set, by the node    *
+* ids. Unreachable nodes get INFINITY. Returns false if out of memory, or if   *
+* 'backward' is set and the parents of a node on the way are not known.        *
+*******************************************************************************/
+static bool search_all(directed_graph_node_t* p_landmark,
+                       directed_graph_weight_function_t* p_weight_function,
+                       bool backward,
+                       size_t node_count,
+                       double* p_costs)
+{
+    search_state_t          state;
+    directed_graph_node_t*  p_current;
+    directed_graph_node_t*  p_next;
+    directed_graph_node_t** p_neighbours;
+    weight_t*               p_weight;
+    double*                 p_arc_weight;
+    double                  cost;
+    size_t                  neighbour_count;
+    size_t                  i;
+
+    for (i = 0; i < node_count; ++i) p_costs[i] = INFINITY;
+
+    search_state_t_alloc(&state, NULL);
+
+    if (!search_state_t_is_ready(&state))
+    {
+        search_state_t_free(&state);
+        return false;
+    }
+
+    if (!(p_weight = allocator_t_alloc(NULL, sizeof(*p_weight))))
+    {
+        search_state_t_free(&state);
+        return false;
+    }
+
+    p_weight->weight = 0.0;
+    list_t_push_back(state.p_weight_list, p_weight);
+    heap_t_add(state.p_open_set, p_landmark, p_weight);
+    unordered_map_t_put(state.p_cost_map, p_landmark, p_weight);
+
+    while (heap_t_size(state.p_open_set) > 0)
+    {
+        p_current = heap_t_extract_min(state.p_open_set);
+        cost = ((weight_t*) unordered_map_t_get(state.p_cost_map,
+                                                p_current))->weight;
+
+        unordered_set_t_add(state.p_closed_set, p_current);
+
+        if (directed_graph_node_t_id(p_current) < node_count)
+        {
+            p_costs[directed_graph_node_t_id(p_current)] = cost;
+        }
+
+        /* Missing parents would hide paths, so give up instead. */
+        if (backward && !directed_graph_node_t_parents_known(p_current))
+        {
+            search_state_t_free(&state);
+            return false;
+        }
+
+        p_neighbours = backward ?
+                       directed_graph_node_t_parents(p_current) :
+                       directed_graph_node_t_children(p_current);
+        neighbour_count = backward ?
+                          directed_graph_node_t_parent_count(p_current) :
+                          directed_graph_node_t_child_count(p_current);
+
+        for (i = 0; i < neighbour_count; ++i)
+        {
+            p_next = p_neighbours[i];
+
+            if (unordered_set_t_contains(state.p_closed_set, p_next))
+            {
+                continue;
+            }
+
+            p_arc_weight = backward ?
+                    directed_graph_weight_function_t_get(p_weight_function,
+                                                         p_next,
+                                                         p_current) :
+                    directed_graph_weight_function_t_get(p_weight_function,
+                                                         p_current,
+                                                         p_next);
+
+            if (!p_arc_weight) continue;
+
+            p_weight = unordered_map_t_get(state.p_cost_map, p_next);
+
+            if (p_weight && p_weight->weight <= cost + *p_arc_weight)
+            {
+                continue;
+            }
+
+            if (!(p_weight = allocator_t_alloc(NULL, sizeof(*p_weight))))
+            {
+                search_state_t_free(&state);
+                return false;
+            }
+
+            p_weight->weight = cost + *p_arc_weight;
+            list_t_push_back(state.p_weight_list, p_weight);
+
+            if (unordered_map_t_contains_key(state.p_cost_map, p_next))
+            {
+                heap_t_decrease_key(state.p_open_set, p_next, p_weight);
+            }
+            else
+            {
+                heap_t_add(state.p_open_set, p_next, p_weight);
+            }
+
+            unordered_map_t_put(state.p_cost_map, p_next, p_weight);
+        }
+    }
+
+    search_state_t_free(&state);
+    return true;
+}
+
+/*******************************************************************************
+* Stores the costs of a search, indexed by node id, as the column 'column' of  *
+* the table 'p_table' of the set.                                              *
+*******************************************************************************/
+static void store_column(landmark_set_t* p_set,
+                         double* p_table,
+                         size_t column,
+                         const double* p_costs)
+{
+    size_t i;
+
+    for (i = 0; i < p_set->node_count; ++i)
+    {
+        p_table[i * p_set->count + column] = p_costs[i];
+    }
+}
+
+landmark_set_t* landmark_set_t_alloc(
+        directed_graph_node_t** p_nodes,
+        size_t node_count,
+        directed_graph_weight_function_t* p_weight_function,
+        size_t landmark_count,
+        allocator_t* p_allocator)
+{
+    landmark_set_t* p_set;
+    double*         p_costs;
+    double*         p_nearest;
+    size_t          farthest;
+    size_t          i;
+    size_t          j;
+
+    if (!p_nodes || !p_weight_function)          return NULL;
+    if (node_count == 0 || landmark_count == 0)  return NULL;
+    if (node_count >= DIRECTED_GRAPH_NODE_NO_ID) return NULL;
+    if (landmark_count > node_count)             landmark_count = node_count;
+
+    if (!(p_set = allocator_t_calloc(p_allocator, 1, sizeof(*p_set))))
+    {
+        return NULL;
+    }
+
+    p_set->count       = landmark_count;
+    p_set->node_count  = node_count;
+    p_set->p_allocator = p_allocator;
+    p_set->p_landmarks = allocator_t_alloc(p_allocator,
+                                           sizeof(directed_graph_node_t*) *
+                                           landmark_count);
+    p_set->p_from = allocator_t_calloc(p_allocator,
+                                       node_count * landmark_count,
+                                       sizeof(double));
+    p_set->p_to   = allocator_t_calloc(p_allocator,
+                                       node_count * landmark_count,
+                                       sizeof(double));
+    p_costs   = malloc(sizeof(double) * node_count);
+    p_nearest = malloc(sizeof(double) * node_count);
+
+    if (!p_set->p_landmarks || !p_set->p_from || !p_set->p_to
+            || !p_costs || !p_nearest)
+    {
+        free(p_costs);
+        free(p_nearest);
+        landmark_set_t_free(p_set);
+        return NULL;
+    }
+
+    for (i = 0; i < node_count; ++i)
+    {
+        directed_graph_node_t_set_id(p_nodes[i], (uint32_t) i);
+        p_nearest[i] = INFINITY;
+    }
+
+    farthest = 0;
+
+    for (j = 0; j < landmark_count; ++j)
+    {
+        p_set->p_landmarks[j] = p_nodes[farthest];
+
+        if (!search_all(p_nodes[farthest],
+                        p_weight_function,
+                        false,
+                        node_count,
+                        p_costs))
+        {
+            break;
+        }
+
+        store_column(p_set, p_set->p_from, j, p_costs);
+
+        /* The next landmark is the node the farthest from all so far, which
+           is one they cannot reach if there is such a node. */
+        farthest = 0;
+
+        for (i = 0; i < node_count; ++i)
+        {
+            if (p_costs[i] < p_nearest[i]) p_nearest[i] = p_costs[i];
+            if (p_nearest[i] > p_nearest[farthest]) farthest = i;
+        }
+
+        if (!search_all(p_set->p_landmarks[j],
+                        p_weight_function,
+                        true,
+                        node_count,
+                        p_costs))
+        {
+            break;
+        }
+
+        store_column(p_set, p_set->p_to, j, p_costs);
+    }
+
+    free(p_costs);
+    free(p_nearest);
+
+    if (j < landmark_count)
+    {
+        landmark_set_t_free(p_set);
+        return NULL;
+    }
+
+    return p_set;
+}
+
+size_t landmark_set_t_size(landmark_set_t* p_set)
+{
+    return p_set ? p_set->count : 0;
+}
+
+directed_graph_node_t* landmark_set_t_get(landmark_set_t* p_set, size_t index)
+{
+    if (!p_set || index >= p_set->count) return NULL;
+
+    return p_set->p_landmarks[index];
+}
+
+/*******************************************************************************
+* Returns the best bound of the landmarks on the cost from the node with id    *
+* 'from' to the node with id 'to'. A landmark that cannot reach or be reached  *
+* from either node gives no bound.                                             *
+*******************************************************************************/
+static double bound(landmark_set_t* p_set, size_t from, size_t to)
+{
+    const double* p_from_a = p_set->p_from + from * p_set->count;
+    const double* p_from_b = p_set->p_from + to   * p_set->count;
+    const double* p_to_a   = p_set->p_to   + from * p_set->count;
+    const double* p_to_b   = p_set->p_to   + to   * p_set->count;
+    double        best     = 0.0;
+    size_t        j;
+
+    for (j = 0; j < p_set->count; ++j)
+    {
+        if (p_from_a[j] < INFINITY && p_from_b[j] - p_from_a[j] > best)
+        {
+            best = p_from_b[j] - p_from_a[j];
+        }
+
+        if (p_to_b[j] < INFINITY && p_to_a[j] - p_to_b[j] > best)
+        {
+            best = p_to_a[j] - p_to_b[j];
+        }
+    }
+
+    /* An unreachable target would make the bound infinite; leave it be. */
+    return best < INFINITY ? best : 0.0;
+}
+
+static double estimate_landmarks(void* p_context,
+                                 directed_graph_node_t* p_from,
+                                 directed_graph_node_t* p_to)
+{
+    landmark_set_t* p_set = p_context;
+    uint32_t        from  = directed_graph_node_t_id(p_from);
+    uint32_t        to    = directed_graph_node_t_id(p_to);
+
+    if (from >= p_set->node_count || to >= p_set->node_count) return 0.0;
+
+    return bound(p_set, from, to);
+}
+
+static void estimate_landmarks_batch(void* p_context,
+                                     directed_graph_node_t** p_from,
+                                     size_t count,
+                                     directed_graph_node_t* p_to,
+                                     double* p_estimates)
+{
+    landmark_set_t* p_set = p_context;
+    uint32_t        to    = directed_graph_node_t_id(p_to);
+    uint32_t        from;
+    size_t          i;
+
+    for (i = 0; i < count; ++i)
+    {
+        from = directed_graph_node_t_id(p_from[i]);
+
+        p_estimates[i] = from < p_set->node_count && to < p_set->node_count ?
+                         bound(p_set, from, to) :
+                         0.0;
+    }
+}
+
+heuristic_t heuristic_landmarks(landmark_set_t* p_set)
+{
+    heuristic_t heuristic;
+
+    heuristic.p_estimate       = estimate_landmarks;
+    heuristic.p_estimate_batch = estimate_landmarks_batch;
+    heuristic.p_context        = p_set;
+    heuristic.p_coordinates    = NULL;
+    heuristic.symmetric        = false;
+    return heuristic;
+}
+
+size_t landmark_set_t_memory_usage(landmark_set_t* p_set)
+{
+    if (!p_set) return 0;
+
+    return memory_block_size(sizeof(*p_set)) +
+           memory_block_size(sizeof(directed_graph_node_t*) * p_set->count) +
+           2 * memory_block_size(sizeof(double) *
+                                 p_set->count *
+                                 p_set->node_count);
+}
+
+void landmark_set_t_free(landmark_set_t* p_set)
+{
+    if (!p_set) return;
+
+    allocator_t_free(p_set->p_allocator, p_set->p_landmarks);
+    allocator_t_free(p_set->p_allocator, p_set->p_from);
+    allocator_t_free(p_set->p_allocator, p_set->p_to);
+    allocator_t_free(p_set->p_allocator, p_set);
+}
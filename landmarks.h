@@ -0,0 +1,73 @@
+#ifndef LANDMARKS_H
+#define	LANDMARKS_H
+
+#include "allocator.h"
+#include "directed_graph_node.h"
+#include "heuristic.h"
+#include "weight_function.h"
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A few landmark nodes with the costs of the shortest paths from each of   *
+    * them to every node and from every node to each of them. By the triangle  *
+    * inequality, the cost from a to b is at least d(L, b) - d(L, a) and at    *
+    * least d(a, L) - d(b, L) for any landmark L, which bounds the paths of    *
+    * any graph, whatever its weights have to do with its coordinates.         *
+    ***************************************************************************/
+    typedef struct landmark_set_t landmark_set_t;
+
+    /***************************************************************************
+    * Numbers the 'node_count' nodes of 'p_nodes' by their position, picks     *
+    * 'landmark_count' landmarks among them and runs two full searches from    *
+    * each. The first landmark is the first node, and each next one is the     *
+    * node farthest from the landmarks picked so far. The costs to the         *
+    * landmarks follow the parents of the nodes, so a graph built with         *
+    * 'directed_graph_node_t_add_child' needs its parents built first. The     *
+    * tables come from 'p_allocator', or from the C library if it is NULL.     *
+    * Returns NULL if there is not enough memory or the parents of a node are  *
+    * not known.                                                               *
+    ***************************************************************************/
+    landmark_set_t* landmark_set_t_alloc(
+            directed_graph_node_t** p_nodes,
+            size_t node_count,
+            directed_graph_weight_function_t* p_weight_function,
+            size_t landmark_count,
+            allocator_t* p_allocator);
+
+    /***************************************************************************
+    * Returns the number of landmarks.                                         *
+    ***************************************************************************/
+    size_t landmark_set_t_size(landmark_set_t* p_set);
+
+    /***************************************************************************
+    * Returns the 'index'th landmark, or NULL if there is no such landmark.    *
+    ***************************************************************************/
+    directed_graph_node_t* landmark_set_t_get(landmark_set_t* p_set,
+                                              size_t index);
+
+    /***************************************************************************
+    * Returns the heuristic taking the best bound of all the landmarks. Nodes  *
+    * outside of the set are estimated at zero.                                *
+    ***************************************************************************/
+    heuristic_t heuristic_landmarks(landmark_set_t* p_set);
+
+    /***************************************************************************
+    * Returns the number of bytes the set takes from the allocator, including  *
+    * the allocator overhead of each block.                                    *
+    ***************************************************************************/
+    size_t landmark_set_t_memory_usage(landmark_set_t* p_set);
+
+    /***************************************************************************
+    * Deallocates the set.                                                     *
+    ***************************************************************************/
+    void landmark_set_t_free(landmark_set_t* p_set);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* LANDMARKS_H */
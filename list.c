@@ -1,9 +1,12 @@
 #include "list.h"
+#include "allocator.h"
+#include "memory_usage.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
 typedef struct list_t {
-    void** p_table;
+    void**       p_table;
+    allocator_t* p_allocator;
     size_t size;
     size_t capacity;
     size_t head;
@@ -28,22 +31,24 @@ static size_t fix_initial_capacity(size_t initial_capacity)
     return ret;
 }
 
-list_t* list_t_alloc(size_t initial_capacity)
+list_t* list_t_alloc(size_t initial_capacity, allocator_t* p_allocator)
 {
-    list_t* p_ret = malloc(sizeof(*p_ret));
+    list_t* p_ret = allocator_t_alloc(p_allocator, sizeof(*p_ret));
 
     if (!p_ret) return NULL;
 
     initial_capacity = fix_initial_capacity(initial_capacity);
 
-    p_ret->p_table = malloc(sizeof(void*) * initial_capacity);
+    p_ret->p_table = allocator_t_alloc(p_allocator,
+                                       sizeof(void*) * initial_capacity);
 
     if (!p_ret->p_table)
     {
-        free(p_ret);
+        allocator_t_free(p_allocator, p_ret);
         return NULL;
     }
 
+    p_ret->p_allocator = p_allocator;
     p_ret->capacity = initial_capacity;
     p_ret->mask     = initial_capacity - 1;
     p_ret->head     = 0;
@@ -61,7 +66,8 @@ static bool ensure_capacity_before_add(list_t* p_list)
     if (p_list->size < p_list->capacity) return true;
 
     new_capacity = 2 * p_list->capacity;
-    p_new_table  = malloc(sizeof(void*) * new_capacity);
+    p_new_table  = allocator_t_alloc(p_list->p_allocator,
+                                     sizeof(void*) * new_capacity);
 
     if (!p_new_table) return false;
 
@@ -70,7 +76,7 @@ static bool ensure_capacity_before_add(list_t* p_list)
         p_new_table[i] = p_list->p_table[(p_list->head + i) & p_list->mask];
     }
 
-    free(p_list->p_table);
+    allocator_t_free(p_list->p_allocator, p_list->p_table);
     p_list->p_table  = p_new_table;
     p_list->capacity = new_capacity;
     p_list->mask     = new_capacity - 1;
@@ -153,6 +159,14 @@ size_t list_t_size(list_t* p_list)
     return p_list ? p_list->size : 0;
 }
 
+size_t list_t_memory_usage(list_t* p_list)
+{
+    if (!p_list) return 0;
+
+    return memory_block_size(sizeof(*p_list)) +
+           memory_block_size(sizeof(void*) * p_list->capacity);
+}
+
 void* list_t_get(list_t* p_list, size_t index)
 {
     if (!p_list)               return NULL;
@@ -278,6 +292,6 @@ void list_t_free(list_t* p_list)
 {
     if (!p_list) return;
 
-    free(p_list->p_table);
-    free(p_list);
+    allocator_t_free(p_list->p_allocator, p_list->p_table);
+    allocator_t_free(p_list->p_allocator, p_list);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef LIST_H
 #define	LIST_H
 
+#include "allocator.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -11,9 +12,10 @@ extern "C" {
     typedef struct list_t list_t;
 
     /***************************************************************************
-    * Allocates the new, empty list with initial capacity.                     *
+    * Allocates the new, empty list with initial capacity. The list comes from *
+    * 'p_allocator', or from the C library if it is NULL.                      *
     ***************************************************************************/  
-    list_t* list_t_alloc(size_t initial_capacity);
+    list_t* list_t_alloc(size_t initial_capacity, allocator_t* p_allocator);
 
     /***************************************************************************
     * Inserts the element to in front of the head of the list. Returns true if *
@@ -38,6 +40,12 @@ extern "C" {
     ***************************************************************************/  
     size_t  list_t_size(list_t* p_list);
 
+    /***************************************************************************
+    * Returns the number of bytes the list takes from the allocator, including *
+    * the allocator overhead of each block. The elements are not counted.      *
+    ***************************************************************************/
+    size_t  list_t_memory_usage(list_t* p_list);
+
     /***************************************************************************
     * Returns the index'th element of the list. Returns NULL if the index is   *
     * out of range.                                                            * 
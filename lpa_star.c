@@ -0,0 +1,628 @@
+#include "lpa_star.h"
+#include "directed_graph_node.h"
+#include "heap.h"
+#include "list.h"
+#include "memory_usage.h"
+#include "utils.h"
+#include <math.h>
+
+/*******************************************************************************
+* The key of a node in the open set, compared by the first value and then by   *
+* the second.                                                                  *
+*******************************************************************************/
+typedef struct lpa_key_t {
+    double primary;
+    double secondary;
+} lpa_key_t;
+
+/*******************************************************************************
+* The costs of a node. The node is consistent if 'g' equals 'rhs', and is in   *
+* the open set with 'key' otherwise.                                           *
+*******************************************************************************/
+typedef struct lpa_node_t {
+    double    g;
+    double    rhs;
+    lpa_key_t key;
+} lpa_node_t;
+
+struct lpa_star_t {
+    directed_graph_node_t*            p_source;
+    directed_graph_node_t*            p_target;
+    directed_graph_weight_function_t* p_weight_function;
+    heuristic_t                       heuristic;
+    search_stats_t*                   p_stats;
+    search_budget_t*                  p_budget;
+    allocator_t*                      p_allocator;
+    /* True for D* Lite, which grows from the target over the parents. */
+    bool                              backward;
+    /* Maps each node reached to its costs. */
+    unordered_map_t*                  p_node_map;
+    /* Owns the costs of the nodes. */
+    list_t*                           p_record_list;
+    heap_t*                           p_open_set;
+    /* The sum of the estimates between the sources D* Lite moved through,
+       which keeps the keys already in the open set valid. */
+    double                            key_modifier;
+    size_t                            expanded;
+    /* Set once the search needed the parents of a node that lacks them. */
+    bool                              parents_unknown;
+};
+
+static int key_cmp(void* p_a, void* p_b)
+{
+    lpa_key_t* p_key_a = p_a;
+    lpa_key_t* p_key_b = p_b;
+
+    if (p_key_a->primary < p_key_b->primary) return -1;
+    if (p_key_a->primary > p_key_b->primary) return 1;
+    if (p_key_a->secondary < p_key_b->secondary) return -1;
+    if (p_key_a->secondary > p_key_b->secondary) return 1;
+
+    return 0;
+}
+
+/* The node the search grows from, whose 'rhs' is zero. */
+static directed_graph_node_t* root_of(lpa_star_t* p_search)
+{
+    return p_search->backward ? p_search->p_target : p_search->p_source;
+}
+
+/* The node the search grows towards. */
+static directed_graph_node_t* goal_of(lpa_star_t* p_search)
+{
+    return p_search->backward ? p_search->p_source : p_search->p_target;
+}
+
+static double g_of(lpa_star_t* p_search, directed_graph_node_t* p_node)
+{
+    lpa_node_t* p_record = unordered_map_t_get(p_search->p_node_map, p_node);
+
+    return p_record ? p_record->g : INFINITY;
+}
+
+static double rhs_of(lpa_star_t* p_search, directed_graph_node_t* p_node)
+{
+    lpa_node_t* p_record = unordered_map_t_get(p_search->p_node_map, p_node);
+
+    return p_record ? p_record->rhs : INFINITY;
+}
+
+/*******************************************************************************
+* Returns the weight of the arc from 'p_from' to 'p_to' in the direction the   *
+* search grows.                                                                *
+*******************************************************************************/
+static double arc_cost(lpa_star_t* p_search,
+                       directed_graph_node_t* p_from,
+                       directed_graph_node_t* p_to)
+{
+    return *directed_graph_weight_function_t_get(
+            p_search->p_weight_function,
+            p_search->backward ? p_to : p_from,
+            p_search->backward ? p_from : p_to);
+}
+
+/*******************************************************************************
+* Returns the parents of 'p_node'. If they are not known, returns none and     *
+* marks the search, whose paths could not be trusted any more.                 *
+*******************************************************************************/
+static directed_graph_node_t** parents_of(lpa_star_t* p_search,
+                                          directed_graph_node_t* p_node,
+                                          size_t* p_count)
+{
+    if (!directed_graph_node_t_parents_known(p_node))
+    {
+        p_search->parents_unknown = true;
+        *p_count = 0;
+        return NULL;
+    }
+
+    *p_count = directed_graph_node_t_parent_count(p_node);
+    return directed_graph_node_t_parents(p_node);
+}
+
+/*******************************************************************************
+* Returns the nodes with arcs to 'p_node' in the direction the search grows.   *
+*******************************************************************************/
+static directed_graph_node_t** predecessors(lpa_star_t* p_search,
+                                            directed_graph_node_t* p_node,
+                                            size_t* p_count)
+{
+    if (p_search->backward)
+    {
+        *p_count = directed_graph_node_t_child_count(p_node);
+        return directed_graph_node_t_children(p_node);
+    }
+
+    return parents_of(p_search, p_node, p_count);
+}
+
+/*******************************************************************************
+* Returns the nodes with arcs from 'p_node' in the direction the search grows. *
+*******************************************************************************/
+static directed_graph_node_t** successors(lpa_star_t* p_search,
+                                          directed_graph_node_t* p_node,
+                                          size_t* p_count)
+{
+    if (p_search->backward) return parents_of(p_search, p_node, p_count);
+
+    *p_count = directed_graph_node_t_child_count(p_node);
+    return directed_graph_node_t_children(p_node);
+}
+
+static lpa_key_t compute_key(lpa_star_t* p_search,
+                             directed_graph_node_t* p_node)
+{
+    lpa_key_t key;
+    double    g   = g_of(p_search, p_node);
+    double    rhs = rhs_of(p_search, p_node);
+
+    key.secondary = g < rhs ? g : rhs;
+    key.primary   = key.secondary + p_search->key_modifier +
+                    (p_search->backward ?
+                     heuristic_t_estimate(&p_search->heuristic,
+                                          p_search->p_source,
+                                          p_node) :
+                     heuristic_t_estimate(&p_search->heuristic,
+                                          p_node,
+                                          p_search->p_target));
+    return key;
+}
+
+/*******************************************************************************
+* Returns the costs of 'p_node', recording them as infinite on first use, or   *
+* NULL if there is not enough memory.                                          *
+*******************************************************************************/
+static lpa_node_t* record_of(lpa_star_t* p_search,
+                             directed_graph_node_t* p_node)
+{
+    lpa_node_t* p_record = unordered_map_t_get(p_search->p_node_map, p_node);
+
+    if (p_record) return p_record;
+
+    if (!(p_record = allocator_t_alloc(p_search->p_allocator,
+                                       sizeof(*p_record))))
+    {
+        return NULL;
+    }
+
+    p_record->g   = INFINITY;
+    p_record->rhs = INFINITY;
+
+    if (!list_t_push_back(p_search->p_record_list, p_record))
+    {
+        allocator_t_free(p_search->p_allocator, p_record);
+        return NULL;
+    }
+
+    unordered_map_t_put(p_search->p_node_map, p_node, p_record);
+    return p_record;
+}
+
+/*******************************************************************************
+* Puts 'p_node' in the open set with a fresh key if it is inconsistent, and    *
+* takes it out otherwise. Returns false if there is not enough memory.         *
+*******************************************************************************/
+static bool requeue(lpa_star_t* p_search,
+                    directed_graph_node_t* p_node,
+                    lpa_node_t* p_record)
+{
+    heap_t_remove(p_search->p_open_set, p_node);
+
+    if (p_record->g == p_record->rhs) return true;
+
+    p_record->key = compute_key(p_search, p_node);
+    SEARCH_STATS_COUNT(p_search->p_stats, heap_pushes);
+    return heap_t_add(p_search->p_open_set, p_node, &p_record->key);
+}
+
+/*******************************************************************************
+* Sets the 'rhs' of 'p_node' to the least cost its predecessors offer and      *
+* requeues it. Returns false if there is not enough memory.                    *
+*******************************************************************************/
+static bool update_node(lpa_star_t* p_search, directed_graph_node_t* p_node)
+{
+    directed_graph_node_t** p_predecessors;
+    lpa_node_t*             p_record;
+    size_t                  count;
+    size_t                  i;
+    double                  cost;
+
+    if (!(p_record = record_of(p_search, p_node))) return false;
+
+    if (!equals_function(p_node, root_of(p_search)))
+    {
+        p_record->rhs  = INFINITY;
+        p_predecessors = predecessors(p_search, p_node, &count);
+
+        for (i = 0; i < count; ++i)
+        {
+            cost = g_of(p_search, p_predecessors[i]);
+
+            if (cost == INFINITY) continue;
+
+            cost += arc_cost(p_search, p_predecessors[i], p_node);
+
+            if (p_record->rhs > cost) p_record->rhs = cost;
+        }
+    }
+
+    return requeue(p_search, p_node, p_record);
+}
+
+/*******************************************************************************
+* Expands the least node of the open set. A node whose 'g' was too high takes  *
+* its 'rhs' and offers it to its successors; a node whose 'g' was too low      *
+* loses it, and the successors that relied on it look for another parent.      *
+* Returns false if there is not enough memory.                                 *
+*******************************************************************************/
+static bool expand(lpa_star_t* p_search, directed_graph_node_t* p_node)
+{
+    directed_graph_node_t** p_successors;
+    directed_graph_node_t*  p_successor;
+    lpa_node_t*             p_record;
+    lpa_node_t*             p_successor_record;
+    size_t                  count;
+    size_t                  i;
+    double                  old_g;
+    double                  cost;
+
+    p_record     = unordered_map_t_get(p_search->p_node_map, p_node);
+    p_successors = successors(p_search, p_node, &count);
+    old_g        = p_record->g;
+
+    heap_t_remove(p_search->p_open_set, p_node);
+    SEARCH_STATS_COUNT(p_search->p_stats, heap_pops);
+    SEARCH_STATS_COUNT(p_search->p_stats, nodes_settled);
+    ++p_search->expanded;
+
+    if (p_record->g > p_record->rhs)
+    {
+        p_record->g = p_record->rhs;
+
+        for (i = 0; i < count; ++i)
+        {
+            p_successor = p_successors[i];
+            SEARCH_STATS_COUNT(p_search->p_stats, arcs_relaxed);
+
+            if (equals_function(p_successor, root_of(p_search))) continue;
+
+            if (!(p_successor_record = record_of(p_search, p_successor)))
+            {
+                return false;
+            }
+
+            cost = p_record->g + arc_cost(p_search, p_node, p_successor);
+
+            if (p_successor_record->rhs > cost)
+            {
+                p_successor_record->rhs = cost;
+
+                if (!requeue(p_search, p_successor, p_successor_record))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    p_record->g = INFINITY;
+
+    for (i = 0; i < count; ++i)
+    {
+        p_successor = p_successors[i];
+        SEARCH_STATS_COUNT(p_search->p_stats, arcs_relaxed);
+
+        if (rhs_of(p_search, p_successor) ==
+                old_g + arc_cost(p_search, p_node, p_successor) &&
+            !update_node(p_search, p_successor))
+        {
+            return false;
+        }
+    }
+
+    return requeue(p_search, p_node, p_record);
+}
+
+static size_t memory_usage(lpa_star_t* p_search)
+{
+    return unordered_map_t_memory_usage(p_search->p_node_map) +
+           list_t_memory_usage(p_search->p_record_list) +
+           memory_block_size(sizeof(lpa_node_t)) *
+           list_t_size(p_search->p_record_list) +
+           heap_t_memory_usage(p_search->p_open_set);
+}
+
+/*******************************************************************************
+* Expands nodes until the goal is consistent and no open node has a lower key. *
+* Returns false if there is not enough memory or the budget runs out.          *
+*******************************************************************************/
+static bool compute_shortest_path(lpa_star_t* p_search)
+{
+    directed_graph_node_t* p_node;
+    lpa_node_t*            p_record;
+    lpa_key_t              goal_key;
+    lpa_key_t              key;
+
+    p_search->expanded = 0;
+    search_budget_t_start(p_search->p_budget);
+
+    while (heap_t_size(p_search->p_open_set) > 0)
+    {
+        p_node   = heap_t_min(p_search->p_open_set);
+        p_record = unordered_map_t_get(p_search->p_node_map, p_node);
+        goal_key = compute_key(p_search, goal_of(p_search));
+
+        if (key_cmp(&p_record->key, &goal_key) >= 0 &&
+            g_of(p_search, goal_of(p_search)) ==
+            rhs_of(p_search, goal_of(p_search)))
+        {
+            break;
+        }
+
+        if (SEARCH_BUDGET_EXHAUSTED(p_search->p_budget,
+                                    p_search->expanded,
+                                    memory_usage(p_search)))
+        {
+            return false;
+        }
+
+        SEARCH_STATS_PEAK(p_search->p_stats,
+                          peak_open_set,
+                          heap_t_size(p_search->p_open_set));
+
+        /* A key from before the source moved may be too low by now. */
+        key = compute_key(p_search, p_node);
+
+        if (key_cmp(&p_record->key, &key) < 0)
+        {
+            if (!requeue(p_search, p_node, p_record)) return false;
+
+            continue;
+        }
+
+        if (!expand(p_search, p_node)) return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Walks from the goal back to the root over the predecessors that offer the    *
+* least cost.                                                                  *
+*******************************************************************************/
+static list_t* extract_path(lpa_star_t* p_search)
+{
+    directed_graph_node_t** p_predecessors;
+    directed_graph_node_t*  p_node = goal_of(p_search);
+    directed_graph_node_t*  p_best;
+    list_t*                 p_path;
+    size_t                  count;
+    size_t                  steps = 0;
+    size_t                  i;
+    double                  best_cost;
+    double                  cost;
+
+    if (!(p_path = list_t_alloc(INITIAL_CAPACITY, NULL))) return NULL;
+
+    if (g_of(p_search, p_node) == INFINITY) return p_path;
+
+    list_t_push_back(p_path, p_node);
+
+    while (!equals_function(p_node, root_of(p_search)))
+    {
+        p_predecessors = predecessors(p_search, p_node, &count);
+        p_best         = NULL;
+        best_cost      = INFINITY;
+
+        for (i = 0; i < count; ++i)
+        {
+            cost = g_of(p_search, p_predecessors[i]);
+
+            if (cost == INFINITY) continue;
+
+            cost += arc_cost(p_search, p_predecessors[i], p_node);
+
+            if (best_cost > cost)
+            {
+                best_cost = cost;
+                p_best    = p_predecessors[i];
+            }
+        }
+
+        /* Cannot happen once the search is consistent along the path. */
+        if (!p_best || ++steps > list_t_size(p_search->p_record_list))
+        {
+            list_t_clear(p_path);
+            return p_path;
+        }
+
+        p_node = p_best;
+
+        if (p_search->backward) list_t_push_back(p_path, p_node);
+        else                    list_t_push_front(p_path, p_node);
+    }
+
+    return p_path;
+}
+
+static lpa_star_t* lpa_star_t_alloc_impl(
+        directed_graph_node_t* p_source,
+        directed_graph_node_t* p_target,
+        directed_graph_weight_function_t* p_weight_function,
+        unordered_map_t* p_location_map,
+        bool backward,
+        search_options_t* p_options)
+{
+    lpa_star_t*  p_search;
+    lpa_node_t*  p_record;
+    allocator_t* p_allocator = p_options ? p_options->p_allocator : NULL;
+
+    if (!p_source || !p_target || !p_weight_function) return NULL;
+
+    if (!(p_search = allocator_t_calloc(p_allocator, 1, sizeof(*p_search))))
+    {
+        return NULL;
+    }
+
+    p_search->p_source          = p_source;
+    p_search->p_target          = p_target;
+    p_search->p_weight_function = p_weight_function;
+    p_search->p_stats           = p_options ? p_options->p_stats : NULL;
+    p_search->p_budget          = p_options ? p_options->p_budget : NULL;
+    p_search->p_allocator       = p_allocator;
+    p_search->backward          = backward;
+    p_search->p_node_map        = unordered_map_t_alloc(INITIAL_CAPACITY,
+                                                        LOAD_FACTOR,
+                                                        hash_function,
+                                                        equals_function,
+                                                        p_allocator);
+    p_search->p_record_list     = list_t_alloc(INITIAL_CAPACITY, p_allocator);
+    p_search->p_open_set        = heap_t_alloc(4,
+                                               INITIAL_CAPACITY,
+                                               LOAD_FACTOR,
+                                               hash_function,
+                                               equals_function,
+                                               key_cmp,
+                                               p_allocator);
+
+    if (!choose_heuristic(&p_search->heuristic, p_location_map, p_options)
+            || !p_search->p_node_map
+            || !p_search->p_record_list
+            || !p_search->p_open_set
+            || !(p_record = record_of(p_search, root_of(p_search))))
+    {
+        lpa_star_t_free(p_search);
+        return NULL;
+    }
+
+    SEARCH_STATS_START(p_search->p_stats);
+    p_record->rhs = 0.0;
+
+    if (!requeue(p_search, root_of(p_search), p_record))
+    {
+        lpa_star_t_free(p_search);
+        return NULL;
+    }
+
+    return p_search;
+}
+
+lpa_star_t* lpa_star_t_alloc(
+        directed_graph_node_t* p_source,
+        directed_graph_node_t* p_target,
+        directed_graph_weight_function_t* p_weight_function,
+        unordered_map_t* p_location_map,
+        search_options_t* p_options)
+{
+    return lpa_star_t_alloc_impl(p_source,
+                                 p_target,
+                                 p_weight_function,
+                                 p_location_map,
+                                 false,
+                                 p_options);
+}
+
+lpa_star_t* lpa_star_t_alloc_d_star_lite(
+        directed_graph_node_t* p_source,
+        directed_graph_node_t* p_target,
+        directed_graph_weight_function_t* p_weight_function,
+        unordered_map_t* p_location_map,
+        search_options_t* p_options)
+{
+    return lpa_star_t_alloc_impl(p_source,
+                                 p_target,
+                                 p_weight_function,
+                                 p_location_map,
+                                 true,
+                                 p_options);
+}
+
+list_t* lpa_star_t_path(lpa_star_t* p_search)
+{
+    list_t* p_path;
+
+    if (!p_search) return NULL;
+
+    if (!compute_shortest_path(p_search) || p_search->parents_unknown)
+    {
+        return NULL;
+    }
+
+    p_path = extract_path(p_search);
+
+    if (p_search->parents_unknown)
+    {
+        list_t_free(p_path);
+        return NULL;
+    }
+
+    return p_path;
+}
+
+bool lpa_star_t_update_arcs(lpa_star_t* p_search,
+                            directed_graph_node_t** p_tails,
+                            directed_graph_node_t** p_heads,
+                            size_t count)
+{
+    size_t i;
+
+    if (!p_search) return false;
+
+    /* Only the end of each arc the search reaches last can change its rhs,
+       which is either end of an undirected edge. */
+    for (i = 0; i < count; ++i)
+    {
+        if (!update_node(p_search,
+                         p_search->backward ? p_tails[i] : p_heads[i]))
+        {
+            return false;
+        }
+
+        if (directed_graph_node_t_is_undirected(p_tails[i]) &&
+            !update_node(p_search,
+                         p_search->backward ? p_heads[i] : p_tails[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool lpa_star_t_move_source(lpa_star_t* p_search,
+                            directed_graph_node_t* p_source)
+{
+    if (!p_search || !p_source || !p_search->backward) return false;
+
+    p_search->key_modifier += heuristic_t_estimate(&p_search->heuristic,
+                                                   p_search->p_source,
+                                                   p_source);
+    p_search->p_source = p_source;
+    return true;
+}
+
+size_t lpa_star_t_expanded(lpa_star_t* p_search)
+{
+    return p_search ? p_search->expanded : 0;
+}
+
+void lpa_star_t_free(lpa_star_t* p_search)
+{
+    size_t i;
+
+    if (!p_search) return;
+
+    for (i = 0; i < list_t_size(p_search->p_record_list); ++i)
+    {
+        allocator_t_free(p_search->p_allocator,
+                         list_t_get(p_search->p_record_list, i));
+    }
+
+    if (p_search->p_record_list) list_t_free(p_search->p_record_list);
+    if (p_search->p_node_map)    unordered_map_t_free(p_search->p_node_map);
+    if (p_search->p_open_set)    heap_t_free(p_search->p_open_set);
+
+    allocator_t_free(p_search->p_allocator, p_search);
+}
@@ -0,0 +1,93 @@
+#ifndef LPA_STAR_H
+#define	LPA_STAR_H
+
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include "unordered_map.h"
+#include "list.h"
+#include "search_options.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * An incremental search. It keeps for each node the cost 'g' it settled at *
+    * and the cost 'rhs' its neighbours offer, and only expands the nodes      *
+    * whose two costs differ, so after a few arcs change a new path costs      *
+    * about as much as the part of the search those arcs affect. A Lifelong    *
+    * Planning A* (LPA*) search grows from the source. A D* Lite search grows  *
+    * from the target, so that its source may move along the path as it is     *
+    * followed. Both need the parents of the nodes and a heuristic that never  *
+    * overestimates and obeys the triangle inequality.                         *
+    ***************************************************************************/
+    typedef struct lpa_star_t lpa_star_t;
+
+    /***************************************************************************
+    * Prepares an LPA* search from 'p_source' to 'p_target'. The heuristic is  *
+    * chosen as in 'astar_with_options'. The statistics of 'p_options' add up  *
+    * over all the repairs, and its budget applies to each of them. Returns    *
+    * NULL if there is no heuristic or there is not enough memory.             *
+    ***************************************************************************/
+    lpa_star_t* lpa_star_t_alloc(
+            directed_graph_node_t* p_source,
+            directed_graph_node_t* p_target,
+            directed_graph_weight_function_t* p_weight_function,
+            unordered_map_t* p_location_map,
+            search_options_t* p_options);
+
+    /***************************************************************************
+    * Same as 'lpa_star_t_alloc', but prepares a D* Lite search, whose source  *
+    * may be moved with 'lpa_star_t_move_source'.                              *
+    ***************************************************************************/
+    lpa_star_t* lpa_star_t_alloc_d_star_lite(
+            directed_graph_node_t* p_source,
+            directed_graph_node_t* p_target,
+            directed_graph_weight_function_t* p_weight_function,
+            unordered_map_t* p_location_map,
+            search_options_t* p_options);
+
+    /***************************************************************************
+    * Brings the search up to date with the arcs changed so far and returns a  *
+    * shortest path, which is empty if the target is not reachable. Returns    *
+    * NULL if there is not enough memory or the budget runs out, in which case *
+    * the next call goes on with the repair. Also returns NULL, for good, once *
+    * the search meets a node whose parents are not known.                     *
+    ***************************************************************************/
+    list_t* lpa_star_t_path(lpa_star_t* p_search);
+
+    /***************************************************************************
+    * Tells the search that the 'count' arcs from 'p_tails[i]' to 'p_heads[i]' *
+    * had their weights changed, or were added or removed, since the last      *
+    * path. The next path repairs the search around them. An undirected edge   *
+    * counts as both of its arcs. Returns false if there is not enough         *
+    * memory, which leaves the search broken.                                  *
+    ***************************************************************************/
+    bool lpa_star_t_update_arcs(lpa_star_t* p_search,
+                                directed_graph_node_t** p_tails,
+                                directed_graph_node_t** p_heads,
+                                size_t count);
+
+    /***************************************************************************
+    * Moves the source of a D* Lite search to 'p_source', usually the next     *
+    * node of the last path. Returns false for an LPA* search, which cannot    *
+    * move its source.                                                         *
+    ***************************************************************************/
+    bool lpa_star_t_move_source(lpa_star_t* p_search,
+                                directed_graph_node_t* p_source);
+
+    /***************************************************************************
+    * Returns the number of nodes the last call to 'lpa_star_t_path' expanded. *
+    ***************************************************************************/
+    size_t lpa_star_t_expanded(lpa_star_t* p_search);
+
+    /***************************************************************************
+    * Deallocates the search. The paths it returned are left alone.            *
+    ***************************************************************************/
+    void lpa_star_t_free(lpa_star_t* p_search);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* LPA_STAR_H */
@@ -1,12 +1,31 @@
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "astar.h"
+#include "benchmark.h"
+#include "microbench.h"
 #include "dijkstra.h"
+#include "ara_star.h"
 #include "bidir_astar.h"
 #include "bidir_dijkstra.h"
 #include "directed_graph_node.h"
+#include "focal_search.h"
+#include "graph_generators.h"
+#include "heap_trace.h"
+#include "heuristic.h"
+#include "landmarks.h"
+#include "lpa_star.h"
+#include "memory_usage.h"
+#include "route_cache.h"
+#include "search_task.h"
+#include "shortest_path_tree.h"
+#include "source_tree_cache.h"
+#include "td_search.h"
+#include "td_weight_function.h"
 #include "weight_function.h"
+#include "weight_profiles.h"
 #include "utils.h"
 
 #define ASSERT(CONDITION) assert(CONDITION, #CONDITION, __FILE__, __LINE__)
@@ -30,10 +49,10 @@ static void test_directed_graph_node_correctness()
     directed_graph_node_t* p_node_c;
     directed_graph_node_t* p_node_d;
     
-    p_node_a = directed_graph_node_t_alloc("Node A");
-    p_node_b = directed_graph_node_t_alloc("Node B");
-    p_node_c = directed_graph_node_t_alloc("Node C");
-    p_node_d = directed_graph_node_t_alloc("Node D");
+    p_node_a = directed_graph_node_t_alloc("Node A", NULL);
+    p_node_b = directed_graph_node_t_alloc("Node B", NULL);
+    p_node_c = directed_graph_node_t_alloc("Node C", NULL);
+    p_node_d = directed_graph_node_t_alloc("Node D", NULL);
     
     ASSERT(strcmp(directed_graph_node_t_to_string(p_node_a), 
            "[directed_graph_node_t: id = Node A]") == 0);
@@ -100,6 +119,149 @@ static void test_directed_graph_node_correctness()
     ASSERT(directed_graph_node_t_has_child(p_node_b, p_node_d));
 }
 
+static void test_adjacency_correctness()
+{
+    directed_graph_node_t* p_hub;
+    directed_graph_node_t* p_nodes[40];
+    directed_graph_node_t** p_reverse_arcs;
+    char                   names[40][8];
+    size_t                 i;
+    
+    p_hub = directed_graph_node_t_alloc("Hub", NULL);
+    
+    /* Grow past the inline arcs and past the point where the index is built. */
+    for (i = 0; i < 40; ++i)
+    {
+        sprintf(names[i], "%d", (int) i);
+        p_nodes[i] = directed_graph_node_t_alloc(names[i], NULL);
+        ASSERT(directed_graph_node_t_add_arc(p_hub, p_nodes[i]));
+        ASSERT(directed_graph_node_t_child_count(p_hub) == i + 1);
+        ASSERT(directed_graph_node_t_parent_count(p_nodes[i]) == 1);
+    }
+    
+    ASSERT(directed_graph_node_t_add_arc(p_hub, p_nodes[7]) == false);
+    ASSERT(directed_graph_node_t_child_count(p_hub) == 40);
+    
+    for (i = 0; i < 40; i += 2)
+    {
+        directed_graph_node_t_remove_arc(p_hub, p_nodes[i]);
+    }
+    
+    ASSERT(directed_graph_node_t_child_count(p_hub) == 20);
+    
+    for (i = 0; i < 40; ++i)
+    {
+        ASSERT(directed_graph_node_t_has_child(p_hub, p_nodes[i]) == (i & 1));
+        ASSERT(directed_graph_node_t_parent_count(p_nodes[i]) == (i & 1));
+    }
+    
+    for (i = 0; i < 20; ++i)
+    {
+        ASSERT(directed_graph_node_t_has_child(
+                    p_hub, 
+                    directed_graph_node_t_children(p_hub)[i]));
+    }
+    
+    directed_graph_node_t_clear(p_hub);
+    
+    ASSERT(directed_graph_node_t_child_count(p_hub) == 0);
+    ASSERT(directed_graph_node_t_parent_count(p_nodes[1]) == 0);
+    
+    /* The parents of forward-only arcs are only there once asked for. */
+    for (i = 1; i < 4; ++i)
+    {
+        ASSERT(directed_graph_node_t_add_child(p_nodes[0], p_nodes[i]));
+        ASSERT(directed_graph_node_t_add_child(p_nodes[i], p_nodes[4]));
+    }
+    
+    ASSERT(directed_graph_node_t_parent_count(p_nodes[4]) == 0);
+    ASSERT(directed_graph_node_t_parents_known(p_nodes[4]) == false);
+    ASSERT(directed_graph_node_t_parents_known(p_nodes[0]));
+    ASSERT(p_reverse_arcs = directed_graph_node_t_build_parents(p_nodes, 
+                                                                5, 
+                                                                NULL));
+    ASSERT(directed_graph_node_t_parent_count(p_nodes[4]) == 3);
+    ASSERT(directed_graph_node_t_parents_known(p_nodes[4]));
+    ASSERT(directed_graph_node_t_parents(p_nodes[1])[0] == p_nodes[0]);
+    
+    /* A shared parent slice is copied out before it grows. */
+    ASSERT(directed_graph_node_t_add_arc(p_nodes[2], p_nodes[1]));
+    ASSERT(directed_graph_node_t_parent_count(p_nodes[1]) == 2);
+    ASSERT(directed_graph_node_t_parent_count(p_nodes[2]) == 1);
+    ASSERT(directed_graph_node_t_parent_count(p_nodes[4]) == 3);
+    
+    for (i = 0; i < 5; ++i) directed_graph_node_t_clear(p_nodes[i]);
+    
+    free(p_reverse_arcs);
+    
+    for (i = 0; i < 40; ++i) directed_graph_node_t_free(p_nodes[i]);
+    
+    directed_graph_node_t_free(p_hub);
+}
+
+static void test_undirected_correctness()
+{
+    directed_graph_weight_function_t* p_weight_function;
+    
+    directed_graph_node_t* p_node_a;
+    directed_graph_node_t* p_node_b;
+    directed_graph_node_t* p_node_c;
+    
+    p_node_a = directed_graph_node_t_alloc("A", NULL);
+    p_node_b = directed_graph_node_t_alloc("B", NULL);
+    p_node_c = directed_graph_node_t_alloc("C", NULL);
+    
+    ASSERT(directed_graph_node_t_add_edge(p_node_a, p_node_b));
+    ASSERT(directed_graph_node_t_add_edge(p_node_b, p_node_a) == false);
+    ASSERT(directed_graph_node_t_add_edge(p_node_c, p_node_b));
+    ASSERT(directed_graph_node_t_is_undirected(p_node_a));
+    
+    /* Each endpoint lists the edge once, as a child and as a parent. */
+    ASSERT(directed_graph_node_t_has_child(p_node_a, p_node_b));
+    ASSERT(directed_graph_node_t_has_child(p_node_b, p_node_a));
+    ASSERT(directed_graph_node_t_child_count(p_node_b) == 2);
+    ASSERT(directed_graph_node_t_parent_count(p_node_b) == 2);
+    ASSERT(directed_graph_node_t_parents(p_node_b) == 
+           directed_graph_node_t_children(p_node_b));
+    ASSERT(directed_graph_node_t_add_arc(p_node_a, p_node_c) == false);
+    
+    ASSERT(p_weight_function = 
+            directed_graph_weight_function_t_alloc_symmetric(hash_function,
+                                                             equals_function,
+                                                             NULL));
+    ASSERT(directed_graph_weight_function_t_put(p_weight_function,
+                                                p_node_b,
+                                                p_node_a,
+                                                3.0));
+    ASSERT(*directed_graph_weight_function_t_get(p_weight_function, 
+                                                 p_node_a, 
+                                                 p_node_b) == 3.0);
+    ASSERT(directed_graph_weight_function_t_put(p_weight_function,
+                                                p_node_a,
+                                                p_node_b,
+                                                5.0));
+    ASSERT(*directed_graph_weight_function_t_get(p_weight_function, 
+                                                 p_node_b, 
+                                                 p_node_a) == 5.0);
+    ASSERT(directed_graph_weight_function_t_get(p_weight_function, 
+                                                p_node_b, 
+                                                p_node_c) == NULL);
+    
+    /* An edge is removed given either way around. */
+    ASSERT(directed_graph_node_t_remove_arc(p_node_b, p_node_a));
+    ASSERT(directed_graph_node_t_has_child(p_node_a, p_node_b) == false);
+    ASSERT(directed_graph_node_t_child_count(p_node_b) == 1);
+    
+    directed_graph_node_t_clear(p_node_b);
+    
+    ASSERT(directed_graph_node_t_child_count(p_node_c) == 0);
+    
+    directed_graph_weight_function_t_free(p_weight_function);
+    directed_graph_node_t_free(p_node_a);
+    directed_graph_node_t_free(p_node_b);
+    directed_graph_node_t_free(p_node_c);
+}
+
 static void test_weight_function_correctness()
 {
     directed_graph_weight_function_t* p_weight_function;
@@ -111,14 +273,15 @@ static void test_weight_function_correctness()
     
     double weight;
     
-    p_node_a = directed_graph_node_t_alloc("Node A");
-    p_node_b = directed_graph_node_t_alloc("Node B");
-    p_node_c = directed_graph_node_t_alloc("Node C");
-    p_node_d = directed_graph_node_t_alloc("Node D");
+    p_node_a = directed_graph_node_t_alloc("Node A", NULL);
+    p_node_b = directed_graph_node_t_alloc("Node B", NULL);
+    p_node_c = directed_graph_node_t_alloc("Node C", NULL);
+    p_node_d = directed_graph_node_t_alloc("Node D", NULL);
     
     ASSERT(p_weight_function = 
             directed_graph_weight_function_t_alloc(hash_function, 
-                                                   equals_function));
+                                                   equals_function,
+                                                   NULL));
     
     ASSERT(directed_graph_weight_function_t_get(p_weight_function, 
                                                 p_node_a, 
@@ -175,17 +338,24 @@ static void test_dijkstra_correctness()
     
     directed_graph_weight_function_t* p_weight_function;
     list_t* p_path;
+    heap_t* p_heap;
+    heap_trace_t* p_heap_trace;
+    heap_trace_queue_t queue;
+    search_options_t trace_options;
+    
+    memset(&trace_options, 0, sizeof(trace_options));
     
-    p_node_a = directed_graph_node_t_alloc("A");
-    p_node_b = directed_graph_node_t_alloc("B");
-    p_node_c = directed_graph_node_t_alloc("C");
-    p_node_d = directed_graph_node_t_alloc("D");
-    p_node_e = directed_graph_node_t_alloc("E");
-    p_node_s = directed_graph_node_t_alloc("Source");
-    p_node_t = directed_graph_node_t_alloc("Target");
+    p_node_a = directed_graph_node_t_alloc("A", NULL);
+    p_node_b = directed_graph_node_t_alloc("B", NULL);
+    p_node_c = directed_graph_node_t_alloc("C", NULL);
+    p_node_d = directed_graph_node_t_alloc("D", NULL);
+    p_node_e = directed_graph_node_t_alloc("E", NULL);
+    p_node_s = directed_graph_node_t_alloc("Source", NULL);
+    p_node_t = directed_graph_node_t_alloc("Target", NULL);
     
     p_weight_function = directed_graph_weight_function_t_alloc(hash_function,
-                                                               equals_function);
+                                                               equals_function,
+                                                               NULL);
     
     directed_graph_node_t_add_arc(p_node_s, p_node_a);
     directed_graph_weight_function_t_put(p_weight_function,
@@ -245,6 +415,94 @@ static void test_dijkstra_correctness()
     ASSERT(list_t_get(p_path, 4) == p_node_d);
     ASSERT(list_t_get(p_path, 5) == p_node_e);
     ASSERT(list_t_get(p_path, 6) == p_node_t);
+    
+    list_t_free(p_path);
+    
+#ifndef NO_SEARCH_STATS
+    search_stats_t   stats;
+    search_options_t options;
+    
+    memset(&options, 0, sizeof(options));
+    options.p_stats = &stats;
+    
+    p_path = dijkstra_with_options(p_node_s, 
+                                   p_node_t, 
+                                   p_weight_function, 
+                                   &options);
+    
+    ASSERT(list_t_size(p_path) == 7);
+    ASSERT(stats.nodes_settled == 7);
+    ASSERT(stats.heap_pops == 7);
+    ASSERT(stats.heap_pushes == 7);
+    ASSERT(stats.arcs_relaxed == 8);
+    ASSERT(stats.decrease_keys == 2);
+    ASSERT(stats.peak_open_set == 2);
+    
+    list_t_free(p_path);
+#endif
+    
+    p_path = dijkstra_settle_order(p_node_s, p_weight_function, 4);
+    
+    ASSERT(list_t_size(p_path) == 4);
+    ASSERT(list_t_get(p_path, 0) == p_node_s);
+    ASSERT(list_t_get(p_path, 1) == p_node_a);
+    ASSERT(list_t_get(p_path, 2) == p_node_b);
+    ASSERT(list_t_get(p_path, 3) == p_node_c);
+    
+    list_t_free(p_path);
+    
+    p_heap_trace = heap_trace_t_alloc();
+    trace_options.p_heap_trace = p_heap_trace;
+    list_t_free(dijkstra_with_options(p_node_s, 
+                                      p_node_t, 
+                                      p_weight_function, 
+                                      &trace_options));
+    
+    ASSERT(heap_trace_t_size(p_heap_trace) == 16);
+    ASSERT(heap_trace_t_elements(p_heap_trace) == 7);
+    ASSERT(heap_trace_t_searches(p_heap_trace) == 1);
+    ASSERT(heap_trace_t_write(p_heap_trace, "heap_trace_test.bin"));
+    heap_trace_t_free(p_heap_trace);
+    
+    p_heap_trace = heap_trace_t_read("heap_trace_test.bin");
+    remove("heap_trace_test.bin");
+    
+    ASSERT(p_heap_trace);
+    ASSERT(heap_trace_t_size(p_heap_trace) == 16);
+    
+    p_heap = heap_t_alloc(2, 
+                          INITIAL_CAPACITY, 
+                          LOAD_FACTOR, 
+                          heap_trace_element_hash, 
+                          heap_trace_element_equals, 
+                          priority_cmp,
+                          NULL);
+    heap_trace_queue_t_init_heap(&queue, p_heap);
+    
+    ASSERT(heap_trace_t_replay(p_heap_trace, &queue));
+    
+    heap_t_free(p_heap);
+    heap_trace_t_free(p_heap_trace);
+    
+#ifndef NO_SEARCH_RECORDER
+    trace_options.p_heap_trace = NULL;
+    trace_options.p_recorder   = search_recorder_t_alloc();
+    list_t_free(dijkstra_with_options(p_node_s, 
+                                      p_node_t, 
+                                      p_weight_function, 
+                                      &trace_options));
+    
+    ASSERT(search_recorder_t_size(trace_options.p_recorder) == 7);
+    ASSERT(search_recorder_t_get(trace_options.p_recorder, 0)->p_node 
+           == p_node_s);
+    ASSERT(search_recorder_t_get(trace_options.p_recorder, 0)->g == 0.0);
+    ASSERT(search_recorder_t_get(trace_options.p_recorder, 6)->p_node 
+           == p_node_t);
+    ASSERT(search_recorder_t_meeting_node(trace_options.p_recorder) 
+           == p_node_t);
+    
+    search_recorder_t_free(trace_options.p_recorder);
+#endif
 }
 
 static void test_bidirectional_dijkstra_correctness()
@@ -260,16 +518,17 @@ static void test_bidirectional_dijkstra_correctness()
     directed_graph_weight_function_t* p_weight_function;
     list_t* p_path;
     
-    p_node_a = directed_graph_node_t_alloc("A");
-    p_node_b = directed_graph_node_t_alloc("B");
-    p_node_c = directed_graph_node_t_alloc("C");
-    p_node_d = directed_graph_node_t_alloc("D");
-    p_node_e = directed_graph_node_t_alloc("E");
-    p_node_s = directed_graph_node_t_alloc("Source");
-    p_node_t = directed_graph_node_t_alloc("Target");
+    p_node_a = directed_graph_node_t_alloc("A", NULL);
+    p_node_b = directed_graph_node_t_alloc("B", NULL);
+    p_node_c = directed_graph_node_t_alloc("C", NULL);
+    p_node_d = directed_graph_node_t_alloc("D", NULL);
+    p_node_e = directed_graph_node_t_alloc("E", NULL);
+    p_node_s = directed_graph_node_t_alloc("Source", NULL);
+    p_node_t = directed_graph_node_t_alloc("Target", NULL);
     
     p_weight_function = directed_graph_weight_function_t_alloc(hash_function,
-                                                               equals_function);
+                                                               equals_function,
+                                                               NULL);
     
     directed_graph_node_t_add_arc(p_node_s, p_node_a);
     directed_graph_weight_function_t_put(p_weight_function,
@@ -339,40 +598,2298 @@ static void test_bidirectional_dijkstra_correctness()
     ASSERT(list_t_size(p_path) == 1);
 }
 
+static void test_graph_generators_correctness()
+{
+    graph_data_t* p_grid;
+    graph_data_t* p_other;
+    list_t*       p_path;
+    list_t*       p_other_path;
+    size_t        i;
+    
+    /* A complete 3 x 2 grid has 7 edges, or 14 arcs. */
+    p_grid = create_grid_graph(3, 2, 1, 10.0, 0.2, 0.0, 7);
+    
+    ASSERT(p_grid->node_count == 6);
+    ASSERT(directed_graph_node_t_has_child(p_grid->p_node_array[0], 
+                                           p_grid->p_node_array[1]));
+    ASSERT(directed_graph_node_t_has_child(p_grid->p_node_array[1], 
+                                           p_grid->p_node_array[0]));
+    ASSERT(directed_graph_node_t_has_child(p_grid->p_node_array[0], 
+                                           p_grid->p_node_array[3]));
+    ASSERT(directed_graph_node_t_has_child(p_grid->p_node_array[0], 
+                                           p_grid->p_node_array[4]) == false);
+    
+    /* The grid stores each edge once, and its parents are its children. */
+    ASSERT(directed_graph_node_t_is_undirected(p_grid->p_node_array[4]));
+    ASSERT(directed_graph_node_t_parent_count(p_grid->p_node_array[4]) == 3);
+    ASSERT(graph_data_t_ensure_parents(p_grid));
+    ASSERT(directed_graph_node_t_parent_count(p_grid->p_node_array[4]) == 3);
+    ASSERT(directed_graph_node_t_add_arc(p_grid->p_node_array[2],
+                                         p_grid->p_node_array[0]) == false);
+    ASSERT(*directed_graph_weight_function_t_get(p_grid->p_weight_function,
+                                                 p_grid->p_node_array[4],
+                                                 p_grid->p_node_array[5]) ==
+           *directed_graph_weight_function_t_get(p_grid->p_weight_function,
+                                                 p_grid->p_node_array[5],
+                                                 p_grid->p_node_array[4]));
+    
+    /* The same seed must reproduce the same graph. */
+    p_other = create_grid_graph(3, 2, 1, 10.0, 0.2, 0.0, 7);
+    
+    for (i = 0; i < 6; ++i)
+    {
+        ASSERT(((point_3d_t*) unordered_map_t_get(p_grid->p_point_map, 
+                                        p_grid->p_node_array[i]))->x ==
+               ((point_3d_t*) unordered_map_t_get(p_other->p_point_map, 
+                                        p_other->p_node_array[i]))->x);
+    }
+    
+    /* The motorway connects the junctions 0 and 10 directly. */
+    p_other = create_highway_graph(11, 11, 10, 10.0, 0.0, 0.5, 7);
+    
+    ASSERT(directed_graph_node_t_has_child(p_other->p_node_array[0], 
+                                           p_other->p_node_array[10]));
+    ASSERT(directed_graph_node_t_has_child(p_other->p_node_array[0], 
+                                           p_other->p_node_array[110]));
+    ASSERT(is_valid_path(dijkstra(p_other->p_node_array[0], 
+                                  p_other->p_node_array[120],
+                                  p_other->p_weight_function)));
+    
+    p_other = create_planar_graph(500, 1000.0, 1000.0, 0.0, 7);
+    
+    ASSERT(p_other->node_count == 500);
+    
+    for (i = 0; i < 500; ++i)
+    {
+        ASSERT(directed_graph_node_t_child_count(
+                    p_other->p_node_array[i]) > 0);
+    }
+    
+    /* The random graph keeps its parents for the backward searches. */
+    srand(7);
+    p_other = create_random_graph(200, 1000, 1000.0, 1000.0, 0.0, 200.0);
+    
+    for (i = 1; i < 20; ++i)
+    {
+        p_path       = dijkstra(p_other->p_node_array[0], 
+                                p_other->p_node_array[i],
+                                p_other->p_weight_function);
+        p_other_path = bidirectional_dijkstra(p_other->p_node_array[0], 
+                                              p_other->p_node_array[i],
+                                              p_other->p_weight_function);
+        
+        ASSERT(p_other_path);
+        ASSERT(list_t_size(p_path) == 0 || is_valid_path(p_other_path));
+        ASSERT(compute_path_cost(p_path, p_other->p_weight_function) ==
+               compute_path_cost(p_other_path, p_other->p_weight_function));
+    }
+    
+    /* Without its parents the backward search gives up rather than miss
+       the paths. */
+    srand(7);
+    p_other = create_random_graph_without_parents(200, 
+                                                  1000, 
+                                                  1000.0, 
+                                                  1000.0, 
+                                                  0.0, 
+                                                  200.0);
+    
+    for (i = 1; list_t_size(dijkstra(p_other->p_node_array[0], 
+                                     p_other->p_node_array[i],
+                                     p_other->p_weight_function)) == 0; ++i)
+    {
+    }
+    
+    ASSERT(directed_graph_node_t_parents_known(p_other->p_node_array[i]) == 
+           false);
+    ASSERT(bidirectional_dijkstra(p_other->p_node_array[0], 
+                                  p_other->p_node_array[i],
+                                  p_other->p_weight_function) == NULL);
+    ASSERT(graph_data_t_ensure_parents(p_other));
+    ASSERT(directed_graph_node_t_parents_known(p_other->p_node_array[i]));
+    ASSERT(is_valid_path(bidirectional_dijkstra(p_other->p_node_array[0], 
+                                                p_other->p_node_array[i],
+                                                p_other->p_weight_function)));
+}
+
+static void test_coordinate_store_correctness()
+{
+    graph_data_t*          p_data;
+    coordinate_store_t*    p_store;
+    directed_graph_node_t* p_loner;
+    directed_graph_node_t* p_source;
+    directed_graph_node_t* p_target;
+    directed_graph_node_t* p_other;
+    list_t*                p_path;
+    list_t*                p_other_path;
+    double                 distances[100];
+    double                 expected;
+    double                 scale;
+    search_stats_t         stats;
+    search_stats_t         other_stats;
+    search_options_t       options;
+    search_options_t       other_options;
+    int                    simd;
+    size_t                 i;
+    
+    memset(&options, 0, sizeof(options));
+    memset(&other_options, 0, sizeof(other_options));
+    other_options.p_stats = &other_stats;
+    
+    p_data = create_planar_graph(100, 1000.0, 1000.0, 0.0, 7);
+    
+    ASSERT(directed_graph_node_t_id(p_data->p_node_array[5]) == 
+           DIRECTED_GRAPH_NODE_NO_ID);
+    ASSERT(graph_data_t_ensure_coordinates(p_data));
+    ASSERT(directed_graph_node_t_id(p_data->p_node_array[5]) == 5);
+    
+    p_store  = p_data->p_coordinates;
+    p_target = p_data->p_node_array[99];
+    scale    = coordinate_store_t_scale(p_store);
+    
+    ASSERT(coordinate_store_t_capacity(p_store) == 100);
+    
+    /* No local road costs less than 1.5 times its length. */
+    ASSERT(scale >= 1.5 * (1.0 - 1e-9) && scale < 2.0);
+    
+    /* Every instruction set matches the point distance, odd tails included. */
+    for (simd = COORDINATE_SIMD_SCALAR; simd <= COORDINATE_SIMD_AVX2; ++simd)
+    {
+        coordinate_store_t_distances_simd(p_store,
+                                          p_data->p_node_array,
+                                          99,
+                                          p_target,
+                                          distances,
+                                          (coordinate_simd_t) simd);
+        
+        for (i = 0; i < 99; ++i)
+        {
+            expected = scale * point_3d_t_distance(
+                    unordered_map_t_get(p_data->p_point_map, 
+                                        p_data->p_node_array[i]),
+                    unordered_map_t_get(p_data->p_point_map, p_target));
+            
+            ASSERT(fabs(distances[i] - expected) <= 1e-12 * expected);
+        }
+    }
+    
+    /* A node without coordinates is estimated at zero. */
+    p_loner = directed_graph_node_t_alloc("Loner", NULL);
+    coordinate_store_t_distances(p_store, &p_loner, 1, p_target, distances);
+    
+    ASSERT(distances[0] == 0.0);
+    ASSERT(coordinate_store_t_distance(p_store, p_target, p_loner) == 0.0);
+    
+    directed_graph_node_t_free(p_loner);
+    
+    /* The scaled heuristic finds equally short paths, settling fewer nodes. */
+    options.p_coordinates = p_store;
+    options.p_stats       = &stats;
+    p_source = p_data->p_node_array[0];
+    
+    p_path       = astar_with_options(p_source,
+                                      p_target,
+                                      p_data->p_weight_function,
+                                      NULL,
+                                      &options);
+    p_other_path = astar_with_options(p_source, 
+                                      p_target,
+                                      p_data->p_weight_function,
+                                      p_data->p_point_map,
+                                      &other_options);
+    
+    ASSERT(list_t_size(p_path) == list_t_size(p_other_path));
+    ASSERT(fabs(compute_path_cost(p_path, p_data->p_weight_function) - 
+                compute_path_cost(p_other_path, p_data->p_weight_function)) 
+           < 1e-9);
+#ifndef NO_SEARCH_STATS
+    ASSERT(stats.nodes_settled < other_stats.nodes_settled);
+#endif
+    
+    list_t_free(p_path);
+    list_t_free(p_other_path);
+    
+    ASSERT(graph_data_t_ensure_parents(p_data));
+    
+    p_path       = bidirectional_astar_with_options(p_source,
+                                                    p_target,
+                                                    p_data->p_weight_function,
+                                                    NULL,
+                                                    &options);
+    p_other_path = bidirectional_astar(p_source, 
+                                       p_target,
+                                       p_data->p_weight_function,
+                                       p_data->p_point_map);
+    
+    ASSERT(list_t_size(p_path) == list_t_size(p_other_path));
+    ASSERT(fabs(compute_path_cost(p_path, p_data->p_weight_function) - 
+                compute_path_cost(p_other_path, p_data->p_weight_function)) 
+           < 1e-9);
+    
+    list_t_free(p_path);
+    list_t_free(p_other_path);
+    
+    /* A cheaper arc lowers the scale so the estimates stay admissible. */
+    p_other = directed_graph_node_t_children(p_source)[0];
+    directed_graph_weight_function_t_put(
+            p_data->p_weight_function, 
+            p_source, 
+            p_other, 
+            0.5 * point_3d_t_distance(
+                    unordered_map_t_get(p_data->p_point_map, p_source),
+                    unordered_map_t_get(p_data->p_point_map, p_other)));
+    
+    ASSERT(coordinate_store_t_scale(p_store) == scale);
+    ASSERT(graph_data_t_ensure_coordinates(p_data));
+    ASSERT(p_data->p_coordinates == p_store);
+    ASSERT(fabs(coordinate_store_t_scale(p_store) - 0.5) < 1e-9);
+    ASSERT(coordinate_store_t_distance(p_store, p_source, p_other) <= 
+           *directed_graph_weight_function_t_get(p_data->p_weight_function, 
+                                                 p_source, 
+                                                 p_other) + 1e-9);
+}
+
+static void test_heuristic_correctness()
+{
+    coordinate_store_t*    p_store;
+    directed_graph_node_t* p_node_a;
+    directed_graph_node_t* p_node_b;
+    graph_data_t*          p_data;
+    landmark_set_t*        p_landmarks;
+    heuristic_t            parts[2];
+    heuristic_max_t        max;
+    heuristic_t            heuristic;
+    search_options_t       options;
+    list_t*                p_path;
+    list_t*                p_other_path;
+    double                 estimates[3][50];
+    double                 cost;
+    double                 great_circle;
+    double                 phi_a;
+    double                 phi_b;
+    double                 h;
+    size_t                 i;
+    size_t                 j;
+    
+    memset(&options, 0, sizeof(options));
+    
+    p_store  = coordinate_store_t_alloc(2, NULL);
+    p_node_a = directed_graph_node_t_alloc("A", NULL);
+    p_node_b = directed_graph_node_t_alloc("B", NULL);
+    
+    directed_graph_node_t_set_id(p_node_a, 0);
+    directed_graph_node_t_set_id(p_node_b, 1);
+    coordinate_store_t_set(p_store, 0, 0.0, 0.0, 0.0);
+    coordinate_store_t_set(p_store, 1, 3.0, 4.0, 12.0);
+    
+    ASSERT(coordinate_store_t_distance(p_store, p_node_a, p_node_b) == 13.0);
+    
+    coordinate_store_t_set_metric(p_store, COORDINATE_METRIC_EUCLIDEAN_2D);
+    ASSERT(coordinate_store_t_distance(p_store, p_node_a, p_node_b) == 5.0);
+    
+    coordinate_store_t_set_metric(p_store, COORDINATE_METRIC_MANHATTAN);
+    ASSERT(coordinate_store_t_distance(p_store, p_node_a, p_node_b) == 7.0);
+    
+    coordinate_store_t_set_metric(p_store, COORDINATE_METRIC_OCTILE);
+    ASSERT(fabs(coordinate_store_t_distance(p_store, p_node_a, p_node_b) - 
+                (4.0 + (sqrt(2.0) - 1.0) * 3.0)) < 1e-12);
+    
+    /* The chord from Paris to London is just short of the great circle. */
+    coordinate_store_t_set_metric(p_store, COORDINATE_METRIC_EUCLIDEAN_3D);
+    coordinate_store_t_set_geo(p_store, 0, 48.8566, 2.3522);
+    coordinate_store_t_set_geo(p_store, 1, 51.5074, -0.1278);
+    
+    phi_a = 48.8566 * M_PI / 180.0;
+    phi_b = 51.5074 * M_PI / 180.0;
+    h = pow(sin((phi_b - phi_a) / 2.0), 2.0) + 
+        cos(phi_a) * cos(phi_b) * 
+        pow(sin((-0.1278 - 2.3522) * M_PI / 360.0), 2.0);
+    great_circle = 2.0 * COORDINATE_EARTH_RADIUS * asin(sqrt(h));
+    heuristic = heuristic_coordinates(p_store);
+    cost = heuristic_t_estimate(&heuristic, p_node_a, p_node_b);
+    
+    ASSERT(great_circle > 340000.0 && great_circle < 347000.0);
+    ASSERT(cost <= great_circle && cost > 0.999 * great_circle);
+    
+    coordinate_store_t_free(p_store);
+    directed_graph_node_t_free(p_node_a);
+    directed_graph_node_t_free(p_node_b);
+    
+    /* The landmarks bound the costs of a graph from below... */
+    p_data = create_planar_graph(200, 1000.0, 1000.0, 0.0, 11);
+    
+    ASSERT(graph_data_t_ensure_parents(p_data));
+    
+    p_landmarks = landmark_set_t_alloc(p_data->p_node_array, 
+                                       p_data->node_count,
+                                       p_data->p_weight_function,
+                                       4,
+                                       NULL);
+    
+    ASSERT(landmark_set_t_size(p_landmarks) == 4);
+    ASSERT(landmark_set_t_get(p_landmarks, 0) == p_data->p_node_array[0]);
+    ASSERT(landmark_set_t_get(p_landmarks, 4) == NULL);
+    ASSERT(graph_data_t_ensure_coordinates(p_data));
+    
+    parts[0]  = heuristic_landmarks(p_landmarks);
+    parts[1]  = heuristic_coordinates(p_data->p_coordinates);
+    max.p_heuristics = parts;
+    max.count        = 2;
+    heuristic = heuristic_max(&max);
+    
+    ASSERT(!parts[0].symmetric && parts[1].symmetric && !heuristic.symmetric);
+    
+    for (j = 150; j < 200; j += 7)
+    {
+        p_node_b = p_data->p_node_array[j];
+        
+        heuristic_t_estimate_batch(&parts[0], 
+                                   p_data->p_node_array, 50, p_node_b, 
+                                   estimates[0]);
+        heuristic_t_estimate_batch(&parts[1], 
+                                   p_data->p_node_array, 50, p_node_b, 
+                                   estimates[1]);
+        heuristic_t_estimate_batch(&heuristic, 
+                                   p_data->p_node_array, 50, p_node_b, 
+                                   estimates[2]);
+        
+        for (i = 0; i < 50; ++i)
+        {
+            p_path = dijkstra(p_data->p_node_array[i], 
+                              p_node_b, 
+                              p_data->p_weight_function);
+            cost = compute_path_cost(p_path, p_data->p_weight_function);
+            
+            /* ...each alone and combined, which takes the better bound. */
+            ASSERT(estimates[0][i] <= cost + 1e-9);
+            ASSERT(estimates[2][i] <= cost + 1e-9);
+            ASSERT(estimates[2][i] == fmax(estimates[0][i], estimates[1][i]));
+            ASSERT(estimates[2][i] == 
+                   heuristic_t_estimate(&heuristic, 
+                                        p_data->p_node_array[i], 
+                                        p_node_b));
+            
+            list_t_free(p_path);
+        }
+    }
+    
+    /* Both A* searches find optimal paths with any of them. */
+    for (i = 0; i < 3; ++i)
+    {
+        options.p_heuristic = i == 2 ? &heuristic : &parts[i];
+        p_node_a = p_data->p_node_array[3 + i];
+        p_node_b = p_data->p_node_array[190 - i];
+        
+        p_other_path = dijkstra(p_node_a, p_node_b, p_data->p_weight_function);
+        cost = compute_path_cost(p_other_path, p_data->p_weight_function);
+        
+        p_path = astar_with_options(p_node_a, 
+                                    p_node_b, 
+                                    p_data->p_weight_function, 
+                                    NULL, 
+                                    &options);
+        
+        ASSERT(fabs(compute_path_cost(p_path, p_data->p_weight_function) - 
+                    cost) < 1e-9);
+        
+        list_t_free(p_path);
+        
+        p_path = bidirectional_astar_with_options(p_node_a, 
+                                                  p_node_b, 
+                                                  p_data->p_weight_function, 
+                                                  NULL, 
+                                                  &options);
+        
+        ASSERT(fabs(compute_path_cost(p_path, p_data->p_weight_function) - 
+                    cost) < 1e-9);
+        
+        list_t_free(p_path);
+        list_t_free(p_other_path);
+    }
+    
+    landmark_set_t_free(p_landmarks);
+}
+
+/*******************************************************************************
+* Checks that 'p_path' leads from 'p_source' to 'p_target' and costs at most   *
+* 1 + 'epsilon' times 'optimal_cost'.                                          *
+*******************************************************************************/
+static void check_bounded_path(list_t* p_path,
+                               directed_graph_node_t* p_source,
+                               directed_graph_node_t* p_target,
+                               directed_graph_weight_function_t* 
+                                                      p_weight_function,
+                               double optimal_cost,
+                               double epsilon)
+{
+    ASSERT(p_path && list_t_size(p_path) > 0);
+    ASSERT(is_valid_path(p_path));
+    ASSERT(list_t_get(p_path, 0) == p_source);
+    ASSERT(list_t_get(p_path, list_t_size(p_path) - 1) == p_target);
+    ASSERT(compute_path_cost(p_path, p_weight_function) <= 
+           (1.0 + epsilon) * optimal_cost + 1e-9);
+}
+
+static void test_bounded_suboptimal_correctness()
+{
+    static const double EPSILONS[] = { 0.0, 0.05, 0.5, 2.0 };
+    
+    graph_data_t*          p_data;
+    directed_graph_node_t* p_source;
+    directed_graph_node_t* p_target;
+    ara_star_t*            p_search;
+    list_t*                p_path;
+    search_stats_t         stats;
+    search_options_t       options;
+    size_t                 settled[2] = { 0, 0 };
+    double                 optimal_cost;
+    double                 cost;
+    double                 previous_cost;
+    double                 bound;
+    size_t                 i;
+    size_t                 j;
+    
+    memset(&options, 0, sizeof(options));
+    
+    p_data = create_planar_graph(400, 1000.0, 1000.0, 0.0, 13);
+    
+    ASSERT(graph_data_t_ensure_parents(p_data));
+    ASSERT(graph_data_t_ensure_coordinates(p_data));
+    
+    options.p_coordinates = p_data->p_coordinates;
+    options.p_stats       = &stats;
+    
+    ASSERT(weighted_astar(p_data->p_node_array[0], 
+                          p_data->p_node_array[1],
+                          p_data->p_weight_function, 
+                          NULL, 
+                          -0.5, 
+                          &options) == NULL);
+    
+    for (i = 0; i < 20; ++i)
+    {
+        p_source = p_data->p_node_array[(37 * i) % 400];
+        p_target = p_data->p_node_array[(101 * i + 211) % 400];
+        p_path   = dijkstra(p_source, p_target, p_data->p_weight_function);
+        optimal_cost = compute_path_cost(p_path, p_data->p_weight_function);
+        
+        list_t_free(p_path);
+        
+        for (j = 0; j < sizeof(EPSILONS) / sizeof(EPSILONS[0]); ++j)
+        {
+            p_path = weighted_astar(p_source, 
+                                    p_target, 
+                                    p_data->p_weight_function, 
+                                    NULL, 
+                                    EPSILONS[j], 
+                                    &options);
+            check_bounded_path(p_path, p_source, p_target, 
+                               p_data->p_weight_function, 
+                               optimal_cost, EPSILONS[j]);
+            list_t_free(p_path);
+            
+            if (j == 0) settled[0] += stats.nodes_settled;
+            if (j == 2) settled[1] += stats.nodes_settled;
+            
+            p_path = weighted_bidirectional_astar(p_source, 
+                                                  p_target, 
+                                                  p_data->p_weight_function, 
+                                                  NULL, 
+                                                  EPSILONS[j], 
+                                                  &options);
+            check_bounded_path(p_path, p_source, p_target, 
+                               p_data->p_weight_function, 
+                               optimal_cost, EPSILONS[j]);
+            list_t_free(p_path);
+            
+            p_path = focal_astar(p_source, 
+                                 p_target, 
+                                 p_data->p_weight_function, 
+                                 NULL, 
+                                 EPSILONS[j], 
+                                 &options);
+            check_bounded_path(p_path, p_source, p_target, 
+                               p_data->p_weight_function, 
+                               optimal_cost, EPSILONS[j]);
+            list_t_free(p_path);
+        }
+        
+        /* Each ARA* path is no worse than the one before and within its 
+           bound, and the last one is the shortest. */
+        p_search = ara_star_t_alloc(p_source, 
+                                    p_target, 
+                                    p_data->p_weight_function, 
+                                    NULL, 
+                                    2.0, 
+                                    &options);
+        previous_cost = INFINITY;
+        
+        ASSERT(ara_star_t_bound(p_search) == INFINITY);
+        
+        while ((p_path = ara_star_t_next(p_search)))
+        {
+            cost = compute_path_cost(p_path, p_data->p_weight_function);
+            
+            check_bounded_path(p_path, p_source, p_target, 
+                               p_data->p_weight_function, 
+                               optimal_cost, ara_star_t_bound(p_search));
+            ASSERT(cost <= previous_cost);
+            
+            previous_cost = cost;
+            list_t_free(p_path);
+        }
+        
+        ASSERT(ara_star_t_bound(p_search) == 0.0);
+        ASSERT(fabs(previous_cost - optimal_cost) < 1e-9);
+        
+        ara_star_t_free(p_search);
+        
+        /* Without time for more, the first path is all there is. */
+        p_path = ara_star(p_source, 
+                          p_target, 
+                          p_data->p_weight_function, 
+                          NULL, 
+                          0.5, 
+                          0, 
+                          &bound, 
+                          &options);
+        
+        ASSERT(bound <= 0.5);
+        check_bounded_path(p_path, p_source, p_target, 
+                           p_data->p_weight_function, 
+                           optimal_cost, bound);
+        list_t_free(p_path);
+    }
+    
+#ifndef NO_SEARCH_STATS
+    ASSERT(settled[1] < settled[0]);
+#endif
+}
+
+/*******************************************************************************
+* Runs the 'index'th of the searches that take a budget.                       *
+*******************************************************************************/
+static list_t* run_budgeted_search(size_t index,
+                                   directed_graph_node_t* p_source,
+                                   directed_graph_node_t* p_target,
+                                   graph_data_t* p_data,
+                                   search_options_t* p_options)
+{
+    directed_graph_weight_function_t* p_weight_function = 
+            p_data->p_weight_function;
+    
+    switch (index)
+    {
+        case 0: 
+            return dijkstra_with_options(p_source, 
+                                         p_target, 
+                                         p_weight_function, 
+                                         p_options);
+        case 1:
+            return bidirectional_dijkstra_with_options(p_source, 
+                                                       p_target, 
+                                                       p_weight_function, 
+                                                       p_options);
+        case 2:
+            return astar_with_options(p_source, 
+                                      p_target, 
+                                      p_weight_function, 
+                                      NULL, 
+                                      p_options);
+        case 3:
+            return bidirectional_astar_with_options(p_source, 
+                                                    p_target, 
+                                                    p_weight_function, 
+                                                    NULL, 
+                                                    p_options);
+        case 4:
+            return focal_astar(p_source, 
+                               p_target, 
+                               p_weight_function, 
+                               NULL, 
+                               0.1, 
+                               p_options);
+        default:
+            return ara_star(p_source, 
+                            p_target, 
+                            p_weight_function, 
+                            NULL, 
+                            0.5, 
+                            0, 
+                            NULL, 
+                            p_options);
+    }
+}
+
+static void test_search_budget_correctness()
+{
+    graph_data_t*          p_data;
+    directed_graph_node_t* p_source;
+    directed_graph_node_t* p_target;
+    directed_graph_node_t* p_loner;
+    ara_star_t*            p_search;
+    list_t*                p_path;
+    search_budget_t        budget;
+    search_stats_t         stats;
+    search_options_t       options;
+    _Atomic int            cancelled = 0;
+    size_t                 i;
+    
+    memset(&options, 0, sizeof(options));
+    
+    p_data = create_grid_graph(60, 60, 1, 10.0, 0.2, 0.0, 17);
+    
+    ASSERT(graph_data_t_ensure_parents(p_data));
+    ASSERT(graph_data_t_ensure_coordinates(p_data));
+    
+    p_source = p_data->p_node_array[0];
+    p_target = p_data->p_node_array[p_data->node_count - 1];
+    p_loner  = directed_graph_node_t_alloc("Loner", NULL);
+    
+    options.p_coordinates = p_data->p_coordinates;
+    options.p_stats       = &stats;
+    options.p_budget      = &budget;
+    
+    for (i = 0; i < 6; ++i)
+    {
+        /* Within the budget, a search runs as usual. */
+        search_budget_t_init(&budget);
+        search_budget_t_set_timeout(&budget, 60000000000ULL);
+        budget.max_settled = 1000000;
+        budget.max_memory  = 1 << 30;
+        budget.p_cancelled = &cancelled;
+        
+        p_path = run_budgeted_search(i, p_source, p_target, p_data, &options);
+        
+        ASSERT(p_path && list_t_size(p_path) > 0);
+        ASSERT(budget.status == SEARCH_STATUS_COMPLETE);
+        
+        list_t_free(p_path);
+        
+        /* An unreachable target is not a budget hit. */
+        p_path = run_budgeted_search(i, p_source, p_loner, p_data, &options);
+        
+        ASSERT(p_path && list_t_size(p_path) == 0);
+        ASSERT(budget.status == SEARCH_STATUS_COMPLETE);
+        
+        list_t_free(p_path);
+        
+        /* Each limit stops the search with its own status. */
+        budget.max_settled = 10;
+        
+        ASSERT(run_budgeted_search(i, p_source, p_target, p_data, &options) 
+               == NULL);
+        ASSERT(budget.status == SEARCH_STATUS_NODE_LIMIT);
+#ifndef NO_SEARCH_STATS
+        ASSERT(stats.nodes_settled == 10);
+#endif
+        
+        budget.max_settled = 0;
+        budget.max_memory  = 1;
+        
+        ASSERT(run_budgeted_search(i, p_source, p_target, p_data, &options) 
+               == NULL);
+        ASSERT(budget.status == SEARCH_STATUS_MEMORY_LIMIT);
+        
+        budget.max_memory  = 0;
+        budget.deadline    = 1;
+        
+        ASSERT(run_budgeted_search(i, p_source, p_target, p_data, &options) 
+               == NULL);
+        ASSERT(budget.status == SEARCH_STATUS_DEADLINE);
+        
+        budget.deadline    = 0;
+        cancelled          = 1;
+        
+        ASSERT(run_budgeted_search(i, p_source, p_target, p_data, &options) 
+               == NULL);
+        ASSERT(budget.status == SEARCH_STATUS_CANCELLED);
+        
+        cancelled          = 0;
+    }
+    
+    /* An interrupted ARA* iteration resumes where it stopped. */
+    search_budget_t_init(&budget);
+    budget.max_settled = 100;
+    p_search = ara_star_t_alloc(p_source, 
+                                p_target, 
+                                p_data->p_weight_function, 
+                                NULL, 
+                                0.0, 
+                                &options);
+    
+    ASSERT(ara_star_t_next(p_search) == NULL);
+    ASSERT(budget.status == SEARCH_STATUS_NODE_LIMIT);
+    
+    budget.max_settled = 0;
+    p_path = ara_star_t_next(p_search);
+    
+    ASSERT(p_path && list_t_size(p_path) > 0);
+    ASSERT(budget.status == SEARCH_STATUS_COMPLETE);
+    ASSERT(ara_star_t_bound(p_search) == 0.0);
+    
+    list_t_free(p_path);
+    ara_star_t_free(p_search);
+    directed_graph_node_t_free(p_loner);
+    ASSERT(strcmp(search_status_name(SEARCH_STATUS_DEADLINE), "deadline") 
+           == 0);
+}
+
+static void test_search_task_correctness()
+{
+    static const search_algorithm_t ALGORITHMS[] = {
+        SEARCH_ALGORITHM_DIJKSTRA,
+        SEARCH_ALGORITHM_ASTAR,
+        SEARCH_ALGORITHM_BIDIRECTIONAL_DIJKSTRA,
+        SEARCH_ALGORITHM_BIDIRECTIONAL_ASTAR
+    };
+    
+    graph_data_t*          p_data;
+    directed_graph_node_t* p_loner;
+    search_task_t*         p_tasks[20];
+    list_t*                p_path;
+    list_t*                p_other_path;
+    search_options_t       options;
+    bool                   running;
+    size_t                 round;
+    size_t                 i;
+    size_t                 j;
+    
+    memset(&options, 0, sizeof(options));
+    
+    p_data = create_planar_graph(300, 1000.0, 1000.0, 0.0, 19);
+    
+    ASSERT(graph_data_t_ensure_parents(p_data));
+    ASSERT(graph_data_t_ensure_coordinates(p_data));
+    
+    options.p_coordinates = p_data->p_coordinates;
+    p_loner = directed_graph_node_t_alloc("Loner", NULL);
+    
+    for (round = 0; round < 2; ++round)
+    {
+        /* Start 20 queries, five per algorithm; the second round reuses the
+           tasks of the first one. */
+        for (i = 0; i < 20; ++i)
+        {
+            if (round == 0)
+            {
+                p_tasks[i] = search_task_t_alloc(ALGORITHMS[i % 4], 
+                                                 p_data->p_weight_function, 
+                                                 NULL, 
+                                                 &options);
+                ASSERT(p_tasks[i]);
+                ASSERT(search_task_t_progress(p_tasks[i]) 
+                       == SEARCH_PROGRESS_IDLE);
+            }
+            
+            ASSERT(search_task_t_start(
+                    p_tasks[i], 
+                    p_data->p_node_array[(7 * i + round) % 
+                                         p_data->node_count],
+                    p_data->p_node_array[(31 * i + 5 * round + 3) % 
+                                         p_data->node_count]));
+        }
+        
+        /* Take turns between the tasks until all of them are done. */
+        do 
+        {
+            running = false;
+            
+            for (i = 0; i < 20; ++i)
+            {
+                if (search_task_t_step(p_tasks[i], 16) 
+                        == SEARCH_PROGRESS_RUNNING)
+                {
+                    ASSERT(search_task_t_result(p_tasks[i]) == NULL);
+                    running = true;
+                }
+            }
+        } 
+        while (running);
+        
+        for (i = 0; i < 20; ++i)
+        {
+            ASSERT(search_task_t_progress(p_tasks[i]) 
+                   == SEARCH_PROGRESS_FOUND);
+            ASSERT(search_task_t_settled(p_tasks[i]) > 0);
+            
+            p_path       = search_task_t_result(p_tasks[i]);
+            p_other_path = dijkstra(
+                    p_data->p_node_array[(7 * i + round) % 
+                                         p_data->node_count],
+                    p_data->p_node_array[(31 * i + 5 * round + 3) % 
+                                         p_data->node_count],
+                    p_data->p_weight_function);
+            
+            ASSERT(is_valid_path(p_path));
+            ASSERT(list_t_get(p_path, 0) == list_t_get(p_other_path, 0));
+            ASSERT(fabs(compute_path_cost(p_path, p_data->p_weight_function) - 
+                        compute_path_cost(p_other_path, 
+                                          p_data->p_weight_function)) 
+                   < 0.001);
+            
+            list_t_free(p_path);
+            list_t_free(p_other_path);
+        }
+    }
+    
+    /* A task proves that a node out of reach is unreachable. */
+    for (i = 0; i < 4; ++i)
+    {
+        ASSERT(search_task_t_start(p_tasks[i], 
+                                   p_data->p_node_array[0], 
+                                   p_loner));
+        
+        for (j = 0; search_task_t_step(p_tasks[i], 50) 
+                    == SEARCH_PROGRESS_RUNNING; ++j) 
+        {
+            ASSERT(j < p_data->node_count);
+        }
+        
+        ASSERT(search_task_t_progress(p_tasks[i]) 
+               == SEARCH_PROGRESS_UNREACHABLE);
+        
+        p_path = search_task_t_result(p_tasks[i]);
+        
+        ASSERT(p_path && list_t_size(p_path) == 0);
+        
+        list_t_free(p_path);
+        
+        /* A source that is its own target is found at once. */
+        ASSERT(search_task_t_start(p_tasks[i], 
+                                   p_data->p_node_array[1], 
+                                   p_data->p_node_array[1]));
+        ASSERT(search_task_t_step(p_tasks[i], 1) == SEARCH_PROGRESS_FOUND);
+        
+        p_path = search_task_t_result(p_tasks[i]);
+        
+        ASSERT(p_path && list_t_size(p_path) == 1);
+        ASSERT(list_t_get(p_path, 0) == p_data->p_node_array[1]);
+        
+        list_t_free(p_path);
+    }
+    
+    for (i = 0; i < 20; ++i) 
+    {
+        search_task_t_free(p_tasks[i]);
+    }
+    
+    /* A* needs a heuristic. */
+    ASSERT(search_task_t_alloc(SEARCH_ALGORITHM_ASTAR, 
+                               p_data->p_weight_function, 
+                               NULL, 
+                               NULL) == NULL);
+    
+    directed_graph_node_t_free(p_loner);
+}
+
+static void test_source_tree_cache_correctness()
+{
+    graph_data_t*             p_data;
+    directed_graph_node_t*    p_source;
+    directed_graph_node_t*    p_target;
+    directed_graph_node_t*    p_loner;
+    source_tree_cache_t*      p_cache;
+    source_tree_cache_stats_t stats;
+    list_t*                   p_path;
+    list_t*                   p_other_path;
+    size_t                    max_memory = 0;
+    size_t                    i;
+    
+    p_data  = create_planar_graph(300, 1000.0, 1000.0, 0.0, 23);
+    p_loner = directed_graph_node_t_alloc("Loner", NULL);
+    p_cache = source_tree_cache_t_alloc(p_data->p_weight_function, 0, NULL);
+    
+    ASSERT(p_cache);
+    
+    /* Queries from a few sources match Dijkstra's algorithm. */
+    for (i = 0; i < 200; ++i)
+    {
+        p_source = p_data->p_node_array[(i % 5) * 41];
+        p_target = p_data->p_node_array[(i * 37) % p_data->node_count];
+        
+        p_path       = source_tree_cache_t_query(p_cache, p_source, p_target);
+        p_other_path = dijkstra(p_source, p_target, p_data->p_weight_function);
+        
+        ASSERT(is_valid_path(p_path));
+        ASSERT(list_t_get(p_path, 0) == p_source);
+        ASSERT(list_t_get(p_path, list_t_size(p_path) - 1) == p_target);
+        ASSERT(fabs(compute_path_cost(p_path, p_data->p_weight_function) - 
+                    compute_path_cost(p_other_path, 
+                                      p_data->p_weight_function)) 
+               < 0.001);
+        
+        if (max_memory < source_tree_cache_t_memory_usage(p_cache))
+        {
+            max_memory = source_tree_cache_t_memory_usage(p_cache);
+        }
+        
+        list_t_free(p_path);
+        list_t_free(p_other_path);
+    }
+    
+    stats = source_tree_cache_t_stats(p_cache);
+    
+    ASSERT(source_tree_cache_t_size(p_cache) == 5);
+    ASSERT(stats.misses == 5);
+    ASSERT(stats.hits + stats.resumes == 195);
+    ASSERT(stats.hits > stats.resumes);
+    ASSERT(stats.evictions == 0);
+    
+    /* An unreachable target runs the search out, after which it is a hit. */
+    for (i = 0; i < 2; ++i)
+    {
+        p_path = source_tree_cache_t_query(p_cache, 
+                                           p_data->p_node_array[0], 
+                                           p_loner);
+        
+        ASSERT(p_path && list_t_size(p_path) == 0);
+        
+        list_t_free(p_path);
+    }
+    
+    ASSERT(source_tree_cache_t_stats(p_cache).hits == stats.hits + 1);
+    
+    /* With room for about two trees, the least recently used go first. */
+    source_tree_cache_t_free(p_cache);
+    max_memory = max_memory * 2 / 5;
+    p_cache = source_tree_cache_t_alloc(p_data->p_weight_function, 
+                                        max_memory, 
+                                        NULL);
+    
+    for (i = 0; i < 50; ++i)
+    {
+        p_path = source_tree_cache_t_query(
+                p_cache, 
+                p_data->p_node_array[(i % 5) * 41], 
+                p_data->p_node_array[(i * 37) % p_data->node_count]);
+        
+        ASSERT(is_valid_path(p_path));
+        ASSERT(source_tree_cache_t_memory_usage(p_cache) <= max_memory);
+        
+        list_t_free(p_path);
+    }
+    
+    ASSERT(source_tree_cache_t_stats(p_cache).evictions > 0);
+    
+    /* A tree that does not fit on its own is dropped after its query. */
+    source_tree_cache_t_free(p_cache);
+    p_cache = source_tree_cache_t_alloc(p_data->p_weight_function, 1, NULL);
+    p_path  = source_tree_cache_t_query(p_cache, 
+                                        p_data->p_node_array[0], 
+                                        p_data->p_node_array[1]);
+    
+    ASSERT(is_valid_path(p_path));
+    ASSERT(source_tree_cache_t_size(p_cache) == 0);
+    
+    list_t_free(p_path);
+    source_tree_cache_t_clear(p_cache);
+    
+    ASSERT(source_tree_cache_t_stats(p_cache).misses == 0);
+    
+    source_tree_cache_t_free(p_cache);
+    directed_graph_node_t_free(p_loner);
+}
+
+static void test_route_cache_correctness()
+{
+    graph_data_t*          p_data;
+    directed_graph_node_t* p_source;
+    directed_graph_node_t* p_target;
+    route_cache_t*         p_cache;
+    route_cache_stats_t    stats;
+    search_options_t       options;
+    directed_graph_weight_function_t* p_other_function;
+    list_t*                p_path;
+    list_t*                p_other_path;
+    double                 cost;
+    size_t                 max_memory;
+    size_t                 i;
+    
+    memset(&options, 0, sizeof(options));
+    
+    p_data = create_planar_graph(200, 1000.0, 1000.0, 0.0, 29);
+    
+    ASSERT(graph_data_t_ensure_parents(p_data));
+    ASSERT(graph_data_t_ensure_coordinates(p_data));
+    
+    options.p_coordinates = p_data->p_coordinates;
+    p_cache = route_cache_t_alloc(0, NULL);
+    
+    ASSERT(p_cache);
+    
+    /* Each query is searched once and then served from the cache. */
+    for (i = 0; i < 80; ++i)
+    {
+        p_source = p_data->p_node_array[(i % 10) * 13];
+        p_target = p_data->p_node_array[(i % 20) * 7 + 1];
+        p_path   = route_cache_t_query(p_cache, 
+                                       (search_algorithm_t) (i % 4), 
+                                       p_source, 
+                                       p_target, 
+                                       p_data->p_weight_function, 
+                                       NULL, 
+                                       &options);
+        p_other_path = dijkstra(p_source, p_target, p_data->p_weight_function);
+        
+        ASSERT(is_valid_path(p_path));
+        ASSERT(list_t_get(p_path, 0) == p_source);
+        ASSERT(fabs(compute_path_cost(p_path, p_data->p_weight_function) - 
+                    compute_path_cost(p_other_path, 
+                                      p_data->p_weight_function)) 
+               < 0.001);
+        
+        list_t_free(p_path);
+        list_t_free(p_other_path);
+    }
+    
+    stats = route_cache_t_stats(p_cache);
+    
+    ASSERT(stats.lookups == 80);
+    ASSERT(stats.hits == 60);
+    ASSERT(stats.insertions == 20);
+    ASSERT(route_cache_t_size(p_cache) == 20);
+    
+    p_source = p_data->p_node_array[0];
+    p_target = p_data->p_node_array[1];
+    p_path   = route_cache_t_get(p_cache, 
+                                 SEARCH_ALGORITHM_DIJKSTRA, 
+                                 p_data->p_weight_function, 
+                                 p_source, 
+                                 p_target, 
+                                 &cost);
+    
+    ASSERT(p_path);
+    ASSERT(fabs(cost - compute_path_cost(p_path, p_data->p_weight_function)) 
+           < 0.001);
+    
+    /* A change to a weight of another function keeps the paths. */
+    p_other_function = directed_graph_weight_function_t_alloc(hash_function, 
+                                                              equals_function, 
+                                                              NULL);
+    
+    ASSERT(directed_graph_weight_function_t_put(p_other_function, 
+                                                p_source, 
+                                                p_target, 
+                                                1.0));
+    ASSERT(route_cache_t_size(p_cache) == 20);
+    
+    directed_graph_weight_function_t_free(p_other_function);
+    
+    /* A change to a weight of the function drops its paths. */
+    directed_graph_weight_function_t_put(
+            p_data->p_weight_function, 
+            list_t_get(p_path, 0), 
+            list_t_get(p_path, 1), 
+            *directed_graph_weight_function_t_get(p_data->p_weight_function, 
+                                                  list_t_get(p_path, 0), 
+                                                  list_t_get(p_path, 1)));
+    list_t_free(p_path);
+    
+    ASSERT(route_cache_t_get(p_cache, 
+                             SEARCH_ALGORITHM_DIJKSTRA, 
+                             p_data->p_weight_function, 
+                             p_source, 
+                             p_target, 
+                             NULL) == NULL);
+    ASSERT(route_cache_t_size(p_cache) == 19);
+    ASSERT(route_cache_t_stats(p_cache).expirations == 1);
+    ASSERT(route_cache_t_stats(p_cache).invalidations == 0);
+    
+    /* Any change to an arc drops all the paths. */
+    directed_graph_version_bump();
+    
+    ASSERT(route_cache_t_size(p_cache) == 0);
+    ASSERT(route_cache_t_stats(p_cache).invalidations == 1);
+    
+    /* The least recently used paths make room for new ones. */
+    p_path = dijkstra(p_source, p_target, p_data->p_weight_function);
+    
+    ASSERT(route_cache_t_put(p_cache, 
+                             SEARCH_ALGORITHM_DIJKSTRA, 
+                             p_data->p_weight_function, 
+                             p_source, 
+                             p_target, 
+                             p_path));
+    
+    max_memory = route_cache_t_memory_usage(p_cache) + 64;
+    route_cache_t_free(p_cache);
+    p_cache = route_cache_t_alloc(max_memory, NULL);
+    
+    for (i = 0; i < 10; ++i)
+    {
+        ASSERT(route_cache_t_put(p_cache, 
+                                 SEARCH_ALGORITHM_DIJKSTRA, 
+                                 p_data->p_weight_function, 
+                                 p_source, 
+                                 p_data->p_node_array[i], 
+                                 p_path));
+        ASSERT(route_cache_t_memory_usage(p_cache) <= max_memory);
+        ASSERT(route_cache_t_size(p_cache) == 1);
+    }
+    
+    ASSERT(route_cache_t_stats(p_cache).evictions == 9);
+    
+    list_t_free(p_path);
+    route_cache_t_clear(p_cache);
+    
+    ASSERT(route_cache_t_stats(p_cache).insertions == 0);
+    
+    route_cache_t_free(p_cache);
+}
+
+/*******************************************************************************
+* Triples the weight of the arc or edge between each two consecutive of the    *
+* 'count' nodes of 'p_path' starting at 'first' and stores the arcs, in the    *
+* direction of the path only, in 'p_tails' and 'p_heads'.                      *
+*******************************************************************************/
+static size_t raise_path_weights(list_t* p_path,
+                                 size_t first,
+                                 size_t count,
+                                 directed_graph_weight_function_t* 
+                                                        p_weight_function,
+                                 directed_graph_node_t** p_tails,
+                                 directed_graph_node_t** p_heads)
+{
+    directed_graph_node_t* p_a;
+    directed_graph_node_t* p_b;
+    size_t                 arcs = 0;
+    size_t                 i;
+    
+    for (i = first; i + 1 < list_t_size(p_path) && i + 1 < first + count; ++i)
+    {
+        p_a = list_t_get(p_path, i);
+        p_b = list_t_get(p_path, i + 1);
+        
+        directed_graph_weight_function_t_put(
+                p_weight_function, 
+                p_a, 
+                p_b, 
+                3.0 * *directed_graph_weight_function_t_get(p_weight_function, 
+                                                            p_a, 
+                                                            p_b));
+        p_tails[arcs]   = p_a;
+        p_heads[arcs++] = p_b;
+    }
+    
+    return arcs;
+}
+
+static void test_lpa_star_correctness()
+{
+    graph_data_t*          p_data;
+    directed_graph_node_t* p_source;
+    directed_graph_node_t* p_target;
+    directed_graph_node_t* p_tails[16];
+    directed_graph_node_t* p_heads[16];
+    directed_graph_node_t* p_nodes[5];
+    char*                  names[5] = { "S", "A", "T", "U", "V" };
+    size_t                 edges[6][2] = { { 0, 1 }, { 1, 2 }, { 0, 2 }, 
+                                           { 2, 3 }, { 0, 4 }, { 4, 3 } };
+    double                 weights[6] = { 1.0, 10.0, 5.0, 1.0, 2.0, 2.0 };
+    point_3d_t             origin = { 0.0, 0.0, 0.0 };
+    directed_graph_weight_function_t* p_weight_function;
+    unordered_map_t*       p_location_map;
+    lpa_star_t*            p_search;
+    list_t*                p_path;
+    list_t*                p_other_path;
+    search_options_t       options;
+    size_t                 first_expanded;
+    size_t                 arcs;
+    size_t                 round;
+    size_t                 i;
+    
+    memset(&options, 0, sizeof(options));
+    
+    p_data = create_grid_graph(40, 40, 1, 10.0, 0.2, 0.05, 31);
+    
+    ASSERT(graph_data_t_ensure_parents(p_data));
+    ASSERT(graph_data_t_ensure_coordinates(p_data));
+    
+    options.p_coordinates = p_data->p_coordinates;
+    p_source = p_data->p_node_array[0];
+    p_target = p_data->p_node_array[p_data->node_count - 1];
+    
+    /* LPA* repairs its path after arcs on it get heavier. */
+    p_search = lpa_star_t_alloc(p_source, 
+                                p_target, 
+                                p_data->p_weight_function, 
+                                NULL, 
+                                &options);
+    p_path = lpa_star_t_path(p_search);
+    first_expanded = lpa_star_t_expanded(p_search);
+    p_other_path = dijkstra(p_source, p_target, p_data->p_weight_function);
+    
+    ASSERT(is_valid_path(p_path));
+    ASSERT(list_t_get(p_path, 0) == p_source);
+    ASSERT(fabs(compute_path_cost(p_path, p_data->p_weight_function) - 
+                compute_path_cost(p_other_path, p_data->p_weight_function)) 
+           < 0.001);
+    ASSERT(!lpa_star_t_move_source(p_search, p_target));
+    
+    list_t_free(p_other_path);
+    
+    for (round = 0; round < 3; ++round)
+    {
+        arcs = raise_path_weights(p_path, 
+                                  list_t_size(p_path) / 2, 
+                                  4, 
+                                  p_data->p_weight_function, 
+                                  p_tails, 
+                                  p_heads);
+        list_t_free(p_path);
+        
+        ASSERT(lpa_star_t_update_arcs(p_search, p_tails, p_heads, arcs));
+        
+        p_path       = lpa_star_t_path(p_search);
+        p_other_path = dijkstra(p_source, 
+                                p_target, 
+                                p_data->p_weight_function);
+        
+        ASSERT(is_valid_path(p_path));
+        ASSERT(list_t_get(p_path, 0) == p_source);
+        ASSERT(list_t_get(p_path, list_t_size(p_path) - 1) == p_target);
+        ASSERT(fabs(compute_path_cost(p_path, p_data->p_weight_function) - 
+                    compute_path_cost(p_other_path, 
+                                      p_data->p_weight_function)) 
+               < 0.001);
+        ASSERT(lpa_star_t_expanded(p_search) < first_expanded);
+        
+        list_t_free(p_other_path);
+    }
+    
+    /* Nothing changed, nothing to expand. */
+    list_t_free(p_path);
+    p_path = lpa_star_t_path(p_search);
+    
+    ASSERT(lpa_star_t_expanded(p_search) == 0);
+    
+    list_t_free(p_path);
+    lpa_star_t_free(p_search);
+    
+    /* D* Lite follows its path while arcs ahead get heavier. */
+    p_search = lpa_star_t_alloc_d_star_lite(p_source, 
+                                            p_target, 
+                                            p_data->p_weight_function, 
+                                            NULL, 
+                                            &options);
+    p_path = lpa_star_t_path(p_search);
+    
+    ASSERT(is_valid_path(p_path));
+    ASSERT(list_t_get(p_path, 0) == p_source);
+    
+    while (list_t_size(p_path) > 1)
+    {
+        p_source = list_t_get(p_path, 1);
+        arcs     = raise_path_weights(p_path, 
+                                      2, 
+                                      3, 
+                                      p_data->p_weight_function, 
+                                      p_tails, 
+                                      p_heads);
+        list_t_free(p_path);
+        
+        ASSERT(lpa_star_t_move_source(p_search, p_source));
+        ASSERT(lpa_star_t_update_arcs(p_search, p_tails, p_heads, arcs));
+        
+        p_path       = lpa_star_t_path(p_search);
+        p_other_path = dijkstra(p_source, 
+                                p_target, 
+                                p_data->p_weight_function);
+        
+        ASSERT(is_valid_path(p_path));
+        ASSERT(list_t_get(p_path, 0) == p_source);
+        ASSERT(list_t_get(p_path, list_t_size(p_path) - 1) == p_target);
+        ASSERT(fabs(compute_path_cost(p_path, p_data->p_weight_function) - 
+                    compute_path_cost(p_other_path, 
+                                      p_data->p_weight_function)) 
+               < 0.001);
+        
+        list_t_free(p_other_path);
+    }
+    
+    list_t_free(p_path);
+    lpa_star_t_free(p_search);
+    
+    /* An unreachable target yields an empty path. */
+    p_target = directed_graph_node_t_alloc("Loner", NULL);
+    p_search = lpa_star_t_alloc(p_data->p_node_array[0], 
+                                p_target, 
+                                p_data->p_weight_function, 
+                                NULL, 
+                                &options);
+    p_path   = lpa_star_t_path(p_search);
+    
+    ASSERT(p_path && list_t_size(p_path) == 0);
+    
+    list_t_free(p_path);
+    lpa_star_t_free(p_search);
+    directed_graph_node_t_free(p_target);
+    
+    /* An undirected edge reported one way round is repaired both ways. */
+    for (i = 0; i < 5; ++i)
+    {
+        p_nodes[i] = directed_graph_node_t_alloc(names[i], NULL);
+    }
+    
+    p_weight_function = directed_graph_weight_function_t_alloc_symmetric(
+            hash_function, 
+            equals_function, 
+            NULL);
+    p_location_map    = unordered_map_t_alloc(16, 
+                                              1.0f, 
+                                              hash_function, 
+                                              equals_function, 
+                                              NULL);
+    
+    for (i = 0; i < 6; ++i)
+    {
+        ASSERT(directed_graph_node_t_add_edge(p_nodes[edges[i][0]], 
+                                              p_nodes[edges[i][1]]));
+        directed_graph_weight_function_t_put(p_weight_function, 
+                                             p_nodes[edges[i][0]], 
+                                             p_nodes[edges[i][1]], 
+                                             weights[i]);
+    }
+    
+    /* All at one point, so the heuristic is zero. */
+    for (i = 0; i < 5; ++i)
+    {
+        unordered_map_t_put(p_location_map, p_nodes[i], &origin);
+    }
+    
+    for (round = 0; round < 2; ++round)
+    {
+        directed_graph_weight_function_t_put(p_weight_function, 
+                                             p_nodes[1], 
+                                             p_nodes[2], 
+                                             10.0);
+        
+        p_search = round == 0 ? 
+                   lpa_star_t_alloc(p_nodes[0], 
+                                    p_nodes[3], 
+                                    p_weight_function, 
+                                    p_location_map, 
+                                    NULL) :
+                   lpa_star_t_alloc_d_star_lite(p_nodes[0], 
+                                                p_nodes[3], 
+                                                p_weight_function, 
+                                                p_location_map, 
+                                                NULL);
+        p_path = lpa_star_t_path(p_search);
+        
+        ASSERT(compute_path_cost(p_path, p_weight_function) == 4.0);
+        
+        list_t_free(p_path);
+        
+        /* Lower A-T and report it as (T, A), against the path. */
+        directed_graph_weight_function_t_put(p_weight_function, 
+                                             p_nodes[1], 
+                                             p_nodes[2], 
+                                             1.0);
+        p_tails[0] = p_nodes[2];
+        p_heads[0] = p_nodes[1];
+        
+        ASSERT(lpa_star_t_update_arcs(p_search, p_tails, p_heads, 1));
+        
+        p_path       = lpa_star_t_path(p_search);
+        p_other_path = dijkstra(p_nodes[0], p_nodes[3], p_weight_function);
+        
+        ASSERT(compute_path_cost(p_other_path, p_weight_function) == 3.0);
+        ASSERT(compute_path_cost(p_path, p_weight_function) == 3.0);
+        
+        list_t_free(p_path);
+        list_t_free(p_other_path);
+        lpa_star_t_free(p_search);
+    }
+    
+    unordered_map_t_free(p_location_map);
+    directed_graph_weight_function_t_free(p_weight_function);
+    
+    for (i = 0; i < 5; ++i) directed_graph_node_t_free(p_nodes[i]);
+}
+
+/*******************************************************************************
+* Checks that 'p_tree' holds the same distances as a full search from          *
+* 'p_source' over the 'node_count' nodes of 'p_nodes'.                         *
+*******************************************************************************/
+static void check_shortest_path_tree(shortest_path_tree_t* p_tree,
+                                     directed_graph_node_t* p_source,
+                                     directed_graph_node_t** p_nodes,
+                                     size_t node_count,
+                                     directed_graph_weight_function_t* 
+                                                        p_weight_function)
+{
+    shortest_path_tree_t* p_fresh_tree;
+    list_t*               p_path;
+    double                distance;
+    double                fresh_distance;
+    size_t                i;
+    
+    p_fresh_tree = shortest_path_tree_t_alloc(p_source, 
+                                              p_weight_function, 
+                                              NULL);
+    
+    ASSERT(shortest_path_tree_t_size(p_tree) == 
+           shortest_path_tree_t_size(p_fresh_tree));
+    
+    for (i = 0; i < node_count; ++i)
+    {
+        distance       = shortest_path_tree_t_distance(p_tree, p_nodes[i]);
+        fresh_distance = shortest_path_tree_t_distance(p_fresh_tree, 
+                                                       p_nodes[i]);
+        
+        ASSERT(distance == fresh_distance || 
+               fabs(distance - fresh_distance) < 0.001);
+    }
+    
+    p_path = shortest_path_tree_t_path(p_tree, p_nodes[node_count - 1]);
+    
+    ASSERT(is_valid_path(p_path));
+    
+    if (list_t_size(p_path) > 0)
+    {
+        ASSERT(fabs(compute_path_cost(p_path, p_weight_function) - 
+                    shortest_path_tree_t_distance(p_tree, 
+                                                  p_nodes[node_count - 1])) 
+               < 0.001);
+    }
+    
+    list_t_free(p_path);
+    shortest_path_tree_t_free(p_fresh_tree);
+}
+
+static void test_shortest_path_tree_correctness()
+{
+    graph_data_t*          p_data;
+    directed_graph_node_t* p_source;
+    directed_graph_node_t* p_tails[8];
+    directed_graph_node_t* p_heads[8];
+    directed_graph_node_t* p_nodes[3];
+    directed_graph_node_t* p_node;
+    double                 old_distances[8];
+    shortest_path_tree_t*  p_tree;
+    directed_graph_weight_function_t* p_weight_function;
+    list_t*                p_path;
+    list_t*                p_changed;
+    list_t*                p_subtree;
+    size_t                 round;
+    size_t                 i;
+    
+    p_data = create_grid_graph(30, 30, 1, 10.0, 0.2, 0.05, 37);
+    
+    ASSERT(graph_data_t_ensure_parents(p_data));
+    
+    p_source = p_data->p_node_array[0];
+    p_tree   = shortest_path_tree_t_alloc(p_source, 
+                                          p_data->p_weight_function, 
+                                          NULL);
+    
+    ASSERT(p_tree);
+    ASSERT(shortest_path_tree_t_distance(p_tree, p_source) == 0.0);
+    ASSERT(shortest_path_tree_t_parent(p_tree, p_source) == NULL);
+    
+    check_shortest_path_tree(p_tree, 
+                             p_source, 
+                             p_data->p_node_array, 
+                             p_data->node_count, 
+                             p_data->p_weight_function);
+    
+    /* Raise and lower arcs in turn, some of them on the tree. */
+    for (round = 0; round < 6; ++round)
+    {
+        p_path = shortest_path_tree_t_path(
+                p_tree, 
+                p_data->p_node_array[(round * 211) % p_data->node_count]);
+        
+        for (i = 0; i < 8; ++i)
+        {
+            if (i < 4 && list_t_size(p_path) > i + 1)
+            {
+                p_tails[i] = list_t_get(p_path, i);
+                p_heads[i] = list_t_get(p_path, i + 1);
+            }
+            else
+            {
+                p_tails[i] = p_data->p_node_array[(round * 97 + i * 31) % 
+                                                  p_data->node_count];
+                p_heads[i] = directed_graph_node_t_child_count(p_tails[i]) > 0 ? 
+                             directed_graph_node_t_children(p_tails[i])[0] : 
+                             p_tails[i];
+            }
+        }
+        
+        for (i = 0; i < 8; ++i)
+        {
+            old_distances[i] = shortest_path_tree_t_distance(p_tree, 
+                                                             p_heads[i]);
+            
+            if (p_tails[i] == p_heads[i]) continue;
+            
+            directed_graph_weight_function_t_put(
+                    p_data->p_weight_function, 
+                    p_tails[i], 
+                    p_heads[i], 
+                    *directed_graph_weight_function_t_get(
+                            p_data->p_weight_function, 
+                            p_tails[i], 
+                            p_heads[i]) * (round % 2 == 0 ? 4.0 : 0.2));
+        }
+        
+        p_changed = shortest_path_tree_t_update(p_tree, 
+                                                p_tails, 
+                                                p_heads, 
+                                                8);
+        
+        ASSERT(p_changed);
+        ASSERT(shortest_path_tree_t_settled(p_tree) < p_data->node_count);
+        
+        check_shortest_path_tree(p_tree, 
+                                 p_source, 
+                                 p_data->p_node_array, 
+                                 p_data->node_count, 
+                                 p_data->p_weight_function);
+        
+        /* Every head whose distance changed is reported. */
+        for (i = 0; i < 8; ++i)
+        {
+            if (shortest_path_tree_t_distance(p_tree, p_heads[i]) != 
+                    old_distances[i])
+            {
+                ASSERT(list_t_contains(p_changed, p_heads[i], 
+                                       equals_function));
+            }
+        }
+        
+        list_t_free(p_changed);
+        list_t_free(p_path);
+    }
+    
+    /* Removing and restoring a tree arc cuts and rejoins its subtree. */
+    p_path = shortest_path_tree_t_path(p_tree, 
+                                       p_data->p_node_array[
+                                               p_data->node_count - 1]);
+    
+    ASSERT(list_t_size(p_path) > 1);
+    
+    p_tails[0] = list_t_get(p_path, 0);
+    p_heads[0] = list_t_get(p_path, 1);
+    p_subtree  = list_t_alloc(10, NULL);
+    
+    /* Every node whose tree path runs over the arc loses that path. */
+    for (i = 0; i < p_data->node_count; ++i)
+    {
+        for (p_node = p_data->p_node_array[i]; 
+             p_node && p_node != p_heads[0]; 
+             p_node = shortest_path_tree_t_parent(p_tree, p_node))
+        {
+        }
+        
+        if (p_node) list_t_push_back(p_subtree, p_data->p_node_array[i]);
+    }
+    
+    ASSERT(list_t_size(p_subtree) > 0);
+    
+    /* The grid is undirected, so the arc goes with its edge. */
+    ASSERT(directed_graph_node_t_remove_arc(p_tails[0], p_heads[0]));
+    ASSERT(p_changed = shortest_path_tree_t_update(p_tree, 
+                                                   p_tails, 
+                                                   p_heads, 
+                                                   1));
+    
+    for (i = 0; i < list_t_size(p_subtree); ++i)
+    {
+        ASSERT(list_t_contains(p_changed, 
+                               list_t_get(p_subtree, i), 
+                               equals_function));
+    }
+    
+    list_t_free(p_changed);
+    check_shortest_path_tree(p_tree, 
+                             p_source, 
+                             p_data->p_node_array, 
+                             p_data->node_count, 
+                             p_data->p_weight_function);
+    
+    ASSERT(directed_graph_node_t_add_edge(p_tails[0], p_heads[0]));
+    ASSERT(p_changed = shortest_path_tree_t_update(p_tree, 
+                                                   p_tails, 
+                                                   p_heads, 
+                                                   1));
+    
+    for (i = 0; i < list_t_size(p_subtree); ++i)
+    {
+        ASSERT(list_t_contains(p_changed, 
+                               list_t_get(p_subtree, i), 
+                               equals_function));
+    }
+    
+    list_t_free(p_changed);
+    check_shortest_path_tree(p_tree, 
+                             p_source, 
+                             p_data->p_node_array, 
+                             p_data->node_count, 
+                             p_data->p_weight_function);
+    
+    list_t_free(p_subtree);
+    list_t_free(p_path);
+    shortest_path_tree_t_free(p_tree);
+    
+    /* An arc to an unreached node reports the node it reaches. */
+    p_nodes[0]        = directed_graph_node_t_alloc("S", NULL);
+    p_nodes[1]        = directed_graph_node_t_alloc("A", NULL);
+    p_nodes[2]        = directed_graph_node_t_alloc("B", NULL);
+    p_weight_function = directed_graph_weight_function_t_alloc(hash_function,
+                                                               equals_function,
+                                                               NULL);
+    
+    ASSERT(directed_graph_node_t_add_arc(p_nodes[0], p_nodes[1]));
+    directed_graph_weight_function_t_put(p_weight_function, 
+                                         p_nodes[0], 
+                                         p_nodes[1], 
+                                         1.0);
+    
+    p_tree = shortest_path_tree_t_alloc(p_nodes[0], p_weight_function, NULL);
+    
+    ASSERT(shortest_path_tree_t_distance(p_tree, p_nodes[2]) == INFINITY);
+    ASSERT(directed_graph_node_t_add_arc(p_nodes[1], p_nodes[2]));
+    directed_graph_weight_function_t_put(p_weight_function, 
+                                         p_nodes[1], 
+                                         p_nodes[2], 
+                                         2.0);
+    
+    p_tails[0] = p_nodes[1];
+    p_heads[0] = p_nodes[2];
+    
+    ASSERT(p_changed = shortest_path_tree_t_update(p_tree, 
+                                                   p_tails, 
+                                                   p_heads, 
+                                                   1));
+    ASSERT(shortest_path_tree_t_distance(p_tree, p_nodes[2]) == 3.0);
+    ASSERT(list_t_size(p_changed) == 1);
+    ASSERT(list_t_get(p_changed, 0) == p_nodes[2]);
+    
+    list_t_free(p_changed);
+    shortest_path_tree_t_free(p_tree);
+    directed_graph_weight_function_t_free(p_weight_function);
+    
+    for (i = 0; i < 3; ++i) directed_graph_node_t_free(p_nodes[i]);
+}
+
+/*******************************************************************************
+* Returns the earliest arrival at 'p_target' when leaving 'p_source' at        *
+* 'departure', relaxing every arc of the 'node_count' nodes of 'p_nodes' until *
+* no arrival improves.                                                         *
+*******************************************************************************/
+static double td_earliest_arrival(directed_graph_node_t** p_nodes, 
+                                  size_t node_count, 
+                                  td_weight_function_t* p_weight_function, 
+                                  directed_graph_node_t* p_source, 
+                                  directed_graph_node_t* p_target, 
+                                  double departure)
+{
+    double* p_arrivals = malloc(sizeof(double) * node_count);
+    double  arrival;
+    bool    changed    = true;
+    size_t  i;
+    size_t  j;
+    size_t  k;
+    
+    for (i = 0; i < node_count; ++i) 
+    {
+        p_arrivals[i] = p_nodes[i] == p_source ? departure : INFINITY;
+    }
+    
+    while (changed)
+    {
+        changed = false;
+        
+        for (i = 0; i < node_count; ++i)
+        {
+            if (p_arrivals[i] == INFINITY) continue;
+            
+            for (j = 0; j < directed_graph_node_t_child_count(p_nodes[i]); ++j)
+            {
+                directed_graph_node_t* p_child = 
+                        directed_graph_node_t_children(p_nodes[i])[j];
+                
+                arrival = p_arrivals[i] + 
+                          td_weight_function_t_evaluate(p_weight_function, 
+                                                        p_nodes[i], 
+                                                        p_child, 
+                                                        p_arrivals[i]);
+                
+                for (k = 0; p_nodes[k] != p_child; ++k) ;
+                
+                if (arrival < p_arrivals[k] - 1e-9)
+                {
+                    p_arrivals[k] = arrival;
+                    changed       = true;
+                }
+            }
+        }
+    }
+    
+    for (i = 0; p_nodes[i] != p_target; ++i) ;
+    
+    arrival = p_arrivals[i];
+    free(p_arrivals);
+    return arrival;
+}
+
+static void test_td_search_correctness()
+{
+    graph_data_t*          p_data;
+    td_weight_function_t*  p_function;
+    directed_graph_weight_function_t* p_bounds;
+    directed_graph_node_t* p_tail;
+    directed_graph_node_t* p_head;
+    directed_graph_node_t* p_source;
+    directed_graph_node_t* p_target;
+    list_t*                p_path;
+    list_t*                p_static_path;
+    double                 times[3];
+    double                 durations[3];
+    double                 weight;
+    double                 arrival;
+    double                 astar_arrival;
+    size_t                 round;
+    size_t                 i;
+    size_t                 j;
+    
+    p_data     = create_grid_graph(12, 12, 1, 10.0, 0.2, 0.05, 41);
+    p_function = td_weight_function_t_alloc(hash_function, 
+                                            equals_function, 
+                                            NULL);
+    
+    ASSERT(p_function);
+    
+    p_tail = p_data->p_node_array[0];
+    p_head = directed_graph_node_t_children(p_tail)[0];
+    
+    /* Functions with no breakpoints, or not FIFO, are rejected. */
+    times[0] = 0.0;  durations[0] = 10.0;
+    times[1] = 5.0;  durations[1] = 2.0;
+    
+    ASSERT(!td_weight_function_t_put(p_function, p_tail, p_head, 
+                                     times, durations, 0));
+    ASSERT(!td_weight_function_t_put(p_function, p_tail, p_head, 
+                                     times, durations, 2));
+    
+    times[1] = 0.0;  durations[1] = 10.0;
+    
+    ASSERT(!td_weight_function_t_put(p_function, p_tail, p_head, 
+                                     times, durations, 2));
+    ASSERT(td_weight_function_t_evaluate(p_function, p_tail, p_head, 0.0) 
+           == INFINITY);
+    
+    /* Rush hour triples the static weights, twice over to exercise the 
+       reuse of the breakpoints of replaced functions. */
+    for (round = 0; round < 2; ++round)
+    {
+        for (i = 0; i < p_data->node_count; ++i)
+        {
+            p_tail = p_data->p_node_array[i];
+            
+            for (j = 0; j < directed_graph_node_t_child_count(p_tail); ++j)
+            {
+                p_head = directed_graph_node_t_children(p_tail)[j];
+                weight = *directed_graph_weight_function_t_get(
+                        p_data->p_weight_function, 
+                        p_tail, 
+                        p_head);
+                
+                times[0] = 20.0 * (i % 5);
+                times[1] = times[0] + 100.0;
+                times[2] = times[1] + 100.0;
+                durations[0] = weight;
+                durations[1] = 3.0 * weight;
+                durations[2] = weight;
+                
+                ASSERT(td_weight_function_t_put(p_function, p_tail, p_head, 
+                                                times, durations, 3));
+            }
+        }
+    }
+    
+    ASSERT(td_weight_function_t_memory_usage(p_function) > 0);
+    
+    /* Travel times are interpolated, and constant outside the breakpoints. */
+    p_tail = p_data->p_node_array[0];
+    p_head = directed_graph_node_t_children(p_tail)[0];
+    weight = *directed_graph_weight_function_t_get(p_data->p_weight_function, 
+                                                   p_tail, 
+                                                   p_head);
+    
+    ASSERT(td_weight_function_t_evaluate(p_function, p_tail, p_head, -5.0) 
+           == weight);
+    ASSERT(fabs(td_weight_function_t_evaluate(p_function, p_tail, p_head, 
+                                              50.0) - 2.0 * weight) < 1e-9);
+    ASSERT(td_weight_function_t_evaluate(p_function, p_tail, p_head, 100.0) 
+           == 3.0 * weight);
+    ASSERT(td_weight_function_t_evaluate(p_function, p_tail, p_head, 1e6) 
+           == weight);
+    
+    /* The least travel times are the static weights. */
+    p_bounds = directed_graph_weight_function_t_alloc(hash_function, 
+                                                      equals_function, 
+                                                      NULL);
+    
+    ASSERT(td_weight_function_t_lower_bounds(p_function, p_bounds));
+    ASSERT(*directed_graph_weight_function_t_get(p_bounds, p_tail, p_head) 
+           == weight);
+    
+    directed_graph_weight_function_t_free(p_bounds);
+    
+    /* The searches arrive as early as possible at any departure time. */
+    for (round = 0; round < 8; ++round)
+    {
+        p_source = p_data->p_node_array[(round * 17) % p_data->node_count];
+        p_target = p_data->p_node_array[(round * 53 + 101) % 
+                                        p_data->node_count];
+        p_path   = td_dijkstra(p_source, 
+                               p_target, 
+                               p_function, 
+                               round * 25.0, 
+                               &arrival, 
+                               NULL);
+        
+        ASSERT(p_path);
+        ASSERT(fabs(arrival - td_earliest_arrival(p_data->p_node_array, 
+                                                  p_data->node_count, 
+                                                  p_function, 
+                                                  p_source, 
+                                                  p_target, 
+                                                  round * 25.0)) < 1e-6);
+        
+        if (arrival < INFINITY)
+        {
+            ASSERT(is_valid_path(p_path));
+            ASSERT(list_t_get(p_path, 0) == p_source);
+            ASSERT(fabs(td_weight_function_t_arrival(p_function, 
+                                                     p_path, 
+                                                     round * 25.0) - 
+                        arrival) < 1e-6);
+        }
+        
+        list_t_free(p_path);
+        p_path = td_astar(p_source, 
+                          p_target, 
+                          p_function, 
+                          round * 25.0, 
+                          &astar_arrival, 
+                          p_data->p_point_map, 
+                          NULL);
+        
+        ASSERT(p_path);
+        ASSERT(astar_arrival == arrival || 
+               fabs(astar_arrival - arrival) < 1e-6);
+        
+        list_t_free(p_path);
+    }
+    
+    /* Long after the rush hour the static shortest paths are the fastest. */
+    p_source      = p_data->p_node_array[0];
+    p_target      = p_data->p_node_array[p_data->node_count - 1];
+    p_path        = td_dijkstra(p_source, p_target, p_function, 1e6, 
+                                &arrival, NULL);
+    p_static_path = dijkstra(p_source, p_target, p_data->p_weight_function);
+    
+    ASSERT(fabs(arrival - 1e6 - 
+                compute_path_cost(p_static_path, p_data->p_weight_function)) 
+           < 1e-6);
+    
+    list_t_free(p_path);
+    list_t_free(p_static_path);
+    td_weight_function_t_free(p_function);
+}
+
+static void test_weight_profiles_correctness()
+{
+    graph_data_t*          p_data;
+    weight_profiles_t*     p_profiles;
+    directed_graph_weight_function_t* p_car;
+    directed_graph_weight_function_t* p_truck;
+    directed_graph_node_t* p_source;
+    directed_graph_node_t* p_target;
+    directed_graph_node_t* p_tail;
+    directed_graph_node_t* p_head;
+    list_t*                p_path;
+    list_t*                p_other_path;
+    double*                p_weights;
+    size_t                 arc_count = 0;
+    size_t                 arc;
+    uint64_t               version;
+    size_t                 i;
+    
+    p_data = create_grid_graph(20, 20, 1, 10.0, 0.2, 0.05, 43);
+    
+    ASSERT(graph_data_t_ensure_parents(p_data));
+    
+    for (i = 0; i < p_data->node_count; ++i) 
+    {
+        arc_count += directed_graph_node_t_child_count(
+                p_data->p_node_array[i]);
+    }
+    
+    p_profiles = weight_profiles_t_alloc(p_data->p_node_array, 
+                                         p_data->node_count, 
+                                         NULL);
+    
+    /* The grid is undirected, and each edge is numbered once. */
+    arc_count /= 2;
+    
+    ASSERT(p_profiles);
+    ASSERT(weight_profiles_t_arc_count(p_profiles) == arc_count);
+    ASSERT(weight_profiles_t_add(p_profiles, p_data->p_weight_function) == 0);
+    ASSERT(weight_profiles_t_add(p_profiles, NULL) == 1);
+    ASSERT(weight_profiles_t_add(p_profiles, p_data->p_weight_function) == 2);
+    ASSERT(weight_profiles_t_size(p_profiles) == 3);
+    ASSERT(weight_profiles_t_weight_function(p_profiles, 3) == NULL);
+    ASSERT(weight_profiles_t_weights(p_profiles, 1)[0] == INFINITY);
+    
+    /* Trucks take half as long again over every arc. */
+    p_weights = weight_profiles_t_weights(p_profiles, 1);
+    
+    for (i = 0; i < arc_count; ++i) 
+    {
+        p_weights[i] = 1.5 * weight_profiles_t_weights(p_profiles, 0)[i];
+    }
+    
+    p_car   = weight_profiles_t_weight_function(p_profiles, 0);
+    p_truck = weight_profiles_t_weight_function(p_profiles, 1);
+    
+    directed_graph_weight_function_t_changed(p_truck);
+    
+    /* Every search runs on any profile. */
+    for (i = 0; i < 10; ++i)
+    {
+        p_source = p_data->p_node_array[(i * 37) % p_data->node_count];
+        p_target = p_data->p_node_array[(i * 91 + 13) % p_data->node_count];
+        
+        p_path       = dijkstra(p_source, p_target, p_car);
+        p_other_path = dijkstra(p_source, 
+                                p_target, 
+                                p_data->p_weight_function);
+        
+        ASSERT(fabs(compute_path_cost(p_path, p_car) - 
+                    compute_path_cost(p_other_path, 
+                                      p_data->p_weight_function)) < 0.001);
+        
+        list_t_free(p_path);
+        p_path = bidirectional_dijkstra(p_source, p_target, p_truck);
+        
+        ASSERT(is_valid_path(p_path));
+        ASSERT(fabs(compute_path_cost(p_path, p_truck) - 
+                    1.5 * compute_path_cost(p_other_path, 
+                                            p_data->p_weight_function)) 
+               < 0.001);
+        
+        list_t_free(p_path);
+        list_t_free(p_other_path);
+    }
+    
+    /* A weight put into a profile lands in its array and nowhere else. */
+    p_tail = p_data->p_node_array[0];
+    p_head = directed_graph_node_t_children(p_tail)[0];
+    arc    = weight_profiles_t_arc_index(p_profiles, p_tail, p_head);
+    
+    ASSERT(arc < arc_count);
+    ASSERT(weight_profiles_t_arc_index(p_profiles, p_head, p_tail) == arc);
+    ASSERT(weight_profiles_t_arc_index(p_profiles, p_tail, p_tail) == 
+           WEIGHT_PROFILE_NONE);
+    ASSERT(directed_graph_weight_function_t_get(p_car, p_tail, p_tail) 
+           == NULL);
+    ASSERT(directed_graph_weight_function_t_put(
+            weight_profiles_t_weight_function(p_profiles, 2), 
+            p_tail, 
+            p_head, 
+            1000.0));
+    ASSERT(weight_profiles_t_weights(p_profiles, 2)[arc] == 1000.0);
+    
+    /* Both directions of the edge read the weight put either way. */
+    ASSERT(*directed_graph_weight_function_t_get(
+            weight_profiles_t_weight_function(p_profiles, 2), 
+            p_head, 
+            p_tail) == 1000.0);
+    ASSERT(directed_graph_weight_function_t_put(
+            weight_profiles_t_weight_function(p_profiles, 2), 
+            p_head, 
+            p_tail, 
+            2000.0));
+    ASSERT(*directed_graph_weight_function_t_get(
+            weight_profiles_t_weight_function(p_profiles, 2), 
+            p_tail, 
+            p_head) == 2000.0);
+    ASSERT(*directed_graph_weight_function_t_get(p_car, p_tail, p_head) == 
+           *directed_graph_weight_function_t_get(p_data->p_weight_function, 
+                                                 p_tail, 
+                                                 p_head));
+    
+    /* Replacing a profile leaves the others alone, but not the caches. */
+    version = directed_graph_weight_function_t_version(p_truck);
+    
+    ASSERT(weight_profiles_t_load(p_profiles, 1, p_data->p_weight_function));
+    ASSERT(directed_graph_weight_function_t_version(p_truck) != version);
+    ASSERT(weight_profiles_t_weights(p_profiles, 1)[arc] == 
+           weight_profiles_t_weights(p_profiles, 0)[arc]);
+    ASSERT(weight_profiles_t_weights(p_profiles, 2)[arc] == 2000.0);
+    ASSERT(!weight_profiles_t_load(p_profiles, 3, NULL));
+    
+    /* Three profiles take less than the one hashed weight function. */
+    ASSERT(weight_profiles_t_memory_usage(p_profiles) < 
+           directed_graph_weight_function_t_memory_usage(
+                   p_data->p_weight_function));
+    
+    weight_profiles_t_free(p_profiles);
+}
+
+static void test_memory_usage_correctness()
+{
+    unordered_map_t* p_map;
+    graph_data_t*    p_grid;
+    size_t           empty_usage;
+    size_t           usage;
+    size_t           i;
+    
+    p_map = unordered_map_t_alloc(16,
+                                  1.0f,
+                                  hash_function,
+                                  equals_function,
+                                  NULL);
+    empty_usage = unordered_map_t_memory_usage(p_map);
+    
+    /* An entry holds five pointers. */
+    unordered_map_t_put(p_map, p_map, NULL);
+    
+    ASSERT(unordered_map_t_memory_usage(p_map) == 
+           empty_usage + memory_block_size(5 * sizeof(void*)));
+    
+    unordered_map_t_free(p_map);
+    
+    p_grid = create_grid_graph(3, 2, 1, 10.0, 0.0, 0.0, 7);
+    usage  = directed_graph_weight_function_t_memory_usage(
+                    p_grid->p_weight_function);
+    
+    for (i = 0; i < p_grid->node_count; ++i)
+    {
+        usage += directed_graph_node_t_memory_usage(p_grid->p_node_array[i]);
+    }
+    
+    ASSERT(graph_data_t_memory_usage(p_grid) > usage);
+    
+    /* The nodes of a grid are undirected and take no reverse arcs. */
+    usage = graph_data_t_memory_usage(p_grid);
+    
+    ASSERT(graph_data_t_ensure_parents(p_grid));
+    ASSERT(graph_data_t_memory_usage(p_grid) == 
+           usage + memory_block_size(sizeof(directed_graph_node_t*)));
+    
+#ifndef NO_SEARCH_STATS
+    search_stats_t   stats;
+    search_options_t options;
+    
+    memset(&options, 0, sizeof(options));
+    options.p_stats = &stats;
+    
+    list_t_free(dijkstra_with_options(p_grid->p_node_array[0], 
+                                      p_grid->p_node_array[5], 
+                                      p_grid->p_weight_function, 
+                                      &options));
+    
+    ASSERT(stats.peak_memory > 0);
+#endif
+}
+
+typedef struct counting_allocator_t {
+    size_t allocations;
+    size_t live_blocks;
+} counting_allocator_t;
+
+static void* counting_alloc(void* p_context, size_t size)
+{
+    counting_allocator_t* p_counter = p_context;
+    void*                 p_block   = malloc(size);
+
+    if (p_block)
+    {
+        p_counter->allocations++;
+        p_counter->live_blocks++;
+    }
+
+    return p_block;
+}
+
+static void* counting_realloc(void* p_context, void* p_block, size_t size)
+{
+    counting_allocator_t* p_counter = p_context;
+
+    if (!p_block) return counting_alloc(p_context, size);
+
+    p_counter->allocations++;
+    return realloc(p_block, size);
+}
+
+static void counting_free(void* p_context, void* p_block)
+{
+    counting_allocator_t* p_counter = p_context;
+
+    p_counter->live_blocks--;
+    free(p_block);
+}
+
+static void test_allocator_correctness()
+{
+    counting_allocator_t              counter = { 0, 0 };
+    allocator_t                       allocator = { counting_alloc,
+                                                    counting_realloc,
+                                                    counting_free,
+                                                    &counter };
+    directed_graph_node_t*            p_nodes[4];
+    directed_graph_weight_function_t* p_weight_function;
+    search_options_t                  options;
+    list_t*                           p_path;
+    size_t                            allocations;
+    size_t                            i;
+
+    memset(&options, 0, sizeof(options));
+    options.p_allocator = &allocator;
+
+    p_nodes[0] = directed_graph_node_t_alloc("A", &allocator);
+    p_nodes[1] = directed_graph_node_t_alloc("B", &allocator);
+    p_nodes[2] = directed_graph_node_t_alloc("C", &allocator);
+    p_nodes[3] = directed_graph_node_t_alloc("D", &allocator);
+    p_weight_function = directed_graph_weight_function_t_alloc(hash_function,
+                                                               equals_function,
+                                                               &allocator);
+
+    for (i = 0; i < 3; ++i)
+    {
+        directed_graph_node_t_add_arc(p_nodes[i], p_nodes[i + 1]);
+        directed_graph_weight_function_t_put(p_weight_function,
+                                             p_nodes[i],
+                                             p_nodes[i + 1],
+                                             1.0);
+    }
+
+    /* Overwriting a weight must release the old one. */
+    directed_graph_weight_function_t_put(p_weight_function,
+                                         p_nodes[0],
+                                         p_nodes[1],
+                                         2.0);
+
+    ASSERT(counter.allocations > 0);
+    allocations = counter.allocations;
+
+    p_path = dijkstra_with_options(p_nodes[0],
+                                   p_nodes[3],
+                                   p_weight_function,
+                                   &options);
+
+    ASSERT(list_t_size(p_path) == 4);
+    ASSERT(counter.allocations > allocations);
+
+    /* The path comes from the C library. */
+    list_t_free(p_path);
+
+    /* The weight function hashes the nodes, so free it first. */
+    directed_graph_weight_function_t_free(p_weight_function);
+
+    for (i = 0; i < 4; ++i) directed_graph_node_t_free(p_nodes[i]);
+
+    ASSERT(counter.live_blocks == 0);
+}
+
 static const size_t NODES = 20000;
-static const size_t EDGES = NODES * 9;
-static const double MAXX = 10000.0;
-static const double MAXY = 10000.0;
-static const double MAXZ = 200.0;
-static const double MAX_DISTANCE = 800.0;
 
+/*******************************************************************************
+* Usage: cpathfinding [FAMILY [NODES [SEED]]], where FAMILY is one of "random" *
+* (the default), "grid", "grid3d", "planar" and "highway".                     *
+*        cpathfinding bench [OPTIONS] runs the benchmark; see 'benchmark.h'.   *
+*        cpathfinding microbench [OPTIONS] runs the container benchmarks; see  *
+*        'microbench.h'.                                                       *
+*        cpathfinding replay FILE [OPTIONS] replays a saved heap trace.        *
+*******************************************************************************/
 int main(int argc, char** argv) {
-    graph_data_t* p_data;
-    clock_t       c;
-    int           seed = time(NULL);
-    double        duration;
-    list_t*       p_path;
-    size_t        i;
+    graph_data_t*    p_data;
+    search_options_t options;
+    clock_t          c;
+    int              seed = time(NULL);
+    double           duration;
+    list_t*          p_path;
+    size_t           i;
+    size_t           nodes = NODES;
+    const char*      p_family = "random";
     
     directed_graph_node_t* p_source;
     directed_graph_node_t* p_target;
     
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        return benchmark_main(argc - 1, argv + 1);
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "microbench") == 0)
+    {
+        return microbench_main(argc - 1, argv + 1);
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "replay") == 0)
+    {
+        return microbench_replay_main(argc - 1, argv + 1);
+    }
+    
+    if (argc > 1) p_family = argv[1];
+    if (argc > 2) nodes    = (size_t) strtoul(argv[2], NULL, 10);
+    if (argc > 3) seed     = atoi(argv[3]);
+    
+    if (!is_graph_family(p_family))
+    {
+        fprintf(stderr, "Unknown graph family: %s\n", p_family);
+        return (EXIT_FAILURE);
+    }
+    
     printf("Seed: %d\n", seed);
     srand(seed);
     
     test_directed_graph_node_correctness();
+    test_adjacency_correctness();
+    test_undirected_correctness();
     test_weight_function_correctness();
     test_dijkstra_correctness();
     test_bidirectional_dijkstra_correctness();
+    test_graph_generators_correctness();
+    test_coordinate_store_correctness();
+    test_heuristic_correctness();
+    test_bounded_suboptimal_correctness();
+    test_search_budget_correctness();
+    test_search_task_correctness();
+    test_source_tree_cache_correctness();
+    test_route_cache_correctness();
+    test_lpa_star_correctness();
+    test_shortest_path_tree_correctness();
+    test_td_search_correctness();
+    test_weight_profiles_correctness();
+    test_memory_usage_correctness();
+    test_allocator_correctness();
     
     c = clock();
-    p_data = create_random_graph(NODES, EDGES, MAXX, MAXY, MAXZ, MAX_DISTANCE);
+    p_data = create_graph_family(p_family, nodes, seed);
+    
+    if (!p_data)
+    {
+        fprintf(stderr, "Could not build the graph.\n");
+        return (EXIT_FAILURE);
+    }
     
     duration = ((double) clock() - c);
-    printf("Built the graph in %f seconds.\n", duration / CLOCKS_PER_SEC);
+    printf("Built the %s graph of %zu nodes in %f seconds.\n", 
+           p_family,
+           p_data->node_count,
+           duration / CLOCKS_PER_SEC);
     
-    p_source = choose(p_data->p_node_array, NODES);
-    p_target = choose(p_data->p_node_array, NODES);
+    p_source = choose(p_data->p_node_array, p_data->node_count);
+    p_target = choose(p_data->p_node_array, p_data->node_count);
     
     printf("Source: %s\n", directed_graph_node_t_to_string(p_source));
     printf("Target: %s\n", directed_graph_node_t_to_string(p_target));
@@ -397,12 +2914,26 @@ int main(int argc, char** argv) {
            compute_path_cost(p_path, p_data->p_weight_function));
     
     /**** ASTAR ALGORITHM ****/
+    
+    /* The coordinates are packed by node id for the batched heuristic. */
+    if (!graph_data_t_ensure_coordinates(p_data))
+    {
+        fprintf(stderr, "Could not pack the coordinates.\n");
+        return (EXIT_FAILURE);
+    }
+    
+    memset(&options, 0, sizeof(options));
+    options.p_coordinates = p_data->p_coordinates;
+    printf("Heuristic batches use %s.\n", 
+           coordinate_simd_name(coordinate_simd_best()));
+    
     c = clock();
     
-    p_path = astar(p_source, 
-                   p_target, 
-                   p_data->p_weight_function, 
-                   p_data->p_point_map);
+    p_path = astar_with_options(p_source, 
+                                p_target, 
+                                p_data->p_weight_function, 
+                                p_data->p_point_map,
+                                &options);
     
     duration = ((double) clock() - c);
     
@@ -421,6 +2952,19 @@ int main(int argc, char** argv) {
     /**** BIDIRECTIONAL DIJKSTRA'S ALGORITHM ****/
     c = clock();
     
+    /* The backward searches need the parents, which are built on demand. */
+    if (!graph_data_t_ensure_parents(p_data))
+    {
+        fprintf(stderr, "Could not build the reverse arcs.\n");
+        return (EXIT_FAILURE);
+    }
+    
+    duration = ((double) clock() - c);
+    printf("Built the reverse arcs in %f seconds.\n", 
+           duration / CLOCKS_PER_SEC);
+    
+    c = clock();
+    
     p_path = bidirectional_dijkstra(p_source, 
                                     p_target, 
                                     p_data->p_weight_function);
@@ -444,10 +2988,11 @@ int main(int argc, char** argv) {
     /**** BIDIRECTIONAL ASTAR ALGORITHM ****/
     c = clock();
     
-    p_path = bidirectional_astar(p_source, 
-                                 p_target, 
-                                 p_data->p_weight_function,
-                                 p_data->p_point_map);
+    p_path = bidirectional_astar_with_options(p_source, 
+                                              p_target, 
+                                              p_data->p_weight_function,
+                                              p_data->p_point_map,
+                                              &options);
     
     duration = ((double) clock() - c);
     
@@ -0,0 +1,40 @@
+#include "memory_usage.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+/* Blocks at least this large are mapped directly from the system. */
+static const size_t MMAP_THRESHOLD = 128 * 1024;
+static const size_t PAGE_SIZE      = 4096;
+static const size_t ALIGNMENT      = 16;
+static const size_t MINIMUM_CHUNK  = 4 * sizeof(size_t);
+
+size_t memory_block_size(size_t bytes)
+{
+    size_t chunk = bytes + sizeof(size_t);
+
+    if (chunk >= MMAP_THRESHOLD)
+    {
+        /* A mapped chunk keeps two words of bookkeeping. */
+        chunk = bytes + 2 * sizeof(size_t);
+        return (chunk + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    }
+
+    chunk = (chunk + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    return chunk < MINIMUM_CHUNK ? MINIMUM_CHUNK : chunk;
+}
+
+size_t memory_block_usage(void* p_block, size_t bytes)
+{
+    if (!p_block) return 0;
+
+#ifdef __GLIBC__
+    bytes = malloc_usable_size(p_block);
+
+    /* A mapped chunk keeps two words of bookkeeping, others keep one. */
+    return bytes + (bytes >= MMAP_THRESHOLD ? 2 : 1) * sizeof(size_t);
+#else
+    return memory_block_size(bytes);
+#endif
+}
@@ -0,0 +1,30 @@
+#ifndef MEMORY_USAGE_H
+#define	MEMORY_USAGE_H
+
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * Returns the number of bytes the allocator takes for a block of 'bytes'   *
+    * requested bytes, including its bookkeeping and alignment. This follows   *
+    * the chunk layout of the GNU C library; elsewhere it assumes a word of    *
+    * bookkeeping and 16-byte alignment.                                       *
+    ***************************************************************************/
+    size_t memory_block_size(size_t bytes);
+
+    /***************************************************************************
+    * Returns the number of bytes the allocator took for the block 'p_block',  *
+    * which was allocated with 'bytes' requested bytes. The GNU C library      *
+    * reports the exact figure; elsewhere this equals 'memory_block_size'.     *
+    * Returns zero if 'p_block' is NULL.                                       *
+    ***************************************************************************/
+    size_t memory_block_usage(void* p_block, size_t bytes);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* MEMORY_USAGE_H */
@@ -0,0 +1,1214 @@
+#include "microbench.h"
+#include "dijkstra.h"
+#include "graph_generators.h"
+#include "heap.h"
+#include "heap_trace.h"
+#include "list.h"
+#include "unordered_map.h"
+#include "unordered_set.h"
+#include "utils.h"
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+static const size_t DEFAULT_SIZES[]        = { 1000, 10000, 100000, 1000000 };
+static const float  DEFAULT_LOAD_FACTORS[] = { 0.75f, 1.0f, 2.0f };
+static const size_t DEFAULT_DEGREES[]      = { 2, 4, 8 };
+
+static const char* DISTRIBUTION_NAMES[MICROBENCH_DISTRIBUTION_COUNT] = {
+    "sequential",
+    "uniform",
+    "clustered",
+    "strided"
+};
+
+/* Keeps the compiler from optimizing away the lookups being measured. */
+static volatile size_t sink;
+
+/*******************************************************************************
+* The splitmix64 finalizer. It is a bijection, so distinct inputs stay         *
+* distinct.                                                                    *
+*******************************************************************************/
+static uint64_t mix(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static size_t identity_hash(void* p_key)
+{
+    return (size_t) p_key;
+}
+
+static size_t mixing_hash(void* p_key)
+{
+    return (size_t) mix((uint64_t) (uintptr_t) p_key);
+}
+
+static bool key_equals(void* p_a, void* p_b)
+{
+    return p_a == p_b;
+}
+
+const char* microbench_distribution_name(
+        microbench_distribution_t distribution)
+{
+    if (distribution >= MICROBENCH_DISTRIBUTION_COUNT) return "unknown";
+
+    return DISTRIBUTION_NAMES[distribution];
+}
+
+void microbench_keys(microbench_distribution_t distribution,
+                     size_t first,
+                     size_t size,
+                     unsigned int seed,
+                     size_t* p_keys)
+{
+    size_t   i;
+    uint64_t index;
+
+    for (i = 0; i < size; ++i)
+    {
+        index = first + i;
+
+        switch (distribution)
+        {
+            case MICROBENCH_UNIFORM:
+                p_keys[i] = (size_t) mix(index ^ ((uint64_t) seed << 40));
+                break;
+
+            case MICROBENCH_CLUSTERED:
+                p_keys[i] = (size_t) (mix((index >> 6) ^
+                                          ((uint64_t) seed << 40)) << 6 |
+                                      (index & 63));
+                break;
+
+            case MICROBENCH_STRIDED:
+                p_keys[i] = (size_t) ((index + 1) << 12);
+                break;
+
+            default:
+                p_keys[i] = (size_t) (index + 1);
+                break;
+        }
+
+        /* Zero is the only key that never occurs. */
+        if (p_keys[i] == 0) p_keys[i] = (size_t) -1;
+    }
+}
+
+static unsigned long long now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int double_cmp(const void* pa, const void* pb)
+{
+    double a = *(const double*) pa;
+    double b = *(const double*) pb;
+
+    if (a < b) return -1;
+    if (a > b) return 1;
+    return 0;
+}
+
+/*******************************************************************************
+* Appends to 'p_results' the result of an operation that was run               *
+* 'operations' times in each of the 'repetitions' measured nanosecond times    *
+* in 'p_times'. Sorts 'p_times'.                                               *
+*******************************************************************************/
+static void add_result(list_t*      p_results,
+                       const char*  p_container,
+                       const char*  p_operation,
+                       const char*  p_distribution,
+                       size_t       size,
+                       double       parameter,
+                       size_t       operations,
+                       double*      p_times,
+                       size_t       repetitions)
+{
+    microbench_result_t* p_result = malloc(sizeof(*p_result));
+
+    if (!p_result) return;
+
+    qsort(p_times, repetitions, sizeof(double), double_cmp);
+
+    if (operations == 0) operations = 1;
+
+    p_result->p_container             = p_container;
+    p_result->p_operation             = p_operation;
+    p_result->p_distribution          = p_distribution;
+    p_result->size                    = size;
+    p_result->parameter               = parameter;
+    p_result->operations              = operations;
+    p_result->best_ns_per_operation   = p_times[0] / operations;
+    p_result->median_ns_per_operation = p_times[repetitions / 2] / operations;
+
+    list_t_push_back(p_results, p_result);
+}
+
+/*******************************************************************************
+* Measures insertion, lookups of present and absent keys, iteration and        *
+* removal on 'unordered_map_t'.                                                *
+*******************************************************************************/
+static void bench_map(microbench_config_t*      p_config,
+                      size_t                    size,
+                      float                     load_factor,
+                      microbench_distribution_t distribution,
+                      size_t*                   p_keys,
+                      size_t*                   p_missing_keys,
+                      double*                   p_times,
+                      list_t*                   p_results)
+{
+    static const char* OPERATIONS[] = {
+        "put", "get_hit", "get_miss", "iterate", "remove"
+    };
+
+    const size_t              repetitions = p_config->repetitions;
+    unordered_map_t*          p_map;
+    unordered_map_iterator_t* p_iterator;
+    void*                     p_key;
+    void*                     p_value;
+    unsigned long long        t[6];
+    size_t                    r;
+    size_t                    i;
+
+    for (r = 0; r < repetitions; ++r)
+    {
+        p_map = unordered_map_t_alloc(INITIAL_CAPACITY,
+                                      load_factor,
+                                      p_config->mix_hash ? mixing_hash :
+                                                           identity_hash,
+                                      key_equals,
+                                      NULL);
+        t[0] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            unordered_map_t_put(p_map, (void*) p_keys[i], (void*) p_keys[i]);
+        }
+
+        t[1] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            sink += (size_t) unordered_map_t_get(p_map, (void*) p_keys[i]);
+        }
+
+        t[2] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            sink += (size_t) unordered_map_t_get(p_map,
+                                                 (void*) p_missing_keys[i]);
+        }
+
+        t[3] = now();
+        p_iterator = unordered_map_iterator_t_alloc(p_map);
+
+        while (unordered_map_iterator_t_has_next(p_iterator))
+        {
+            unordered_map_iterator_t_next(p_iterator, &p_key, &p_value);
+            sink += (size_t) p_value;
+        }
+
+        unordered_map_iterator_t_free(p_iterator);
+        t[4] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            unordered_map_t_remove(p_map, (void*) p_keys[i]);
+        }
+
+        t[5] = now();
+        unordered_map_t_free(p_map);
+
+        for (i = 0; i < 5; ++i)
+        {
+            p_times[i * repetitions + r] = (double) (t[i + 1] - t[i]);
+        }
+    }
+
+    for (i = 0; i < 5; ++i)
+    {
+        add_result(p_results,
+                   "map",
+                   OPERATIONS[i],
+                   microbench_distribution_name(distribution),
+                   size,
+                   load_factor,
+                   size,
+                   &p_times[i * repetitions],
+                   repetitions);
+    }
+}
+
+/*******************************************************************************
+* Measures insertion, lookups of present and absent keys, iteration and        *
+* removal on 'unordered_set_t'.                                                *
+*******************************************************************************/
+static void bench_set(microbench_config_t*      p_config,
+                      size_t                    size,
+                      float                     load_factor,
+                      microbench_distribution_t distribution,
+                      size_t*                   p_keys,
+                      size_t*                   p_missing_keys,
+                      double*                   p_times,
+                      list_t*                   p_results)
+{
+    static const char* OPERATIONS[] = {
+        "add", "contains_hit", "contains_miss", "iterate", "remove"
+    };
+
+    const size_t              repetitions = p_config->repetitions;
+    unordered_set_t*          p_set;
+    unordered_set_iterator_t* p_iterator;
+    void*                     p_key;
+    unsigned long long        t[6];
+    size_t                    r;
+    size_t                    i;
+
+    for (r = 0; r < repetitions; ++r)
+    {
+        p_set = unordered_set_t_alloc(INITIAL_CAPACITY,
+                                      load_factor,
+                                      p_config->mix_hash ? mixing_hash :
+                                                           identity_hash,
+                                      key_equals,
+                                      NULL);
+        t[0] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            unordered_set_t_add(p_set, (void*) p_keys[i]);
+        }
+
+        t[1] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            sink += unordered_set_t_contains(p_set, (void*) p_keys[i]);
+        }
+
+        t[2] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            sink += unordered_set_t_contains(p_set, (void*) p_missing_keys[i]);
+        }
+
+        t[3] = now();
+        p_iterator = unordered_set_iterator_t_alloc(p_set);
+
+        while (unordered_set_iterator_t_has_next(p_iterator))
+        {
+            unordered_set_iterator_t_next(p_iterator, &p_key);
+            sink += (size_t) p_key;
+        }
+
+        unordered_set_iterator_t_free(p_iterator);
+        t[4] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            unordered_set_t_remove(p_set, (void*) p_keys[i]);
+        }
+
+        t[5] = now();
+        unordered_set_t_free(p_set);
+
+        for (i = 0; i < 5; ++i)
+        {
+            p_times[i * repetitions + r] = (double) (t[i + 1] - t[i]);
+        }
+    }
+
+    for (i = 0; i < 5; ++i)
+    {
+        add_result(p_results,
+                   "set",
+                   OPERATIONS[i],
+                   microbench_distribution_name(distribution),
+                   size,
+                   load_factor,
+                   size,
+                   &p_times[i * repetitions],
+                   repetitions);
+    }
+}
+
+/*******************************************************************************
+* Measures appending, indexing and removing at both ends of 'list_t'.          *
+*******************************************************************************/
+static void bench_list(microbench_config_t* p_config,
+                       size_t               size,
+                       size_t*              p_keys,
+                       double*              p_times,
+                       list_t*              p_results)
+{
+    static const char* OPERATIONS[] = {
+        "push_back", "get", "pop_back", "push_front", "pop_front"
+    };
+
+    const size_t       repetitions = p_config->repetitions;
+    list_t*            p_list;
+    unsigned long long t[6];
+    size_t             r;
+    size_t             i;
+
+    for (r = 0; r < repetitions; ++r)
+    {
+        p_list = list_t_alloc(INITIAL_CAPACITY, NULL);
+        t[0] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            list_t_push_back(p_list, (void*) p_keys[i]);
+        }
+
+        t[1] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            sink += (size_t) list_t_get(p_list, i);
+        }
+
+        t[2] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            sink += (size_t) list_t_pop_back(p_list);
+        }
+
+        t[3] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            list_t_push_front(p_list, (void*) p_keys[i]);
+        }
+
+        t[4] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            sink += (size_t) list_t_pop_front(p_list);
+        }
+
+        t[5] = now();
+        list_t_free(p_list);
+
+        for (i = 0; i < 5; ++i)
+        {
+            p_times[i * repetitions + r] = (double) (t[i + 1] - t[i]);
+        }
+    }
+
+    for (i = 0; i < 5; ++i)
+    {
+        add_result(p_results,
+                   "list",
+                   OPERATIONS[i],
+                   "-",
+                   size,
+                   0.0,
+                   size,
+                   &p_times[i * repetitions],
+                   repetitions);
+    }
+}
+
+/*******************************************************************************
+* Measures insertion and extraction of random priorities on 'heap_t', and      *
+* lowering every priority of a full heap.                                      *
+*******************************************************************************/
+static void bench_heap(microbench_config_t*      p_config,
+                       size_t                    size,
+                       size_t                    degree,
+                       microbench_distribution_t distribution,
+                       size_t*                   p_keys,
+                       weight_t*                 p_priorities,
+                       weight_t*                 p_lower_priorities,
+                       double*                   p_times,
+                       list_t*                   p_results)
+{
+    static const char* OPERATIONS[] = {
+        "add", "extract_min", "decrease_key"
+    };
+
+    const size_t       repetitions = p_config->repetitions;
+    heap_t*            p_heap;
+    unsigned long long t[5];
+    size_t             r;
+    size_t             i;
+
+    for (r = 0; r < repetitions; ++r)
+    {
+        p_heap = heap_t_alloc(degree,
+                              INITIAL_CAPACITY,
+                              LOAD_FACTOR,
+                              p_config->mix_hash ? mixing_hash :
+                                                   identity_hash,
+                              key_equals,
+                              priority_cmp,
+                              NULL);
+        t[0] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            heap_t_add(p_heap, (void*) p_keys[i], &p_priorities[i]);
+        }
+
+        t[1] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            sink += (size_t) heap_t_extract_min(p_heap);
+        }
+
+        t[2] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            heap_t_add(p_heap, (void*) p_keys[i], &p_priorities[i]);
+        }
+
+        t[3] = now();
+
+        for (i = 0; i < size; ++i)
+        {
+            heap_t_decrease_key(p_heap, (void*) p_keys[i],
+                                &p_lower_priorities[i]);
+        }
+
+        t[4] = now();
+        heap_t_free(p_heap);
+
+        p_times[0 * repetitions + r] = (double) (t[1] - t[0]);
+        p_times[1 * repetitions + r] = (double) (t[2] - t[1]);
+        p_times[2 * repetitions + r] = (double) (t[4] - t[3]);
+    }
+
+    for (i = 0; i < 3; ++i)
+    {
+        add_result(p_results,
+                   "heap",
+                   OPERATIONS[i],
+                   microbench_distribution_name(distribution),
+                   size,
+                   (double) degree,
+                   size,
+                   &p_times[i * repetitions],
+                   repetitions);
+    }
+}
+
+/*******************************************************************************
+* Replays the trace against a fresh heap of given degree.                      *
+*******************************************************************************/
+static void bench_trace(microbench_config_t* p_config,
+                        heap_trace_t*        p_trace,
+                        const char*          p_source,
+                        size_t               degree,
+                        double*              p_times,
+                        list_t*              p_results)
+{
+    heap_t*            p_heap;
+    heap_trace_queue_t queue;
+    unsigned long long start;
+    size_t             r;
+
+    for (r = 0; r < p_config->repetitions; ++r)
+    {
+        p_heap = heap_t_alloc(degree,
+                              INITIAL_CAPACITY,
+                              LOAD_FACTOR,
+                              p_config->mix_hash ? mixing_hash :
+                                                   identity_hash,
+                              key_equals,
+                              priority_cmp,
+                              NULL);
+        heap_trace_queue_t_init_heap(&queue, p_heap);
+
+        start = now();
+        heap_trace_t_replay(p_trace, &queue);
+        p_times[r] = (double) (now() - start);
+
+        heap_t_free(p_heap);
+    }
+
+    add_result(p_results,
+               "heap",
+               "dijkstra_trace",
+               p_source,
+               heap_trace_t_elements(p_trace),
+               (double) degree,
+               heap_trace_t_size(p_trace),
+               p_times,
+               p_config->repetitions);
+}
+
+/*******************************************************************************
+* Copies 'count' elements of 'size' bytes each from 'p_source' to a new array. *
+*******************************************************************************/
+static void* copy_array(const void* p_source, size_t count, size_t size)
+{
+    void* p_ret = malloc(count * size);
+
+    if (p_ret) memcpy(p_ret, p_source, count * size);
+
+    return p_ret;
+}
+
+bool microbench_config_t_init(microbench_config_t* p_config)
+{
+    if (!p_config) return false;
+
+    p_config->size_count        = sizeof(DEFAULT_SIZES) /
+                                  sizeof(DEFAULT_SIZES[0]);
+    p_config->load_factor_count = sizeof(DEFAULT_LOAD_FACTORS) /
+                                  sizeof(DEFAULT_LOAD_FACTORS[0]);
+    p_config->degree_count      = sizeof(DEFAULT_DEGREES) /
+                                  sizeof(DEFAULT_DEGREES[0]);
+    p_config->p_sizes           = copy_array(DEFAULT_SIZES,
+                                             p_config->size_count,
+                                             sizeof(size_t));
+    p_config->p_load_factors    = copy_array(DEFAULT_LOAD_FACTORS,
+                                             p_config->load_factor_count,
+                                             sizeof(float));
+    p_config->p_degrees         = copy_array(DEFAULT_DEGREES,
+                                             p_config->degree_count,
+                                             sizeof(size_t));
+    p_config->distributions     = (1u << MICROBENCH_DISTRIBUTION_COUNT) - 1;
+    p_config->mix_hash          = true;
+    p_config->repetitions       = 3;
+    p_config->seed              = (unsigned int) time(NULL);
+    p_config->p_trace_family    = "grid";
+    p_config->trace_nodes       = 10000;
+    p_config->trace_queries     = 10;
+    p_config->p_trace_file      = NULL;
+    p_config->p_save_trace_file = NULL;
+    p_config->format            = BENCHMARK_FORMAT_TEXT;
+    p_config->p_output_file     = NULL;
+
+    return p_config->p_sizes && p_config->p_load_factors
+                             && p_config->p_degrees;
+}
+
+void microbench_config_t_free(microbench_config_t* p_config)
+{
+    if (!p_config) return;
+
+    free(p_config->p_sizes);
+    free(p_config->p_load_factors);
+    free(p_config->p_degrees);
+
+    p_config->p_sizes        = NULL;
+    p_config->p_load_factors = NULL;
+    p_config->p_degrees      = NULL;
+}
+
+/*******************************************************************************
+* Returns the number of comma-separated items in 'p_value'.                    *
+*******************************************************************************/
+static size_t count_items(const char* p_value)
+{
+    size_t count = 1;
+
+    for (; *p_value; ++p_value)
+    {
+        if (*p_value == ',') ++count;
+    }
+
+    return count;
+}
+
+/*******************************************************************************
+* Parses a comma-separated list of positive integers into a new array.         *
+*******************************************************************************/
+static bool parse_size_list(const char* p_value,
+                            size_t**    pp_list,
+                            size_t*     p_count)
+{
+    size_t* p_list;
+    char*   p_end;
+    size_t  count = count_items(p_value);
+    size_t  i;
+
+    if (!(p_list = malloc(sizeof(size_t) * count))) return false;
+
+    for (i = 0; i < count; ++i)
+    {
+        p_list[i] = (size_t) strtoull(p_value, &p_end, 10);
+
+        if (p_end == p_value || p_list[i] == 0)
+        {
+            free(p_list);
+            return false;
+        }
+
+        p_value = p_end + 1;
+    }
+
+    free(*pp_list);
+    *pp_list = p_list;
+    *p_count = count;
+    return true;
+}
+
+/*******************************************************************************
+* Parses a comma-separated list of positive decimals into a new array.         *
+*******************************************************************************/
+static bool parse_float_list(const char* p_value,
+                             float**     pp_list,
+                             size_t*     p_count)
+{
+    float* p_list;
+    char*  p_end;
+    size_t count = count_items(p_value);
+    size_t i;
+
+    if (!(p_list = malloc(sizeof(float) * count))) return false;
+
+    for (i = 0; i < count; ++i)
+    {
+        p_list[i] = strtof(p_value, &p_end);
+
+        if (p_end == p_value || p_list[i] <= 0.0f)
+        {
+            free(p_list);
+            return false;
+        }
+
+        p_value = p_end + 1;
+    }
+
+    free(*pp_list);
+    *pp_list = p_list;
+    *p_count = count;
+    return true;
+}
+
+/*******************************************************************************
+* Parses a comma-separated list of distribution names, or "all".               *
+*******************************************************************************/
+static bool parse_distributions(const char* p_value, unsigned int* p_mask)
+{
+    unsigned int mask = 0;
+    size_t       length;
+    size_t       i;
+
+    if (strcmp(p_value, "all") == 0)
+    {
+        *p_mask = (1u << MICROBENCH_DISTRIBUTION_COUNT) - 1;
+        return true;
+    }
+
+    while (*p_value)
+    {
+        length = strcspn(p_value, ",");
+
+        for (i = 0; i < MICROBENCH_DISTRIBUTION_COUNT; ++i)
+        {
+            if (strlen(DISTRIBUTION_NAMES[i]) == length
+                    && strncmp(p_value, DISTRIBUTION_NAMES[i], length) == 0)
+            {
+                mask |= 1u << i;
+                break;
+            }
+        }
+
+        if (i == MICROBENCH_DISTRIBUTION_COUNT) return false;
+
+        p_value += length;
+
+        if (*p_value == ',') ++p_value;
+    }
+
+    *p_mask = mask;
+    return mask != 0;
+}
+
+static void print_usage(void)
+{
+    fprintf(stderr,
+            "Usage: cpathfinding microbench [--sizes N,...] "
+            "[--load-factors F,...]\n"
+            "       [--degrees N,...] [--distributions NAME,...|all] "
+            "[--hash identity|mix]\n"
+            "       [--repetitions N] [--seed N] [--trace-family NAME]\n"
+            "       [--trace-nodes N] [--trace-queries N] "
+            "[--trace-file FILE]\n"
+            "       [--save-trace FILE] [--format text|csv|json] "
+            "[--output FILE]\n");
+}
+
+bool microbench_config_t_parse(microbench_config_t* p_config,
+                               int argc,
+                               char** argv)
+{
+    int         i;
+    bool        ok = true;
+    const char* p_option;
+    const char* p_value;
+
+    if (!p_config) return false;
+
+    for (i = 1; i < argc && ok; ++i)
+    {
+        p_option = argv[i];
+
+        if (i + 1 >= argc)
+        {
+            print_usage();
+            return false;
+        }
+
+        p_value = argv[++i];
+
+        if (strcmp(p_option, "--sizes") == 0)
+        {
+            ok = parse_size_list(p_value,
+                                 &p_config->p_sizes,
+                                 &p_config->size_count);
+        }
+        else if (strcmp(p_option, "--load-factors") == 0)
+        {
+            ok = parse_float_list(p_value,
+                                  &p_config->p_load_factors,
+                                  &p_config->load_factor_count);
+        }
+        else if (strcmp(p_option, "--degrees") == 0)
+        {
+            ok = parse_size_list(p_value,
+                                 &p_config->p_degrees,
+                                 &p_config->degree_count);
+        }
+        else if (strcmp(p_option, "--distributions") == 0)
+        {
+            ok = parse_distributions(p_value, &p_config->distributions);
+        }
+        else if (strcmp(p_option, "--hash") == 0)
+        {
+            ok = strcmp(p_value, "identity") == 0 ||
+                 strcmp(p_value, "mix") == 0;
+            p_config->mix_hash = strcmp(p_value, "mix") == 0;
+        }
+        else if (strcmp(p_option, "--repetitions") == 0)
+        {
+            p_config->repetitions = (size_t) strtoul(p_value, NULL, 10);
+            ok = p_config->repetitions > 0;
+        }
+        else if (strcmp(p_option, "--seed") == 0)
+        {
+            p_config->seed = (unsigned int) strtoul(p_value, NULL, 10);
+        }
+        else if (strcmp(p_option, "--trace-family") == 0)
+        {
+            p_config->p_trace_family = p_value;
+            ok = is_graph_family(p_value);
+        }
+        else if (strcmp(p_option, "--trace-nodes") == 0)
+        {
+            p_config->trace_nodes = (size_t) strtoul(p_value, NULL, 10);
+        }
+        else if (strcmp(p_option, "--trace-queries") == 0)
+        {
+            p_config->trace_queries = (size_t) strtoul(p_value, NULL, 10);
+            ok = p_config->trace_queries > 0;
+        }
+        else if (strcmp(p_option, "--trace-file") == 0)
+        {
+            p_config->p_trace_file = p_value;
+        }
+        else if (strcmp(p_option, "--save-trace") == 0)
+        {
+            p_config->p_save_trace_file = p_value;
+        }
+        else if (strcmp(p_option, "--output") == 0)
+        {
+            p_config->p_output_file = p_value;
+        }
+        else if (strcmp(p_option, "--format") == 0)
+        {
+            if (strcmp(p_value, "text") == 0)
+            {
+                p_config->format = BENCHMARK_FORMAT_TEXT;
+            }
+            else if (strcmp(p_value, "csv") == 0)
+            {
+                p_config->format = BENCHMARK_FORMAT_CSV;
+            }
+            else if (strcmp(p_value, "json") == 0)
+            {
+                p_config->format = BENCHMARK_FORMAT_JSON;
+            }
+            else
+            {
+                ok = false;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option: %s\n", p_option);
+            print_usage();
+            return false;
+        }
+    }
+
+    if (!ok)
+    {
+        fprintf(stderr, "Invalid value for %s: %s\n", p_option, p_value);
+        return false;
+    }
+
+    return true;
+}
+
+static void print_text(FILE* p_out, microbench_config_t* p_config,
+                       list_t* p_results)
+{
+    microbench_result_t* p_result;
+    size_t               i;
+
+    fprintf(p_out, "Seed: %u, repetitions: %zu, hash: %s\n",
+            p_config->seed,
+            p_config->repetitions,
+            p_config->mix_hash ? "mix" : "identity");
+    fprintf(p_out, "%-5s %-15s %-12s %10s %6s %12s %10s %10s %8s\n",
+            "cont", "operation", "keys", "size", "param", "operations",
+            "best_ns", "median_ns", "Mops/s");
+
+    for (i = 0; i < list_t_size(p_results); ++i)
+    {
+        p_result = list_t_get(p_results, i);
+
+        fprintf(p_out, "%-5s %-15s %-12s %10zu %6.2f %12zu %10.2f %10.2f "
+                       "%8.2f\n",
+                p_result->p_container,
+                p_result->p_operation,
+                p_result->p_distribution,
+                p_result->size,
+                p_result->parameter,
+                p_result->operations,
+                p_result->best_ns_per_operation,
+                p_result->median_ns_per_operation,
+                p_result->best_ns_per_operation > 0.0 ?
+                    1000.0 / p_result->best_ns_per_operation : 0.0);
+    }
+}
+
+static void print_csv(FILE* p_out, microbench_config_t* p_config,
+                      list_t* p_results)
+{
+    microbench_result_t* p_result;
+    size_t               i;
+
+    fprintf(p_out, "container,operation,keys,size,parameter,operations,"
+                   "best_ns,median_ns,hash,seed,repetitions\n");
+
+    for (i = 0; i < list_t_size(p_results); ++i)
+    {
+        p_result = list_t_get(p_results, i);
+
+        fprintf(p_out, "%s,%s,%s,%zu,%.2f,%zu,%.3f,%.3f,%s,%u,%zu\n",
+                p_result->p_container,
+                p_result->p_operation,
+                p_result->p_distribution,
+                p_result->size,
+                p_result->parameter,
+                p_result->operations,
+                p_result->best_ns_per_operation,
+                p_result->median_ns_per_operation,
+                p_config->mix_hash ? "mix" : "identity",
+                p_config->seed,
+                p_config->repetitions);
+    }
+}
+
+static void print_json(FILE* p_out, microbench_config_t* p_config,
+                       list_t* p_results)
+{
+    microbench_result_t* p_result;
+    size_t               i;
+
+    fprintf(p_out, "{\n  \"seed\": %u,\n  \"repetitions\": %zu,\n"
+                   "  \"hash\": \"%s\",\n  \"results\": [\n",
+            p_config->seed,
+            p_config->repetitions,
+            p_config->mix_hash ? "mix" : "identity");
+
+    for (i = 0; i < list_t_size(p_results); ++i)
+    {
+        p_result = list_t_get(p_results, i);
+
+        fprintf(p_out, "    { \"container\": \"%s\", \"operation\": \"%s\", "
+                       "\"keys\": \"%s\", \"size\": %zu, "
+                       "\"parameter\": %.2f, \"operations\": %zu, "
+                       "\"best_ns\": %.3f, \"median_ns\": %.3f }%s\n",
+                p_result->p_container,
+                p_result->p_operation,
+                p_result->p_distribution,
+                p_result->size,
+                p_result->parameter,
+                p_result->operations,
+                p_result->best_ns_per_operation,
+                p_result->median_ns_per_operation,
+                i + 1 < list_t_size(p_results) ? "," : "");
+    }
+
+    fprintf(p_out, "  ]\n}\n");
+}
+
+/*******************************************************************************
+* Loads the trace file of the configuration, or records the trace of random    *
+* Dijkstra queries on a generated graph, and replays it with each heap degree. *
+*******************************************************************************/
+static bool run_trace(microbench_config_t* p_config,
+                      double*              p_times,
+                      list_t*              p_results)
+{
+    graph_data_t*     p_data;
+    heap_trace_t*     p_trace;
+    search_options_t  options;
+    const char*       p_source;
+    size_t            i;
+
+    if (p_config->p_trace_file)
+    {
+        p_trace  = heap_trace_t_read(p_config->p_trace_file);
+        p_source = "file";
+
+        if (!p_trace)
+        {
+            fprintf(stderr, "Could not read the trace %s.\n",
+                    p_config->p_trace_file);
+            return false;
+        }
+    }
+    else
+    {
+        p_data = create_graph_family(p_config->p_trace_family,
+                                     p_config->trace_nodes,
+                                     p_config->seed);
+
+        if (!p_data || !(p_trace = heap_trace_t_alloc())) return false;
+
+        memset(&options, 0, sizeof(options));
+        options.p_heap_trace = p_trace;
+        p_source = p_config->p_trace_family;
+        srand(p_config->seed);
+
+        for (i = 0; i < p_config->trace_queries; ++i)
+        {
+            list_t_free(dijkstra_with_options(
+                    choose(p_data->p_node_array, p_data->node_count),
+                    choose(p_data->p_node_array, p_data->node_count),
+                    p_data->p_weight_function,
+                    &options));
+        }
+
+        if (heap_trace_t_is_truncated(p_trace))
+        {
+            heap_trace_t_free(p_trace);
+            return false;
+        }
+    }
+
+    if (p_config->p_save_trace_file
+            && !heap_trace_t_write(p_trace, p_config->p_save_trace_file))
+    {
+        fprintf(stderr, "Could not write the trace %s.\n",
+                p_config->p_save_trace_file);
+    }
+
+    for (i = 0; i < p_config->degree_count; ++i)
+    {
+        bench_trace(p_config,
+                    p_trace,
+                    p_source,
+                    p_config->p_degrees[i],
+                    p_times,
+                    p_results);
+    }
+
+    heap_trace_t_free(p_trace);
+    return true;
+}
+
+/*******************************************************************************
+* Runs the benchmarks of a parsed configuration and frees it.                  *
+*******************************************************************************/
+static int run(microbench_config_t* p_config)
+{
+    microbench_distribution_t distribution;
+    list_t*                   p_results;
+    size_t*                   p_keys = NULL;
+    size_t*                   p_missing_keys = NULL;
+    weight_t*                 p_priorities = NULL;
+    weight_t*                 p_lower_priorities = NULL;
+    double*                   p_times = NULL;
+    FILE*                     p_out;
+    /* At least one, so that the key arrays exist when replaying a file. */
+    size_t                    max_size = 1;
+    size_t                    size;
+    int                       status = EXIT_SUCCESS;
+    size_t                    i;
+    size_t                    j;
+
+    for (i = 0; i < p_config->size_count; ++i)
+    {
+        if (max_size < p_config->p_sizes[i]) max_size = p_config->p_sizes[i];
+    }
+
+    p_results          = list_t_alloc(INITIAL_CAPACITY, NULL);
+    p_keys             = malloc(sizeof(size_t) * max_size);
+    p_missing_keys     = malloc(sizeof(size_t) * max_size);
+    p_priorities       = malloc(sizeof(weight_t) * max_size);
+    p_lower_priorities = malloc(sizeof(weight_t) * max_size);
+    p_times            = malloc(sizeof(double) * 5 * p_config->repetitions);
+
+    if (!p_results || !p_keys || !p_missing_keys || !p_priorities
+            || !p_lower_priorities || !p_times)
+    {
+        fprintf(stderr, "Could not allocate %zu keys.\n", max_size);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < max_size; ++i)
+    {
+        p_priorities[i].weight = (double) (mix(i ^ p_config->seed) >> 11) /
+                                 (double) (1ULL << 53);
+        p_lower_priorities[i].weight = p_priorities[i].weight *
+                                       (double) (mix(~i) >> 11) /
+                                       (double) (1ULL << 53);
+    }
+
+    for (i = 0; i < p_config->size_count; ++i)
+    {
+        size = p_config->p_sizes[i];
+
+        microbench_keys(MICROBENCH_SEQUENTIAL, 0, size, p_config->seed, p_keys);
+        bench_list(p_config, size, p_keys, p_times, p_results);
+
+        for (distribution = 0;
+             distribution < MICROBENCH_DISTRIBUTION_COUNT;
+             ++distribution)
+        {
+            if (!(p_config->distributions & (1u << distribution))) continue;
+
+            microbench_keys(distribution, 0, size, p_config->seed, p_keys);
+            microbench_keys(distribution, size, size, p_config->seed,
+                            p_missing_keys);
+
+            for (j = 0; j < p_config->load_factor_count; ++j)
+            {
+                bench_map(p_config, size, p_config->p_load_factors[j],
+                          distribution, p_keys, p_missing_keys, p_times,
+                          p_results);
+                bench_set(p_config, size, p_config->p_load_factors[j],
+                          distribution, p_keys, p_missing_keys, p_times,
+                          p_results);
+            }
+
+            for (j = 0; j < p_config->degree_count; ++j)
+            {
+                bench_heap(p_config, size, p_config->p_degrees[j], distribution,
+                           p_keys, p_priorities, p_lower_priorities, p_times,
+                           p_results);
+            }
+        }
+    }
+
+    if ((p_config->trace_nodes > 0 || p_config->p_trace_file)
+            && !run_trace(p_config, p_times, p_results))
+    {
+        fprintf(stderr, "Could not replay the Dijkstra trace.\n");
+
+        /* A trace file that cannot be read is a user error. */
+        if (p_config->p_trace_file) status = EXIT_FAILURE;
+    }
+
+    p_out = p_config->p_output_file ? fopen(p_config->p_output_file, "w") :
+                                      stdout;
+
+    if (!p_out)
+    {
+        fprintf(stderr, "Could not open %s.\n", p_config->p_output_file);
+        return EXIT_FAILURE;
+    }
+
+    switch (p_config->format)
+    {
+        case BENCHMARK_FORMAT_CSV:
+            print_csv(p_out, p_config, p_results);
+            break;
+
+        case BENCHMARK_FORMAT_JSON:
+            print_json(p_out, p_config, p_results);
+            break;
+
+        default:
+            print_text(p_out, p_config, p_results);
+            break;
+    }
+
+    if (p_out != stdout) fclose(p_out);
+
+    for (i = 0; i < list_t_size(p_results); ++i)
+    {
+        free(list_t_get(p_results, i));
+    }
+
+    list_t_free(p_results);
+    free(p_keys);
+    free(p_missing_keys);
+    free(p_priorities);
+    free(p_lower_priorities);
+    free(p_times);
+    microbench_config_t_free(p_config);
+    return status;
+}
+
+int microbench_main(int argc, char** argv)
+{
+    microbench_config_t config;
+
+    if (!microbench_config_t_init(&config)
+            || !microbench_config_t_parse(&config, argc, argv))
+    {
+        microbench_config_t_free(&config);
+        return EXIT_FAILURE;
+    }
+
+    return run(&config);
+}
+
+int microbench_replay_main(int argc, char** argv)
+{
+    microbench_config_t config;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: cpathfinding replay FILE [--degrees N,...] "
+                        "[--hash identity|mix]\n"
+                        "       [--repetitions N] [--format text|csv|json] "
+                        "[--output FILE]\n");
+        return EXIT_FAILURE;
+    }
+
+    /* The trace file takes the place of the program name for the parser. */
+    if (!microbench_config_t_init(&config)
+            || !microbench_config_t_parse(&config, argc - 1, argv + 1))
+    {
+        microbench_config_t_free(&config);
+        return EXIT_FAILURE;
+    }
+
+    config.size_count   = 0;
+    config.p_trace_file = argv[1];
+    return run(&config);
+}
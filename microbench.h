@@ -0,0 +1,121 @@
+#ifndef MICROBENCH_H
+#define	MICROBENCH_H
+
+#include "benchmark.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    typedef enum microbench_distribution_t {
+        /* The keys 1, 2, ..., n. */
+        MICROBENCH_SEQUENTIAL,
+        /* Distinct keys spread uniformly over the 64-bit range. */
+        MICROBENCH_UNIFORM,
+        /* Runs of 64 consecutive keys starting at random points. */
+        MICROBENCH_CLUSTERED,
+        /* The multiples of 4096, which defeat a table indexed by low bits. */
+        MICROBENCH_STRIDED,
+        MICROBENCH_DISTRIBUTION_COUNT
+    } microbench_distribution_t;
+
+    typedef struct microbench_config_t {
+        size_t*            p_sizes;
+        size_t             size_count;
+        float*             p_load_factors;
+        size_t             load_factor_count;
+        size_t*            p_degrees;
+        size_t             degree_count;
+        /* Bit i is set if the distribution i is measured. */
+        unsigned int       distributions;
+        /* Hash the integer keys with a mixing function rather than the
+           identity, which degenerates on the strided keys. */
+        bool               mix_hash;
+        size_t             repetitions;
+        unsigned int       seed;
+        /* The graph of the Dijkstra trace, or 0 nodes to skip the trace. */
+        const char*        p_trace_family;
+        size_t             trace_nodes;
+        /* The number of random queries recorded into the trace. */
+        size_t             trace_queries;
+        /* If set, the trace is read from this file instead of recorded. */
+        const char*        p_trace_file;
+        /* If set, the trace is also written to this file. */
+        const char*        p_save_trace_file;
+        benchmark_format_t format;
+        const char*        p_output_file;
+    } microbench_config_t;
+
+    /***************************************************************************
+    * The throughput of a single container operation. 'parameter' is the load  *
+    * factor of the hash tables or the degree of the heap, and is zero for the *
+    * list.                                                                    *
+    ***************************************************************************/
+    typedef struct microbench_result_t {
+        const char* p_container;
+        const char* p_operation;
+        const char* p_distribution;
+        size_t      size;
+        double      parameter;
+        size_t      operations;
+        double      best_ns_per_operation;
+        double      median_ns_per_operation;
+    } microbench_result_t;
+
+    /***************************************************************************
+    * Loads the default configuration: the sizes 1000 to 1000000 in steps of   *
+    * ten, the load factors 0.75, 1.0 and 2.0, the heap degrees 2, 4 and 8,    *
+    * all key distributions, the mixing hash, three repetitions and a trace of *
+    * ten Dijkstra queries on a grid of 10000 nodes.                           *
+    ***************************************************************************/
+    bool microbench_config_t_init(microbench_config_t* p_config);
+
+    /***************************************************************************
+    * Reads the command line options into 'p_config'. Returns false and        *
+    * prints a message to the standard error on invalid options.               *
+    ***************************************************************************/
+    bool microbench_config_t_parse(microbench_config_t* p_config,
+                                   int argc,
+                                   char** argv);
+
+    /***************************************************************************
+    * Deallocates the option lists of the configuration.                       *
+    ***************************************************************************/
+    void microbench_config_t_free(microbench_config_t* p_config);
+
+    /***************************************************************************
+    * Returns the name of the key distribution, such as "uniform".             *
+    ***************************************************************************/
+    const char* microbench_distribution_name(
+            microbench_distribution_t distribution);
+
+    /***************************************************************************
+    * Loads 'size' distinct keys of given distribution into 'p_keys', starting *
+    * from the 'first'th key of the sequence. None of the keys is zero.        *
+    ***************************************************************************/
+    void microbench_keys(microbench_distribution_t distribution,
+                         size_t first,
+                         size_t size,
+                         unsigned int seed,
+                         size_t* p_keys);
+
+    /***************************************************************************
+    * Runs the container microbenchmarks with given command line options.      *
+    * Returns the exit status for the program.                                 *
+    ***************************************************************************/
+    int microbench_main(int argc, char** argv);
+
+    /***************************************************************************
+    * Replays the heap trace file named by the first argument against the heap *
+    * degrees of the remaining options. Returns the exit status for the        *
+    * program.                                                                 *
+    ***************************************************************************/
+    int microbench_replay_main(int argc, char** argv);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* MICROBENCH_H */
@@ -35,18 +35,41 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
+	${OBJECTDIR}/allocator.o \
+	${OBJECTDIR}/ara_star.o \
 	${OBJECTDIR}/astar.o \
+	${OBJECTDIR}/benchmark.o \
 	${OBJECTDIR}/bidir_astar.o \
 	${OBJECTDIR}/bidir_dijkstra.o \
+	${OBJECTDIR}/coordinate_store.o \
 	${OBJECTDIR}/dijkstra.o \
 	${OBJECTDIR}/directed_graph_node.o \
+	${OBJECTDIR}/focal_search.o \
+	${OBJECTDIR}/graph_generators.o \
 	${OBJECTDIR}/heap.o \
+	${OBJECTDIR}/heap_trace.o \
+	${OBJECTDIR}/heuristic.o \
+	${OBJECTDIR}/landmarks.o \
 	${OBJECTDIR}/list.o \
+	${OBJECTDIR}/lpa_star.o \
 	${OBJECTDIR}/main.o \
+	${OBJECTDIR}/memory_usage.o \
+	${OBJECTDIR}/microbench.o \
+	${OBJECTDIR}/perf_counters.o \
+	${OBJECTDIR}/route_cache.o \
+	${OBJECTDIR}/search_budget.o \
+	${OBJECTDIR}/search_recorder.o \
+	${OBJECTDIR}/search_stats.o \
+	${OBJECTDIR}/search_task.o \
+	${OBJECTDIR}/shortest_path_tree.o \
+	${OBJECTDIR}/source_tree_cache.o \
+	${OBJECTDIR}/td_search.o \
+	${OBJECTDIR}/td_weight_function.o \
 	${OBJECTDIR}/unordered_map.o \
 	${OBJECTDIR}/unordered_set.o \
 	${OBJECTDIR}/utils.o \
-	${OBJECTDIR}/weight_function.o
+	${OBJECTDIR}/weight_function.o \
+	${OBJECTDIR}/weight_profiles.o
 
 
 # C Compiler Flags
@@ -63,7 +86,7 @@ FFLAGS=
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=
+LDLIBSOPTIONS=-lm -lpthread
 
 # Build Targets
 .build-conf: ${BUILD_SUBPROJECTS}
@@ -73,11 +96,26 @@ ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/cpathfinding: ${OBJECTFILES}
 	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}
 	${LINK.c} -o ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/cpathfinding ${OBJECTFILES} ${LDLIBSOPTIONS}
 
+${OBJECTDIR}/allocator.o: allocator.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/allocator.o allocator.c
+
+${OBJECTDIR}/ara_star.o: ara_star.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/ara_star.o ara_star.c
+
 ${OBJECTDIR}/astar.o: astar.c 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/astar.o astar.c
 
+${OBJECTDIR}/benchmark.o: benchmark.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/benchmark.o benchmark.c
+
 ${OBJECTDIR}/bidir_astar.o: bidir_astar.c 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -88,6 +126,11 @@ ${OBJECTDIR}/bidir_dijkstra.o: bidir_dijkstra.c
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bidir_dijkstra.o bidir_dijkstra.c
 
+${OBJECTDIR}/coordinate_store.o: coordinate_store.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/coordinate_store.o coordinate_store.c
+
 ${OBJECTDIR}/dijkstra.o: dijkstra.c 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -98,21 +141,111 @@ ${OBJECTDIR}/directed_graph_node.o: directed_graph_node.c
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/directed_graph_node.o directed_graph_node.c
 
+${OBJECTDIR}/focal_search.o: focal_search.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/focal_search.o focal_search.c
+
+${OBJECTDIR}/graph_generators.o: graph_generators.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/graph_generators.o graph_generators.c
+
 ${OBJECTDIR}/heap.o: heap.c 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/heap.o heap.c
 
+${OBJECTDIR}/heap_trace.o: heap_trace.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/heap_trace.o heap_trace.c
+
+${OBJECTDIR}/heuristic.o: heuristic.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/heuristic.o heuristic.c
+
+${OBJECTDIR}/landmarks.o: landmarks.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/landmarks.o landmarks.c
+
 ${OBJECTDIR}/list.o: list.c 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/list.o list.c
 
+${OBJECTDIR}/lpa_star.o: lpa_star.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/lpa_star.o lpa_star.c
+
 ${OBJECTDIR}/main.o: main.c 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/main.o main.c
 
+${OBJECTDIR}/memory_usage.o: memory_usage.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/memory_usage.o memory_usage.c
+
+${OBJECTDIR}/microbench.o: microbench.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/microbench.o microbench.c
+
+${OBJECTDIR}/perf_counters.o: perf_counters.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/perf_counters.o perf_counters.c
+
+${OBJECTDIR}/route_cache.o: route_cache.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/route_cache.o route_cache.c
+
+${OBJECTDIR}/search_budget.o: search_budget.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/search_budget.o search_budget.c
+
+${OBJECTDIR}/search_recorder.o: search_recorder.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/search_recorder.o search_recorder.c
+
+${OBJECTDIR}/search_stats.o: search_stats.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/search_stats.o search_stats.c
+
+${OBJECTDIR}/search_task.o: search_task.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/search_task.o search_task.c
+
+${OBJECTDIR}/shortest_path_tree.o: shortest_path_tree.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/shortest_path_tree.o shortest_path_tree.c
+
+${OBJECTDIR}/source_tree_cache.o: source_tree_cache.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/source_tree_cache.o source_tree_cache.c
+
+${OBJECTDIR}/td_search.o: td_search.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/td_search.o td_search.c
+
+${OBJECTDIR}/td_weight_function.o: td_weight_function.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/td_weight_function.o td_weight_function.c
+
 ${OBJECTDIR}/unordered_map.o: unordered_map.c 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -133,6 +266,11 @@ ${OBJECTDIR}/weight_function.o: weight_function.c
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/weight_function.o weight_function.c
 
+${OBJECTDIR}/weight_profiles.o: weight_profiles.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/weight_profiles.o weight_profiles.c
+
 # Subprojects
 .build-subprojects:
 
@@ -0,0 +1,186 @@
+#include "perf_counters.h"
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* COUNTER_NAMES[PERF_COUNTER_COUNT] = {
+    "cycles",
+    "instructions",
+    "branch_misses",
+    "l1d_misses",
+    "llc_misses",
+    "dtlb_misses"
+};
+
+const char* perf_counter_name(perf_counter_kind_t kind)
+{
+    if (kind >= PERF_COUNTER_COUNT) return "unknown";
+
+    return COUNTER_NAMES[kind];
+}
+
+#ifdef __linux__
+
+/*******************************************************************************
+* Returns the configuration of a read miss event of the cache 'cache'.         *
+*******************************************************************************/
+static uint64_t cache_miss_config(uint64_t cache)
+{
+    return cache |
+           ((uint64_t) PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           ((uint64_t) PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+static int open_counter(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+
+    attr.size           = sizeof(attr);
+    attr.type           = type;
+    attr.config         = config;
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                          PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+bool perf_counters_t_open(perf_counters_t* p_counters)
+{
+    size_t i;
+
+    if (!p_counters) return false;
+
+    p_counters->fds[PERF_COUNTER_CYCLES] =
+            open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    p_counters->fds[PERF_COUNTER_INSTRUCTIONS] =
+            open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    p_counters->fds[PERF_COUNTER_BRANCH_MISSES] =
+            open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    p_counters->fds[PERF_COUNTER_L1D_MISSES] =
+            open_counter(PERF_TYPE_HW_CACHE,
+                         cache_miss_config(PERF_COUNT_HW_CACHE_L1D));
+    p_counters->fds[PERF_COUNTER_LLC_MISSES] =
+            open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    p_counters->fds[PERF_COUNTER_DTLB_MISSES] =
+            open_counter(PERF_TYPE_HW_CACHE,
+                         cache_miss_config(PERF_COUNT_HW_CACHE_DTLB));
+
+    for (i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        if (p_counters->fds[i] >= 0) return true;
+    }
+
+    return false;
+}
+
+void perf_counters_t_start(perf_counters_t* p_counters)
+{
+    size_t i;
+
+    if (!p_counters) return;
+
+    for (i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        if (p_counters->fds[i] < 0) continue;
+
+        ioctl(p_counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(p_counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void perf_counters_t_stop(perf_counters_t* p_counters, perf_sample_t* p_sample)
+{
+    /* The value, the time enabled and the time running. */
+    uint64_t data[3];
+    size_t   i;
+
+    if (!p_counters || !p_sample) return;
+
+    for (i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        if (p_counters->fds[i] >= 0)
+        {
+            ioctl(p_counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        p_sample->values[i] = 0;
+
+        if (p_counters->fds[i] < 0) continue;
+
+        if (read(p_counters->fds[i], data, sizeof(data)) != sizeof(data))
+        {
+            continue;
+        }
+
+        if (data[2] > 0 && data[2] < data[1])
+        {
+            data[0] = (uint64_t) ((double) data[0] * data[1] / data[2]);
+        }
+
+        p_sample->values[i] = data[0];
+    }
+}
+
+void perf_counters_t_close(perf_counters_t* p_counters)
+{
+    size_t i;
+
+    if (!p_counters) return;
+
+    for (i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        if (p_counters->fds[i] >= 0) close(p_counters->fds[i]);
+
+        p_counters->fds[i] = -1;
+    }
+}
+
+#else
+
+bool perf_counters_t_open(perf_counters_t* p_counters)
+{
+    size_t i;
+
+    if (!p_counters) return false;
+
+    for (i = 0; i < PERF_COUNTER_COUNT; ++i) p_counters->fds[i] = -1;
+
+    return false;
+}
+
+void perf_counters_t_start(perf_counters_t* p_counters)
+{
+}
+
+void perf_counters_t_stop(perf_counters_t* p_counters, perf_sample_t* p_sample)
+{
+    if (p_sample) memset(p_sample, 0, sizeof(*p_sample));
+}
+
+void perf_counters_t_close(perf_counters_t* p_counters)
+{
+}
+
+#endif
+
+bool perf_counters_t_is_available(perf_counters_t* p_counters,
+                                  perf_counter_kind_t kind)
+{
+    if (!p_counters || kind >= PERF_COUNTER_COUNT) return false;
+
+    return p_counters->fds[kind] >= 0;
+}
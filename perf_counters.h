@@ -0,0 +1,77 @@
+#ifndef PERF_COUNTERS_H
+#define	PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    typedef enum perf_counter_kind_t {
+        PERF_COUNTER_CYCLES,
+        PERF_COUNTER_INSTRUCTIONS,
+        PERF_COUNTER_BRANCH_MISSES,
+        PERF_COUNTER_L1D_MISSES,
+        PERF_COUNTER_LLC_MISSES,
+        PERF_COUNTER_DTLB_MISSES,
+        PERF_COUNTER_COUNT
+    } perf_counter_kind_t;
+
+    /***************************************************************************
+    * A set of hardware counters of the calling thread. Only user space events *
+    * are counted. A counter the kernel or the hardware refuses to open is     *
+    * simply left out, so any subset of the counters may be available.         *
+    ***************************************************************************/
+    typedef struct perf_counters_t {
+        int fds[PERF_COUNTER_COUNT];
+    } perf_counters_t;
+
+    /***************************************************************************
+    * The counter values of a measured interval. The value of an unavailable   *
+    * counter is zero.                                                         *
+    ***************************************************************************/
+    typedef struct perf_sample_t {
+        unsigned long long values[PERF_COUNTER_COUNT];
+    } perf_sample_t;
+
+    /***************************************************************************
+    * Opens the counters. Returns true if at least one counter is available.   *
+    * Always returns false on systems other than Linux.                        *
+    ***************************************************************************/
+    bool perf_counters_t_open(perf_counters_t* p_counters);
+
+    /***************************************************************************
+    * Returns true if the counter 'kind' was opened successfully.              *
+    ***************************************************************************/
+    bool perf_counters_t_is_available(perf_counters_t* p_counters,
+                                      perf_counter_kind_t kind);
+
+    /***************************************************************************
+    * Resets the counters to zero and starts counting.                         *
+    ***************************************************************************/
+    void perf_counters_t_start(perf_counters_t* p_counters);
+
+    /***************************************************************************
+    * Stops counting and loads the counts since the last start into            *
+    * 'p_sample'. If the kernel multiplexed a counter, its count is scaled up  *
+    * to the whole interval.                                                   *
+    ***************************************************************************/
+    void perf_counters_t_stop(perf_counters_t* p_counters,
+                              perf_sample_t* p_sample);
+
+    /***************************************************************************
+    * Closes all the counters.                                                 *
+    ***************************************************************************/
+    void perf_counters_t_close(perf_counters_t* p_counters);
+
+    /***************************************************************************
+    * Returns the name of the counter 'kind', such as "cycles".                *
+    ***************************************************************************/
+    const char* perf_counter_name(perf_counter_kind_t kind);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* PERF_COUNTERS_H */
@@ -0,0 +1,502 @@
+#include "route_cache.h"
+#include "astar.h"
+#include "bidir_astar.h"
+#include "bidir_dijkstra.h"
+#include "dijkstra.h"
+#include "memory_usage.h"
+#include "utils.h"
+#include <pthread.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* A cached path, which is also a node of the list of the paths ordered from    *
+* the most to the least recently used. The nodes of the path follow the entry  *
+* in the same block.                                                           *
+*******************************************************************************/
+typedef struct route_entry_t {
+    directed_graph_node_t*            p_source;
+    directed_graph_node_t*            p_target;
+    directed_graph_weight_function_t* p_weight_function;
+    search_algorithm_t                algorithm;
+    struct route_entry_t*             p_prev;
+    struct route_entry_t*             p_next;
+    double                            cost;
+    size_t                            length;
+    /* The version of the weight function the path was found at. */
+    uint64_t                          weight_version;
+    directed_graph_node_t*            p_nodes[];
+} route_entry_t;
+
+struct route_cache_t {
+    /* Guards everything below. */
+    pthread_mutex_t     lock;
+    allocator_t*        p_allocator;
+    /* Maps each entry, by its query, to itself. */
+    unordered_map_t*    p_entry_map;
+    route_entry_t*      p_head;
+    route_entry_t*      p_tail;
+    size_t              max_memory;
+    /* The sum of the memory of the entries. */
+    size_t              entry_memory;
+    /* The arc version of the graphs the entries were cached at. */
+    uint64_t            version;
+    route_cache_stats_t stats;
+};
+
+/*******************************************************************************
+* The entries are told apart by their queries, whose nodes are known by        *
+* identity.                                                                    *
+*******************************************************************************/
+static size_t route_entry_hash(void* p_key)
+{
+    route_entry_t* p_entry = p_key;
+    size_t         hash;
+
+    hash = (size_t) ((uintptr_t) p_entry->p_source >> 4);
+    hash = hash * 31 + (size_t) ((uintptr_t) p_entry->p_target >> 4);
+    hash = hash * 31 + (size_t) ((uintptr_t) p_entry->p_weight_function >> 4);
+    return hash * 31 + (size_t) p_entry->algorithm;
+}
+
+static bool route_entry_equals(void* p_a, void* p_b)
+{
+    route_entry_t* p_entry_a = p_a;
+    route_entry_t* p_entry_b = p_b;
+
+    return p_entry_a->p_source          == p_entry_b->p_source &&
+           p_entry_a->p_target          == p_entry_b->p_target &&
+           p_entry_a->p_weight_function == p_entry_b->p_weight_function &&
+           p_entry_a->algorithm         == p_entry_b->algorithm;
+}
+
+static size_t entry_memory_usage(size_t length)
+{
+    return memory_block_size(sizeof(route_entry_t) +
+                             sizeof(directed_graph_node_t*) * length);
+}
+
+static void unlink_entry(route_cache_t* p_cache, route_entry_t* p_entry)
+{
+    if (p_entry->p_prev) p_entry->p_prev->p_next = p_entry->p_next;
+    else                 p_cache->p_head         = p_entry->p_next;
+
+    if (p_entry->p_next) p_entry->p_next->p_prev = p_entry->p_prev;
+    else                 p_cache->p_tail         = p_entry->p_prev;
+
+    p_entry->p_prev = NULL;
+    p_entry->p_next = NULL;
+}
+
+static void push_front(route_cache_t* p_cache, route_entry_t* p_entry)
+{
+    p_entry->p_prev = NULL;
+    p_entry->p_next = p_cache->p_head;
+
+    if (p_cache->p_head) p_cache->p_head->p_prev = p_entry;
+    else                 p_cache->p_tail         = p_entry;
+
+    p_cache->p_head = p_entry;
+}
+
+static void drop_entry(route_cache_t* p_cache, route_entry_t* p_entry)
+{
+    unlink_entry(p_cache, p_entry);
+    unordered_map_t_remove(p_cache->p_entry_map, p_entry);
+    p_cache->entry_memory -= entry_memory_usage(p_entry->length);
+    allocator_t_free(p_cache->p_allocator, p_entry);
+}
+
+static void drop_entries(route_cache_t* p_cache)
+{
+    while (p_cache->p_head) drop_entry(p_cache, p_cache->p_head);
+}
+
+/*******************************************************************************
+* Drops all the entries if the arcs of the graphs changed since they were      *
+* cached. A change of weights only makes stale the entries of its function.    *
+*******************************************************************************/
+static void check_version(route_cache_t* p_cache)
+{
+    uint64_t version = directed_graph_arc_version();
+
+    if (p_cache->version == version) return;
+
+    if (p_cache->p_head) ++p_cache->stats.invalidations;
+
+    drop_entries(p_cache);
+    p_cache->version = version;
+}
+
+static size_t memory_usage(route_cache_t* p_cache)
+{
+    return memory_block_size(sizeof(*p_cache)) +
+           unordered_map_t_memory_usage(p_cache->p_entry_map) +
+           p_cache->entry_memory;
+}
+
+route_cache_t* route_cache_t_alloc(size_t max_memory, allocator_t* p_allocator)
+{
+    route_cache_t* p_cache;
+
+    if (!(p_cache = allocator_t_calloc(p_allocator, 1, sizeof(*p_cache))))
+    {
+        return NULL;
+    }
+
+    p_cache->p_allocator = p_allocator;
+    p_cache->max_memory  = max_memory;
+    p_cache->version     = directed_graph_arc_version();
+    p_cache->p_entry_map = unordered_map_t_alloc(INITIAL_CAPACITY,
+                                                 LOAD_FACTOR,
+                                                 route_entry_hash,
+                                                 route_entry_equals,
+                                                 p_allocator);
+
+    if (!p_cache->p_entry_map)
+    {
+        allocator_t_free(p_allocator, p_cache);
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&p_cache->lock, NULL) != 0)
+    {
+        unordered_map_t_free(p_cache->p_entry_map);
+        allocator_t_free(p_allocator, p_cache);
+        return NULL;
+    }
+
+    return p_cache;
+}
+
+/*******************************************************************************
+* Does the work of 'route_cache_t_get' with the lock held.                     *
+*******************************************************************************/
+static list_t* get_path(route_cache_t* p_cache,
+                        search_algorithm_t algorithm,
+                        directed_graph_weight_function_t* p_weight_function,
+                        directed_graph_node_t* p_source,
+                        directed_graph_node_t* p_target,
+                        double* p_cost)
+{
+    route_entry_t  key;
+    route_entry_t* p_entry;
+    list_t*        p_path;
+    size_t         i;
+
+    check_version(p_cache);
+    ++p_cache->stats.lookups;
+
+    key.p_source          = p_source;
+    key.p_target          = p_target;
+    key.p_weight_function = p_weight_function;
+    key.algorithm         = algorithm;
+
+    if (!(p_entry = unordered_map_t_get(p_cache->p_entry_map, &key)))
+    {
+        return NULL;
+    }
+
+    if (p_entry->weight_version !=
+        directed_graph_weight_function_t_version(p_weight_function))
+    {
+        drop_entry(p_cache, p_entry);
+        ++p_cache->stats.expirations;
+        return NULL;
+    }
+
+    if (!(p_path = list_t_alloc(p_entry->length > 0 ?
+                                p_entry->length : INITIAL_CAPACITY,
+                                NULL)))
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < p_entry->length; ++i)
+    {
+        list_t_push_back(p_path, p_entry->p_nodes[i]);
+    }
+
+    if (p_cost) *p_cost = p_entry->cost;
+
+    ++p_cache->stats.hits;
+    unlink_entry(p_cache, p_entry);
+    push_front(p_cache, p_entry);
+    return p_path;
+}
+
+list_t* route_cache_t_get(route_cache_t* p_cache,
+                          search_algorithm_t algorithm,
+                          directed_graph_weight_function_t* p_weight_function,
+                          directed_graph_node_t* p_source,
+                          directed_graph_node_t* p_target,
+                          double* p_cost)
+{
+    list_t* p_path;
+
+    if (!p_cache) return NULL;
+
+    pthread_mutex_lock(&p_cache->lock);
+    p_path = get_path(p_cache,
+                      algorithm,
+                      p_weight_function,
+                      p_source,
+                      p_target,
+                      p_cost);
+    pthread_mutex_unlock(&p_cache->lock);
+    return p_path;
+}
+
+/*******************************************************************************
+* Does the work of 'route_cache_t_put' with the lock held, for a path found at *
+* the arc version 'arc_version' and the weight version 'weight_version'. A     *
+* path found before a change is not cached.                                    *
+*******************************************************************************/
+static bool put_path(route_cache_t* p_cache,
+                     search_algorithm_t algorithm,
+                     directed_graph_weight_function_t* p_weight_function,
+                     directed_graph_node_t* p_source,
+                     directed_graph_node_t* p_target,
+                     list_t* p_path,
+                     uint64_t arc_version,
+                     uint64_t weight_version)
+{
+    route_entry_t* p_entry;
+    size_t         length;
+    size_t         memory;
+    size_t         i;
+
+    check_version(p_cache);
+
+    if (arc_version != p_cache->version ||
+        weight_version !=
+        directed_graph_weight_function_t_version(p_weight_function))
+    {
+        return false;
+    }
+
+    length = list_t_size(p_path);
+    memory = entry_memory_usage(length);
+
+    if (!(p_entry = allocator_t_alloc(p_cache->p_allocator,
+                                      sizeof(*p_entry) +
+                                      sizeof(directed_graph_node_t*) *
+                                      length)))
+    {
+        return false;
+    }
+
+    p_entry->p_source          = p_source;
+    p_entry->p_target          = p_target;
+    p_entry->p_weight_function = p_weight_function;
+    p_entry->algorithm         = algorithm;
+    p_entry->cost              = compute_path_cost(p_path, p_weight_function);
+    p_entry->length            = length;
+    p_entry->weight_version    = weight_version;
+
+    for (i = 0; i < length; ++i)
+    {
+        p_entry->p_nodes[i] = list_t_get(p_path, i);
+    }
+
+    /* Replace the path cached for the query, if any. */
+    if (unordered_map_t_contains_key(p_cache->p_entry_map, p_entry))
+    {
+        drop_entry(p_cache, unordered_map_t_get(p_cache->p_entry_map,
+                                                p_entry));
+    }
+
+    /* Drop the least recently used paths until this one fits. */
+    while (p_cache->max_memory > 0 && p_cache->p_tail &&
+           memory_usage(p_cache) + memory > p_cache->max_memory)
+    {
+        drop_entry(p_cache, p_cache->p_tail);
+        ++p_cache->stats.evictions;
+    }
+
+    if (p_cache->max_memory > 0 &&
+        memory_usage(p_cache) + memory > p_cache->max_memory)
+    {
+        allocator_t_free(p_cache->p_allocator, p_entry);
+        return false;
+    }
+
+    unordered_map_t_put(p_cache->p_entry_map, p_entry, p_entry);
+
+    if (!unordered_map_t_contains_key(p_cache->p_entry_map, p_entry))
+    {
+        allocator_t_free(p_cache->p_allocator, p_entry);
+        return false;
+    }
+
+    push_front(p_cache, p_entry);
+    p_cache->entry_memory += memory;
+    ++p_cache->stats.insertions;
+    return true;
+}
+
+bool route_cache_t_put(route_cache_t* p_cache,
+                       search_algorithm_t algorithm,
+                       directed_graph_weight_function_t* p_weight_function,
+                       directed_graph_node_t* p_source,
+                       directed_graph_node_t* p_target,
+                       list_t* p_path)
+{
+    bool ret;
+
+    if (!p_cache || !p_path) return false;
+
+    pthread_mutex_lock(&p_cache->lock);
+    ret = put_path(p_cache,
+                   algorithm,
+                   p_weight_function,
+                   p_source,
+                   p_target,
+                   p_path,
+                   directed_graph_arc_version(),
+                   directed_graph_weight_function_t_version(
+                           p_weight_function));
+    pthread_mutex_unlock(&p_cache->lock);
+    return ret;
+}
+
+list_t* route_cache_t_query(route_cache_t* p_cache,
+                            search_algorithm_t algorithm,
+                            directed_graph_node_t* p_source,
+                            directed_graph_node_t* p_target,
+                            directed_graph_weight_function_t*
+                                           p_weight_function,
+                            unordered_map_t* p_location_map,
+                            search_options_t* p_options)
+{
+    list_t*  p_path;
+    uint64_t arc_version;
+    uint64_t weight_version;
+
+    /* The versions are read first so that a change made during the search
+       keeps its path out of the cache. */
+    arc_version    = directed_graph_arc_version();
+    weight_version = directed_graph_weight_function_t_version(
+                             p_weight_function);
+
+    if ((p_path = route_cache_t_get(p_cache,
+                                    algorithm,
+                                    p_weight_function,
+                                    p_source,
+                                    p_target,
+                                    NULL)))
+    {
+        return p_path;
+    }
+
+    switch (algorithm)
+    {
+        case SEARCH_ALGORITHM_DIJKSTRA:
+            p_path = dijkstra_with_options(p_source,
+                                           p_target,
+                                           p_weight_function,
+                                           p_options);
+            break;
+
+        case SEARCH_ALGORITHM_ASTAR:
+            p_path = astar_with_options(p_source,
+                                        p_target,
+                                        p_weight_function,
+                                        p_location_map,
+                                        p_options);
+            break;
+
+        case SEARCH_ALGORITHM_BIDIRECTIONAL_DIJKSTRA:
+            p_path = bidirectional_dijkstra_with_options(p_source,
+                                                         p_target,
+                                                         p_weight_function,
+                                                         p_options);
+            break;
+
+        case SEARCH_ALGORITHM_BIDIRECTIONAL_ASTAR:
+            p_path = bidirectional_astar_with_options(p_source,
+                                                      p_target,
+                                                      p_weight_function,
+                                                      p_location_map,
+                                                      p_options);
+            break;
+
+        default:
+            return NULL;
+    }
+
+    if (p_path && p_cache)
+    {
+        pthread_mutex_lock(&p_cache->lock);
+        put_path(p_cache,
+                 algorithm,
+                 p_weight_function,
+                 p_source,
+                 p_target,
+                 p_path,
+                 arc_version,
+                 weight_version);
+        pthread_mutex_unlock(&p_cache->lock);
+    }
+
+    return p_path;
+}
+
+size_t route_cache_t_size(route_cache_t* p_cache)
+{
+    size_t size;
+
+    if (!p_cache) return 0;
+
+    pthread_mutex_lock(&p_cache->lock);
+    check_version(p_cache);
+    size = unordered_map_t_size(p_cache->p_entry_map);
+    pthread_mutex_unlock(&p_cache->lock);
+    return size;
+}
+
+route_cache_stats_t route_cache_t_stats(route_cache_t* p_cache)
+{
+    route_cache_stats_t stats = { 0, 0, 0, 0, 0, 0 };
+
+    if (!p_cache) return stats;
+
+    pthread_mutex_lock(&p_cache->lock);
+    stats = p_cache->stats;
+    pthread_mutex_unlock(&p_cache->lock);
+    return stats;
+}
+
+size_t route_cache_t_memory_usage(route_cache_t* p_cache)
+{
+    size_t usage;
+
+    if (!p_cache) return 0;
+
+    pthread_mutex_lock(&p_cache->lock);
+    usage = memory_usage(p_cache);
+    pthread_mutex_unlock(&p_cache->lock);
+    return usage;
+}
+
+void route_cache_t_clear(route_cache_t* p_cache)
+{
+    route_cache_stats_t stats = { 0, 0, 0, 0, 0, 0 };
+
+    if (!p_cache) return;
+
+    pthread_mutex_lock(&p_cache->lock);
+    drop_entries(p_cache);
+    p_cache->version = directed_graph_arc_version();
+    p_cache->stats   = stats;
+    pthread_mutex_unlock(&p_cache->lock);
+}
+
+void route_cache_t_free(route_cache_t* p_cache)
+{
+    if (!p_cache) return;
+
+    drop_entries(p_cache);
+    pthread_mutex_destroy(&p_cache->lock);
+    unordered_map_t_free(p_cache->p_entry_map);
+    allocator_t_free(p_cache->p_allocator, p_cache);
+}
@@ -0,0 +1,128 @@
+#ifndef ROUTE_CACHE_H
+#define	ROUTE_CACHE_H
+
+#include "allocator.h"
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include "unordered_map.h"
+#include "list.h"
+#include "search_options.h"
+#include "search_task.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A cache of the paths the searches returned, keyed by the source, the     *
+    * target, the algorithm and the weight function. Each path is kept as one  *
+    * block of nodes with its cost. When the cache would take more memory than *
+    * allowed, the least recently used paths are dropped. The whole cache is   *
+    * dropped at once as soon as 'directed_graph_arc_version' differs from the *
+    * version it was filled at, while a path whose weight function changed     *
+    * since it was found is dropped when it is looked up, so a change to any   *
+    * arc or weight is never answered with an old path. The cache may be used  *
+    * from several threads at once; a lock guards it, but not the searches     *
+    * 'route_cache_t_query' runs, which run side by side.                      *
+    ***************************************************************************/
+    typedef struct route_cache_t route_cache_t;
+
+    /***************************************************************************
+    * The counters of a cache.                                                 *
+    ***************************************************************************/
+    typedef struct route_cache_stats_t {
+        size_t lookups;
+        size_t hits;
+        size_t insertions;
+        /* The paths dropped to stay within the memory limit. */
+        size_t evictions;
+        /* The times the cache was dropped for a change of the arcs. */
+        size_t invalidations;
+        /* The paths dropped for a change of the weights they were found at. */
+        size_t expirations;
+    } route_cache_stats_t;
+
+    /***************************************************************************
+    * Allocates an empty cache that takes at most 'max_memory' bytes from      *
+    * 'p_allocator', or any amount if 'max_memory' is zero. The memory comes   *
+    * from the C library if 'p_allocator' is NULL. Returns NULL if there is    *
+    * not enough memory.                                                       *
+    ***************************************************************************/
+    route_cache_t* route_cache_t_alloc(size_t max_memory,
+                                       allocator_t* p_allocator);
+
+    /***************************************************************************
+    * Returns a new list holding the path cached for the query, which is empty *
+    * if the target was not reachable, and stores its cost in 'p_cost' unless  *
+    * it is NULL. Returns NULL if the query is not cached.                     *
+    ***************************************************************************/
+    list_t* route_cache_t_get(route_cache_t* p_cache,
+                              search_algorithm_t algorithm,
+                              directed_graph_weight_function_t*
+                                             p_weight_function,
+                              directed_graph_node_t* p_source,
+                              directed_graph_node_t* p_target,
+                              double* p_cost);
+
+    /***************************************************************************
+    * Caches 'p_path', which the search 'algorithm' returned for the query,    *
+    * replacing any path cached for it. The path is copied. Returns false if   *
+    * the path does not fit in the memory limit or there is not enough memory. *
+    ***************************************************************************/
+    bool route_cache_t_put(route_cache_t* p_cache,
+                           search_algorithm_t algorithm,
+                           directed_graph_weight_function_t* p_weight_function,
+                           directed_graph_node_t* p_source,
+                           directed_graph_node_t* p_target,
+                           list_t* p_path);
+
+    /***************************************************************************
+    * Returns the path cached for the query or, if there is none, runs the     *
+    * search 'algorithm' with 'p_location_map' and 'p_options' as its          *
+    * '_with_options' function does and caches the path it returns, unless the *
+    * arcs or the weights changed during the search. Returns NULL if the       *
+    * search does.                                                             *
+    ***************************************************************************/
+    list_t* route_cache_t_query(route_cache_t* p_cache,
+                                search_algorithm_t algorithm,
+                                directed_graph_node_t* p_source,
+                                directed_graph_node_t* p_target,
+                                directed_graph_weight_function_t*
+                                               p_weight_function,
+                                unordered_map_t* p_location_map,
+                                search_options_t* p_options);
+
+    /***************************************************************************
+    * Returns the number of paths in the cache.                                *
+    ***************************************************************************/
+    size_t route_cache_t_size(route_cache_t* p_cache);
+
+    /***************************************************************************
+    * Returns the counters of the cache, which count from its allocation or    *
+    * its last clearing. The hit rate is 'hits' over 'lookups'.                *
+    ***************************************************************************/
+    route_cache_stats_t route_cache_t_stats(route_cache_t* p_cache);
+
+    /***************************************************************************
+    * Returns the number of bytes the cache takes from the allocator,          *
+    * including the allocator overhead of each block.                          *
+    ***************************************************************************/
+    size_t route_cache_t_memory_usage(route_cache_t* p_cache);
+
+    /***************************************************************************
+    * Drops all the paths in the cache and resets its counters.                *
+    ***************************************************************************/
+    void route_cache_t_clear(route_cache_t* p_cache);
+
+    /***************************************************************************
+    * Deallocates the cache. The paths it returned are left alone.             *
+    ***************************************************************************/
+    void route_cache_t_free(route_cache_t* p_cache);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* ROUTE_CACHE_H */
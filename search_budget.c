@@ -0,0 +1,80 @@
+#include "search_budget.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+void search_budget_t_init(search_budget_t* p_budget)
+{
+    if (!p_budget) return;
+
+    memset(p_budget, 0, sizeof(*p_budget));
+    p_budget->status = SEARCH_STATUS_COMPLETE;
+}
+
+void search_budget_t_set_timeout(search_budget_t* p_budget,
+                                 unsigned long long timeout)
+{
+    if (!p_budget) return;
+
+    p_budget->deadline = search_budget_now() + timeout;
+}
+
+void search_budget_t_start(search_budget_t* p_budget)
+{
+    if (!p_budget) return;
+
+    p_budget->status = SEARCH_STATUS_COMPLETE;
+}
+
+bool search_budget_t_check(search_budget_t* p_budget,
+                           size_t settled,
+                           size_t memory)
+{
+    if (!p_budget) return true;
+
+    if (p_budget->p_cancelled &&
+        atomic_load_explicit(p_budget->p_cancelled, memory_order_relaxed))
+    {
+        p_budget->status = SEARCH_STATUS_CANCELLED;
+    }
+    else if (p_budget->max_settled && settled >= p_budget->max_settled)
+    {
+        p_budget->status = SEARCH_STATUS_NODE_LIMIT;
+    }
+    else if (p_budget->max_memory && memory > p_budget->max_memory)
+    {
+        p_budget->status = SEARCH_STATUS_MEMORY_LIMIT;
+    }
+    else if (p_budget->deadline && search_budget_now() >= p_budget->deadline)
+    {
+        p_budget->status = SEARCH_STATUS_DEADLINE;
+    }
+    else
+    {
+        return true;
+    }
+
+    return false;
+}
+
+unsigned long long search_budget_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+const char* search_status_name(search_status_t status)
+{
+    switch (status)
+    {
+        case SEARCH_STATUS_COMPLETE:     return "complete";
+        case SEARCH_STATUS_DEADLINE:     return "deadline";
+        case SEARCH_STATUS_NODE_LIMIT:   return "node limit";
+        case SEARCH_STATUS_MEMORY_LIMIT: return "memory limit";
+        case SEARCH_STATUS_CANCELLED:    return "cancelled";
+    }
+
+    return "unknown";
+}
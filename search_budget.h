@@ -0,0 +1,99 @@
+#ifndef SEARCH_BUDGET_H
+#define	SEARCH_BUDGET_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The number of settled nodes between two checks of the clock, the memory  *
+    * and the cancellation flag of a budget.                                   *
+    ***************************************************************************/
+#define SEARCH_BUDGET_CHECK_INTERVAL 64
+
+    /***************************************************************************
+    * How a search with a budget ended. A search that gives up returns NULL,   *
+    * which only the status tells apart from running out of memory.            *
+    ***************************************************************************/
+    typedef enum search_status_t {
+        /* Found a path, proved there is none, or failed on its own. */
+        SEARCH_STATUS_COMPLETE,
+        SEARCH_STATUS_DEADLINE,
+        SEARCH_STATUS_NODE_LIMIT,
+        SEARCH_STATUS_MEMORY_LIMIT,
+        SEARCH_STATUS_CANCELLED
+    } search_status_t;
+
+    /***************************************************************************
+    * The limits of a search. Any of them may be zero, which means no limit.   *
+    ***************************************************************************/
+    typedef struct search_budget_t {
+        /* The time on 'search_budget_now' past which the search gives up. */
+        unsigned long long  deadline;
+        /* The most nodes the search may settle. */
+        size_t              max_settled;
+        /* The most bytes the search state may take from the allocator. */
+        size_t              max_memory;
+        /* If set, the search gives up once it reads a nonzero value here,
+           which another thread may write at any time. */
+        const _Atomic int*  p_cancelled;
+        /* Set by the search to how it ended. */
+        search_status_t     status;
+    } search_budget_t;
+
+    /***************************************************************************
+    * Sets up a budget with no limits.                                         *
+    ***************************************************************************/
+    void search_budget_t_init(search_budget_t* p_budget);
+
+    /***************************************************************************
+    * Sets the deadline of the budget to 'timeout' nanoseconds from now.       *
+    ***************************************************************************/
+    void search_budget_t_set_timeout(search_budget_t* p_budget,
+                                     unsigned long long timeout);
+
+    /***************************************************************************
+    * Marks the search as running to completion. Does nothing if 'p_budget' is *
+    * NULL.                                                                    *
+    ***************************************************************************/
+    void search_budget_t_start(search_budget_t* p_budget);
+
+    /***************************************************************************
+    * Returns true if a search that has settled 'settled' nodes and whose      *
+    * state takes 'memory' bytes may go on. Otherwise sets the status to the   *
+    * limit that was hit and returns false.                                    *
+    ***************************************************************************/
+    bool search_budget_t_check(search_budget_t* p_budget,
+                               size_t settled,
+                               size_t memory);
+
+    /***************************************************************************
+    * Returns the time on the monotonic clock in nanoseconds.                  *
+    ***************************************************************************/
+    unsigned long long search_budget_now(void);
+
+    /***************************************************************************
+    * Returns the name of the status, such as "deadline".                      *
+    ***************************************************************************/
+    const char* search_status_name(search_status_t status);
+
+    /***************************************************************************
+    * The searches check their budgets only through the macro below, which is  *
+    * true if the search must give up before settling another node. It calls   *
+    * 'search_budget_t_check' once every 'SEARCH_BUDGET_CHECK_INTERVAL' nodes, *
+    * and right at the node limit, and only then evaluates 'memory'.           *
+    ***************************************************************************/
+#define SEARCH_BUDGET_EXHAUSTED(p_budget, settled, memory)                     \
+    ((p_budget) &&                                                             \
+     ((settled) % SEARCH_BUDGET_CHECK_INTERVAL == 0 ||                         \
+      (settled) == (p_budget)->max_settled) &&                                 \
+     !search_budget_t_check((p_budget), (settled), (memory)))
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SEARCH_BUDGET_H */
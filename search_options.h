@@ -0,0 +1,47 @@
+#ifndef SEARCH_OPTIONS_H
+#define	SEARCH_OPTIONS_H
+
+#include "allocator.h"
+#include "coordinate_store.h"
+#include "heuristic.h"
+#include "heap_trace.h"
+#include "search_budget.h"
+#include "search_recorder.h"
+#include "search_stats.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * Optional extras of a search. Any of the pointers may be NULL, and so may *
+    * the options themselves.                                                  *
+    ***************************************************************************/
+    typedef struct search_options_t {
+        /* If set, is cleared and then filled in by the search. */
+        search_stats_t* p_stats;
+        /* If set, the heap operations of the search are appended to it. Only
+           Dijkstra's algorithm and A* record them. */
+        heap_trace_t*   p_heap_trace;
+        /* If set, is cleared and then given the nodes settled by the search. */
+        search_recorder_t* p_recorder;
+        /* If set, the search takes all its working memory from it. The
+           returned path always comes from the C library. */
+        allocator_t*    p_allocator;
+        /* If set, the A* searches take the coordinates of the nodes from it
+           rather than from the location map, and estimate all the neighbours
+           of a node in one batch. */
+        coordinate_store_t* p_coordinates;
+        /* If set, the A* searches are guided by it, and the coordinates
+           above and the location map are ignored. */
+        heuristic_t*    p_heuristic;
+        /* If set, the search gives up and returns NULL once any of its limits
+           is hit, and sets its status either way. */
+        search_budget_t* p_budget;
+    } search_options_t;
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SEARCH_OPTIONS_H */
@@ -0,0 +1,179 @@
+#include "search_recorder.h"
+#include "utils.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char     MAGIC[4] = { 'S', 'R', 'E', 'C' };
+static const uint32_t VERSION  = 1;
+
+struct search_recorder_t {
+    search_record_t*       p_records;
+    size_t                 size;
+    size_t                 capacity;
+    directed_graph_node_t* p_meeting_node;
+};
+
+search_recorder_t* search_recorder_t_alloc(void)
+{
+    search_recorder_t* p_recorder = calloc(1, sizeof(*p_recorder));
+
+    if (!p_recorder) return NULL;
+
+    p_recorder->capacity  = 256;
+    p_recorder->p_records = malloc(sizeof(search_record_t) *
+                                   p_recorder->capacity);
+
+    if (!p_recorder->p_records)
+    {
+        free(p_recorder);
+        return NULL;
+    }
+
+    return p_recorder;
+}
+
+void search_recorder_t_settle(search_recorder_t* p_recorder,
+                              directed_graph_node_t* p_node,
+                              double g,
+                              double f,
+                              search_direction_t direction)
+{
+    search_record_t* p_records;
+    search_record_t* p_record;
+
+    if (!p_recorder) return;
+
+    if (p_recorder->size == p_recorder->capacity)
+    {
+        p_records = realloc(p_recorder->p_records,
+                            sizeof(search_record_t) * 2 *
+                            p_recorder->capacity);
+
+        /* Drop the record rather than fail the search. */
+        if (!p_records) return;
+
+        p_recorder->p_records  = p_records;
+        p_recorder->capacity  *= 2;
+    }
+
+    p_record = &p_recorder->p_records[p_recorder->size++];
+    p_record->p_node    = p_node;
+    p_record->g         = g;
+    p_record->f         = f;
+    p_record->direction = direction;
+}
+
+void search_recorder_t_meet(search_recorder_t* p_recorder,
+                            directed_graph_node_t* p_node)
+{
+    if (p_recorder) p_recorder->p_meeting_node = p_node;
+}
+
+size_t search_recorder_t_size(search_recorder_t* p_recorder)
+{
+    return p_recorder ? p_recorder->size : 0;
+}
+
+const search_record_t* search_recorder_t_get(search_recorder_t* p_recorder,
+                                             size_t index)
+{
+    if (!p_recorder || index >= p_recorder->size) return NULL;
+
+    return &p_recorder->p_records[index];
+}
+
+directed_graph_node_t* search_recorder_t_meeting_node(
+        search_recorder_t* p_recorder)
+{
+    return p_recorder ? p_recorder->p_meeting_node : NULL;
+}
+
+static void write_uint32(FILE* p_file, uint32_t value)
+{
+    int i;
+
+    for (i = 0; i < 4; ++i)
+    {
+        putc((int) ((value >> (8 * i)) & 0xff), p_file);
+    }
+}
+
+static void write_uint64(FILE* p_file, uint64_t value)
+{
+    write_uint32(p_file, (uint32_t) value);
+    write_uint32(p_file, (uint32_t) (value >> 32));
+}
+
+static void write_float(FILE* p_file, double value)
+{
+    float    f = (float) value;
+    uint32_t bits;
+
+    memcpy(&bits, &f, sizeof(bits));
+    write_uint32(p_file, bits);
+}
+
+/*******************************************************************************
+* Writes the coordinates of 'p_node', or three NaNs if they are not known.     *
+*******************************************************************************/
+static void write_point(FILE* p_file,
+                        unordered_map_t* p_location_map,
+                        directed_graph_node_t* p_node)
+{
+    point_3d_t* p_point = p_location_map && p_node ?
+                          unordered_map_t_get(p_location_map, p_node) :
+                          NULL;
+
+    write_float(p_file, p_point ? p_point->x : NAN);
+    write_float(p_file, p_point ? p_point->y : NAN);
+    write_float(p_file, p_point ? p_point->z : NAN);
+}
+
+bool search_recorder_t_write(search_recorder_t* p_recorder,
+                             unordered_map_t* p_location_map,
+                             const char* p_file_name)
+{
+    FILE*            p_file;
+    search_record_t* p_record;
+    size_t           i;
+    bool             ok;
+
+    if (!p_recorder || !p_file_name) return false;
+    if (!(p_file = fopen(p_file_name, "wb"))) return false;
+
+    fwrite(MAGIC, 1, sizeof(MAGIC), p_file);
+    write_uint32(p_file, VERSION);
+    write_uint64(p_file, p_recorder->size);
+    write_point(p_file, p_location_map, p_recorder->p_meeting_node);
+    write_uint32(p_file, p_recorder->p_meeting_node ? 1 : 0);
+
+    for (i = 0; i < p_recorder->size; ++i)
+    {
+        p_record = &p_recorder->p_records[i];
+        write_point(p_file, p_location_map, p_record->p_node);
+        write_float(p_file, p_record->g);
+        write_float(p_file, p_record->f);
+        write_uint32(p_file, (uint32_t) p_record->direction);
+    }
+
+    ok = !ferror(p_file);
+    return fclose(p_file) == 0 && ok;
+}
+
+void search_recorder_t_clear(search_recorder_t* p_recorder)
+{
+    if (!p_recorder) return;
+
+    p_recorder->size           = 0;
+    p_recorder->p_meeting_node = NULL;
+}
+
+void search_recorder_t_free(search_recorder_t* p_recorder)
+{
+    if (!p_recorder) return;
+
+    free(p_recorder->p_records);
+    free(p_recorder);
+}
@@ -0,0 +1,141 @@
+#ifndef SEARCH_RECORDER_H
+#define	SEARCH_RECORDER_H
+
+#include "directed_graph_node.h"
+#include "unordered_map.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    typedef enum search_direction_t {
+        SEARCH_FORWARD,
+        SEARCH_BACKWARD
+    } search_direction_t;
+
+    /***************************************************************************
+    * A single settled node. 'g' is the distance from the source of its        *
+    * direction and 'f' is the key it was settled with, which equals 'g' for   *
+    * the Dijkstra variants.                                                   *
+    ***************************************************************************/
+    typedef struct search_record_t {
+        directed_graph_node_t* p_node;
+        double                 g;
+        double                 f;
+        search_direction_t     direction;
+    } search_record_t;
+
+    /***************************************************************************
+    * Logs the nodes a search settles, in order, and the node at which the     *
+    * shortest path was found: the target, or the meeting node of the two      *
+    * frontiers of a bidirectional search.                                     *
+    ***************************************************************************/
+    typedef struct search_recorder_t search_recorder_t;
+
+    /***************************************************************************
+    * Allocates a new, empty recorder.                                         *
+    ***************************************************************************/
+    search_recorder_t* search_recorder_t_alloc(void);
+
+    /***************************************************************************
+    * Appends a settled node.                                                  *
+    ***************************************************************************/
+    void search_recorder_t_settle(search_recorder_t* p_recorder,
+                                  directed_graph_node_t* p_node,
+                                  double g,
+                                  double f,
+                                  search_direction_t direction);
+
+    /***************************************************************************
+    * Sets the node at which the shortest path was found.                      *
+    ***************************************************************************/
+    void search_recorder_t_meet(search_recorder_t* p_recorder,
+                                directed_graph_node_t* p_node);
+
+    /***************************************************************************
+    * Returns the number of settled nodes recorded.                            *
+    ***************************************************************************/
+    size_t search_recorder_t_size(search_recorder_t* p_recorder);
+
+    /***************************************************************************
+    * Returns the 'index'th settled node, or NULL if there is no such node.    *
+    ***************************************************************************/
+    const search_record_t* search_recorder_t_get(search_recorder_t* p_recorder,
+                                                 size_t index);
+
+    /***************************************************************************
+    * Returns the node at which the shortest path was found, or NULL if none   *
+    * was.                                                                     *
+    ***************************************************************************/
+    directed_graph_node_t* search_recorder_t_meeting_node(
+            search_recorder_t* p_recorder);
+
+    /***************************************************************************
+    * Saves the recording with the coordinates of 'p_location_map', which may  *
+    * be NULL. All numbers are little-endian. The file begins with a 32-byte   *
+    * header: the bytes "SREC", a 32-bit version, a 64-bit record count, the   *
+    * x, y and z of the meeting node as 32-bit floats and a 32-bit flag that   *
+    * is one if there is a meeting node. Each record then takes 24 bytes: x,   *
+    * y, z, g and f as 32-bit floats, and the direction as a 32-bit integer,   *
+    * zero for forward. Unknown coordinates are NaN. Returns false on an I/O   *
+    * error.                                                                   *
+    ***************************************************************************/
+    bool search_recorder_t_write(search_recorder_t* p_recorder,
+                                 unordered_map_t* p_location_map,
+                                 const char* p_file_name);
+
+    /***************************************************************************
+    * Drops all the records and the meeting node.                              *
+    ***************************************************************************/
+    void search_recorder_t_clear(search_recorder_t* p_recorder);
+
+    /***************************************************************************
+    * Deallocates the recorder.                                                *
+    ***************************************************************************/
+    void search_recorder_t_free(search_recorder_t* p_recorder);
+
+    /***************************************************************************
+    * The searches record only through the macros below, which do nothing if   *
+    * the recorder is NULL and then leave their other arguments unevaluated,   *
+    * so the f-cost of a settled node is only computed when it is recorded.    *
+    * Compiling with -DNO_SEARCH_RECORDER turns all of them into no-ops.       *
+    ***************************************************************************/
+#ifndef NO_SEARCH_RECORDER
+
+#define SEARCH_RECORDER_CLEAR(p_recorder)                                      \
+    do { if (p_recorder) search_recorder_t_clear(p_recorder); } while (0)
+
+#define SEARCH_RECORDER_SETTLE(p_recorder, p_node, g, f, direction)            \
+    do                                                                         \
+    {                                                                          \
+        if (p_recorder)                                                        \
+        {                                                                      \
+            search_recorder_t_settle((p_recorder),                             \
+                                     (p_node),                                 \
+                                     (g),                                      \
+                                     (f),                                      \
+                                     (direction));                             \
+        }                                                                      \
+    }                                                                          \
+    while (0)
+
+#define SEARCH_RECORDER_MEET(p_recorder, p_node)                               \
+    do { if (p_recorder) search_recorder_t_meet((p_recorder), (p_node)); }     \
+    while (0)
+
+#else
+
+#define SEARCH_RECORDER_CLEAR(p_recorder)                 ((void) (p_recorder))
+#define SEARCH_RECORDER_SETTLE(p_recorder, p_node, g, f, direction)            \
+                                                          ((void) (p_recorder))
+#define SEARCH_RECORDER_MEET(p_recorder, p_node)          ((void) (p_recorder))
+
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SEARCH_RECORDER_H */
@@ -0,0 +1,38 @@
+#include "search_stats.h"
+#include <string.h>
+#include <time.h>
+
+static unsigned long long now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void search_stats_t_clear(search_stats_t* p_stats)
+{
+    if (!p_stats) return;
+
+    memset(p_stats, 0, sizeof(*p_stats));
+}
+
+void search_stats_t_start(search_stats_t* p_stats)
+{
+    if (!p_stats) return;
+
+    memset(p_stats, 0, sizeof(*p_stats));
+    p_stats->phase_start = now();
+}
+
+void search_stats_t_end_phase(search_stats_t* p_stats,
+                              unsigned long long* p_phase_time)
+{
+    unsigned long long end;
+
+    if (!p_stats || !p_phase_time) return;
+
+    end = now();
+    *p_phase_time += end - p_stats->phase_start;
+    p_stats->phase_start = end;
+}
@@ -0,0 +1,96 @@
+#ifndef SEARCH_STATS_H
+#define	SEARCH_STATS_H
+
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * Describes how much work a single search did. The times are wall-clock    *
+    * nanoseconds spent in each phase of the search: allocating and seeding    *
+    * the search state, the main loop, reconstructing the path and releasing   *
+    * the search state.                                                        *
+    ***************************************************************************/
+    typedef struct search_stats_t {
+        size_t             nodes_settled;
+        size_t             arcs_relaxed;
+        size_t             decrease_keys;
+        size_t             heap_pushes;
+        size_t             heap_pops;
+        size_t             peak_open_set;
+        /* The most bytes the search state took from the allocator. */
+        size_t             peak_memory;
+        unsigned long long setup_time;
+        unsigned long long search_time;
+        unsigned long long traceback_time;
+        unsigned long long cleanup_time;
+        /* The time at which the current phase began. */
+        unsigned long long phase_start;
+    } search_stats_t;
+
+    /***************************************************************************
+    * Resets all the counters to zero. Does nothing if 'p_stats' is NULL.      *
+    ***************************************************************************/
+    void search_stats_t_clear(search_stats_t* p_stats);
+
+    /***************************************************************************
+    * Resets all the counters and starts timing the first phase of a search.   *
+    * Does nothing if 'p_stats' is NULL.                                       *
+    ***************************************************************************/
+    void search_stats_t_start(search_stats_t* p_stats);
+
+    /***************************************************************************
+    * Adds the time elapsed since the start of the current phase to            *
+    * '*p_phase_time' and starts the next phase.                               *
+    ***************************************************************************/
+    void search_stats_t_end_phase(search_stats_t* p_stats,
+                                  unsigned long long* p_phase_time);
+
+    /***************************************************************************
+    * The searches collect their statistics only through the macros below.     *
+    * Compiling with -DNO_SEARCH_STATS turns all of them into no-ops, so that  *
+    * the searches do no bookkeeping at all and leave 'p_stats' untouched.     *
+    ***************************************************************************/
+#ifndef NO_SEARCH_STATS
+
+#define SEARCH_STATS_START(p_stats) search_stats_t_start(p_stats)
+
+#define SEARCH_STATS_ADD(p_stats, counter, amount)                             \
+    do { if (p_stats) (p_stats)->counter += (amount); } while (0)
+
+#define SEARCH_STATS_COUNT(p_stats, counter) SEARCH_STATS_ADD(p_stats, counter, 1)
+
+#define SEARCH_STATS_PEAK(p_stats, peak, value)                                \
+    do                                                                         \
+    {                                                                          \
+        if ((p_stats) && (p_stats)->peak < (size_t)(value))                    \
+        {                                                                      \
+            (p_stats)->peak = (size_t)(value);                                 \
+        }                                                                      \
+    }                                                                          \
+    while (0)
+
+#define SEARCH_STATS_END_PHASE(p_stats, phase)                                 \
+    do                                                                         \
+    {                                                                          \
+        if (p_stats) search_stats_t_end_phase((p_stats), &(p_stats)->phase);   \
+    }                                                                          \
+    while (0)
+
+#else
+
+#define SEARCH_STATS_START(p_stats)                ((void) (p_stats))
+#define SEARCH_STATS_ADD(p_stats, counter, amount) ((void) (p_stats))
+#define SEARCH_STATS_COUNT(p_stats, counter)       ((void) (p_stats))
+#define SEARCH_STATS_PEAK(p_stats, peak, value)    ((void) (p_stats))
+#define SEARCH_STATS_END_PHASE(p_stats, phase)     ((void) (p_stats))
+
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SEARCH_STATS_H */
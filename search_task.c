@@ -0,0 +1,489 @@
+#include "search_task.h"
+#include "directed_graph_node.h"
+#include "heap.h"
+#include "list.h"
+#include "utils.h"
+#include <float.h>
+
+/* The number of neighbours whose estimates are computed in one batch. */
+#define HEURISTIC_BATCH 64
+
+/* The indices of the two searches of a task. */
+#define FORWARD  0
+#define BACKWARD 1
+
+struct search_task_t {
+    directed_graph_weight_function_t* p_weight_function;
+    heuristic_t                       heuristic;
+    bool                              informed;
+    bool                              bidirectional;
+    search_stats_t*                   p_stats;
+    search_recorder_t*                p_recorder;
+    search_budget_t*                  p_budget;
+    /* The forward search and, if the task is bidirectional, the backward
+       one. The heap of each is keyed by the costs for Dijkstra's algorithm
+       and by the costs plus the estimates for A*. */
+    search_state_t                    states[2];
+    directed_graph_node_t*            p_source;
+    directed_graph_node_t*            p_target;
+    /* The node at which the best path the two searches found meets. */
+    directed_graph_node_t*            p_touch_node;
+    double                            best_path_cost;
+    size_t                            settled;
+    search_progress_t                 progress;
+};
+
+static double cost_of(search_state_t* p_state, directed_graph_node_t* p_node)
+{
+    return ((weight_t*) unordered_map_t_get(p_state->p_cost_map,
+                                            p_node))->weight;
+}
+
+/*******************************************************************************
+* Returns the estimate of the search 'side' for 'p_node': the one to the       *
+* target for the forward search and the one from the source for the backward   *
+* search, or zero for Dijkstra's algorithm.                                    *
+*******************************************************************************/
+static double estimate_of(search_task_t* p_task,
+                          int side,
+                          directed_graph_node_t* p_node)
+{
+    if (!p_task->informed) return 0.0;
+
+    return side == FORWARD ?
+           heuristic_t_estimate(&p_task->heuristic, p_node, p_task->p_target) :
+           heuristic_t_estimate(&p_task->heuristic, p_task->p_source, p_node);
+}
+
+/*******************************************************************************
+* Sets the cost and the parent of 'p_node' in the search 'side' and adds the   *
+* node to its open set, or lowers its key there. Returns false if there is not *
+* enough memory.                                                               *
+*******************************************************************************/
+static bool reach(search_task_t* p_task,
+                  int side,
+                  directed_graph_node_t* p_node,
+                  directed_graph_node_t* p_parent,
+                  double cost,
+                  double estimate)
+{
+    search_state_t* p_state = &p_task->states[side];
+    weight_t*       p_weight;
+    weight_t*       p_key;
+
+    if (!(p_weight = allocator_t_alloc(p_state->p_allocator,
+                                       sizeof(*p_weight))))
+    {
+        return false;
+    }
+
+    p_weight->weight = cost;
+    list_t_push_back(p_state->p_weight_list, p_weight);
+    p_key = p_weight;
+
+    if (p_task->informed)
+    {
+        if (!(p_key = allocator_t_alloc(p_state->p_allocator,
+                                        sizeof(*p_key))))
+        {
+            return false;
+        }
+
+        p_key->weight = cost + estimate;
+        list_t_push_back(p_state->p_weight_list, p_key);
+    }
+
+    if (unordered_map_t_contains_key(p_state->p_cost_map, p_node))
+    {
+        heap_t_decrease_key(p_state->p_open_set, p_node, p_key);
+        SEARCH_STATS_COUNT(p_task->p_stats, decrease_keys);
+    }
+    else
+    {
+        heap_t_add(p_state->p_open_set, p_node, p_key);
+        SEARCH_STATS_COUNT(p_task->p_stats, heap_pushes);
+    }
+
+    unordered_map_t_put(p_state->p_cost_map, p_node, p_weight);
+    unordered_map_t_put(p_state->p_parent_map, p_node, p_parent);
+    return true;
+}
+
+/*******************************************************************************
+* Settles the next node of the search 'side' and relaxes its arcs. Returns     *
+* false if there is not enough memory or the backward search meets a node      *
+* whose parents are not known.                                                 *
+*******************************************************************************/
+static bool settle(search_task_t* p_task, int side)
+{
+    search_state_t*         p_state = &p_task->states[side];
+    search_state_t*         p_other = &p_task->states[1 - side];
+    directed_graph_node_t*  p_current;
+    directed_graph_node_t*  p_next;
+    directed_graph_node_t** p_neighbours;
+    weight_t*               p_old_cost;
+    size_t                  neighbour_count;
+    size_t                  i;
+    double                  estimates[HEURISTIC_BATCH];
+    double                  cost;
+    double                  path_cost;
+
+    p_current = heap_t_extract_min(p_state->p_open_set);
+    unordered_set_t_add(p_state->p_closed_set, p_current);
+    ++p_task->settled;
+
+    SEARCH_STATS_COUNT(p_task->p_stats, heap_pops);
+    SEARCH_STATS_COUNT(p_task->p_stats, nodes_settled);
+    SEARCH_RECORDER_SETTLE(p_task->p_recorder,
+                           p_current,
+                           cost_of(p_state, p_current),
+                           cost_of(p_state, p_current) +
+                           estimate_of(p_task, side, p_current),
+                           side == FORWARD ? SEARCH_FORWARD : SEARCH_BACKWARD);
+
+    if (!p_task->bidirectional && equals_function(p_current,
+                                                  p_task->p_target))
+    {
+        SEARCH_RECORDER_MEET(p_task->p_recorder, p_current);
+        p_task->progress = SEARCH_PROGRESS_FOUND;
+        return true;
+    }
+
+    if (side == FORWARD)
+    {
+        p_neighbours    = directed_graph_node_t_children(p_current);
+        neighbour_count = directed_graph_node_t_child_count(p_current);
+    }
+    else if (directed_graph_node_t_parents_known(p_current))
+    {
+        p_neighbours    = directed_graph_node_t_parents(p_current);
+        neighbour_count = directed_graph_node_t_parent_count(p_current);
+    }
+    else
+    {
+        /* Missing parents would hide paths, so give up instead. */
+        return false;
+    }
+
+    for (i = 0; i < neighbour_count; ++i)
+    {
+        p_next = p_neighbours[i];
+
+        /* Estimate the neighbours ahead, closed or not, in one batch. */
+        if (p_task->informed && i % HEURISTIC_BATCH == 0)
+        {
+            if (side == FORWARD)
+            {
+                heuristic_t_estimate_batch(
+                        &p_task->heuristic,
+                        p_neighbours + i,
+                        neighbour_count - i < HEURISTIC_BATCH ?
+                                neighbour_count - i : HEURISTIC_BATCH,
+                        p_task->p_target,
+                        estimates);
+            }
+            else
+            {
+                heuristic_t_estimate_batch_to(
+                        &p_task->heuristic,
+                        p_task->p_source,
+                        p_neighbours + i,
+                        neighbour_count - i < HEURISTIC_BATCH ?
+                                neighbour_count - i : HEURISTIC_BATCH,
+                        estimates);
+            }
+        }
+
+        if (unordered_set_t_contains(p_state->p_closed_set, p_next)) continue;
+
+        SEARCH_STATS_COUNT(p_task->p_stats, arcs_relaxed);
+
+        cost = cost_of(p_state, p_current) +
+               *directed_graph_weight_function_t_get(
+                       p_task->p_weight_function,
+                       side == FORWARD ? p_current : p_next,
+                       side == FORWARD ? p_next : p_current);
+        p_old_cost = unordered_map_t_get(p_state->p_cost_map, p_next);
+
+        if (p_old_cost && p_old_cost->weight <= cost) continue;
+
+        if (!reach(p_task,
+                   side,
+                   p_next,
+                   p_current,
+                   cost,
+                   p_task->informed ? estimates[i % HEURISTIC_BATCH] : 0.0))
+        {
+            return false;
+        }
+
+        SEARCH_STATS_PEAK(p_task->p_stats,
+                          peak_open_set,
+                          heap_t_size(p_state->p_open_set) +
+                          (p_task->bidirectional ?
+                                  heap_t_size(p_other->p_open_set) : 0));
+
+        /* Check whether the node improves the path between the searches. */
+        if (p_task->bidirectional &&
+                unordered_set_t_contains(p_other->p_closed_set, p_next))
+        {
+            path_cost = cost + cost_of(p_other, p_next);
+
+            if (p_task->best_path_cost > path_cost)
+            {
+                p_task->best_path_cost = path_cost;
+                p_task->p_touch_node   = p_next;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Returns the least key of the open set of the search 'side'.                  *
+*******************************************************************************/
+static double least_key(search_task_t* p_task, int side)
+{
+    directed_graph_node_t* p_node = heap_t_min(p_task->states[side].p_open_set);
+
+    return cost_of(&p_task->states[side], p_node) +
+           estimate_of(p_task, side, p_node);
+}
+
+/*******************************************************************************
+* Returns true if no path through the open sets of a bidirectional task can be *
+* shorter than the best one found.                                             *
+*******************************************************************************/
+static bool searches_done(search_task_t* p_task)
+{
+    double key_a;
+    double key_b;
+
+    if (!p_task->p_touch_node) return false;
+
+    key_a = least_key(p_task, FORWARD);
+    key_b = least_key(p_task, BACKWARD);
+
+    return p_task->informed ?
+           p_task->best_path_cost < (key_a > key_b ? key_a : key_b) :
+           p_task->best_path_cost < key_a + key_b;
+}
+
+static size_t memory_usage(search_task_t* p_task)
+{
+    return search_state_t_memory_usage(&p_task->states[FORWARD]) +
+           (p_task->bidirectional ?
+                   search_state_t_memory_usage(&p_task->states[BACKWARD]) :
+                   0);
+}
+
+search_task_t* search_task_t_alloc(
+        search_algorithm_t algorithm,
+        directed_graph_weight_function_t* p_weight_function,
+        unordered_map_t* p_location_map,
+        search_options_t* p_options)
+{
+    search_task_t* p_task;
+    allocator_t*   p_allocator = p_options ? p_options->p_allocator : NULL;
+
+    if (!p_weight_function) return NULL;
+
+    if (!(p_task = allocator_t_calloc(p_allocator, 1, sizeof(*p_task))))
+    {
+        return NULL;
+    }
+
+    p_task->p_weight_function = p_weight_function;
+    p_task->p_stats           = p_options ? p_options->p_stats : NULL;
+    p_task->p_recorder        = p_options ? p_options->p_recorder : NULL;
+    p_task->p_budget          = p_options ? p_options->p_budget : NULL;
+    p_task->informed          = algorithm == SEARCH_ALGORITHM_ASTAR ||
+                                algorithm ==
+                                        SEARCH_ALGORITHM_BIDIRECTIONAL_ASTAR;
+    p_task->bidirectional     = algorithm ==
+                                        SEARCH_ALGORITHM_BIDIRECTIONAL_DIJKSTRA ||
+                                algorithm ==
+                                        SEARCH_ALGORITHM_BIDIRECTIONAL_ASTAR;
+    p_task->progress          = SEARCH_PROGRESS_IDLE;
+
+    search_state_t_alloc(&p_task->states[FORWARD], p_allocator);
+    search_state_t_alloc(&p_task->states[BACKWARD], p_allocator);
+
+    if ((p_task->informed && !choose_heuristic(&p_task->heuristic,
+                                               p_location_map,
+                                               p_options))
+            || !search_state_t_is_ready(&p_task->states[FORWARD])
+            || !search_state_t_is_ready(&p_task->states[BACKWARD]))
+    {
+        search_task_t_free(p_task);
+        return NULL;
+    }
+
+    return p_task;
+}
+
+bool search_task_t_start(search_task_t* p_task,
+                         directed_graph_node_t* p_source,
+                         directed_graph_node_t* p_target)
+{
+    if (!p_task || !p_source || !p_target) return false;
+
+    search_state_t_clear(&p_task->states[FORWARD]);
+    search_state_t_clear(&p_task->states[BACKWARD]);
+
+    p_task->p_source       = p_source;
+    p_task->p_target       = p_target;
+    p_task->p_touch_node   = NULL;
+    p_task->best_path_cost = DBL_MAX;
+    p_task->settled        = 0;
+    p_task->progress       = SEARCH_PROGRESS_IDLE;
+
+    SEARCH_STATS_START(p_task->p_stats);
+    SEARCH_RECORDER_CLEAR(p_task->p_recorder);
+    search_budget_t_start(p_task->p_budget);
+
+    if (!reach(p_task,
+               FORWARD,
+               p_source,
+               NULL,
+               0.0,
+               estimate_of(p_task, FORWARD, p_source)))
+    {
+        return false;
+    }
+
+    if (p_task->bidirectional)
+    {
+        if (!reach(p_task,
+                   BACKWARD,
+                   p_target,
+                   NULL,
+                   0.0,
+                   estimate_of(p_task, BACKWARD, p_target)))
+        {
+            return false;
+        }
+
+        if (equals_function(p_source, p_target))
+        {
+            SEARCH_RECORDER_MEET(p_task->p_recorder, p_source);
+            p_task->p_touch_node   = p_source;
+            p_task->best_path_cost = 0.0;
+            p_task->progress       = SEARCH_PROGRESS_FOUND;
+            return true;
+        }
+    }
+
+    p_task->progress = SEARCH_PROGRESS_RUNNING;
+    return true;
+}
+
+search_progress_t search_task_t_step(search_task_t* p_task,
+                                     size_t max_settles)
+{
+    heap_t* p_open_set_a;
+    heap_t* p_open_set_b;
+    size_t  n;
+
+    if (!p_task) return SEARCH_PROGRESS_IDLE;
+
+    p_open_set_a = p_task->states[FORWARD].p_open_set;
+    p_open_set_b = p_task->states[BACKWARD].p_open_set;
+
+    for (n = 0; n < max_settles &&
+                p_task->progress == SEARCH_PROGRESS_RUNNING; ++n)
+    {
+        if (p_task->bidirectional)
+        {
+            if (heap_t_size(p_open_set_a) == 0 ||
+                heap_t_size(p_open_set_b) == 0)
+            {
+                /* One of the searches ran out of nodes, maybe after the two
+                   have met. */
+                p_task->progress = p_task->p_touch_node ?
+                                   SEARCH_PROGRESS_FOUND :
+                                   SEARCH_PROGRESS_UNREACHABLE;
+                break;
+            }
+
+            if (searches_done(p_task))
+            {
+                p_task->progress = SEARCH_PROGRESS_FOUND;
+                break;
+            }
+        }
+        else if (heap_t_size(p_open_set_a) == 0)
+        {
+            p_task->progress = SEARCH_PROGRESS_UNREACHABLE;
+            break;
+        }
+
+        if (SEARCH_BUDGET_EXHAUSTED(p_task->p_budget,
+                                    p_task->settled,
+                                    memory_usage(p_task)))
+        {
+            p_task->progress = SEARCH_PROGRESS_FAILED;
+            break;
+        }
+
+        SEARCH_STATS_PEAK(p_task->p_stats, peak_memory, memory_usage(p_task));
+
+        if (!settle(p_task,
+                    p_task->bidirectional &&
+                    heap_t_size(p_open_set_a) > heap_t_size(p_open_set_b) ?
+                            BACKWARD : FORWARD))
+        {
+            p_task->progress = SEARCH_PROGRESS_FAILED;
+        }
+    }
+
+    if (p_task->bidirectional && p_task->progress == SEARCH_PROGRESS_FOUND)
+    {
+        SEARCH_RECORDER_MEET(p_task->p_recorder, p_task->p_touch_node);
+    }
+
+    return p_task->progress;
+}
+
+search_progress_t search_task_t_progress(search_task_t* p_task)
+{
+    return p_task ? p_task->progress : SEARCH_PROGRESS_IDLE;
+}
+
+size_t search_task_t_settled(search_task_t* p_task)
+{
+    return p_task ? p_task->settled : 0;
+}
+
+list_t* search_task_t_result(search_task_t* p_task)
+{
+    if (!p_task) return NULL;
+
+    switch (p_task->progress)
+    {
+        case SEARCH_PROGRESS_FOUND:
+            return p_task->bidirectional ?
+                   traceback_bidirectional_path(
+                           p_task->p_touch_node,
+                           p_task->states[FORWARD].p_parent_map,
+                           p_task->states[BACKWARD].p_parent_map) :
+                   traceback_path(p_task->p_target,
+                                  p_task->states[FORWARD].p_parent_map);
+
+        case SEARCH_PROGRESS_UNREACHABLE:
+            return list_t_alloc(INITIAL_CAPACITY, NULL);
+
+        default:
+            return NULL;
+    }
+}
+
+void search_task_t_free(search_task_t* p_task)
+{
+    if (!p_task) return;
+
+    search_state_t_free(&p_task->states[FORWARD]);
+    search_state_t_free(&p_task->states[BACKWARD]);
+    allocator_t_free(p_task->states[FORWARD].p_allocator, p_task);
+}
@@ -0,0 +1,105 @@
+#ifndef SEARCH_TASK_H
+#define	SEARCH_TASK_H
+
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include "unordered_map.h"
+#include "list.h"
+#include "search_options.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The searches a task can run.                                             *
+    ***************************************************************************/
+    typedef enum search_algorithm_t {
+        SEARCH_ALGORITHM_DIJKSTRA,
+        SEARCH_ALGORITHM_ASTAR,
+        SEARCH_ALGORITHM_BIDIRECTIONAL_DIJKSTRA,
+        SEARCH_ALGORITHM_BIDIRECTIONAL_ASTAR
+    } search_algorithm_t;
+
+    /***************************************************************************
+    * Where a task stands.                                                     *
+    ***************************************************************************/
+    typedef enum search_progress_t {
+        /* Not started, or started without enough memory. */
+        SEARCH_PROGRESS_IDLE,
+        SEARCH_PROGRESS_RUNNING,
+        SEARCH_PROGRESS_FOUND,
+        SEARCH_PROGRESS_UNREACHABLE,
+        /* Out of memory or out of budget, which the status of the budget
+           tells, or a backward search met a node whose parents are not
+           known. */
+        SEARCH_PROGRESS_FAILED
+    } search_progress_t;
+
+    /***************************************************************************
+    * A search that runs a few nodes at a time, so that one thread can take    *
+    * turns between many of them and put the urgent ones first. It finds the   *
+    * same paths as the blocking search it is named after. A task keeps its    *
+    * search states between queries, so starting it again reuses their         *
+    * memory.                                                                  *
+    ***************************************************************************/
+    typedef struct search_task_t search_task_t;
+
+    /***************************************************************************
+    * Allocates a task running 'algorithm' over the arcs weighted by           *
+    * 'p_weight_function'. The A* searches choose their heuristic as           *
+    * 'astar_with_options' does, so 'p_location_map' may be NULL if the        *
+    * options give one; the Dijkstra searches ignore it. The options, which    *
+    * may be NULL, must outlive the task: their counters add up over the steps *
+    * of a query, which leave the phase times alone, and their budget applies  *
+    * to each query as a whole. The heap trace is not used. A bidirectional    *
+    * task needs the parents of the nodes. Returns NULL if there is no         *
+    * heuristic for A* or there is not enough memory.                          *
+    ***************************************************************************/
+    search_task_t* search_task_t_alloc(
+            search_algorithm_t algorithm,
+            directed_graph_weight_function_t* p_weight_function,
+            unordered_map_t* p_location_map,
+            search_options_t* p_options);
+
+    /***************************************************************************
+    * Drops the query of the task, if any, and starts one from 'p_source' to   *
+    * 'p_target'. Returns false if there is not enough memory.                 *
+    ***************************************************************************/
+    bool search_task_t_start(search_task_t* p_task,
+                             directed_graph_node_t* p_source,
+                             directed_graph_node_t* p_target);
+
+    /***************************************************************************
+    * Settles at most 'max_settles' more nodes and returns the progress of the *
+    * task. Does nothing unless the task is running.                           *
+    ***************************************************************************/
+    search_progress_t search_task_t_step(search_task_t* p_task,
+                                         size_t max_settles);
+
+    /***************************************************************************
+    * Returns the progress of the task.                                        *
+    ***************************************************************************/
+    search_progress_t search_task_t_progress(search_task_t* p_task);
+
+    /***************************************************************************
+    * Returns the number of nodes the current query has settled.               *
+    ***************************************************************************/
+    size_t search_task_t_settled(search_task_t* p_task);
+
+    /***************************************************************************
+    * Returns a new list holding the path found, an empty one if the target is *
+    * unreachable, or NULL if the task is in any other state.                  *
+    ***************************************************************************/
+    list_t* search_task_t_result(search_task_t* p_task);
+
+    /***************************************************************************
+    * Deallocates the task.                                                    *
+    ***************************************************************************/
+    void search_task_t_free(search_task_t* p_task);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SEARCH_TASK_H */
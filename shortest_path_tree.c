@@ -0,0 +1,511 @@
+#include "shortest_path_tree.h"
+#include "heap.h"
+#include "unordered_map.h"
+#include "unordered_set.h"
+#include "utils.h"
+#include <math.h>
+
+/*******************************************************************************
+* The place of a node in the tree. 'distance' is the priority of the node in   *
+* the open set, so it may only change while the node is out of it.             *
+*******************************************************************************/
+typedef struct tree_node_t {
+    weight_t               distance;
+    directed_graph_node_t* p_parent;
+    /* The distance before the repair that first changed it. */
+    double                 old_distance;
+    /* The repair that last changed the node. */
+    size_t                 stamp;
+} tree_node_t;
+
+struct shortest_path_tree_t {
+    directed_graph_node_t*            p_source;
+    directed_graph_weight_function_t* p_weight_function;
+    allocator_t*                      p_allocator;
+    /* Maps each node ever reached to its place in the tree. */
+    unordered_map_t*                  p_node_map;
+    /* Owns the places of the nodes. */
+    list_t*                           p_record_list;
+    heap_t*                           p_open_set;
+    /* The nodes changed by the current repair. */
+    list_t*                           p_touched_list;
+    /* The nodes below the tree arcs the current repair broke. */
+    unordered_set_t*                  p_affected_set;
+    list_t*                           p_affected_list;
+    size_t                            stamp;
+    size_t                            reached;
+    size_t                            settled;
+};
+
+static double distance_of(shortest_path_tree_t* p_tree,
+                          directed_graph_node_t* p_node)
+{
+    tree_node_t* p_record = unordered_map_t_get(p_tree->p_node_map, p_node);
+
+    return p_record ? p_record->distance.weight : INFINITY;
+}
+
+/*******************************************************************************
+* Returns the place of 'p_node', recording it as unreached on first use, or    *
+* NULL if there is not enough memory.                                          *
+*******************************************************************************/
+static tree_node_t* record_of(shortest_path_tree_t* p_tree,
+                              directed_graph_node_t* p_node)
+{
+    tree_node_t* p_record = unordered_map_t_get(p_tree->p_node_map, p_node);
+
+    if (p_record) return p_record;
+
+    if (!(p_record = allocator_t_alloc(p_tree->p_allocator,
+                                       sizeof(*p_record))))
+    {
+        return NULL;
+    }
+
+    p_record->distance.weight = INFINITY;
+    p_record->p_parent        = NULL;
+    p_record->old_distance    = INFINITY;
+    /* No repair changed it yet, so the current one reports it. */
+    p_record->stamp           = p_tree->stamp - 1;
+
+    if (!list_t_push_back(p_tree->p_record_list, p_record))
+    {
+        allocator_t_free(p_tree->p_allocator, p_record);
+        return NULL;
+    }
+
+    unordered_map_t_put(p_tree->p_node_map, p_node, p_record);
+    return p_record;
+}
+
+/*******************************************************************************
+* Moves 'p_node' under 'p_parent' at 'distance' and requeues it if it is       *
+* reached. Returns false if there is not enough memory.                        *
+*******************************************************************************/
+static bool place_node(shortest_path_tree_t* p_tree,
+                       directed_graph_node_t* p_node,
+                       tree_node_t* p_record,
+                       directed_graph_node_t* p_parent,
+                       double distance)
+{
+    /* Remember the old distance the first time this repair changes it. */
+    if (p_record->stamp != p_tree->stamp)
+    {
+        if (!list_t_push_back(p_tree->p_touched_list, p_node)) return false;
+
+        p_record->stamp        = p_tree->stamp;
+        p_record->old_distance = p_record->distance.weight;
+    }
+
+    if (p_record->distance.weight == INFINITY && distance != INFINITY)
+    {
+        ++p_tree->reached;
+    }
+    else if (p_record->distance.weight != INFINITY && distance == INFINITY)
+    {
+        --p_tree->reached;
+    }
+
+    heap_t_remove(p_tree->p_open_set, p_node);
+    p_record->distance.weight = distance;
+    p_record->p_parent        = p_parent;
+
+    return distance == INFINITY ||
+           heap_t_add(p_tree->p_open_set, p_node, &p_record->distance);
+}
+
+/*******************************************************************************
+* Settles the nodes of the open set in the order of their distances, lowering  *
+* the distances of their children as in Dijkstra's algorithm. Returns false if *
+* there is not enough memory.                                                  *
+*******************************************************************************/
+static bool settle_open_nodes(shortest_path_tree_t* p_tree)
+{
+    directed_graph_node_t*  p_current;
+    directed_graph_node_t*  p_child;
+    directed_graph_node_t** p_children;
+    tree_node_t*            p_child_record;
+    size_t                  child_count;
+    size_t                  i;
+    double                  distance;
+
+    while (heap_t_size(p_tree->p_open_set) > 0)
+    {
+        p_current   = heap_t_extract_min(p_tree->p_open_set);
+        p_children  = directed_graph_node_t_children(p_current);
+        child_count = directed_graph_node_t_child_count(p_current);
+        ++p_tree->settled;
+
+        for (i = 0; i < child_count; ++i)
+        {
+            p_child  = p_children[i];
+            distance = distance_of(p_tree, p_current) +
+                       *directed_graph_weight_function_t_get(
+                               p_tree->p_weight_function,
+                               p_current,
+                               p_child);
+
+            if (distance >= distance_of(p_tree, p_child)) continue;
+
+            if (!(p_child_record = record_of(p_tree, p_child)) ||
+                !place_node(p_tree,
+                            p_child,
+                            p_child_record,
+                            p_current,
+                            distance))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Marks the head of the arc from 'p_tail' to 'p_head' as affected if the arc   *
+* is in the tree and got heavier or was removed. Returns false if there is not *
+* enough memory.                                                               *
+*******************************************************************************/
+static bool break_arc(shortest_path_tree_t* p_tree,
+                      directed_graph_node_t* p_tail,
+                      directed_graph_node_t* p_head)
+{
+    tree_node_t* p_record = unordered_map_t_get(p_tree->p_node_map, p_head);
+
+    if (!p_record || p_record->p_parent != p_tail) return true;
+
+    if (directed_graph_node_t_has_child(p_tail, p_head) &&
+        distance_of(p_tree, p_tail) +
+        *directed_graph_weight_function_t_get(p_tree->p_weight_function,
+                                              p_tail,
+                                              p_head)
+        <= p_record->distance.weight)
+    {
+        return true;
+    }
+
+    if (unordered_set_t_contains(p_tree->p_affected_set, p_head)) return true;
+
+    unordered_set_t_add(p_tree->p_affected_set, p_head);
+    return list_t_push_back(p_tree->p_affected_list, p_head);
+}
+
+/*******************************************************************************
+* Moves 'p_head' under 'p_tail' if the arc between them is a shortcut. Returns *
+* false if there is not enough memory.                                         *
+*******************************************************************************/
+static bool offer_arc(shortest_path_tree_t* p_tree,
+                      directed_graph_node_t* p_tail,
+                      directed_graph_node_t* p_head)
+{
+    tree_node_t* p_record;
+    double       distance;
+
+    if (!directed_graph_node_t_has_child(p_tail, p_head) ||
+        distance_of(p_tree, p_tail) == INFINITY)
+    {
+        return true;
+    }
+
+    distance = distance_of(p_tree, p_tail) +
+               *directed_graph_weight_function_t_get(p_tree->p_weight_function,
+                                                     p_tail,
+                                                     p_head);
+
+    if (distance >= distance_of(p_tree, p_head)) return true;
+
+    return (p_record = record_of(p_tree, p_head)) &&
+           place_node(p_tree, p_head, p_record, p_tail, distance);
+}
+
+/*******************************************************************************
+* Unsettles the subtree of the head of each tree arc that got heavier or was   *
+* removed and puts each of its nodes back at the best distance the rest of the *
+* tree offers. Returns false if there is not enough memory or the parents of   *
+* an affected node are not known.                                              *
+*******************************************************************************/
+static bool unsettle_subtrees(shortest_path_tree_t* p_tree,
+                              directed_graph_node_t** p_tails,
+                              directed_graph_node_t** p_heads,
+                              size_t count)
+{
+    unordered_set_t*        p_affected_set  = p_tree->p_affected_set;
+    list_t*                 p_affected_list = p_tree->p_affected_list;
+    directed_graph_node_t*  p_node;
+    directed_graph_node_t** p_neighbours;
+    tree_node_t*            p_record;
+    tree_node_t*            p_neighbour_record;
+    size_t                  neighbour_count;
+    size_t                  i;
+    size_t                  j;
+    double                  distance;
+
+    unordered_set_t_clear(p_affected_set);
+    list_t_clear(p_affected_list);
+
+    for (i = 0; i < count; ++i)
+    {
+        if (!break_arc(p_tree, p_tails[i], p_heads[i])) return false;
+
+        if (directed_graph_node_t_is_undirected(p_tails[i]) &&
+            !break_arc(p_tree, p_heads[i], p_tails[i]))
+        {
+            return false;
+        }
+    }
+
+    /* Gather the subtrees below the affected arcs; the list grows as it is
+       walked. */
+    for (i = 0; i < list_t_size(p_affected_list); ++i)
+    {
+        p_node          = list_t_get(p_affected_list, i);
+        p_neighbours    = directed_graph_node_t_children(p_node);
+        neighbour_count = directed_graph_node_t_child_count(p_node);
+
+        for (j = 0; j < neighbour_count; ++j)
+        {
+            p_neighbour_record = unordered_map_t_get(p_tree->p_node_map,
+                                                     p_neighbours[j]);
+
+            if (p_neighbour_record &&
+                p_neighbour_record->p_parent == p_node &&
+                !unordered_set_t_contains(p_affected_set, p_neighbours[j]))
+            {
+                unordered_set_t_add(p_affected_set, p_neighbours[j]);
+
+                if (!list_t_push_back(p_affected_list, p_neighbours[j]))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < list_t_size(p_affected_list); ++i)
+    {
+        p_node = list_t_get(p_affected_list, i);
+
+        if (!place_node(p_tree,
+                        p_node,
+                        unordered_map_t_get(p_tree->p_node_map, p_node),
+                        NULL,
+                        INFINITY))
+        {
+            return false;
+        }
+    }
+
+    /* Offer each affected node the best parent outside of the subtrees. */
+    for (i = 0; i < list_t_size(p_affected_list); ++i)
+    {
+        p_node          = list_t_get(p_affected_list, i);
+        p_record        = unordered_map_t_get(p_tree->p_node_map, p_node);
+
+        /* Missing parents would hide paths, so give up instead. */
+        if (!directed_graph_node_t_parents_known(p_node)) return false;
+
+        p_neighbours    = directed_graph_node_t_parents(p_node);
+        neighbour_count = directed_graph_node_t_parent_count(p_node);
+
+        for (j = 0; j < neighbour_count; ++j)
+        {
+            if (unordered_set_t_contains(p_affected_set, p_neighbours[j]))
+            {
+                continue;
+            }
+
+            distance = distance_of(p_tree, p_neighbours[j]) +
+                       *directed_graph_weight_function_t_get(
+                               p_tree->p_weight_function,
+                               p_neighbours[j],
+                               p_node);
+
+            if (distance < p_record->distance.weight &&
+                !place_node(p_tree,
+                            p_node,
+                            p_record,
+                            p_neighbours[j],
+                            distance))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+shortest_path_tree_t* shortest_path_tree_t_alloc(
+        directed_graph_node_t* p_source,
+        directed_graph_weight_function_t* p_weight_function,
+        allocator_t* p_allocator)
+{
+    shortest_path_tree_t* p_tree;
+    tree_node_t*          p_record;
+
+    if (!p_source || !p_weight_function) return NULL;
+
+    if (!(p_tree = allocator_t_calloc(p_allocator, 1, sizeof(*p_tree))))
+    {
+        return NULL;
+    }
+
+    p_tree->p_source          = p_source;
+    p_tree->p_weight_function = p_weight_function;
+    p_tree->p_allocator       = p_allocator;
+    p_tree->p_node_map        = unordered_map_t_alloc(INITIAL_CAPACITY,
+                                                      LOAD_FACTOR,
+                                                      hash_function,
+                                                      equals_function,
+                                                      p_allocator);
+    p_tree->p_record_list     = list_t_alloc(INITIAL_CAPACITY, p_allocator);
+    p_tree->p_touched_list    = list_t_alloc(INITIAL_CAPACITY, p_allocator);
+    p_tree->p_affected_list   = list_t_alloc(INITIAL_CAPACITY, p_allocator);
+    p_tree->p_affected_set    = unordered_set_t_alloc(INITIAL_CAPACITY,
+                                                      LOAD_FACTOR,
+                                                      hash_function,
+                                                      equals_function,
+                                                      p_allocator);
+    p_tree->p_open_set        = heap_t_alloc(4,
+                                             INITIAL_CAPACITY,
+                                             LOAD_FACTOR,
+                                             hash_function,
+                                             equals_function,
+                                             priority_cmp,
+                                             p_allocator);
+
+    if (!p_tree->p_node_map || !p_tree->p_record_list ||
+        !p_tree->p_touched_list || !p_tree->p_affected_list ||
+        !p_tree->p_affected_set || !p_tree->p_open_set ||
+        !(p_record = record_of(p_tree, p_source)) ||
+        !place_node(p_tree, p_source, p_record, NULL, 0.0) ||
+        !settle_open_nodes(p_tree))
+    {
+        shortest_path_tree_t_free(p_tree);
+        return NULL;
+    }
+
+    list_t_clear(p_tree->p_touched_list);
+    return p_tree;
+}
+
+list_t* shortest_path_tree_t_update(shortest_path_tree_t* p_tree,
+                                    directed_graph_node_t** p_tails,
+                                    directed_graph_node_t** p_heads,
+                                    size_t count)
+{
+    directed_graph_node_t* p_node;
+    tree_node_t*           p_record;
+    list_t*                p_changed_list;
+    size_t                 i;
+
+    if (!p_tree) return NULL;
+
+    ++p_tree->stamp;
+    p_tree->settled = 0;
+    list_t_clear(p_tree->p_touched_list);
+
+    if (!unsettle_subtrees(p_tree, p_tails, p_heads, count)) return NULL;
+
+    /* Offer the head of each arc the path over it. */
+    for (i = 0; i < count; ++i)
+    {
+        if (!offer_arc(p_tree, p_tails[i], p_heads[i])) return NULL;
+
+        if (directed_graph_node_t_is_undirected(p_tails[i]) &&
+            !offer_arc(p_tree, p_heads[i], p_tails[i]))
+        {
+            return NULL;
+        }
+    }
+
+    if (!settle_open_nodes(p_tree) ||
+        !(p_changed_list = list_t_alloc(INITIAL_CAPACITY, NULL)))
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < list_t_size(p_tree->p_touched_list); ++i)
+    {
+        p_node   = list_t_get(p_tree->p_touched_list, i);
+        p_record = unordered_map_t_get(p_tree->p_node_map, p_node);
+
+        if (p_record->distance.weight != p_record->old_distance)
+        {
+            list_t_push_back(p_changed_list, p_node);
+        }
+    }
+
+    return p_changed_list;
+}
+
+double shortest_path_tree_t_distance(shortest_path_tree_t* p_tree,
+                                     directed_graph_node_t* p_node)
+{
+    return p_tree ? distance_of(p_tree, p_node) : INFINITY;
+}
+
+directed_graph_node_t* shortest_path_tree_t_parent(
+        shortest_path_tree_t* p_tree,
+        directed_graph_node_t* p_node)
+{
+    tree_node_t* p_record;
+
+    if (!p_tree) return NULL;
+
+    p_record = unordered_map_t_get(p_tree->p_node_map, p_node);
+    return p_record ? p_record->p_parent : NULL;
+}
+
+list_t* shortest_path_tree_t_path(shortest_path_tree_t* p_tree,
+                                  directed_graph_node_t* p_target)
+{
+    list_t* p_path;
+
+    if (!p_tree) return NULL;
+
+    if (!(p_path = list_t_alloc(INITIAL_CAPACITY, NULL))) return NULL;
+
+    if (distance_of(p_tree, p_target) == INFINITY) return p_path;
+
+    while (p_target)
+    {
+        list_t_push_front(p_path, p_target);
+        p_target = shortest_path_tree_t_parent(p_tree, p_target);
+    }
+
+    return p_path;
+}
+
+size_t shortest_path_tree_t_size(shortest_path_tree_t* p_tree)
+{
+    return p_tree ? p_tree->reached : 0;
+}
+
+size_t shortest_path_tree_t_settled(shortest_path_tree_t* p_tree)
+{
+    return p_tree ? p_tree->settled : 0;
+}
+
+void shortest_path_tree_t_free(shortest_path_tree_t* p_tree)
+{
+    size_t i;
+
+    if (!p_tree) return;
+
+    for (i = 0; i < list_t_size(p_tree->p_record_list); ++i)
+    {
+        allocator_t_free(p_tree->p_allocator,
+                         list_t_get(p_tree->p_record_list, i));
+    }
+
+    if (p_tree->p_record_list)   list_t_free(p_tree->p_record_list);
+    if (p_tree->p_touched_list)  list_t_free(p_tree->p_touched_list);
+    if (p_tree->p_affected_list) list_t_free(p_tree->p_affected_list);
+    if (p_tree->p_affected_set)  unordered_set_t_free(p_tree->p_affected_set);
+    if (p_tree->p_node_map)      unordered_map_t_free(p_tree->p_node_map);
+    if (p_tree->p_open_set)      heap_t_free(p_tree->p_open_set);
+
+    allocator_t_free(p_tree->p_allocator, p_tree);
+}
@@ -0,0 +1,88 @@
+#ifndef SHORTEST_PATH_TREE_H
+#define	SHORTEST_PATH_TREE_H
+
+#include "allocator.h"
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include "list.h"
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The shortest paths from one source to every node it reaches, kept up to  *
+    * date as arcs change in the manner of Ramalingam and Reps: a heavier or   *
+    * removed tree arc only unsettles the subtree below it, which is settled   *
+    * again from the nodes around it, and a lighter or new arc only spreads    *
+    * as far as it shortens paths. The tree needs the parents of the nodes.    *
+    ***************************************************************************/
+    typedef struct shortest_path_tree_t shortest_path_tree_t;
+
+    /***************************************************************************
+    * Builds the tree of the shortest paths from 'p_source' over the arcs      *
+    * weighted by 'p_weight_function'. The tree comes from 'p_allocator', or   *
+    * from the C library if it is NULL. Returns NULL if there is not enough    *
+    * memory.                                                                  *
+    ***************************************************************************/
+    shortest_path_tree_t* shortest_path_tree_t_alloc(
+            directed_graph_node_t* p_source,
+            directed_graph_weight_function_t* p_weight_function,
+            allocator_t* p_allocator);
+
+    /***************************************************************************
+    * Repairs the tree after the 'count' arcs from 'p_tails[i]' to             *
+    * 'p_heads[i]' had their weights raised or lowered, or were added or       *
+    * removed, and returns a new list of the nodes whose distances changed.    *
+    * An undirected edge counts as both of its arcs.                           *
+    * Returns NULL if there is not enough memory or the repair needs the       *
+    * parents of a node that does not know them, which leaves the tree broken. *
+    ***************************************************************************/
+    list_t* shortest_path_tree_t_update(shortest_path_tree_t* p_tree,
+                                        directed_graph_node_t** p_tails,
+                                        directed_graph_node_t** p_heads,
+                                        size_t count);
+
+    /***************************************************************************
+    * Returns the cost of the shortest path to 'p_node', or INFINITY if the    *
+    * source does not reach it.                                                *
+    ***************************************************************************/
+    double shortest_path_tree_t_distance(shortest_path_tree_t* p_tree,
+                                         directed_graph_node_t* p_node);
+
+    /***************************************************************************
+    * Returns the node before 'p_node' on its shortest path, or NULL for the   *
+    * source and the nodes the source does not reach.                          *
+    ***************************************************************************/
+    directed_graph_node_t* shortest_path_tree_t_parent(
+            shortest_path_tree_t* p_tree,
+            directed_graph_node_t* p_node);
+
+    /***************************************************************************
+    * Returns a new list holding the shortest path to 'p_target', which is     *
+    * empty if the source does not reach it.                                   *
+    ***************************************************************************/
+    list_t* shortest_path_tree_t_path(shortest_path_tree_t* p_tree,
+                                      directed_graph_node_t* p_target);
+
+    /***************************************************************************
+    * Returns the number of nodes the source reaches.                          *
+    ***************************************************************************/
+    size_t shortest_path_tree_t_size(shortest_path_tree_t* p_tree);
+
+    /***************************************************************************
+    * Returns the number of nodes the last build or repair settled.            *
+    ***************************************************************************/
+    size_t shortest_path_tree_t_settled(shortest_path_tree_t* p_tree);
+
+    /***************************************************************************
+    * Deallocates the tree.                                                    *
+    ***************************************************************************/
+    void shortest_path_tree_t_free(shortest_path_tree_t* p_tree);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SHORTEST_PATH_TREE_H */
@@ -0,0 +1,311 @@
+#include "source_tree_cache.h"
+#include "heap.h"
+#include "memory_usage.h"
+#include "unordered_map.h"
+#include "unordered_set.h"
+#include "utils.h"
+
+/*******************************************************************************
+* A search from one source, which is also a node of the list of the searches   *
+* ordered from the most to the least recently used.                            *
+*******************************************************************************/
+typedef struct source_tree_t {
+    directed_graph_node_t* p_source;
+    search_state_t         state;
+    struct source_tree_t*  p_prev;
+    struct source_tree_t*  p_next;
+    /* The memory the tree took when last measured. */
+    size_t                 memory;
+} source_tree_t;
+
+struct source_tree_cache_t {
+    directed_graph_weight_function_t* p_weight_function;
+    allocator_t*                      p_allocator;
+    /* Maps each source to its tree. */
+    unordered_map_t*                  p_tree_map;
+    source_tree_t*                    p_head;
+    source_tree_t*                    p_tail;
+    size_t                            max_memory;
+    /* The sum of the memory of the trees. */
+    size_t                            tree_memory;
+    source_tree_cache_stats_t         stats;
+};
+
+static size_t tree_memory_usage(source_tree_t* p_tree)
+{
+    return memory_block_size(sizeof(*p_tree)) +
+           search_state_t_memory_usage(&p_tree->state);
+}
+
+static void unlink_tree(source_tree_cache_t* p_cache, source_tree_t* p_tree)
+{
+    if (p_tree->p_prev) p_tree->p_prev->p_next = p_tree->p_next;
+    else                p_cache->p_head        = p_tree->p_next;
+
+    if (p_tree->p_next) p_tree->p_next->p_prev = p_tree->p_prev;
+    else                p_cache->p_tail        = p_tree->p_prev;
+
+    p_tree->p_prev = NULL;
+    p_tree->p_next = NULL;
+}
+
+static void push_front(source_tree_cache_t* p_cache, source_tree_t* p_tree)
+{
+    p_tree->p_prev = NULL;
+    p_tree->p_next = p_cache->p_head;
+
+    if (p_cache->p_head) p_cache->p_head->p_prev = p_tree;
+    else                 p_cache->p_tail         = p_tree;
+
+    p_cache->p_head = p_tree;
+}
+
+static void drop_tree(source_tree_cache_t* p_cache, source_tree_t* p_tree)
+{
+    unlink_tree(p_cache, p_tree);
+    unordered_map_t_remove(p_cache->p_tree_map, p_tree->p_source);
+    p_cache->tree_memory -= p_tree->memory;
+    search_state_t_free(&p_tree->state);
+    allocator_t_free(p_cache->p_allocator, p_tree);
+}
+
+/*******************************************************************************
+* Allocates a tree holding a search from 'p_source' that settled nothing yet.  *
+*******************************************************************************/
+static source_tree_t* tree_alloc(source_tree_cache_t* p_cache,
+                                 directed_graph_node_t* p_source)
+{
+    source_tree_t* p_tree;
+    weight_t*      p_weight;
+
+    if (!(p_tree = allocator_t_calloc(p_cache->p_allocator,
+                                      1,
+                                      sizeof(*p_tree))))
+    {
+        return NULL;
+    }
+
+    p_tree->p_source = p_source;
+    search_state_t_alloc(&p_tree->state, p_cache->p_allocator);
+
+    if (!search_state_t_is_ready(&p_tree->state) ||
+        !(p_weight = allocator_t_alloc(p_cache->p_allocator,
+                                       sizeof(*p_weight))))
+    {
+        search_state_t_free(&p_tree->state);
+        allocator_t_free(p_cache->p_allocator, p_tree);
+        return NULL;
+    }
+
+    p_weight->weight = 0.0;
+    list_t_push_back(p_tree->state.p_weight_list, p_weight);
+    heap_t_add(p_tree->state.p_open_set, p_source, p_weight);
+    unordered_map_t_put(p_tree->state.p_parent_map, p_source, NULL);
+    unordered_map_t_put(p_tree->state.p_cost_map, p_source, p_weight);
+    return p_tree;
+}
+
+/*******************************************************************************
+* Goes on with the search of 'p_tree' until it settles 'p_target' or runs out  *
+* of nodes. Returns false if there is not enough memory, which leaves the      *
+* search broken.                                                               *
+*******************************************************************************/
+static bool grow_tree(source_tree_cache_t* p_cache,
+                      source_tree_t* p_tree,
+                      directed_graph_node_t* p_target)
+{
+    search_state_t*         p_state = &p_tree->state;
+    directed_graph_node_t*  p_current;
+    directed_graph_node_t*  p_child;
+    directed_graph_node_t** p_children;
+    weight_t*               p_weight;
+    weight_t*               p_old_weight;
+    size_t                  child_count;
+    size_t                  i;
+    double                  cost;
+
+    while (!unordered_set_t_contains(p_state->p_closed_set, p_target) &&
+           heap_t_size(p_state->p_open_set) > 0)
+    {
+        p_current = heap_t_extract_min(p_state->p_open_set);
+        unordered_set_t_add(p_state->p_closed_set, p_current);
+
+        p_children  = directed_graph_node_t_children(p_current);
+        child_count = directed_graph_node_t_child_count(p_current);
+
+        for (i = 0; i < child_count; ++i)
+        {
+            p_child = p_children[i];
+
+            if (unordered_set_t_contains(p_state->p_closed_set, p_child))
+            {
+                continue;
+            }
+
+            cost = ((weight_t*) unordered_map_t_get(p_state->p_cost_map,
+                                                    p_current))->weight +
+                   *directed_graph_weight_function_t_get(
+                           p_cache->p_weight_function,
+                           p_current,
+                           p_child);
+            p_old_weight = unordered_map_t_get(p_state->p_cost_map, p_child);
+
+            if (p_old_weight && p_old_weight->weight <= cost) continue;
+
+            if (!(p_weight = allocator_t_alloc(p_cache->p_allocator,
+                                               sizeof(*p_weight))))
+            {
+                return false;
+            }
+
+            p_weight->weight = cost;
+            list_t_push_back(p_state->p_weight_list, p_weight);
+
+            if (p_old_weight)
+            {
+                heap_t_decrease_key(p_state->p_open_set, p_child, p_weight);
+            }
+            else
+            {
+                heap_t_add(p_state->p_open_set, p_child, p_weight);
+            }
+
+            unordered_map_t_put(p_state->p_parent_map, p_child, p_current);
+            unordered_map_t_put(p_state->p_cost_map, p_child, p_weight);
+        }
+    }
+
+    return true;
+}
+
+source_tree_cache_t* source_tree_cache_t_alloc(
+        directed_graph_weight_function_t* p_weight_function,
+        size_t max_memory,
+        allocator_t* p_allocator)
+{
+    source_tree_cache_t* p_cache;
+
+    if (!p_weight_function) return NULL;
+
+    if (!(p_cache = allocator_t_calloc(p_allocator, 1, sizeof(*p_cache))))
+    {
+        return NULL;
+    }
+
+    p_cache->p_weight_function = p_weight_function;
+    p_cache->p_allocator       = p_allocator;
+    p_cache->max_memory        = max_memory;
+    p_cache->p_tree_map        = unordered_map_t_alloc(INITIAL_CAPACITY,
+                                                       LOAD_FACTOR,
+                                                       hash_function,
+                                                       equals_function,
+                                                       p_allocator);
+
+    if (!p_cache->p_tree_map)
+    {
+        allocator_t_free(p_allocator, p_cache);
+        return NULL;
+    }
+
+    return p_cache;
+}
+
+list_t* source_tree_cache_t_query(source_tree_cache_t* p_cache,
+                                  directed_graph_node_t* p_source,
+                                  directed_graph_node_t* p_target)
+{
+    source_tree_t* p_tree;
+    list_t*        p_path;
+
+    if (!p_cache || !p_source || !p_target) return NULL;
+
+    if ((p_tree = unordered_map_t_get(p_cache->p_tree_map, p_source)))
+    {
+        if (unordered_set_t_contains(p_tree->state.p_closed_set, p_target) ||
+            heap_t_size(p_tree->state.p_open_set) == 0)
+        {
+            ++p_cache->stats.hits;
+        }
+        else
+        {
+            ++p_cache->stats.resumes;
+        }
+
+        unlink_tree(p_cache, p_tree);
+    }
+    else
+    {
+        if (!(p_tree = tree_alloc(p_cache, p_source))) return NULL;
+
+        unordered_map_t_put(p_cache->p_tree_map, p_source, p_tree);
+        ++p_cache->stats.misses;
+    }
+
+    push_front(p_cache, p_tree);
+
+    if (!grow_tree(p_cache, p_tree, p_target))
+    {
+        drop_tree(p_cache, p_tree);
+        return NULL;
+    }
+
+    p_path = unordered_set_t_contains(p_tree->state.p_closed_set, p_target) ?
+             traceback_path(p_target, p_tree->state.p_parent_map) :
+             list_t_alloc(INITIAL_CAPACITY, NULL);
+
+    p_cache->tree_memory -= p_tree->memory;
+    p_tree->memory        = tree_memory_usage(p_tree);
+    p_cache->tree_memory += p_tree->memory;
+
+    /* Drop the least recently used trees, this one last, until the rest fit. */
+    while (p_cache->max_memory > 0 && p_cache->p_tail &&
+           source_tree_cache_t_memory_usage(p_cache) > p_cache->max_memory)
+    {
+        drop_tree(p_cache, p_cache->p_tail);
+        ++p_cache->stats.evictions;
+    }
+
+    return p_path;
+}
+
+size_t source_tree_cache_t_size(source_tree_cache_t* p_cache)
+{
+    return p_cache ? unordered_map_t_size(p_cache->p_tree_map) : 0;
+}
+
+source_tree_cache_stats_t source_tree_cache_t_stats(
+        source_tree_cache_t* p_cache)
+{
+    source_tree_cache_stats_t stats = { 0, 0, 0, 0 };
+
+    return p_cache ? p_cache->stats : stats;
+}
+
+size_t source_tree_cache_t_memory_usage(source_tree_cache_t* p_cache)
+{
+    if (!p_cache) return 0;
+
+    return memory_block_size(sizeof(*p_cache)) +
+           unordered_map_t_memory_usage(p_cache->p_tree_map) +
+           p_cache->tree_memory;
+}
+
+void source_tree_cache_t_clear(source_tree_cache_t* p_cache)
+{
+    source_tree_cache_stats_t stats = { 0, 0, 0, 0 };
+
+    if (!p_cache) return;
+
+    while (p_cache->p_head) drop_tree(p_cache, p_cache->p_head);
+
+    p_cache->stats = stats;
+}
+
+void source_tree_cache_t_free(source_tree_cache_t* p_cache)
+{
+    if (!p_cache) return;
+
+    source_tree_cache_t_clear(p_cache);
+    unordered_map_t_free(p_cache->p_tree_map);
+    allocator_t_free(p_cache->p_allocator, p_cache);
+}
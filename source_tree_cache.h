@@ -0,0 +1,93 @@
+#ifndef SOURCE_TREE_CACHE_H
+#define	SOURCE_TREE_CACHE_H
+
+#include "allocator.h"
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include "list.h"
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A cache of the Dijkstra searches from the sources queried lately. Each   *
+    * search stops once it settles its target but keeps its settled nodes and  *
+    * its open set, so another query from the same source is answered by a     *
+    * traceback if the target is already settled, or else by going on with     *
+    * the search until it is. When the searches take more memory than allowed, *
+    * the least recently used ones are dropped. The cache knows nothing of     *
+    * changes to the graph or the weights, so it must be cleared after them.   *
+    ***************************************************************************/
+    typedef struct source_tree_cache_t source_tree_cache_t;
+
+    /***************************************************************************
+    * The numbers of queries a cache answered in each way.                     *
+    ***************************************************************************/
+    typedef struct source_tree_cache_stats_t {
+        /* Answered by a traceback alone. */
+        size_t hits;
+        /* Answered by going on with a cached search. */
+        size_t resumes;
+        /* Answered by a new search. */
+        size_t misses;
+        /* The searches dropped to stay within the memory limit. */
+        size_t evictions;
+    } source_tree_cache_stats_t;
+
+    /***************************************************************************
+    * Allocates an empty cache of searches over the arcs weighted by           *
+    * 'p_weight_function', which takes at most 'max_memory' bytes from         *
+    * 'p_allocator' between queries, or any amount if 'max_memory' is zero.    *
+    * The memory comes from the C library if 'p_allocator' is NULL. Returns    *
+    * NULL if there is not enough memory.                                      *
+    ***************************************************************************/
+    source_tree_cache_t* source_tree_cache_t_alloc(
+            directed_graph_weight_function_t* p_weight_function,
+            size_t max_memory,
+            allocator_t* p_allocator);
+
+    /***************************************************************************
+    * Returns a shortest path from 'p_source' to 'p_target' as 'dijkstra'      *
+    * does, or an empty path if 'p_target' is not reachable. A search that     *
+    * does not fit in the memory limit on its own still answers the query and  *
+    * is dropped right after. Returns NULL if there is not enough memory.      *
+    ***************************************************************************/
+    list_t* source_tree_cache_t_query(source_tree_cache_t* p_cache,
+                                      directed_graph_node_t* p_source,
+                                      directed_graph_node_t* p_target);
+
+    /***************************************************************************
+    * Returns the number of searches in the cache.                             *
+    ***************************************************************************/
+    size_t source_tree_cache_t_size(source_tree_cache_t* p_cache);
+
+    /***************************************************************************
+    * Returns the counters of the cache, which count from its allocation or    *
+    * its last clearing.                                                       *
+    ***************************************************************************/
+    source_tree_cache_stats_t source_tree_cache_t_stats(
+            source_tree_cache_t* p_cache);
+
+    /***************************************************************************
+    * Returns the number of bytes the cache takes from the allocator,          *
+    * including the allocator overhead of each block.                          *
+    ***************************************************************************/
+    size_t source_tree_cache_t_memory_usage(source_tree_cache_t* p_cache);
+
+    /***************************************************************************
+    * Drops all the searches in the cache and resets its counters.             *
+    ***************************************************************************/
+    void source_tree_cache_t_clear(source_tree_cache_t* p_cache);
+
+    /***************************************************************************
+    * Deallocates the cache. The paths it returned are left alone.             *
+    ***************************************************************************/
+    void source_tree_cache_t_free(source_tree_cache_t* p_cache);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SOURCE_TREE_CACHE_H */
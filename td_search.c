@@ -0,0 +1,240 @@
+#include "td_search.h"
+#include "heap.h"
+#include "utils.h"
+#include <math.h>
+
+/* The number of children whose estimates are computed in one batch. */
+#define HEURISTIC_BATCH 64
+
+/*******************************************************************************
+* Runs the time-dependent search, guided by 'p_heuristic' or, if it is NULL,   *
+* by nothing. The costs of the search are the times of arrival at the nodes,   *
+* and the priorities add the estimate of the rest of the way.                  *
+*******************************************************************************/
+static list_t* td_search(directed_graph_node_t* p_source,
+                         directed_graph_node_t* p_target,
+                         td_weight_function_t* p_weight_function,
+                         double departure,
+                         double* p_arrival,
+                         heuristic_t* p_heuristic,
+                         search_options_t* p_options)
+{
+    search_state_t            state;
+    search_stats_t*           p_stats;
+    search_recorder_t*        p_recorder;
+    search_budget_t*          p_budget;
+
+    list_t*                   p_list;
+    heap_t*                   p_open_set;
+    unordered_set_t*          p_closed_set;
+    unordered_map_t*          p_parent_map;
+    unordered_map_t*          p_cost_map;
+    directed_graph_node_t*    p_current;
+    directed_graph_node_t*    p_child;
+    directed_graph_node_t**   p_children;
+    size_t                    child_count;
+    size_t                    i;
+    size_t                    settled = 0;
+    double                    estimates[HEURISTIC_BATCH];
+    double                    time;
+    double                    travel_time;
+    weight_t*                 p_time;
+    weight_t*                 p_priority;
+
+    if (p_arrival) *p_arrival = INFINITY;
+
+    p_stats    = p_options ? p_options->p_stats : NULL;
+    p_recorder = p_options ? p_options->p_recorder : NULL;
+    p_budget   = p_options ? p_options->p_budget : NULL;
+
+    SEARCH_STATS_START(p_stats);
+    SEARCH_RECORDER_CLEAR(p_recorder);
+    search_budget_t_start(p_budget);
+    search_state_t_alloc(&state, p_options ? p_options->p_allocator : NULL);
+
+    if (!search_state_t_is_ready(&state))
+    {
+        search_state_t_free(&state);
+        return NULL;
+    }
+
+    p_open_set   = state.p_open_set;
+    p_closed_set = state.p_closed_set;
+    p_cost_map   = state.p_cost_map;
+    p_parent_map = state.p_parent_map;
+
+    p_time = allocator_t_alloc(state.p_allocator, sizeof(*p_time));
+    p_time->weight = departure;
+
+    heap_t_add(p_open_set, p_source, p_time);
+    unordered_map_t_put(p_parent_map, p_source, NULL);
+    unordered_map_t_put(p_cost_map, p_source, p_time);
+    list_t_push_back(state.p_weight_list, p_time);
+
+    SEARCH_STATS_COUNT(p_stats, heap_pushes);
+    SEARCH_STATS_PEAK(p_stats, peak_open_set, 1);
+    SEARCH_STATS_END_PHASE(p_stats, setup_time);
+
+    while (heap_t_size(p_open_set) > 0)
+    {
+        SEARCH_STATS_PEAK(p_stats,
+                          peak_memory,
+                          search_state_t_memory_usage(&state));
+
+        if (SEARCH_BUDGET_EXHAUSTED(p_budget,
+                                    settled,
+                                    search_state_t_memory_usage(&state)))
+        {
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
+            search_state_t_free(&state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+            return NULL;
+        }
+
+        p_current = heap_t_extract_min(p_open_set);
+        time = ((weight_t*) unordered_map_t_get(p_cost_map,
+                                                p_current))->weight;
+
+        SEARCH_STATS_COUNT(p_stats, heap_pops);
+        SEARCH_STATS_COUNT(p_stats, nodes_settled);
+        ++settled;
+        SEARCH_RECORDER_SETTLE(p_recorder,
+                               p_current,
+                               time - departure,
+                               time - departure +
+                               (p_heuristic ?
+                                heuristic_t_estimate(p_heuristic,
+                                                     p_current,
+                                                     p_target) : 0.0),
+                               SEARCH_FORWARD);
+
+        if (equals_function(p_current, p_target))
+        {
+            SEARCH_RECORDER_MEET(p_recorder, p_target);
+            SEARCH_STATS_END_PHASE(p_stats, search_time);
+            p_list = traceback_path(p_target, p_parent_map);
+            SEARCH_STATS_END_PHASE(p_stats, traceback_time);
+
+            if (p_arrival) *p_arrival = time;
+
+            search_state_t_free(&state);
+            SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+            return p_list;
+        }
+
+        unordered_set_t_add(p_closed_set, p_current);
+
+        p_children  = directed_graph_node_t_children(p_current);
+        child_count = directed_graph_node_t_child_count(p_current);
+
+        for (i = 0; i < child_count; ++i)
+        {
+            p_child = p_children[i];
+
+            if (p_heuristic && i % HEURISTIC_BATCH == 0)
+            {
+                heuristic_t_estimate_batch(
+                        p_heuristic,
+                        p_children + i,
+                        child_count - i < HEURISTIC_BATCH ?
+                                child_count - i : HEURISTIC_BATCH,
+                        p_target,
+                        estimates);
+            }
+
+            if (unordered_set_t_contains(p_closed_set, p_child)) continue;
+
+            /* Leave the arc at the time the search got to its tail. */
+            travel_time = td_weight_function_t_evaluate(p_weight_function,
+                                                        p_current,
+                                                        p_child,
+                                                        time);
+
+            if (travel_time == INFINITY) continue;
+
+            SEARCH_STATS_COUNT(p_stats, arcs_relaxed);
+
+            p_time = unordered_map_t_get(p_cost_map, p_child);
+
+            if (p_time && time + travel_time >= p_time->weight) continue;
+
+            p_time     = allocator_t_alloc(state.p_allocator,
+                                           sizeof(*p_time));
+            p_priority = allocator_t_alloc(state.p_allocator,
+                                           sizeof(*p_priority));
+            p_time->weight     = time + travel_time;
+            p_priority->weight = p_time->weight +
+                                 (p_heuristic ?
+                                  estimates[i % HEURISTIC_BATCH] : 0.0);
+
+            if (unordered_map_t_contains_key(p_parent_map, p_child))
+            {
+                heap_t_decrease_key(p_open_set, p_child, p_priority);
+                SEARCH_STATS_COUNT(p_stats, decrease_keys);
+            }
+            else
+            {
+                heap_t_add(p_open_set, p_child, p_priority);
+                SEARCH_STATS_COUNT(p_stats, heap_pushes);
+                SEARCH_STATS_PEAK(p_stats,
+                                  peak_open_set,
+                                  heap_t_size(p_open_set));
+            }
+
+            unordered_map_t_put(p_parent_map, p_child, p_current);
+            unordered_map_t_put(p_cost_map, p_child, p_time);
+            list_t_push_back(state.p_weight_list, p_time);
+            list_t_push_back(state.p_weight_list, p_priority);
+        }
+    }
+
+    SEARCH_STATS_END_PHASE(p_stats, search_time);
+    search_state_t_free(&state);
+    SEARCH_STATS_END_PHASE(p_stats, cleanup_time);
+    return list_t_alloc(10, NULL);
+}
+
+list_t* td_dijkstra(directed_graph_node_t* p_source,
+                    directed_graph_node_t* p_target,
+                    td_weight_function_t* p_weight_function,
+                    double departure,
+                    double* p_arrival,
+                    search_options_t* p_options)
+{
+    if (!p_source)          return NULL;
+    if (!p_target)          return NULL;
+    if (!p_weight_function) return NULL;
+
+    return td_search(p_source,
+                     p_target,
+                     p_weight_function,
+                     departure,
+                     p_arrival,
+                     NULL,
+                     p_options);
+}
+
+list_t* td_astar(directed_graph_node_t* p_source,
+                 directed_graph_node_t* p_target,
+                 td_weight_function_t* p_weight_function,
+                 double departure,
+                 double* p_arrival,
+                 unordered_map_t* p_location_map,
+                 search_options_t* p_options)
+{
+    heuristic_t heuristic;
+
+    if (!p_source)          return NULL;
+    if (!p_target)          return NULL;
+    if (!p_weight_function) return NULL;
+
+    if (!choose_heuristic(&heuristic, p_location_map, p_options)) return NULL;
+
+    return td_search(p_source,
+                     p_target,
+                     p_weight_function,
+                     departure,
+                     p_arrival,
+                     &heuristic,
+                     p_options);
+}
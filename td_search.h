@@ -0,0 +1,48 @@
+#ifndef TD_SEARCH_H
+#define	TD_SEARCH_H
+
+#include "directed_graph_node.h"
+#include "td_weight_function.h"
+#include "unordered_map.h"
+#include "list.h"
+#include "search_options.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * Returns a path from 'p_source' to 'p_target' arriving as early as        *
+    * possible when leaving at 'departure', or an empty path if 'p_target' is  *
+    * not reachable from 'p_source'. Each arc is evaluated at the time the     *
+    * search arrives at its tail, which finds the earliest arrival since the   *
+    * functions are FIFO. If 'p_arrival' is not NULL, the time of arrival is   *
+    * loaded into it, or INFINITY if there is no path. Honours the options     *
+    * 'p_options', which may be NULL.                                          *
+    ***************************************************************************/
+    list_t* td_dijkstra(directed_graph_node_t* p_source,
+                        directed_graph_node_t* p_target,
+                        td_weight_function_t* p_weight_function,
+                        double departure,
+                        double* p_arrival,
+                        search_options_t* p_options);
+
+    /***************************************************************************
+    * Same as 'td_dijkstra', but guided by the heuristic chosen as in          *
+    * 'astar_with_options'. The heuristic must be admissible for the least     *
+    * travel times of the arcs, as 'td_weight_function_t_lower_bounds' gives   *
+    * them, and obey the triangle inequality for them.                         *
+    ***************************************************************************/
+    list_t* td_astar(directed_graph_node_t* p_source,
+                     directed_graph_node_t* p_target,
+                     td_weight_function_t* p_weight_function,
+                     double departure,
+                     double* p_arrival,
+                     unordered_map_t* p_location_map,
+                     search_options_t* p_options);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* TD_SEARCH_H */
@@ -0,0 +1,485 @@
+#include "td_weight_function.h"
+#include "memory_usage.h"
+#include "unordered_map.h"
+#include "utils.h"
+#include <math.h>
+#include <string.h>
+
+/* The least number of breakpoints the arrays make room for. */
+#define MINIMUM_CAPACITY 64
+
+/*******************************************************************************
+* An arc with a function, whose breakpoints are the 'count' entries of the     *
+* arrays of the weight function starting at 'first'.                           *
+*******************************************************************************/
+typedef struct td_arc_t {
+    directed_graph_node_t* p_tail;
+    directed_graph_node_t* p_head;
+    size_t                 first;
+    size_t                 count;
+} td_arc_t;
+
+struct td_weight_function_t {
+    /* Maps each tail to the map from each head to its arc. */
+    unordered_map_t* p_first_level_map;
+    /* Owns the arcs. */
+    list_t*          p_arc_list;
+    double*          p_times;
+    double*          p_durations;
+    size_t           size;
+    size_t           capacity;
+    /* The number of stored breakpoints of functions since replaced. */
+    size_t           garbage;
+    size_t (*p_hash_function)(void*);
+    bool (*p_equals_function)(void*, void*);
+    allocator_t*     p_allocator;
+};
+
+td_weight_function_t* td_weight_function_t_alloc(
+        size_t (*p_hash_function)(void*),
+        bool (*p_equals_function)(void*, void*),
+        allocator_t* p_allocator)
+{
+    td_weight_function_t* p_ret;
+
+    if (!p_hash_function)   return NULL;
+    if (!p_equals_function) return NULL;
+
+    if (!(p_ret = allocator_t_calloc(p_allocator, 1, sizeof(*p_ret))))
+    {
+        return NULL;
+    }
+
+    p_ret->p_hash_function   = p_hash_function;
+    p_ret->p_equals_function = p_equals_function;
+    p_ret->p_allocator       = p_allocator;
+    p_ret->p_first_level_map = unordered_map_t_alloc(INITIAL_CAPACITY,
+                                                     LOAD_FACTOR,
+                                                     p_hash_function,
+                                                     p_equals_function,
+                                                     p_allocator);
+    p_ret->p_arc_list        = list_t_alloc(INITIAL_CAPACITY, p_allocator);
+
+    if (!p_ret->p_first_level_map || !p_ret->p_arc_list)
+    {
+        td_weight_function_t_free(p_ret);
+        return NULL;
+    }
+
+    return p_ret;
+}
+
+static td_arc_t* arc_of(td_weight_function_t* p_function,
+                        directed_graph_node_t* p_tail,
+                        directed_graph_node_t* p_head)
+{
+    unordered_map_t* p_second_level_map =
+            unordered_map_t_get(p_function->p_first_level_map, p_tail);
+
+    return p_second_level_map ?
+           unordered_map_t_get(p_second_level_map, p_head) : NULL;
+}
+
+/*******************************************************************************
+* Returns the value of the function of 'p_arc' at 'time'. The breakpoints      *
+* bracketing 'time' are found by a binary search over the times of the arc.    *
+*******************************************************************************/
+static double evaluate_arc(td_weight_function_t* p_function,
+                           td_arc_t* p_arc,
+                           double time)
+{
+    const double* p_times     = p_function->p_times + p_arc->first;
+    const double* p_durations = p_function->p_durations + p_arc->first;
+    size_t        low         = 0;
+    size_t        high        = p_arc->count - 1;
+    size_t        middle;
+
+    if (time <= p_times[low])  return p_durations[low];
+    if (time >= p_times[high]) return p_durations[high];
+
+    while (high - low > 1)
+    {
+        middle = low + (high - low) / 2;
+
+        if (p_times[middle] <= time) low  = middle;
+        else                         high = middle;
+    }
+
+    return p_durations[low] + (p_durations[high] - p_durations[low]) *
+                              (time - p_times[low]) /
+                              (p_times[high] - p_times[low]);
+}
+
+/*******************************************************************************
+* Checks that the breakpoints describe a FIFO function. Arrival is linear in   *
+* the departure time between two breakpoints, so it suffices that it does not  *
+* decrease from one breakpoint to the next.                                    *
+*******************************************************************************/
+static bool is_fifo(const double* p_times,
+                    const double* p_durations,
+                    size_t count)
+{
+    size_t i;
+
+    if (count == 0) return false;
+
+    for (i = 0; i < count; ++i)
+    {
+        if (!(p_durations[i] >= 0.0 && p_durations[i] < INFINITY))
+        {
+            return false;
+        }
+
+        if (!(fabs(p_times[i]) < INFINITY)) return false;
+
+        if (i > 0 && (!(p_times[i] > p_times[i - 1]) ||
+                      p_times[i] + p_durations[i] <
+                      p_times[i - 1] + p_durations[i - 1]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Moves the breakpoints of the arcs to new arrays with no room taken by        *
+* replaced functions. Returns false if there is not enough memory, which       *
+* leaves the old arrays in place.                                              *
+*******************************************************************************/
+static bool compact(td_weight_function_t* p_function)
+{
+    td_arc_t* p_arc;
+    double*   p_times;
+    double*   p_durations;
+    size_t    capacity;
+    size_t    size = 0;
+    size_t    i;
+
+    capacity = 2 * (p_function->size - p_function->garbage);
+
+    if (capacity < MINIMUM_CAPACITY) capacity = MINIMUM_CAPACITY;
+
+    p_times     = allocator_t_alloc(p_function->p_allocator,
+                                    sizeof(double) * capacity);
+    p_durations = allocator_t_alloc(p_function->p_allocator,
+                                    sizeof(double) * capacity);
+
+    if (!p_times || !p_durations)
+    {
+        allocator_t_free(p_function->p_allocator, p_times);
+        allocator_t_free(p_function->p_allocator, p_durations);
+        return false;
+    }
+
+    for (i = 0; i < list_t_size(p_function->p_arc_list); ++i)
+    {
+        p_arc = list_t_get(p_function->p_arc_list, i);
+        memcpy(p_times + size,
+               p_function->p_times + p_arc->first,
+               sizeof(double) * p_arc->count);
+        memcpy(p_durations + size,
+               p_function->p_durations + p_arc->first,
+               sizeof(double) * p_arc->count);
+        p_arc->first = size;
+        size += p_arc->count;
+    }
+
+    allocator_t_free(p_function->p_allocator, p_function->p_times);
+    allocator_t_free(p_function->p_allocator, p_function->p_durations);
+    p_function->p_times     = p_times;
+    p_function->p_durations = p_durations;
+    p_function->size        = size;
+    p_function->capacity    = capacity;
+    p_function->garbage     = 0;
+    return true;
+}
+
+/*******************************************************************************
+* Makes room for 'count' more breakpoints at the end of the arrays, first      *
+* reclaiming the room of replaced functions once they take the most of it.     *
+* Returns false if there is not enough memory.                                 *
+*******************************************************************************/
+static bool reserve(td_weight_function_t* p_function, size_t count)
+{
+    double* p_block;
+    size_t  capacity;
+
+    if (p_function->garbage > p_function->size / 2 &&
+        p_function->garbage >= MINIMUM_CAPACITY)
+    {
+        compact(p_function);
+    }
+
+    if (p_function->size + count <= p_function->capacity) return true;
+
+    capacity = 2 * p_function->capacity;
+
+    if (capacity < p_function->size + count)
+    {
+        capacity = p_function->size + count;
+    }
+
+    if (capacity < MINIMUM_CAPACITY) capacity = MINIMUM_CAPACITY;
+
+    if (!(p_block = allocator_t_realloc(p_function->p_allocator,
+                                        p_function->p_times,
+                                        sizeof(double) * capacity)))
+    {
+        return false;
+    }
+
+    p_function->p_times = p_block;
+
+    if (!(p_block = allocator_t_realloc(p_function->p_allocator,
+                                        p_function->p_durations,
+                                        sizeof(double) * capacity)))
+    {
+        return false;
+    }
+
+    p_function->p_durations = p_block;
+    p_function->capacity    = capacity;
+    return true;
+}
+
+/*******************************************************************************
+* Returns the arc ('p_tail', 'p_head'), adding it without breakpoints if it    *
+* has no function yet, or NULL if there is not enough memory.                  *
+*******************************************************************************/
+static td_arc_t* add_arc(td_weight_function_t* p_function,
+                         directed_graph_node_t* p_tail,
+                         directed_graph_node_t* p_head)
+{
+    unordered_map_t* p_second_level_map;
+    td_arc_t*        p_arc;
+
+    if (!(p_second_level_map =
+            unordered_map_t_get(p_function->p_first_level_map, p_tail)))
+    {
+        if (!(p_second_level_map =
+                unordered_map_t_alloc(INITIAL_CAPACITY,
+                                      LOAD_FACTOR,
+                                      p_function->p_hash_function,
+                                      p_function->p_equals_function,
+                                      p_function->p_allocator)))
+        {
+            return NULL;
+        }
+
+        unordered_map_t_put(p_function->p_first_level_map,
+                            p_tail,
+                            p_second_level_map);
+
+        if (!unordered_map_t_contains_key(p_function->p_first_level_map,
+                                          p_tail))
+        {
+            unordered_map_t_free(p_second_level_map);
+            return NULL;
+        }
+    }
+
+    if ((p_arc = unordered_map_t_get(p_second_level_map, p_head)))
+    {
+        return p_arc;
+    }
+
+    if ((p_arc = allocator_t_calloc(p_function->p_allocator,
+                                    1,
+                                    sizeof(*p_arc))))
+    {
+        p_arc->p_tail = p_tail;
+        p_arc->p_head = p_head;
+
+        if (list_t_push_back(p_function->p_arc_list, p_arc))
+        {
+            unordered_map_t_put(p_second_level_map, p_head, p_arc);
+
+            if (unordered_map_t_contains_key(p_second_level_map, p_head))
+            {
+                return p_arc;
+            }
+
+            list_t_pop_back(p_function->p_arc_list);
+        }
+
+        allocator_t_free(p_function->p_allocator, p_arc);
+    }
+
+    /* Only the arcs lead to the maps of heads, so drop one left without. */
+    if (unordered_map_t_size(p_second_level_map) == 0)
+    {
+        unordered_map_t_remove(p_function->p_first_level_map, p_tail);
+        unordered_map_t_free(p_second_level_map);
+    }
+
+    return NULL;
+}
+
+bool td_weight_function_t_put(td_weight_function_t* p_function,
+                              directed_graph_node_t* p_tail,
+                              directed_graph_node_t* p_head,
+                              const double* p_times,
+                              const double* p_durations,
+                              size_t count)
+{
+    td_arc_t* p_arc;
+
+    if (!p_function)  return false;
+    if (!p_tail)      return false;
+    if (!p_head)      return false;
+    if (!p_times)     return false;
+    if (!p_durations) return false;
+
+    if (!is_fifo(p_times, p_durations, count)) return false;
+
+    if (!reserve(p_function, count)) return false;
+
+    if (!(p_arc = add_arc(p_function, p_tail, p_head))) return false;
+
+    memcpy(p_function->p_times + p_function->size,
+           p_times,
+           sizeof(double) * count);
+    memcpy(p_function->p_durations + p_function->size,
+           p_durations,
+           sizeof(double) * count);
+
+    p_function->garbage += p_arc->count;
+    p_arc->first         = p_function->size;
+    p_arc->count         = count;
+    p_function->size    += count;
+    return true;
+}
+
+double td_weight_function_t_evaluate(td_weight_function_t* p_function,
+                                     directed_graph_node_t* p_tail,
+                                     directed_graph_node_t* p_head,
+                                     double time)
+{
+    td_arc_t* p_arc;
+
+    if (!p_function) return INFINITY;
+
+    if (!(p_arc = arc_of(p_function, p_tail, p_head))) return INFINITY;
+
+    return evaluate_arc(p_function, p_arc, time);
+}
+
+bool td_weight_function_t_lower_bounds(
+        td_weight_function_t* p_function,
+        directed_graph_weight_function_t* p_weight_function)
+{
+    td_arc_t* p_arc;
+    double    least;
+    size_t    i;
+    size_t    j;
+
+    if (!p_function)        return false;
+    if (!p_weight_function) return false;
+
+    for (i = 0; i < list_t_size(p_function->p_arc_list); ++i)
+    {
+        p_arc = list_t_get(p_function->p_arc_list, i);
+        least = p_function->p_durations[p_arc->first];
+
+        for (j = 1; j < p_arc->count; ++j)
+        {
+            if (p_function->p_durations[p_arc->first + j] < least)
+            {
+                least = p_function->p_durations[p_arc->first + j];
+            }
+        }
+
+        if (!directed_graph_weight_function_t_put(p_weight_function,
+                                                  p_arc->p_tail,
+                                                  p_arc->p_head,
+                                                  least))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+double td_weight_function_t_arrival(td_weight_function_t* p_function,
+                                    list_t* p_path,
+                                    double departure)
+{
+    double time = departure;
+    size_t i;
+
+    if (!p_function) return INFINITY;
+    if (!p_path)     return INFINITY;
+
+    for (i = 1; i < list_t_size(p_path); ++i)
+    {
+        time += td_weight_function_t_evaluate(p_function,
+                                              list_t_get(p_path, i - 1),
+                                              list_t_get(p_path, i),
+                                              time);
+    }
+
+    return time;
+}
+
+size_t td_weight_function_t_memory_usage(td_weight_function_t* p_function)
+{
+    unordered_map_iterator_t* p_iterator;
+    void*                     p_tail;
+    void*                     p_second_level_map;
+    size_t                    usage;
+
+    if (!p_function) return 0;
+
+    usage = memory_block_size(sizeof(*p_function)) +
+            unordered_map_t_memory_usage(p_function->p_first_level_map) +
+            list_t_memory_usage(p_function->p_arc_list) +
+            memory_block_size(sizeof(td_arc_t)) *
+            list_t_size(p_function->p_arc_list);
+
+    if (p_function->capacity > 0)
+    {
+        usage += 2 * memory_block_size(sizeof(double) * p_function->capacity);
+    }
+
+    p_iterator = unordered_map_iterator_t_alloc(p_function->p_first_level_map);
+
+    while (unordered_map_iterator_t_has_next(p_iterator))
+    {
+        unordered_map_iterator_t_next(p_iterator,
+                                      &p_tail,
+                                      &p_second_level_map);
+        usage += unordered_map_t_memory_usage(p_second_level_map);
+    }
+
+    unordered_map_iterator_t_free(p_iterator);
+    return usage;
+}
+
+void td_weight_function_t_free(td_weight_function_t* p_function)
+{
+    td_arc_t* p_arc;
+    size_t    i;
+
+    if (!p_function) return;
+
+    for (i = 0; p_function->p_arc_list &&
+                i < list_t_size(p_function->p_arc_list); ++i)
+    {
+        p_arc = list_t_get(p_function->p_arc_list, i);
+
+        /* The first arc of each tail frees the map of its heads. */
+        unordered_map_t_free(unordered_map_t_remove(
+                p_function->p_first_level_map,
+                p_arc->p_tail));
+        allocator_t_free(p_function->p_allocator, p_arc);
+    }
+
+    list_t_free(p_function->p_arc_list);
+    unordered_map_t_free(p_function->p_first_level_map);
+    allocator_t_free(p_function->p_allocator, p_function->p_times);
+    allocator_t_free(p_function->p_allocator, p_function->p_durations);
+    allocator_t_free(p_function->p_allocator, p_function);
+}
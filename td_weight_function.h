@@ -0,0 +1,93 @@
+#ifndef TD_WEIGHT_FUNCTION_H
+#define	TD_WEIGHT_FUNCTION_H
+
+#include "allocator.h"
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include "list.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * Time-dependent arc weights. The travel time of each arc is a piecewise   *
+    * linear function of the departure time at its tail, given by breakpoints  *
+    * of increasing time and held constant before the first and after the      *
+    * last breakpoint. The functions are FIFO: leaving later never means       *
+    * arriving earlier. The breakpoints of each arc are stored contiguously,   *
+    * the times apart from the travel times, so that an evaluation is one      *
+    * binary search over a short array of times.                               *
+    ***************************************************************************/
+    typedef struct td_weight_function_t td_weight_function_t;
+
+    /***************************************************************************
+    * Allocates a new, empty time-dependent weight function. The function, its *
+    * maps and the breakpoints come from 'p_allocator', or from the C library  *
+    * if it is NULL.                                                           *
+    ***************************************************************************/
+    td_weight_function_t* td_weight_function_t_alloc(
+            size_t (*p_hash_function)(void*),
+            bool (*p_equals_function)(void*, void*),
+            allocator_t* p_allocator);
+
+    /***************************************************************************
+    * Associates with the arc ('p_tail', 'p_head') the travel times            *
+    * 'p_durations[i]' when leaving at the times 'p_times[i]', of which there  *
+    * are 'count'. Returns false and leaves the arc alone if there are no      *
+    * breakpoints, the times do not increase, a travel time is negative, the   *
+    * function is not FIFO, or there is not enough memory.                     *
+    ***************************************************************************/
+    bool td_weight_function_t_put(td_weight_function_t* p_function,
+                                  directed_graph_node_t* p_tail,
+                                  directed_graph_node_t* p_head,
+                                  const double* p_times,
+                                  const double* p_durations,
+                                  size_t count);
+
+    /***************************************************************************
+    * Returns the travel time over the arc ('p_tail', 'p_head') when leaving   *
+    * at 'time', or INFINITY if the arc has no function.                       *
+    ***************************************************************************/
+    double td_weight_function_t_evaluate(td_weight_function_t* p_function,
+                                         directed_graph_node_t* p_tail,
+                                         directed_graph_node_t* p_head,
+                                         double time);
+
+    /***************************************************************************
+    * Puts the least travel time of every arc with a function into             *
+    * 'p_weight_function'. A heuristic that is admissible for those weights is *
+    * admissible for the time-dependent searches at any departure time.        *
+    * Returns false if there is not enough memory.                             *
+    ***************************************************************************/
+    bool td_weight_function_t_lower_bounds(
+            td_weight_function_t* p_function,
+            directed_graph_weight_function_t* p_weight_function);
+
+    /***************************************************************************
+    * Returns the time of arrival at the end of 'p_path' when leaving its      *
+    * first node at 'departure', or INFINITY if an arc of the path has no      *
+    * function.                                                                *
+    ***************************************************************************/
+    double td_weight_function_t_arrival(td_weight_function_t* p_function,
+                                        list_t* p_path,
+                                        double departure);
+
+    /***************************************************************************
+    * Returns the number of bytes the function and all the stored breakpoints  *
+    * take from the allocator, including the allocator overhead of each block. *
+    ***************************************************************************/
+    size_t td_weight_function_t_memory_usage(td_weight_function_t* p_function);
+
+    /***************************************************************************
+    * Deallocates the function.                                                *
+    ***************************************************************************/
+    void td_weight_function_t_free(td_weight_function_t* p_function);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* TD_WEIGHT_FUNCTION_H */
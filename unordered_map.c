@@ -1,4 +1,6 @@
 #include "unordered_map.h"
+#include "allocator.h"
+#include "memory_usage.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -16,6 +18,7 @@ typedef struct unordered_map_t {
     unordered_map_entry_t*  p_tail;
     size_t                (*p_hash_function)(void*);
     bool                  (*p_equals_function)(void*, void*);
+    allocator_t*            p_allocator;
     size_t                  mod_count;
     size_t                  table_capacity;
     size_t                  size;
@@ -31,10 +34,13 @@ typedef struct unordered_map_iterator_t {
     size_t                 expected_mod_count;
 } unordered_map_iterator_t;
 
-static unordered_map_entry_t* unordered_map_entry_t_alloc(void* p_key,
-                                                          void* p_value)
+static unordered_map_entry_t* unordered_map_entry_t_alloc(
+        unordered_map_t* p_map,
+        void* p_key,
+        void* p_value)
 {
-    unordered_map_entry_t* p_ret = malloc(sizeof(*p_ret));
+    unordered_map_entry_t* p_ret = allocator_t_alloc(p_map->p_allocator,
+                                                     sizeof(*p_ret));
 
     if (!p_ret) return NULL;
 
@@ -86,14 +92,15 @@ static size_t fix_initial_capacity(size_t initial_capacity)
 unordered_map_t* unordered_map_t_alloc(size_t initial_capacity,
                                        float load_factor,
                                        size_t (*p_hash_function)(void*),
-                                       bool (*p_equals_function)(void*, void*))
+                                       bool (*p_equals_function)(void*, void*),
+                                       allocator_t* p_allocator)
 {
     unordered_map_t* p_ret;
 
     if (!p_hash_function)   return NULL;
     if (!p_equals_function) return NULL;
 
-    p_ret = malloc(sizeof(*p_ret));
+    p_ret = allocator_t_alloc(p_allocator, sizeof(*p_ret));
 
     if (!p_ret) return NULL;
 
@@ -106,10 +113,20 @@ unordered_map_t* unordered_map_t_alloc(size_t initial_capacity,
     p_ret->mod_count         = 0;
     p_ret->p_head            = NULL;
     p_ret->p_tail            = NULL;
-    p_ret->p_table           = calloc(initial_capacity, 
+    p_ret->p_table           = allocator_t_calloc(
+                                      p_allocator,
+                                      initial_capacity,
                                       sizeof(unordered_map_entry_t*));
+
+    if (!p_ret->p_table)
+    {
+        allocator_t_free(p_allocator, p_ret);
+        return NULL;
+    }
+
     p_ret->p_hash_function   = p_hash_function;
     p_ret->p_equals_function = p_equals_function;
+    p_ret->p_allocator       = p_allocator;
     p_ret->mask              = initial_capacity - 1;
     p_ret->max_allowed_size  = (size_t)(initial_capacity * load_factor);
 
@@ -128,7 +145,9 @@ static void ensure_capacity(unordered_map_t* p_map)
     
     new_capacity = 2 * p_map->table_capacity;
     new_mask     = new_capacity - 1;
-    p_new_table  = calloc(new_capacity, sizeof(unordered_map_entry_t*));
+    p_new_table  = allocator_t_calloc(p_map->p_allocator,
+                                      new_capacity,
+                                      sizeof(unordered_map_entry_t*));
     
     if (!p_new_table) return;
 
@@ -140,7 +159,7 @@ static void ensure_capacity(unordered_map_t* p_map)
         p_new_table[index] = p_entry;
     }
 
-    free(p_map->p_table);
+    allocator_t_free(p_map->p_allocator, p_map->p_table);
     
     p_map->p_table          = p_new_table;
     p_map->table_capacity   = new_capacity;
@@ -176,7 +195,10 @@ void* unordered_map_t_put(unordered_map_t* p_map, void* p_key, void* p_value)
 
     /* Recompute the index since it is possibly changed by 'ensure_capacity' */
     index                 = hash_value & p_map->mask;
-    p_entry               = unordered_map_entry_t_alloc(p_key, p_value);
+    p_entry               = unordered_map_entry_t_alloc(p_map, p_key, p_value);
+
+    if (!p_entry) return NULL;
+
     p_entry->p_chain_next = p_map->p_table[index];
     p_map->p_table[index] = p_entry;
 
@@ -288,7 +310,7 @@ void* unordered_map_t_remove(unordered_map_t* p_map, void* p_key)
             p_ret = p_current_entry->p_value;
             p_map->size--;
             p_map->mod_count++;
-            free(p_current_entry);
+            allocator_t_free(p_map->p_allocator, p_current_entry);
             return p_ret;
         }
 
@@ -312,7 +334,7 @@ void unordered_map_t_clear(unordered_map_t* p_map)
     {
         index = p_map->p_hash_function(p_entry->p_key) & p_map->mask;
         p_next_entry = p_entry->p_next;
-        free(p_entry);
+        allocator_t_free(p_map->p_allocator, p_entry);
         p_entry = p_next_entry;
         p_map->p_table[index] = NULL;
     }
@@ -328,6 +350,16 @@ size_t unordered_map_t_size(unordered_map_t* p_map)
     return p_map ? p_map->size : 0;
 }
 
+size_t unordered_map_t_memory_usage(unordered_map_t* p_map)
+{
+    if (!p_map) return 0;
+
+    return memory_block_size(sizeof(*p_map)) +
+           memory_block_size(sizeof(unordered_map_entry_t*) *
+                             p_map->table_capacity) +
+           memory_block_size(sizeof(unordered_map_entry_t)) * p_map->size;
+}
+
 bool unordered_map_t_is_healthy(unordered_map_t* p_map)
 {
     size_t counter;
@@ -353,8 +385,8 @@ void unordered_map_t_free(unordered_map_t* p_map)
     if (!p_map) return;
 
     unordered_map_t_clear(p_map);
-    free(p_map->p_table);
-    free(p_map);
+    allocator_t_free(p_map->p_allocator, p_map->p_table);
+    allocator_t_free(p_map->p_allocator, p_map);
 }
 
 unordered_map_iterator_t* 
@@ -364,7 +396,7 @@ unordered_map_iterator_t_alloc(unordered_map_t* p_map)
 
     if (!p_map) return NULL;
 
-    p_ret = malloc(sizeof(*p_ret));
+    p_ret = allocator_t_alloc(p_map->p_allocator, sizeof(*p_ret));
 
     if (!p_ret) return NULL;
 
@@ -410,10 +442,13 @@ unordered_map_iterator_t_is_disturbed(unordered_map_iterator_t* p_iterator)
 
 void unordered_map_iterator_t_free(unordered_map_iterator_t* p_iterator)
 {
+    allocator_t* p_allocator;
+
     if (!p_iterator) return;
 
+    p_allocator = p_iterator->p_map->p_allocator;
     p_iterator->p_map = NULL;
     p_iterator->p_next_entry = NULL;
-    free(p_iterator);
+    allocator_t_free(p_allocator, p_iterator);
 }
 
@@ -1,6 +1,7 @@
 #ifndef UNORDERED_MAP_H
 #define	UNORDERED_MAP_H
 
+#include "allocator.h"
 #include <stdlib.h>
 #include <stdbool.h>
 
@@ -13,13 +14,15 @@ extern "C" {
 
     /***************************************************************************
     * Allocates a new, empty map with given hash function and given equality   *
-    * testing function.                                                        * 
+    * testing function. The map and its entries come from 'p_allocator', or    *
+    * from the C library if it is NULL.                                        *
     ***************************************************************************/ 
     unordered_map_t* unordered_map_t_alloc 
            (size_t initial_capacity,
             float load_factor,
             size_t (*p_hash_function)(void*),
-            bool (*p_equals_function)(void*, void*));
+            bool (*p_equals_function)(void*, void*),
+            allocator_t* p_allocator);
 
     /***************************************************************************
     * If p_map does not contain the key p_key, inserts it in the map,          *
@@ -61,6 +64,13 @@ extern "C" {
     ***************************************************************************/ 
     size_t unordered_map_t_size            (unordered_map_t* p_map);
 
+    /***************************************************************************
+    * Returns the number of bytes the map takes from the allocator, including  *
+    * the allocator overhead of each block. The keys and values are not        *
+    * counted.                                                                 *
+    ***************************************************************************/
+    size_t unordered_map_t_memory_usage    (unordered_map_t* p_map);
+
     /***************************************************************************
     * Checks that the map is in valid state.                                   *
     ***************************************************************************/  
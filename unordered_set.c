@@ -1,4 +1,6 @@
 #include "unordered_set.h"
+#include "allocator.h"
+#include "memory_usage.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -15,6 +17,7 @@ typedef struct unordered_set_t {
     unordered_set_entry_t*  p_tail;
     size_t                (*p_hash_function)(void*);
     bool                  (*p_equals_function)(void*, void*);
+    allocator_t*            p_allocator;
     size_t                  mod_count;
     size_t                  table_capacity;
     size_t                  size;
@@ -30,9 +33,12 @@ typedef struct unordered_set_iterator_t {
     size_t                 expected_mod_count;
 } unordered_set_iterator_t;
 
-static unordered_set_entry_t* unordered_set_entry_t_alloc(void* p_key)
+static unordered_set_entry_t* unordered_set_entry_t_alloc(
+        unordered_set_t* p_set,
+        void* p_key)
 {
-    unordered_set_entry_t* p_ret = malloc(sizeof(*p_ret));
+    unordered_set_entry_t* p_ret = allocator_t_alloc(p_set->p_allocator,
+                                                     sizeof(*p_ret));
 
     if (!p_ret) return NULL;
 
@@ -83,14 +89,15 @@ static size_t fix_initial_capacity(size_t initial_capacity)
 unordered_set_t* unordered_set_t_alloc(size_t initial_capacity,
                                        float load_factor,
                                        size_t (*p_hash_function)(void*),
-                                       bool (*p_equals_function)(void*, void*))
+                                       bool (*p_equals_function)(void*, void*),
+                                       allocator_t* p_allocator)
 {
     unordered_set_t* p_ret;
 
     if (!p_hash_function)   return NULL;
     if (!p_equals_function) return NULL;
 
-    p_ret = malloc(sizeof(*p_ret));
+    p_ret = allocator_t_alloc(p_allocator, sizeof(*p_ret));
 
     if (!p_ret) return NULL;
 
@@ -103,10 +110,20 @@ unordered_set_t* unordered_set_t_alloc(size_t initial_capacity,
     p_ret->mod_count         = 0;
     p_ret->p_head            = NULL;
     p_ret->p_tail            = NULL;
-    p_ret->p_table           = calloc(initial_capacity, 
+    p_ret->p_table           = allocator_t_calloc(
+                                      p_allocator,
+                                      initial_capacity,
                                       sizeof(unordered_set_entry_t*));
+
+    if (!p_ret->p_table)
+    {
+        allocator_t_free(p_allocator, p_ret);
+        return NULL;
+    }
+
     p_ret->p_hash_function   = p_hash_function;
     p_ret->p_equals_function = p_equals_function;
+    p_ret->p_allocator       = p_allocator;
     p_ret->mask              = initial_capacity - 1;
     p_ret->max_allowed_size  = (size_t)(initial_capacity * load_factor);
 
@@ -125,7 +142,9 @@ static void ensure_capacity(unordered_set_t* p_set)
     
     new_capacity = 2 * p_set->table_capacity;
     new_mask = new_capacity - 1;
-    p_new_table = calloc(new_capacity, sizeof(unordered_set_entry_t*));
+    p_new_table = allocator_t_calloc(p_set->p_allocator,
+                                     new_capacity,
+                                     sizeof(unordered_set_entry_t*));
 
     if (!p_new_table) return;
 
@@ -137,7 +156,7 @@ static void ensure_capacity(unordered_set_t* p_set)
         p_new_table[index] = p_entry;
     }
 
-    free(p_set->p_table);
+    allocator_t_free(p_set->p_allocator, p_set->p_table);
     
     p_set->p_table          = p_new_table;
     p_set->table_capacity   = new_capacity;
@@ -170,7 +189,10 @@ bool unordered_set_t_add(unordered_set_t* p_set, void* p_key)
 
     /* Recompute the index since it is possibly changed by 'ensure_capacity' */
     index                 = hash_value & p_set->mask;
-    p_entry               = unordered_set_entry_t_alloc(p_key);
+    p_entry               = unordered_set_entry_t_alloc(p_set, p_key);
+
+    if (!p_entry) return false;
+
     p_entry->p_chain_next = p_set->p_table[index];
     p_set->p_table[index] = p_entry;
 
@@ -251,9 +273,9 @@ bool unordered_set_t_remove(unordered_set_t* p_set, void* p_key)
                 p_set->p_head = p_current_entry->p_next;
             }
             
-            if (p_current_entry->p_prev)
+            if (p_current_entry->p_next)
             {
-                p_current_entry->p_prev->p_next = p_current_entry->p_prev;
+                p_current_entry->p_next->p_prev = p_current_entry->p_prev;
             }
             else
             {
@@ -262,7 +284,7 @@ bool unordered_set_t_remove(unordered_set_t* p_set, void* p_key)
             
             p_set->size--;
             p_set->mod_count++;
-            free(p_current_entry);
+            allocator_t_free(p_set->p_allocator, p_current_entry);
             return true;
         }
 
@@ -286,7 +308,7 @@ void unordered_set_t_clear(unordered_set_t* p_set)
     {
         index = p_set->p_hash_function(p_entry->p_key) & p_set->mask;
         p_next_entry = p_entry->p_next;
-        free(p_entry);
+        allocator_t_free(p_set->p_allocator, p_entry);
         p_entry = p_next_entry;
         p_set->p_table[index] = NULL;
     }
@@ -302,6 +324,16 @@ size_t unordered_set_t_size(unordered_set_t* p_set)
     return p_set ? p_set->size : 0;
 }
 
+size_t unordered_set_t_memory_usage(unordered_set_t* p_set)
+{
+    if (!p_set) return 0;
+
+    return memory_block_size(sizeof(*p_set)) +
+           memory_block_size(sizeof(unordered_set_entry_t*) *
+                             p_set->table_capacity) +
+           memory_block_size(sizeof(unordered_set_entry_t)) * p_set->size;
+}
+
 bool unordered_set_t_is_healthy(unordered_set_t* p_set)
 {
     size_t counter;
@@ -327,8 +359,8 @@ void unordered_set_t_free(unordered_set_t* p_map)
     if (!p_map) return;
 
     unordered_set_t_clear(p_map);
-    free(p_map->p_table);
-    free(p_map);
+    allocator_t_free(p_map->p_allocator, p_map->p_table);
+    allocator_t_free(p_map->p_allocator, p_map);
 }
 
 unordered_set_iterator_t* 
@@ -338,7 +370,7 @@ unordered_set_iterator_t_alloc(unordered_set_t* p_set)
 
     if (!p_set) return NULL;
 
-    p_ret = malloc(sizeof(*p_ret));
+    p_ret = allocator_t_alloc(p_set->p_allocator, sizeof(*p_ret));
 
     if (!p_ret) return NULL;
 
@@ -382,11 +414,14 @@ unordered_set_iterator_t_is_disturbed(unordered_set_iterator_t* p_iterator)
 
 void unordered_set_iterator_t_free(unordered_set_iterator_t* p_iterator)
 {
+    allocator_t* p_allocator;
+
     if (!p_iterator) return;
 
+    p_allocator = p_iterator->p_map->p_allocator;
     p_iterator->p_map = NULL;
     p_iterator->p_next_entry = NULL;
-    free(p_iterator);
+    allocator_t_free(p_allocator, p_iterator);
 }
 
 
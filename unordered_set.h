@@ -1,6 +1,7 @@
 #ifndef UNORDERED_SET_H
 #define	UNORDERED_SET_H
 
+#include "allocator.h"
 #include <stdlib.h>
 #include <stdbool.h>
 
@@ -13,13 +14,15 @@ extern "C" {
 
     /***************************************************************************
     * Allocates a new, empty set with given hash function and given equality   *
-    * testing function.                                                        * 
+    * testing function. The set and its entries come from 'p_allocator', or    *
+    * from the C library if it is NULL.                                        *
     ***************************************************************************/ 
     unordered_set_t* unordered_set_t_alloc 
             (size_t initial_capacity,
              float load_factor,
              size_t (*p_hash_function)(void*),
-             bool (*p_equals_function)(void*, void*));
+             bool (*p_equals_function)(void*, void*),
+             allocator_t* p_allocator);
 
     /***************************************************************************
     * Adds 'p_element' to the set if not already there. Returns true if the    *
@@ -47,6 +50,12 @@ extern "C" {
     ***************************************************************************/ 
     size_t unordered_set_t_size (unordered_set_t* p_set);
 
+    /***************************************************************************
+    * Returns the number of bytes the set takes from the allocator, including  *
+    * the allocator overhead of each block. The elements are not counted.      *
+    ***************************************************************************/
+    size_t unordered_set_t_memory_usage (unordered_set_t* p_set);
+
     /***************************************************************************
     * Checks that the set is in valid state.                                   *
     ***************************************************************************/  
@@ -2,7 +2,12 @@
 #include "unordered_map.h"
 #include "utils.h"
 #include "list.h"
+#include "memory_usage.h"
 #include <math.h>
+#include <string.h>
+
+/* Shaves the cost per distance so that rounding cannot overestimate. */
+static const double COST_PER_DISTANCE_MARGIN = 1e-9;
 
 point_3d_t* random_point(double maxx, double maxy, double maxz) 
 {
@@ -46,32 +51,38 @@ int priority_cmp(void* pa, void* pb)
     return 0;
 }
     
-void search_state_t_alloc(search_state_t* p_state) 
+void search_state_t_alloc(search_state_t* p_state, allocator_t* p_allocator) 
 {
     if (!p_state) return;
 
-    p_state->p_weight_list = list_t_alloc(INITIAL_CAPACITY);
+    p_state->p_allocator   = p_allocator;
+
+    p_state->p_weight_list = list_t_alloc(INITIAL_CAPACITY, p_allocator);
     p_state->p_open_set    = heap_t_alloc(4, 
                                           INITIAL_CAPACITY,
                                           LOAD_FACTOR,
                                           hash_function,
                                           equals_function,
-                                          priority_cmp);
+                                          priority_cmp,
+                                          p_allocator);
 
     p_state->p_closed_set  = unordered_set_t_alloc(INITIAL_CAPACITY,
                                                    LOAD_FACTOR,
                                                    hash_function,
-                                                   equals_function);
+                                                   equals_function,
+                                                   p_allocator);
 
     p_state->p_parent_map  = unordered_map_t_alloc(INITIAL_CAPACITY,
                                                    LOAD_FACTOR,
                                                    hash_function,
-                                                   equals_function);
+                                                   equals_function,
+                                                   p_allocator);
 
     p_state->p_cost_map  = unordered_map_t_alloc(INITIAL_CAPACITY,
                                                  LOAD_FACTOR,
                                                  hash_function,
-                                                 equals_function);
+                                                 equals_function,
+                                                 p_allocator);
 }
 
 bool search_state_t_is_ready(search_state_t* p_state) 
@@ -85,13 +96,243 @@ bool search_state_t_is_ready(search_state_t* p_state)
 
 void search_state_t_free(search_state_t* p_state) 
 {
+    size_t i;
+
+    /* The weight list owns all the weights allocated during the search. */
+    for (i = 0; i < list_t_size(p_state->p_weight_list); ++i)
+    {
+        allocator_t_free(p_state->p_allocator,
+                         list_t_get(p_state->p_weight_list, i));
+    }
+
     if (p_state->p_weight_list) list_t_free(p_state->p_weight_list);
     if (p_state->p_open_set)    heap_t_free(p_state->p_open_set);
     if (p_state->p_closed_set)  unordered_set_t_free(p_state->p_closed_set);
     if (p_state->p_parent_map)  unordered_map_t_free(p_state->p_parent_map);
     if (p_state->p_cost_map)    unordered_map_t_free(p_state->p_cost_map);
 }
+
+void search_state_t_clear(search_state_t* p_state)
+{
+    size_t i;
+
+    for (i = 0; i < list_t_size(p_state->p_weight_list); ++i)
+    {
+        allocator_t_free(p_state->p_allocator,
+                         list_t_get(p_state->p_weight_list, i));
+    }
+
+    list_t_clear(p_state->p_weight_list);
+    heap_t_clear(p_state->p_open_set);
+    unordered_set_t_clear(p_state->p_closed_set);
+    unordered_map_t_clear(p_state->p_parent_map);
+    unordered_map_t_clear(p_state->p_cost_map);
+}
     
+size_t search_state_t_memory_usage(search_state_t* p_state)
+{
+    if (!p_state) return 0;
+
+    return list_t_memory_usage(p_state->p_weight_list) +
+           memory_block_size(sizeof(weight_t)) *
+           list_t_size(p_state->p_weight_list) +
+           heap_t_memory_usage(p_state->p_open_set) +
+           unordered_set_t_memory_usage(p_state->p_closed_set) +
+           unordered_map_t_memory_usage(p_state->p_parent_map) +
+           unordered_map_t_memory_usage(p_state->p_cost_map);
+}
+
+size_t graph_data_t_memory_usage(graph_data_t* p_data)
+{
+    directed_graph_node_t* p_node;
+    size_t                 usage;
+    size_t                 arcs = 0;
+    size_t                 i;
+
+    if (!p_data) return 0;
+
+    usage = memory_block_size(sizeof(*p_data)) +
+            memory_block_size(sizeof(directed_graph_node_t*) *
+                              p_data->node_count) +
+            directed_graph_weight_function_t_memory_usage(
+                    p_data->p_weight_function) +
+            unordered_map_t_memory_usage(p_data->p_point_map) +
+            memory_block_size(sizeof(point_3d_t)) *
+            unordered_map_t_size(p_data->p_point_map);
+
+    for (i = 0; i < p_data->node_count; ++i)
+    {
+        p_node = p_data->p_node_array[i];
+        usage += directed_graph_node_t_memory_usage(p_node);
+
+        /* Undirected nodes have no slice in the reverse arc block. */
+        if (!directed_graph_node_t_is_undirected(p_node))
+        {
+            arcs += directed_graph_node_t_child_count(p_node);
+        }
+
+        /* The graph owns the names of its nodes. */
+        usage += memory_block_usage(
+                directed_graph_node_t_name(p_node),
+                strlen(directed_graph_node_t_name(p_node)) + 1);
+    }
+
+    if (p_data->p_reverse_arcs)
+    {
+        usage += memory_block_size(sizeof(directed_graph_node_t*) *
+                                   (arcs ? arcs : 1));
+    }
+
+    return usage + coordinate_store_t_memory_usage(p_data->p_coordinates);
+}
+
+bool graph_data_t_ensure_parents(graph_data_t* p_data)
+{
+    if (!p_data)                return false;
+    if (p_data->p_reverse_arcs) return true;
+
+    p_data->p_reverse_arcs = 
+            directed_graph_node_t_build_parents(p_data->p_node_array,
+                                                p_data->node_count,
+                                                NULL);
+
+    return p_data->p_reverse_arcs != NULL;
+}
+
+/*******************************************************************************
+* Returns the least cost per unit of Euclidean length over all the arcs of the *
+* graph with a length, or 1.0 if there are none. No path is then cheaper than  *
+* this times the distance between its ends.                                    *
+*******************************************************************************/
+static double min_cost_per_distance(graph_data_t* p_data)
+{
+    directed_graph_node_t*  p_node;
+    directed_graph_node_t** p_children;
+    point_3d_t*             p_point;
+    point_3d_t*             p_child_point;
+    double*                 p_weight;
+    double                  distance;
+    double                  ratio = INFINITY;
+    size_t                  child_count;
+    size_t                  i;
+    size_t                  j;
+
+    for (i = 0; i < p_data->node_count; ++i)
+    {
+        p_node      = p_data->p_node_array[i];
+        p_point     = unordered_map_t_get(p_data->p_point_map, p_node);
+        p_children  = directed_graph_node_t_children(p_node);
+        child_count = directed_graph_node_t_child_count(p_node);
+
+        if (!p_point) continue;
+
+        for (j = 0; j < child_count; ++j)
+        {
+            p_child_point = unordered_map_t_get(p_data->p_point_map, 
+                                                p_children[j]);
+            p_weight = directed_graph_weight_function_t_get(
+                    p_data->p_weight_function,
+                    p_node,
+                    p_children[j]);
+
+            if (!p_child_point || !p_weight) continue;
+
+            distance = point_3d_t_distance(p_point, p_child_point);
+
+            if (distance > 0.0 && *p_weight / distance < ratio)
+            {
+                ratio = *p_weight / distance;
+            }
+        }
+    }
+
+    return ratio == INFINITY ? 1.0 : ratio * (1.0 - COST_PER_DISTANCE_MARGIN);
+}
+
+bool graph_data_t_ensure_coordinates(graph_data_t* p_data)
+{
+    coordinate_store_t* p_store;
+    point_3d_t*         p_point;
+    size_t              i;
+
+    if (!p_data) return false;
+
+    /* Rescale when the weights changed, since a lower weight may break the
+       old scale. */
+    if (p_data->p_coordinates)
+    {
+        if (p_data->coordinates_version != directed_graph_version())
+        {
+            coordinate_store_t_set_scale(p_data->p_coordinates,
+                                         min_cost_per_distance(p_data));
+            p_data->coordinates_version = directed_graph_version();
+        }
+
+        return true;
+    }
+
+    if (!(p_store = coordinate_store_t_alloc(p_data->node_count, NULL)))
+    {
+        return false;
+    }
+
+    for (i = 0; i < p_data->node_count; ++i)
+    {
+        directed_graph_node_t_set_id(p_data->p_node_array[i], (uint32_t) i);
+        p_point = unordered_map_t_get(p_data->p_point_map, 
+                                      p_data->p_node_array[i]);
+
+        if (p_point)
+        {
+            coordinate_store_t_set(p_store,
+                                   (uint32_t) i,
+                                   p_point->x,
+                                   p_point->y,
+                                   p_point->z);
+        }
+    }
+
+    coordinate_store_t_set_scale(p_store, min_cost_per_distance(p_data));
+    p_data->p_coordinates       = p_store;
+    p_data->coordinates_version = directed_graph_version();
+    return true;
+}
+
+void graph_data_t_free(graph_data_t* p_data)
+{
+    char*  p_name;
+    size_t i;
+
+    if (!p_data) return;
+
+    /* The maps hash the nodes by their names, so the nodes go last. */
+    for (i = 0; i < p_data->node_count; ++i)
+    {
+        if (!p_data->p_node_array[i]) continue;
+
+        free(unordered_map_t_get(p_data->p_point_map,
+                                 p_data->p_node_array[i]));
+    }
+
+    unordered_map_t_free(p_data->p_point_map);
+    directed_graph_weight_function_t_free(p_data->p_weight_function);
+    coordinate_store_t_free(p_data->p_coordinates);
+
+    for (i = 0; i < p_data->node_count; ++i)
+    {
+        if (!p_data->p_node_array[i]) continue;
+
+        p_name = directed_graph_node_t_name(p_data->p_node_array[i]);
+        directed_graph_node_t_free(p_data->p_node_array[i]);
+        free(p_name);
+    }
+
+    /* The nodes share the reverse arcs, so these go after them. */
+    free(p_data->p_reverse_arcs);
+    free(p_data->p_node_array);
+    free(p_data);
+}
+
 directed_graph_node_t* choose(directed_graph_node_t** p_table,
                                      const size_t size)
 {
@@ -99,12 +340,17 @@ directed_graph_node_t* choose(directed_graph_node_t** p_table,
     return p_table[index];
 }
 
-graph_data_t* create_random_graph(const size_t nodes, 
-                                  size_t edges,
-                                  const double maxx,
-                                  const double maxy,
-                                  const double maxz,
-                                  const double max_distance)
+/*******************************************************************************
+* Builds the random graph, recording the parents of the nodes along with the   *
+* arcs only if 'keep_parents' is set.                                          *
+*******************************************************************************/
+static graph_data_t* build_random_graph(const size_t nodes,
+                                        size_t edges,
+                                        const double maxx,
+                                        const double maxy,
+                                        const double maxz,
+                                        const double max_distance,
+                                        const bool keep_parents)
 {
     size_t i;
     char* p_name;
@@ -133,7 +379,8 @@ graph_data_t* create_random_graph(const size_t nodes,
 
     if (!(p_weight_function = 
             directed_graph_weight_function_t_alloc(hash_function,
-                                                   equals_function)))
+                                                   equals_function,
+                                                   NULL)))
     {
         free(p_ret);
         free(p_node_array);
@@ -143,7 +390,8 @@ graph_data_t* create_random_graph(const size_t nodes,
     if (!(p_point_map = unordered_map_t_alloc(16, 
                                               1.0f, 
                                               hash_function,
-                                              equals_function)))  
+                                              equals_function,
+                                              NULL)))  
     {
         directed_graph_weight_function_t_free(p_weight_function);
         free(p_ret);
@@ -155,7 +403,7 @@ graph_data_t* create_random_graph(const size_t nodes,
     {
         p_name = malloc(sizeof(char) * 20);
         sprintf(p_name, "%d", i);
-        p_node_array[i] = directed_graph_node_t_alloc(p_name);
+        p_node_array[i] = directed_graph_node_t_alloc(p_name, NULL);
         unordered_map_t_put(p_point_map, 
                             p_node_array[i], 
                             random_point(maxx, maxy, maxz));
@@ -176,7 +424,14 @@ graph_data_t* create_random_graph(const size_t nodes,
             continue;
         }
         
-        directed_graph_node_t_add_arc(p_tail, p_head);
+        if (keep_parents)
+        {
+            directed_graph_node_t_add_arc(p_tail, p_head);
+        }
+        else
+        {
+            directed_graph_node_t_add_child(p_tail, p_head);
+        }
 
         directed_graph_weight_function_t_put(
                 p_weight_function,
@@ -187,13 +442,73 @@ graph_data_t* create_random_graph(const size_t nodes,
         --edges;
     }
 
-    p_ret->p_node_array      = p_node_array;
-    p_ret->p_weight_function = p_weight_function;
-    p_ret->p_point_map       = p_point_map;
+    p_ret->p_node_array        = p_node_array;
+    p_ret->p_weight_function   = p_weight_function;
+    p_ret->p_point_map         = p_point_map;
+    p_ret->node_count          = nodes;
+    p_ret->p_reverse_arcs      = NULL;
+    p_ret->p_coordinates       = NULL;
+    p_ret->coordinates_version = 0;
 
     return p_ret;
 }
 
+graph_data_t* create_random_graph(const size_t nodes, 
+                                  size_t edges,
+                                  const double maxx,
+                                  const double maxy,
+                                  const double maxz,
+                                  const double max_distance)
+{
+    return build_random_graph(nodes,
+                              edges,
+                              maxx,
+                              maxy,
+                              maxz,
+                              max_distance,
+                              true);
+}
+
+graph_data_t* create_random_graph_without_parents(const size_t nodes,
+                                                  size_t edges,
+                                                  const double maxx,
+                                                  const double maxy,
+                                                  const double maxz,
+                                                  const double max_distance)
+{
+    return build_random_graph(nodes,
+                              edges,
+                              maxx,
+                              maxy,
+                              maxz,
+                              max_distance,
+                              false);
+}
+
+bool choose_heuristic(heuristic_t* p_heuristic,
+                      unordered_map_t* p_location_map,
+                      search_options_t* p_options)
+{
+    if (p_options && p_options->p_heuristic) 
+    {
+        *p_heuristic = *p_options->p_heuristic;
+    }
+    else if (p_options && p_options->p_coordinates) 
+    {
+        *p_heuristic = heuristic_coordinates(p_options->p_coordinates);
+    }
+    else if (p_location_map)
+    {
+        *p_heuristic = heuristic_location_map(p_location_map);
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
 list_t* traceback_path(directed_graph_node_t* p_target,
                        unordered_map_t* p_parent_map)
 {
@@ -203,7 +518,7 @@ list_t* traceback_path(directed_graph_node_t* p_target,
     if (!p_target)     return NULL;
     if (!p_parent_map) return NULL;
 
-    p_ret = list_t_alloc(10);
+    p_ret = list_t_alloc(10, NULL);
 
     if (!p_ret)        return NULL;
 
@@ -229,7 +544,7 @@ list_t* traceback_bidirectional_path(directed_graph_node_t* p_middle_node,
     if (!p_parent_map_a) return NULL;
     if (!p_parent_map_b) return NULL;
     
-    p_ret = list_t_alloc(INITIAL_CAPACITY);
+    p_ret = list_t_alloc(INITIAL_CAPACITY, NULL);
     
     if (!p_ret) return NULL;
     
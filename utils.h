@@ -1,11 +1,15 @@
 #ifndef GRAPH_UTILS_H
 #define	GRAPH_UTILS_H
 
+#include "coordinate_store.h"
 #include "directed_graph_node.h"
 #include "unordered_map.h"
+#include "unordered_set.h"
 #include "weight_function.h"
 #include "list.h"
 #include "heap.h"
+#include "heuristic.h"
+#include "search_options.h"
 
 #ifdef	__cplusplus
 extern "C" {
@@ -17,10 +21,26 @@ extern "C" {
         double z;
     } point_3d_t;
 
+    /***************************************************************************
+    * A generated graph. The grid, planar and highway graphs are made of       *
+    * undirected edges, whose nodes report their children as their parents,    *
+    * and the random graph adds its arcs with their parents. Only the graph of *
+    * 'create_random_graph_without_parents' knows no parents until             *
+    * 'graph_data_t_ensure_parents' builds them for a backward search. The     *
+    * packed coordinates the A* searches read are built on demand too, by      *
+    * 'graph_data_t_ensure_coordinates'.                                       *
+    ***************************************************************************/
     typedef struct graph_data_t {
         directed_graph_node_t**           p_node_array;
         directed_graph_weight_function_t* p_weight_function;
         unordered_map_t*                  p_point_map;
+        size_t                            node_count;
+        /* The reverse arcs shared by the nodes, or NULL if not built. */
+        directed_graph_node_t**           p_reverse_arcs;
+        /* The coordinates indexed by node id, or NULL if not built. */
+        coordinate_store_t*               p_coordinates;
+        /* The graph version the scale of the coordinates was computed at. */
+        uint64_t                          coordinates_version;
     } graph_data_t;
 
     typedef struct search_state_t {
@@ -29,6 +49,7 @@ extern "C" {
         unordered_set_t* p_closed_set;
         unordered_map_t* p_parent_map;
         unordered_map_t* p_cost_map;
+        allocator_t*     p_allocator;
     } search_state_t;
     
     typedef struct weight_t {
@@ -40,9 +61,66 @@ extern "C" {
     static const size_t INITIAL_CAPACITY = 16;
     static const float  LOAD_FACTOR = 1.0f;
     
-    void search_state_t_alloc(search_state_t* p_state);
+    /***************************************************************************
+    * Allocates the search state structures from 'p_allocator', or from the C  *
+    * library if it is NULL. The weights of the search should come from the    *
+    * same allocator, since 'search_state_t_free' returns them to it.          *
+    ***************************************************************************/
+    void search_state_t_alloc(search_state_t* p_state,
+                              allocator_t* p_allocator);
     bool search_state_t_is_ready(search_state_t* p_state);
+    
+    /***************************************************************************
+    * Deallocates the search state structures along with all the weights       *
+    * stored in the weight list.                                               *
+    ***************************************************************************/  
     void search_state_t_free(search_state_t* p_state);
+
+    /***************************************************************************
+    * Empties the search state structures and frees all the weights, so that   *
+    * the state can serve another search. The state must be ready.             *
+    ***************************************************************************/
+    void search_state_t_clear(search_state_t* p_state);
+
+    /***************************************************************************
+    * Returns the number of bytes the search state takes from the allocator,   *
+    * including the weights in the weight list. The state itself usually lives *
+    * on the stack and is not counted.                                         *
+    ***************************************************************************/
+    size_t search_state_t_memory_usage(search_state_t* p_state);
+
+    /***************************************************************************
+    * Returns the number of bytes the graph takes from the allocator: the      *
+    * nodes with their names, the weight function and the node coordinates,    *
+    * including the allocator overhead of each block.                          *
+    ***************************************************************************/
+    size_t graph_data_t_memory_usage(graph_data_t* p_data);
+
+    /***************************************************************************
+    * Builds the parents of all the nodes of the graph unless already built,   *
+    * which the bidirectional searches need. Returns false if there is not     *
+    * enough memory.                                                           *
+    ***************************************************************************/
+    bool graph_data_t_ensure_parents(graph_data_t* p_data);
+
+    /***************************************************************************
+    * Numbers the nodes of the graph by their position in the node array and   *
+    * packs the points of the point map into a coordinate store, unless        *
+    * already done. The store is scaled by the least cost per unit of length   *
+    * over all the arcs, which tightens the A* heuristic as far as it stays    *
+    * admissible. The scale only holds for the weights it was computed from,   *
+    * so call this again after changing any weight or arc: it recomputes the   *
+    * scale whenever 'directed_graph_version' moved on. Returns false if there *
+    * is not enough memory.                                                    *
+    ***************************************************************************/
+    bool graph_data_t_ensure_coordinates(graph_data_t* p_data);
+
+    /***************************************************************************
+    * Deallocates the graph, complete or partly built, with its nodes, their   *
+    * names and points, its weight function, its reverse arcs and its          *
+    * coordinates. Unbuilt nodes must be NULL.                                 *
+    ***************************************************************************/
+    void graph_data_t_free(graph_data_t* p_data);
     
     point_3d_t* random_point(double maxx, double maxy, double maxz);
 
@@ -51,6 +129,11 @@ extern "C" {
     directed_graph_node_t* choose(directed_graph_node_t** p_table,
                                   const size_t size);
 
+    /***************************************************************************
+    * Builds a graph of 'nodes' nodes at random points and 'edges' random      *
+    * arcs shorter than 'max_distance', each weighing 1.5 times its length.    *
+    * The nodes know their parents.                                            *
+    ***************************************************************************/
     graph_data_t* create_random_graph(const size_t nodes, 
                                       size_t edges,
                                       const double maxx,
@@ -58,6 +141,29 @@ extern "C" {
                                       const double maxz,
                                       const double max_distance);
 
+    /***************************************************************************
+    * Same as 'create_random_graph', but adds the arcs with                    *
+    * 'directed_graph_node_t_add_child', which saves the memory of the         *
+    * parents. The backward searches need 'graph_data_t_ensure_parents' first. *
+    ***************************************************************************/
+    graph_data_t* create_random_graph_without_parents(
+            const size_t nodes,
+            size_t edges,
+            const double maxx,
+            const double maxy,
+            const double maxz,
+            const double max_distance);
+
+    /***************************************************************************
+    * Loads the heuristic the options ask for, or else the one measuring the   *
+    * packed coordinates of the options, or else the one measuring the points  *
+    * of 'p_location_map', as the A* searches choose it. Returns false if      *
+    * there is none of them.                                                   *
+    ***************************************************************************/
+    bool choose_heuristic(heuristic_t* p_heuristic,
+                          unordered_map_t* p_location_map,
+                          search_options_t* p_options);
+
     list_t* traceback_path(directed_graph_node_t* p_target,
                            unordered_map_t* p_parent_map);
 
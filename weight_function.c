@@ -1,10 +1,21 @@
 #include "weight_function.h"
+#include "allocator.h"
+#include "memory_usage.h"
 #include "unordered_map.h"
+#include <stdatomic.h>
+#include <stdint.h>
 
 typedef struct directed_graph_weight_function_t {
     unordered_map_t* p_first_level_map;
     size_t (*p_hash_function)(void*);
     bool (*p_equals_function)(void*, void*);
+    allocator_t* p_allocator;
+    bool symmetric;
+    /* If set, the function is a view of the weights this finds. */
+    double* (*p_lookup)(void*, directed_graph_node_t*, directed_graph_node_t*);
+    void* p_context;
+    /* The graph version at the last change to the weights. */
+    _Atomic uint64_t version;
 } directed_graph_weight_function_t;
 
 static size_t INITIAL_CAPACITY = 16;
@@ -12,26 +23,112 @@ static size_t LOAD_FACTOR = 1.0f;
 
 directed_graph_weight_function_t* directed_graph_weight_function_t_alloc
                                  (size_t (*p_hash_function)(void*),
-                                  bool (*p_equals_function)(void*, void*))
+                                  bool (*p_equals_function)(void*, void*),
+                                  allocator_t* p_allocator)
 {
     directed_graph_weight_function_t* p_ret;
 
     if (!p_hash_function)   return NULL;
     if (!p_equals_function) return NULL;
 
-    p_ret = malloc(sizeof(*p_ret));
+    p_ret = allocator_t_alloc(p_allocator, sizeof(*p_ret));
 
     if (!p_ret) return NULL;
 
     p_ret->p_first_level_map = unordered_map_t_alloc(INITIAL_CAPACITY,
                                                      LOAD_FACTOR,
                                                      p_hash_function,
-                                                     p_equals_function);
+                                                     p_equals_function,
+                                                     p_allocator);
+    if (!p_ret->p_first_level_map)
+    {
+        allocator_t_free(p_allocator, p_ret);
+        return NULL;
+    }
+
     p_ret->p_hash_function   = p_hash_function;
     p_ret->p_equals_function = p_equals_function;
+    p_ret->p_allocator       = p_allocator;
+    p_ret->symmetric         = false;
+    p_ret->p_lookup          = NULL;
+    p_ret->p_context         = NULL;
+    atomic_init(&p_ret->version, directed_graph_weight_version_bump());
+    return p_ret;
+}
+
+directed_graph_weight_function_t* 
+directed_graph_weight_function_t_alloc_symmetric
+        (size_t (*p_hash_function)(void*),
+         bool (*p_equals_function)(void*, void*),
+         allocator_t* p_allocator)
+{
+    directed_graph_weight_function_t* p_ret = 
+            directed_graph_weight_function_t_alloc(p_hash_function,
+                                                   p_equals_function,
+                                                   p_allocator);
+
+    if (p_ret) p_ret->symmetric = true;
+
+    return p_ret;
+}
+
+directed_graph_weight_function_t*
+directed_graph_weight_function_t_alloc_view
+        (double* (*p_lookup)(void* p_context,
+                             directed_graph_node_t* p_tail,
+                             directed_graph_node_t* p_head),
+         void* p_context,
+         allocator_t* p_allocator)
+{
+    directed_graph_weight_function_t* p_ret;
+
+    if (!p_lookup) return NULL;
+
+    p_ret = allocator_t_calloc(p_allocator, 1, sizeof(*p_ret));
+
+    if (!p_ret) return NULL;
+
+    p_ret->p_allocator = p_allocator;
+    p_ret->p_lookup    = p_lookup;
+    p_ret->p_context   = p_context;
+    atomic_init(&p_ret->version, directed_graph_weight_version_bump());
     return p_ret;
 }
 
+/*******************************************************************************
+* A symmetric function files the weight of an edge under the endpoint at the   *
+* lower address, so that both directions find the same weight.                 *
+*******************************************************************************/
+static void order_endpoints(directed_graph_weight_function_t* p_function,
+                            directed_graph_node_t** pp_tail,
+                            directed_graph_node_t** pp_head)
+{
+    directed_graph_node_t* p_tmp;
+
+    if (p_function->symmetric && (uintptr_t) *pp_tail > (uintptr_t) *pp_head)
+    {
+        p_tmp    = *pp_tail;
+        *pp_tail = *pp_head;
+        *pp_head = p_tmp;
+    }
+}
+
+uint64_t directed_graph_weight_function_t_version
+    (directed_graph_weight_function_t* p_function)
+{
+    if (!p_function) return 0;
+
+    return atomic_load(&p_function->version);
+}
+
+void directed_graph_weight_function_t_changed
+    (directed_graph_weight_function_t* p_function)
+{
+    if (!p_function) return;
+
+    atomic_store(&p_function->version, directed_graph_weight_version_bump());
+}
+
 bool directed_graph_weight_function_t_put
     (directed_graph_weight_function_t* p_weight_function,
      directed_graph_node_t* p_tail,
@@ -45,21 +142,45 @@ bool directed_graph_weight_function_t_put
     if (!p_tail)            return false;
     if (!p_head)            return false;
 
+    if (p_weight_function->p_lookup)
+    {
+        p_weight = p_weight_function->p_lookup(p_weight_function->p_context,
+                                               p_tail,
+                                               p_head);
+
+        if (!p_weight) return false;
+
+        *p_weight = weight;
+        directed_graph_weight_function_t_changed(p_weight_function);
+        return true;
+    }
+
+    order_endpoints(p_weight_function, &p_tail, &p_head);
+    directed_graph_weight_function_t_changed(p_weight_function);
+
     p_tmp_map = unordered_map_t_get(p_weight_function->p_first_level_map,
                                     p_tail);
 
     if (p_tmp_map) 
     {
-        p_weight = malloc(sizeof(double));
+        p_weight = allocator_t_alloc(p_weight_function->p_allocator,
+                                     sizeof(double));
+
+        if (!p_weight) return false;
+
         *p_weight = weight;
-        unordered_map_t_put(p_tmp_map, p_head, p_weight);
+
+        /* Release the weight this one replaces, if any. */
+        allocator_t_free(p_weight_function->p_allocator,
+                         unordered_map_t_put(p_tmp_map, p_head, p_weight));
         return unordered_map_t_contains_key(p_tmp_map, p_head);
     }
 
     p_tmp_map = unordered_map_t_alloc(INITIAL_CAPACITY,
                                       LOAD_FACTOR,
                                       p_weight_function->p_hash_function,
-                                      p_weight_function->p_equals_function);
+                                      p_weight_function->p_equals_function,
+                                      p_weight_function->p_allocator);
 
     if (!p_tmp_map) return false;
 
@@ -70,14 +191,18 @@ bool directed_graph_weight_function_t_put
     if (!unordered_map_t_contains_key(p_weight_function->p_first_level_map, 
                                       p_tail)) return false;
 
-    p_weight = malloc(sizeof(double));
+    p_weight = allocator_t_alloc(p_weight_function->p_allocator,
+                                 sizeof(double));
+
+    if (!p_weight) return false;
+
     *p_weight = weight;
 
     unordered_map_t_put(p_tmp_map, p_head, p_weight);
 
     if (!unordered_map_t_contains_key(p_tmp_map, p_head)) 
     {
-        free(p_weight);
+        allocator_t_free(p_weight_function->p_allocator, p_weight);
         return false;
     }
 
@@ -95,6 +220,13 @@ double* directed_graph_weight_function_t_get(
     if (!p_tail)     return NULL;
     if (!p_head)     return NULL;
 
+    if (p_function->p_lookup)
+    {
+        return p_function->p_lookup(p_function->p_context, p_tail, p_head);
+    }
+
+    order_endpoints(p_function, &p_tail, &p_head);
+
     if (!(p_second_level_map = unordered_map_t_get(
             p_function->p_first_level_map, p_tail))) 
     {
@@ -104,18 +236,52 @@ double* directed_graph_weight_function_t_get(
     return unordered_map_t_get(p_second_level_map, p_head);
 }
 
+size_t directed_graph_weight_function_t_memory_usage
+    (directed_graph_weight_function_t* p_function)
+{
+    unordered_map_iterator_t* p_iterator;
+    void*                     p_node;
+    void*                     p_map;
+    size_t                    usage;
+
+    if (!p_function)          return 0;
+    if (p_function->p_lookup) return memory_block_size(sizeof(*p_function));
+
+    usage = memory_block_size(sizeof(*p_function)) +
+            unordered_map_t_memory_usage(p_function->p_first_level_map);
+
+    p_iterator = unordered_map_iterator_t_alloc(p_function->p_first_level_map);
+
+    while (unordered_map_iterator_t_has_next(p_iterator))
+    {
+        unordered_map_iterator_t_next(p_iterator, &p_node, &p_map);
+        usage += unordered_map_t_memory_usage(p_map) +
+                 memory_block_size(sizeof(double)) *
+                 unordered_map_t_size(p_map);
+    }
+
+    unordered_map_iterator_t_free(p_iterator);
+    return usage;
+}
+
 void directed_graph_weight_function_t_free
     (directed_graph_weight_function_t* p_function)
 {
     unordered_map_iterator_t* p_iterator;
     unordered_map_iterator_t* p_iterator_2;
-    unordered_map_t*          p_map;
-    directed_graph_node_t*    p_node;
-    directed_graph_node_t*    p_node_2;
-    double*                   p_weight;
+    void*                     p_node;
+    void*                     p_map;
+    void*                     p_node_2;
+    void*                     p_weight;
 
     if (!p_function) return;
 
+    if (p_function->p_lookup)
+    {
+        allocator_t_free(p_function->p_allocator, p_function);
+        return;
+    }
+
     p_iterator = unordered_map_iterator_t_alloc(p_function->p_first_level_map);
 
     while (unordered_map_iterator_t_has_next(p_iterator))
@@ -126,11 +292,14 @@ void directed_graph_weight_function_t_free
         while (unordered_map_iterator_t_has_next(p_iterator_2)) 
         {
             unordered_map_iterator_t_next(p_iterator_2, &p_node_2, &p_weight);
-            free(p_weight);
+            allocator_t_free(p_function->p_allocator, p_weight);
         }
 
+        unordered_map_iterator_t_free(p_iterator_2);
         unordered_map_t_free(p_map);
     }
 
+    unordered_map_iterator_t_free(p_iterator);
     unordered_map_t_free(p_function->p_first_level_map);
+    allocator_t_free(p_function->p_allocator, p_function);
 }
@@ -3,6 +3,7 @@
 
 #include "directed_graph_node.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef	__cplusplus
 extern "C" {
@@ -12,15 +13,57 @@ extern "C" {
                    directed_graph_weight_function_t;
 
     /***************************************************************************
-    * Allocates a new, empty weight function.                                  *
+    * Allocates a new, empty weight function. The function, its maps and the   *
+    * weights come from 'p_allocator', or from the C library if it is NULL.    *
     ***************************************************************************/  
     directed_graph_weight_function_t* 
     directed_graph_weight_function_t_alloc(size_t (*p_hash_function)(void*),
                                            bool (*p_equals_function)(void*, 
-                                                                     void*));
+                                                                     void*),
+                                           allocator_t* p_allocator);
 
     /***************************************************************************
-    * Associates the weight 'weight' with the arc ('p_tail', 'p_head').        *
+    * Allocates a new, empty weight function for undirected edges: the weight  *
+    * of ('p_tail', 'p_head') is the weight of ('p_head', 'p_tail'), and is    *
+    * stored once.                                                             *
+    ***************************************************************************/  
+    directed_graph_weight_function_t* 
+    directed_graph_weight_function_t_alloc_symmetric
+            (size_t (*p_hash_function)(void*),
+             bool (*p_equals_function)(void*, void*),
+             allocator_t* p_allocator);
+
+    /***************************************************************************
+    * Allocates a weight function that owns no weights but finds the weight of *
+    * each arc at the address 'p_lookup' returns for it, or NULL if the arc    *
+    * has none. This lets weights kept elsewhere serve every search.           *
+    ***************************************************************************/
+    directed_graph_weight_function_t*
+    directed_graph_weight_function_t_alloc_view
+            (double* (*p_lookup)(void* p_context,
+                                 directed_graph_node_t* p_tail,
+                                 directed_graph_node_t* p_head),
+             void* p_context,
+             allocator_t* p_allocator);
+
+    /***************************************************************************
+    * Returns the version of the function, which is the version of the graphs  *
+    * at the last change to its weights. A cached path found under the         *
+    * function is stale once this moves past the version it was found at.      *
+    ***************************************************************************/
+    uint64_t directed_graph_weight_function_t_version
+        (directed_graph_weight_function_t* p_function);
+
+    /***************************************************************************
+    * Changes the version of the function, and so the version of the graphs,   *
+    * for weights changed behind its back, such as those a view looks up.      *
+    ***************************************************************************/
+    void directed_graph_weight_function_t_changed
+        (directed_graph_weight_function_t* p_function);
+
+    /***************************************************************************
+    * Associates the weight 'weight' with the arc ('p_tail', 'p_head') and     *
+    * changes the version of the function.                                     *
     ***************************************************************************/  
     bool directed_graph_weight_function_t_put
         (directed_graph_weight_function_t* p_function,
@@ -36,6 +79,14 @@ extern "C" {
             directed_graph_node_t* p_tail,
             directed_graph_node_t* p_head);
 
+    /***************************************************************************
+    * Returns the number of bytes the weight function and all the stored       *
+    * weights take from the allocator, including the allocator overhead of     *
+    * each block.                                                              *
+    ***************************************************************************/
+    size_t directed_graph_weight_function_t_memory_usage
+        (directed_graph_weight_function_t* p_function);
+
     /***************************************************************************
     * Deallocate the weight function.                                          *
     ***************************************************************************/  
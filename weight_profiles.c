@@ -0,0 +1,360 @@
+#include "weight_profiles.h"
+#include "memory_usage.h"
+#include <math.h>
+
+/*******************************************************************************
+* A profile: its weights in the order of the arcs and the weight function      *
+* reading them.                                                                *
+*******************************************************************************/
+typedef struct weight_profile_t {
+    weight_profiles_t*                p_owner;
+    double*                           p_weights;
+    directed_graph_weight_function_t* p_weight_function;
+} weight_profile_t;
+
+struct weight_profiles_t {
+    /* The nodes of the graph, which belong to the caller. */
+    directed_graph_node_t** p_nodes;
+    /* The arcs of the node with id 'i' are numbered from 'p_first_arc[i]' up
+       to but excluding 'p_first_arc[i + 1]'. */
+    size_t*                 p_first_arc;
+    size_t                  node_count;
+    weight_profile_t**      p_profiles;
+    size_t                  size;
+    size_t                  capacity;
+    allocator_t*            p_allocator;
+};
+
+/*******************************************************************************
+* Returns true if the arc ('p_tail', 'p_head') is numbered among the arcs of   *
+* 'p_tail'. An undirected edge is numbered once, under its endpoint with the   *
+* lower id, so that both of its arcs share one weight.                         *
+*******************************************************************************/
+static bool owns_arc(directed_graph_node_t* p_tail,
+                     directed_graph_node_t* p_head)
+{
+    return !directed_graph_node_t_is_undirected(p_tail) ||
+           directed_graph_node_t_id(p_tail) <= directed_graph_node_t_id(p_head);
+}
+
+/*******************************************************************************
+* Returns the number of the arcs numbered among the arcs of 'p_node'.          *
+*******************************************************************************/
+static size_t owned_arc_count(directed_graph_node_t* p_node)
+{
+    directed_graph_node_t** p_children;
+    size_t                  child_count;
+    size_t                  count = 0;
+    size_t                  i;
+
+    p_children  = directed_graph_node_t_children(p_node);
+    child_count = directed_graph_node_t_child_count(p_node);
+
+    for (i = 0; i < child_count; ++i)
+    {
+        if (owns_arc(p_node, p_children[i])) ++count;
+    }
+
+    return count;
+}
+
+weight_profiles_t* weight_profiles_t_alloc(directed_graph_node_t** p_nodes,
+                                           size_t node_count,
+                                           allocator_t* p_allocator)
+{
+    weight_profiles_t* p_profiles;
+    size_t             i;
+
+    if (!p_nodes)                 return NULL;
+    if (node_count >= UINT32_MAX) return NULL;
+
+    p_profiles = allocator_t_calloc(p_allocator, 1, sizeof(*p_profiles));
+
+    if (!p_profiles) return NULL;
+
+    p_profiles->p_allocator = p_allocator;
+    p_profiles->p_nodes     = p_nodes;
+    p_profiles->node_count  = node_count;
+    p_profiles->p_first_arc = allocator_t_alloc(p_allocator,
+                                                sizeof(size_t) *
+                                                (node_count + 1));
+
+    if (!p_profiles->p_first_arc)
+    {
+        allocator_t_free(p_allocator, p_profiles);
+        return NULL;
+    }
+
+    p_profiles->p_first_arc[0] = 0;
+
+    /* The ids decide which endpoint numbers an edge, so set them all first. */
+    for (i = 0; i < node_count; ++i)
+    {
+        directed_graph_node_t_set_id(p_nodes[i], (uint32_t) i);
+    }
+
+    for (i = 0; i < node_count; ++i)
+    {
+        p_profiles->p_first_arc[i + 1] = p_profiles->p_first_arc[i] +
+                                         owned_arc_count(p_nodes[i]);
+    }
+
+    return p_profiles;
+}
+
+size_t weight_profiles_t_arc_index(weight_profiles_t* p_profiles,
+                                   directed_graph_node_t* p_tail,
+                                   directed_graph_node_t* p_head)
+{
+    directed_graph_node_t** p_children;
+    directed_graph_node_t*  p_tmp;
+    uint32_t                id;
+    size_t                  child_count;
+    size_t                  owned = 0;
+    size_t                  index = WEIGHT_PROFILE_NONE;
+    size_t                  i;
+
+    if (!p_profiles) return WEIGHT_PROFILE_NONE;
+    if (!p_tail)     return WEIGHT_PROFILE_NONE;
+    if (!p_head)     return WEIGHT_PROFILE_NONE;
+
+    /* Find an edge under the endpoint that numbers it. */
+    if (!owns_arc(p_tail, p_head))
+    {
+        p_tmp  = p_tail;
+        p_tail = p_head;
+        p_head = p_tmp;
+    }
+
+    id = directed_graph_node_t_id(p_tail);
+
+    if (id >= p_profiles->node_count) return WEIGHT_PROFILE_NONE;
+
+    p_children  = directed_graph_node_t_children(p_tail);
+    child_count = directed_graph_node_t_child_count(p_tail);
+
+    for (i = 0; i < child_count; ++i)
+    {
+        if (!owns_arc(p_tail, p_children[i])) continue;
+
+        if (p_children[i] == p_head) index = owned;
+
+        ++owned;
+    }
+
+    /* The arcs were numbered when the node had other children. */
+    if (owned != p_profiles->p_first_arc[id + 1] - p_profiles->p_first_arc[id])
+    {
+        return WEIGHT_PROFILE_NONE;
+    }
+
+    return index == WEIGHT_PROFILE_NONE ? 
+           index : 
+           p_profiles->p_first_arc[id] + index;
+}
+
+/*******************************************************************************
+* Finds the weight of an arc in a profile for the weight function of the       *
+* profile.                                                                     *
+*******************************************************************************/
+static double* lookup_weight(void* p_context,
+                             directed_graph_node_t* p_tail,
+                             directed_graph_node_t* p_head)
+{
+    weight_profile_t* p_profile = p_context;
+    size_t            index     = weight_profiles_t_arc_index(
+                                          p_profile->p_owner,
+                                          p_tail,
+                                          p_head);
+
+    return index == WEIGHT_PROFILE_NONE ? NULL : p_profile->p_weights + index;
+}
+
+/*******************************************************************************
+* Copies the weights of 'p_weight_function' into 'p_profile' in the order of   *
+* the arcs, or INFINITY for the arcs it has no weight for.                     *
+*******************************************************************************/
+static void load_weights(weight_profiles_t* p_profiles,
+                         weight_profile_t* p_profile,
+                         directed_graph_weight_function_t* p_weight_function)
+{
+    directed_graph_node_t*  p_node;
+    directed_graph_node_t** p_children;
+    double*                 p_weight;
+    size_t                  child_count;
+    size_t                  arc;
+    size_t                  i;
+    size_t                  j;
+
+    for (i = 0; i < p_profiles->node_count; ++i)
+    {
+        p_node      = p_profiles->p_nodes[i];
+        p_children  = directed_graph_node_t_children(p_node);
+        child_count = directed_graph_node_t_child_count(p_node);
+        arc         = p_profiles->p_first_arc[i];
+
+        for (j = 0; j < child_count; ++j)
+        {
+            if (!owns_arc(p_node, p_children[j])) continue;
+
+            p_weight = directed_graph_weight_function_t_get(p_weight_function,
+                                                            p_node,
+                                                            p_children[j]);
+
+            p_profile->p_weights[arc++] = p_weight ? *p_weight : INFINITY;
+        }
+    }
+}
+
+size_t weight_profiles_t_add(
+        weight_profiles_t* p_profiles,
+        directed_graph_weight_function_t* p_weight_function)
+{
+    weight_profile_t*  p_profile;
+    weight_profile_t** p_block;
+    size_t             arc_count;
+    size_t             capacity;
+
+    if (!p_profiles) return WEIGHT_PROFILE_NONE;
+
+    if (p_profiles->size == p_profiles->capacity)
+    {
+        capacity = p_profiles->capacity ? 2 * p_profiles->capacity : 4;
+
+        if (!(p_block = allocator_t_realloc(p_profiles->p_allocator,
+                                            p_profiles->p_profiles,
+                                            sizeof(*p_block) * capacity)))
+        {
+            return WEIGHT_PROFILE_NONE;
+        }
+
+        p_profiles->p_profiles = p_block;
+        p_profiles->capacity   = capacity;
+    }
+
+    arc_count = p_profiles->p_first_arc[p_profiles->node_count];
+
+    if (!(p_profile = allocator_t_alloc(p_profiles->p_allocator,
+                                        sizeof(*p_profile))))
+    {
+        return WEIGHT_PROFILE_NONE;
+    }
+
+    p_profile->p_owner   = p_profiles;
+    p_profile->p_weights = allocator_t_alloc(p_profiles->p_allocator,
+                                             sizeof(double) *
+                                             (arc_count ? arc_count : 1));
+    p_profile->p_weight_function =
+            directed_graph_weight_function_t_alloc_view(
+                    lookup_weight,
+                    p_profile,
+                    p_profiles->p_allocator);
+
+    if (!p_profile->p_weights || !p_profile->p_weight_function)
+    {
+        allocator_t_free(p_profiles->p_allocator, p_profile->p_weights);
+        directed_graph_weight_function_t_free(p_profile->p_weight_function);
+        allocator_t_free(p_profiles->p_allocator, p_profile);
+        return WEIGHT_PROFILE_NONE;
+    }
+
+    load_weights(p_profiles, p_profile, p_weight_function);
+    p_profiles->p_profiles[p_profiles->size] = p_profile;
+    return p_profiles->size++;
+}
+
+bool weight_profiles_t_load(
+        weight_profiles_t* p_profiles,
+        size_t profile,
+        directed_graph_weight_function_t* p_weight_function)
+{
+    if (!p_profiles)                 return false;
+    if (profile >= p_profiles->size) return false;
+
+    load_weights(p_profiles,
+                 p_profiles->p_profiles[profile],
+                 p_weight_function);
+    directed_graph_weight_function_t_changed(
+            p_profiles->p_profiles[profile]->p_weight_function);
+    return true;
+}
+
+directed_graph_weight_function_t* weight_profiles_t_weight_function(
+        weight_profiles_t* p_profiles,
+        size_t profile)
+{
+    if (!p_profiles)                 return NULL;
+    if (profile >= p_profiles->size) return NULL;
+
+    return p_profiles->p_profiles[profile]->p_weight_function;
+}
+
+double* weight_profiles_t_weights(weight_profiles_t* p_profiles,
+                                  size_t profile)
+{
+    if (!p_profiles)                 return NULL;
+    if (profile >= p_profiles->size) return NULL;
+
+    return p_profiles->p_profiles[profile]->p_weights;
+}
+
+size_t weight_profiles_t_arc_count(weight_profiles_t* p_profiles)
+{
+    return p_profiles ? p_profiles->p_first_arc[p_profiles->node_count] : 0;
+}
+
+size_t weight_profiles_t_size(weight_profiles_t* p_profiles)
+{
+    return p_profiles ? p_profiles->size : 0;
+}
+
+size_t weight_profiles_t_memory_usage(weight_profiles_t* p_profiles)
+{
+    size_t arc_count;
+    size_t usage;
+    size_t i;
+
+    if (!p_profiles) return 0;
+
+    arc_count = weight_profiles_t_arc_count(p_profiles);
+    usage     = memory_block_size(sizeof(*p_profiles)) +
+                memory_block_size(sizeof(size_t) *
+                                  (p_profiles->node_count + 1));
+
+    if (p_profiles->capacity > 0)
+    {
+        usage += memory_block_size(sizeof(weight_profile_t*) *
+                                   p_profiles->capacity);
+    }
+
+    for (i = 0; i < p_profiles->size; ++i)
+    {
+        usage += memory_block_size(sizeof(weight_profile_t)) +
+                 memory_block_size(sizeof(double) *
+                                   (arc_count ? arc_count : 1)) +
+                 directed_graph_weight_function_t_memory_usage(
+                         p_profiles->p_profiles[i]->p_weight_function);
+    }
+
+    return usage;
+}
+
+void weight_profiles_t_free(weight_profiles_t* p_profiles)
+{
+    size_t i;
+
+    if (!p_profiles) return;
+
+    for (i = 0; i < p_profiles->size; ++i)
+    {
+        directed_graph_weight_function_t_free(
+                p_profiles->p_profiles[i]->p_weight_function);
+        allocator_t_free(p_profiles->p_allocator,
+                         p_profiles->p_profiles[i]->p_weights);
+        allocator_t_free(p_profiles->p_allocator, p_profiles->p_profiles[i]);
+    }
+
+    allocator_t_free(p_profiles->p_allocator, p_profiles->p_profiles);
+    allocator_t_free(p_profiles->p_allocator, p_profiles->p_first_arc);
+    allocator_t_free(p_profiles->p_allocator, p_profiles);
+}
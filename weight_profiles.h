@@ -0,0 +1,112 @@
+#ifndef WEIGHT_PROFILES_H
+#define	WEIGHT_PROFILES_H
+
+#include "allocator.h"
+#include "directed_graph_node.h"
+#include "weight_function.h"
+#include <stdlib.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+    /* The index returned when no profile could be added. */
+#define WEIGHT_PROFILE_NONE ((size_t) -1)
+
+    /***************************************************************************
+    * Several sets of arc weights, or profiles, over one graph, such as the    *
+    * travel times of cars, trucks and bicycles. The arcs are numbered once,   *
+    * by their tails in the order of the nodes and then in the order of the    *
+    * children of each tail, and each profile is one array of weights in that  *
+    * order. An undirected edge is numbered once, under its endpoint with the  *
+    * lower id, so its two arcs share one weight in every profile, as in a     *
+    * symmetric weight function. Each profile is also a weight function that   *
+    * every search takes, so choosing a profile for a query costs nothing.     *
+    * The arcs of the graph must not change while the profiles are in use.     *
+    ***************************************************************************/
+    typedef struct weight_profiles_t weight_profiles_t;
+
+    /***************************************************************************
+    * Numbers the arcs of the 'node_count' nodes of 'p_nodes' for profiles to  *
+    * come, and gives each node its position in 'p_nodes' as its id, as        *
+    * 'graph_data_t_ensure_coordinates' does. The array 'p_nodes' must outlive *
+    * the profiles. The profiles come from 'p_allocator', or from the C        *
+    * library if it is NULL. Returns NULL if there is not enough memory.       *
+    ***************************************************************************/
+    weight_profiles_t* weight_profiles_t_alloc(directed_graph_node_t** p_nodes,
+                                               size_t node_count,
+                                               allocator_t* p_allocator);
+
+    /***************************************************************************
+    * Adds a profile holding the weights of 'p_weight_function', or INFINITY   *
+    * for the arcs it has no weight for or for all the arcs if it is NULL.     *
+    * Returns the index of the profile, or WEIGHT_PROFILE_NONE if there is not *
+    * enough memory.                                                           *
+    ***************************************************************************/
+    size_t weight_profiles_t_add(
+            weight_profiles_t* p_profiles,
+            directed_graph_weight_function_t* p_weight_function);
+
+    /***************************************************************************
+    * Replaces the weights of the profile 'profile' by those of                *
+    * 'p_weight_function', as 'weight_profiles_t_add' takes them, and changes  *
+    * the version of its weight function. The other profiles are left alone.   *
+    * Returns false if there is no such profile.                               *
+    ***************************************************************************/
+    bool weight_profiles_t_load(
+            weight_profiles_t* p_profiles,
+            size_t profile,
+            directed_graph_weight_function_t* p_weight_function);
+
+    /***************************************************************************
+    * Returns the weight function reading and writing the profile 'profile',   *
+    * or NULL if there is no such profile. It belongs to the profiles.         *
+    ***************************************************************************/
+    directed_graph_weight_function_t* weight_profiles_t_weight_function(
+            weight_profiles_t* p_profiles,
+            size_t profile);
+
+    /***************************************************************************
+    * Returns the weights of the profile 'profile' in the order of the arcs,   *
+    * or NULL if there is no such profile. Writing to them goes behind the     *
+    * back of the caches, so call 'directed_graph_weight_function_t_changed'   *
+    * on the weight function of the profile after it.                          *
+    ***************************************************************************/
+    double* weight_profiles_t_weights(weight_profiles_t* p_profiles,
+                                      size_t profile);
+
+    /***************************************************************************
+    * Returns the number of the arc ('p_tail', 'p_head'), which indexes the    *
+    * weights of every profile, or WEIGHT_PROFILE_NONE if there is no such     *
+    * arc. Both arcs of an undirected edge have the same number.               *
+    ***************************************************************************/
+    size_t weight_profiles_t_arc_index(weight_profiles_t* p_profiles,
+                                       directed_graph_node_t* p_tail,
+                                       directed_graph_node_t* p_head);
+
+    /***************************************************************************
+    * Returns the number of the arcs, counting each undirected edge once.      *
+    ***************************************************************************/
+    size_t weight_profiles_t_arc_count(weight_profiles_t* p_profiles);
+
+    /***************************************************************************
+    * Returns the number of the profiles.                                      *
+    ***************************************************************************/
+    size_t weight_profiles_t_size(weight_profiles_t* p_profiles);
+
+    /***************************************************************************
+    * Returns the number of bytes the profiles take from the allocator,        *
+    * including the allocator overhead of each block.                          *
+    ***************************************************************************/
+    size_t weight_profiles_t_memory_usage(weight_profiles_t* p_profiles);
+
+    /***************************************************************************
+    * Deallocates the profiles and their weight functions.                     *
+    ***************************************************************************/
+    void weight_profiles_t_free(weight_profiles_t* p_profiles);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* WEIGHT_PROFILES_H */